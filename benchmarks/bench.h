@@ -0,0 +1,258 @@
+// ? Small harness shared by the benchmarks.
+// ? Each benchmark is built from a single .cpp file which includes this header once,
+// ?  as the header replaces the global operator new to count allocations and track the heap's size.
+// ? The counters are not atomic so the benchmarks must stay single threaded.
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <vector>
+#include <zeta/physicshandler.h>
+
+#include "perf.h"
+
+namespace Bench {
+    static uint64_t allocations = 0; // number of allocations made through operator new since the program started
+    static size_t liveBytes = 0; // bytes currently allocated through operator new
+    static size_t peakBytes = 0; // most bytes allocated at once since the last call to resetPeakBytes
+
+    // Start tracking the high-water mark of the heap from its current size.
+    inline void resetPeakBytes() { peakBytes = liveBytes; };
+
+    // ? Each allocation is prefixed with its size so operator delete knows how many bytes it frees.
+    // ? The prefix is a full max_align_t so the memory handed out keeps malloc's alignment.
+    static const size_t allocHeader = alignof(std::max_align_t);
+
+    // ? The replaced operators only forward to these two functions.
+    // ? Keeping the size prefix out of operator new stops the compiler from treating the offset pointer as
+    // ?  the start of a new'd block, which otherwise raises false mismatched-new-delete and array-bounds warnings.
+
+    // Allocate size bytes behind a size prefix and count the allocation.
+    // Returns nullptr if malloc fails.
+    __attribute__((noinline)) static void* allocate(size_t size) {
+        char* p = (char*) malloc(size + allocHeader);
+        if (!p) { return nullptr; }
+
+        *((size_t*) p) = size;
+
+        ++allocations;
+        liveBytes += size;
+        if (liveBytes > peakBytes) { peakBytes = liveBytes; }
+
+        return p + allocHeader;
+    };
+
+    // Free memory returned by allocate and remove its size from the live bytes.
+    __attribute__((noinline)) static void release(void* p) {
+        if (!p) { return; }
+
+        char* base = (char*) p - allocHeader;
+        liveBytes -= *((size_t*) base);
+        free(base);
+    };
+}
+
+// * ===================================
+// * Allocation Tracking
+// * ===================================
+
+void* operator new(size_t size, std::nothrow_t const &) noexcept { return Bench::allocate(size); }
+
+void* operator new(size_t size) {
+    void* p = Bench::allocate(size);
+    if (!p) { throw std::bad_alloc(); }
+
+    return p;
+}
+
+void operator delete(void* p) noexcept { Bench::release(p); }
+
+void* operator new[](size_t size) { return operator new(size); }
+void* operator new[](size_t size, std::nothrow_t const &) noexcept { return operator new(size, std::nothrow); }
+void operator delete[](void* p) noexcept { operator delete(p); }
+void operator delete(void* p, size_t) noexcept { operator delete(p); }
+void operator delete[](void* p, size_t) noexcept { operator delete(p); }
+void operator delete(void* p, std::nothrow_t const &) noexcept { operator delete(p); }
+void operator delete[](void* p, std::nothrow_t const &) noexcept { operator delete(p); }
+
+namespace Bench {
+    // * ===================================
+    // * Seeded Random Numbers
+    // * ===================================
+
+    // xorshift64* generator. The same seed always gives the same inputs on every platform.
+    class Random {
+        private:
+            uint64_t state;
+
+        public:
+            Random(uint64_t seed) : state(seed ? seed : 0x9E3779B97F4A7C15ull) {};
+
+            inline uint64_t next() {
+                state ^= state >> 12;
+                state ^= state << 25;
+                state ^= state >> 27;
+                return state * 0x2545F4914F6CDD1Dull;
+            };
+
+            // Uniform float in [min, max).
+            inline float uniform(float min, float max) { return min + (max - min) * ((next() >> 40) * (1.0f/16777216.0f)); };
+
+            // Uniform vector in the box [min, max).
+            inline ZMath::Vec3D vec(float min, float max) { return ZMath::Vec3D(uniform(min, max), uniform(min, max), uniform(min, max)); };
+
+            // Uniform direction.
+            ZMath::Vec3D dir() {
+                ZMath::Vec3D v;
+                do { v = vec(-1.0f, 1.0f); } while (v.magSq() > 1.0f || v.magSq() < 1e-4f);
+                return v.normalize();
+            };
+
+            inline bool chance(float p) { return uniform(0.0f, 1.0f) < p; };
+    };
+
+    // * ===================================
+    // * Timing
+    // * ===================================
+
+    typedef std::chrono::steady_clock Clock;
+
+    inline double secondsSince(Clock::time_point const &start) {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    };
+
+    typedef struct Result {
+        char const* name;
+        double ns; // nanoseconds per call
+        double allocs; // allocations per call
+        double hitRatio; // fraction of the calls which reported a hit
+        bool hasCounters; // 1 if the hardware counters were read
+        CounterValues counters; // hardware counts per call
+    } Result;
+
+    /**
+     * @brief Time a function over a set of inputs.
+     *        The inputs are run in passes until minTime has passed so short functions are timed over many calls.
+     *
+     * @param name Name to report.
+     * @param n Number of inputs.
+     * @param minTime Minimum number of seconds to time for.
+     * @param fn Callable with the signature bool(int i) running the function on input i and returning if it hit.
+     * @param perf Hardware counters to read around the timed calls. nullptr to skip reading them.
+     * @return (Result) The time, allocations and hardware counts per call.
+     */
+    template <typename Fn>
+    Result run(char const* name, int n, double minTime, Fn fn, PerfCounters const* perf = nullptr) {
+        Result result;
+        memset(&result, 0, sizeof(result));
+        result.name = name;
+
+        if (n <= 0) { return result; }
+
+        // warm up the caches and count the hits once
+        int hits = 0;
+        for (int i = 0; i < n; ++i) { hits += fn(i); }
+
+        uint64_t startAllocs = allocations;
+        uint64_t calls = 0;
+        volatile int sink = 0;
+
+        CounterValues startCounts;
+        if (perf) { startCounts = perf->read(); }
+
+        Clock::time_point start = Clock::now();
+        double elapsed = 0.0;
+
+        do {
+            int passHits = 0;
+            for (int i = 0; i < n; ++i) { passHits += fn(i); }
+
+            sink = sink + passHits;
+            calls += n;
+            elapsed = secondsSince(start);
+        } while (elapsed < minTime);
+
+        if (perf) {
+            result.hasCounters = 1;
+            result.counters = difference(perf->read(), startCounts);
+
+            for (int i = 0; i < NUM_COUNTERS; ++i) { result.counters[i] /= calls; }
+        }
+
+        result.ns = elapsed * 1e9/calls;
+        result.allocs = (double) (allocations - startAllocs)/calls;
+        result.hitRatio = (double) hits/n;
+
+        return result;
+    };
+
+    // * ===================================
+    // * Reporting
+    // * ===================================
+
+    // Print the header of the hardware counter columns.
+    inline void printCounterHeader() { printf(" %10s %6s %9s %9s %9s", "cycles", "IPC", "L1D miss", "LLC miss", "br miss"); };
+
+    // Print the hardware counter columns. The cycles are divided by per to report them per call, step, etc.
+    inline void printCounters(CounterValues const &c, double per) {
+        printf(" %10.1f %6.2f %8.2f%% %8.2f%% %8.2f%%", ratio(c[COUNTER_CYCLES], per), getIPC(c),
+               getL1DMissRate(c) * 100.0, getLLCMissRate(c) * 100.0, getBranchMissRate(c) * 100.0);
+    };
+
+    inline void printHeader(bool counters = 0) {
+        printf("%-64s %12s %12s %8s", "benchmark", "ns/call", "allocs/call", "hit %");
+        if (counters) { printCounterHeader(); }
+        printf("\n");
+    };
+
+    inline void printResult(Result const &r) {
+        printf("%-64s %12.2f %12.3f %8.1f", r.name, r.ns, r.allocs, r.hitRatio * 100.0);
+        if (r.hasCounters) { printCounters(r.counters, 1.0); }
+        printf("\n");
+    };
+
+    // Write a string as a JSON string.
+    inline void writeString(FILE* file, char const* str) {
+        fputc('"', file);
+
+        for (; *str; ++str) {
+            if (*str == '"' || *str == '\\') { fputc('\\', file); }
+            if ((unsigned char) *str >= 0x20) { fputc(*str, file); }
+        }
+
+        fputc('"', file);
+    };
+
+    // Write hardware counts and the rates derived from them as a JSON object.
+    inline void writeCounters(FILE* file, CounterValues const &c) {
+        fputc('{', file);
+        for (int i = 0; i < NUM_COUNTERS; ++i) { fprintf(file, "\"%s\":%.2f,", counterNames[i], c[i]); }
+
+        fprintf(file, "\"ipc\":%.4f,\"l1dMissRate\":%.4f,\"llcMissRate\":%.4f,\"branchMissRate\":%.4f}",
+                getIPC(c), getL1DMissRate(c), getLLCMissRate(c), getBranchMissRate(c));
+    };
+
+    // Check if a command line flag is present.
+    inline bool hasFlag(int argc, char** argv, char const* flag) {
+        for (int i = 1; i < argc; ++i) {
+            if (!strcmp(argv[i], flag)) { return 1; }
+        }
+
+        return 0;
+    };
+
+    // Get the value following a command line flag or def if it is missing.
+    inline char const* getArg(int argc, char** argv, char const* flag, char const* def) {
+        for (int i = 1; i < argc - 1; ++i) {
+            if (!strcmp(argv[i], flag)) { return argv[i + 1]; }
+        }
+
+        return def;
+    };
+}
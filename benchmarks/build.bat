@@ -0,0 +1,15 @@
+@echo off
+
+@REM Benchmarks are always built with optimizations on. They only need the zeta headers.
+
+if not exist ".\build" (
+    echo "Creating `.\build` directory"
+    mkdir ".\build"
+)
+
+pushd "./build"
+    g++ -O2 -std=c++14 ..\narrowphase.cpp -o narrowphase -I..\..\include
+    g++ -O2 -std=c++14 ..\scenes.cpp -o scenes -I..\..\include
+    g++ -O2 -std=c++14 ..\sensors.cpp -o sensors -I..\..\include
+    g++ -O2 -std=c++14 ..\quantization.cpp -o quantization -I..\..\include
+popd
@@ -0,0 +1,11 @@
+#!/bin/sh
+
+# Benchmarks are always built with optimizations on. They only need the zeta headers.
+
+cd "$(dirname "$0")"
+mkdir -p build
+
+g++ -O2 -std=c++14 narrowphase.cpp -o build/narrowphase -I../include
+g++ -O2 -std=c++14 scenes.cpp -o build/scenes -I../include
+g++ -O2 -std=c++14 sensors.cpp -o build/sensors -I../include
+g++ -O2 -std=c++14 quantization.cpp -o build/quantization -I../include
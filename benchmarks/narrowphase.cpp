@@ -0,0 +1,814 @@
+// ? Microbenchmarks of every narrowphase and intersection routine.
+// ? Each routine is timed over a set of seeded random pairs placed so a controllable fraction of them overlap.
+// ? Reports the time and heap allocations per call along with the fraction of calls which actually hit.
+// ?
+// ? Usage: narrowphase [--seed n] [--hit-ratio r] [--pairs n] [--time seconds] [--filter substring] [--json path] [--perf]
+
+#include "bench.h"
+
+using namespace Zeta;
+
+typedef ZMath::Vec3D Point; // makes the benchmark names read like the routines' names
+
+typedef struct Triangle {
+    ZMath::Vec3D a, b, c;
+} Triangle;
+
+// * ===================================
+// * Settings
+// * ===================================
+
+static struct Config {
+    uint64_t seed = 1;
+    float hitRatio = 0.5f; // fraction of the pairs placed to overlap
+    int pairs = 4096; // number of inputs for each benchmark
+    double time = 0.2; // minimum seconds spent timing each benchmark
+    char const* filter = nullptr; // only run benchmarks with names containing this
+} config;
+
+static std::vector<Bench::Result> results;
+static Bench::PerfCounters* perf = nullptr; // hardware counters read around each benchmark. nullptr unless --perf is passed.
+
+// Check if a benchmark passes the filter.
+static bool selected(char const* name) { return !config.filter || strstr(name, config.filter); };
+
+template <typename Fn>
+static void report(char const* name, int n, Fn fn) {
+    Bench::Result result = Bench::run(name, n, config.time, fn, perf);
+
+    Bench::printResult(result);
+    results.push_back(result);
+};
+
+// * ===================================
+// * Random Shapes
+// * ===================================
+
+// ? Each shape is made around a center with a size around 1.
+// ? inner is set to the radius of a ball around the center which the shape contains.
+// ? outer is set to the radius of a ball around the center which contains the shape.
+// ? Two shapes are guaranteed to overlap when their centers are closer than the sum of their inner radii
+// ?  and guaranteed not to overlap when their centers are further than the sum of their outer radii.
+
+template <typename T> struct Shape;
+
+template <> struct Shape<Point> {
+    static Point make(Bench::Random &, ZMath::Vec3D const &c, float &inner, float &outer) {
+        inner = outer = 0.0f;
+        return c;
+    };
+};
+
+template <> struct Shape<Line3D> {
+    static Line3D make(Bench::Random &rng, ZMath::Vec3D const &c, float &inner, float &outer) {
+        ZMath::Vec3D d = rng.dir() * rng.uniform(0.5f, 1.0f);
+
+        inner = 0.0f;
+        outer = d.mag();
+        return Line3D(c - d, c + d);
+    };
+};
+
+template <> struct Shape<Plane> {
+    static Plane make(Bench::Random &rng, ZMath::Vec3D const &c, float &inner, float &outer) {
+        float h = rng.uniform(0.4f, 0.6f);
+
+        inner = 0.0f;
+        outer = h * 1.4143f;
+        return Plane(ZMath::Vec2D(c.x - h, c.y - h), ZMath::Vec2D(c.x + h, c.y + h), c.z, rng.uniform(0.0f, 360.0f), rng.uniform(0.0f, 360.0f));
+    };
+
+    static StaticBodyCollider staticType() { return STATIC_PLANE_COLLIDER; };
+};
+
+template <> struct Shape<Sphere> {
+    static Sphere make(Bench::Random &rng, ZMath::Vec3D const &c, float &inner, float &outer) {
+        inner = outer = rng.uniform(0.4f, 0.6f);
+        return Sphere(c, inner);
+    };
+
+    static RigidBodyCollider rigidType() { return RIGID_SPHERE_COLLIDER; };
+    static StaticBodyCollider staticType() { return STATIC_SPHERE_COLLIDER; };
+};
+
+template <> struct Shape<AABB> {
+    static AABB make(Bench::Random &rng, ZMath::Vec3D const &c, float &inner, float &outer) {
+        ZMath::Vec3D h = rng.vec(0.4f, 0.57f);
+
+        inner = ZMath::min(h.x, ZMath::min(h.y, h.z));
+        outer = h.mag();
+        return AABB(c - h, c + h);
+    };
+
+    static RigidBodyCollider rigidType() { return RIGID_AABB_COLLIDER; };
+    static StaticBodyCollider staticType() { return STATIC_AABB_COLLIDER; };
+};
+
+template <> struct Shape<Cube> {
+    static Cube make(Bench::Random &rng, ZMath::Vec3D const &c, float &inner, float &outer) {
+        ZMath::Vec3D h = rng.vec(0.4f, 0.57f);
+
+        inner = ZMath::min(h.x, ZMath::min(h.y, h.z));
+        outer = h.mag();
+        return Cube(c - h, c + h, rng.uniform(0.0f, 360.0f), rng.uniform(0.0f, 360.0f));
+    };
+
+    static RigidBodyCollider rigidType() { return RIGID_CUBE_COLLIDER; };
+    static StaticBodyCollider staticType() { return STATIC_CUBE_COLLIDER; };
+};
+
+template <> struct Shape<Capsule> {
+    static Capsule make(Bench::Random &rng, ZMath::Vec3D const &c, float &inner, float &outer) {
+        ZMath::Vec3D d = rng.dir() * rng.uniform(0.3f, 0.5f);
+
+        inner = rng.uniform(0.3f, 0.45f);
+        outer = d.mag() + inner;
+        return Capsule(c - d, c + d, inner);
+    };
+
+    static RigidBodyCollider rigidType() { return RIGID_CAPSULE_COLLIDER; };
+    static StaticBodyCollider staticType() { return STATIC_CAPSULE_COLLIDER; };
+};
+
+// A sphere at the center surrounded by a small box, cube and capsule.
+template <> struct Shape<Compound> {
+    static Compound make(Bench::Random &rng, ZMath::Vec3D const &c, float &inner, float &outer) {
+        RigidBodyCollider types[4] = {RIGID_SPHERE_COLLIDER, RIGID_AABB_COLLIDER, RIGID_CUBE_COLLIDER, RIGID_CAPSULE_COLLIDER};
+        void* colliders[4];
+        ZMath::Vec3D h(0.25f, 0.25f, 0.25f);
+
+        colliders[0] = new Sphere(c, 0.5f);
+
+        ZMath::Vec3D o = c + rng.dir() * 0.6f;
+        colliders[1] = new AABB(o - h, o + h);
+
+        o = c + rng.dir() * 0.6f;
+        colliders[2] = new Cube(o - h, o + h, rng.uniform(0.0f, 360.0f), rng.uniform(0.0f, 360.0f));
+
+        o = c + rng.dir() * 0.6f;
+        ZMath::Vec3D d = rng.dir() * 0.2f;
+        colliders[3] = new Capsule(o - d, o + d, 0.2f);
+
+        inner = 0.5f;
+        outer = 0.6f + h.mag();
+        return Compound(c, types, colliders, 4);
+    };
+
+    static RigidBodyCollider rigidType() { return RIGID_COMPOUND_COLLIDER; };
+};
+
+template <> struct Shape<Triangle> {
+    static Triangle make(Bench::Random &rng, ZMath::Vec3D const &c, float &inner, float &outer) {
+        // the centroid of the triangle is the center
+        ZMath::Vec3D u = rng.dir() * rng.uniform(0.5f, 1.0f), v = rng.dir() * rng.uniform(0.5f, 1.0f);
+
+        inner = 0.0f;
+        outer = ZMath::max(u.mag(), ZMath::max(v.mag(), (u + v).mag()));
+        return {c + u, c + v, c - u - v};
+    };
+};
+
+// * ===================================
+// * Inputs
+// * ===================================
+
+/**
+ * @brief Make the pairs of shapes for a benchmark. Each pair overlaps with a chance of config.hitRatio.
+ *
+ * @param as Filled with the first shape of each pair.
+ * @param bs Filled with the second shape of each pair.
+ */
+template <typename A, typename B>
+static void makePairs(std::vector<A> &as, std::vector<B> &bs) {
+    Bench::Random rng(config.seed);
+
+    as.reserve(config.pairs);
+    bs.reserve(config.pairs);
+
+    for (int i = 0; i < config.pairs; ++i) {
+        float innerA, outerA, innerB, outerB;
+        ZMath::Vec3D c = rng.vec(-100.0f, 100.0f);
+
+        as.push_back(Shape<A>::make(rng, c, innerA, outerA));
+
+        bool hit = rng.chance(config.hitRatio);
+        ZMath::Vec3D dir = rng.dir();
+        float f = hit ? rng.uniform(0.0f, 1.0f) : rng.uniform(1.01f, 1.5f);
+
+        // ? B's size is needed to place it. Making it from a copy of the generator gives the same size it is made with after.
+        Bench::Random sizer = rng;
+        Shape<B>::make(sizer, ZMath::Vec3D(), innerB, outerB);
+
+        float d = hit ? f * (innerA + innerB) : f * (outerA + outerB);
+        bs.push_back(Shape<B>::make(rng, c + dir*d, innerB, outerB));
+    }
+};
+
+// Make a ray aimed at the center of each shape, or directly away from it for a miss.
+template <typename T>
+static void makeRays(std::vector<T> &shapes, std::vector<Ray3D> &rays) {
+    Bench::Random rng(config.seed);
+
+    shapes.reserve(config.pairs);
+    rays.reserve(config.pairs);
+
+    for (int i = 0; i < config.pairs; ++i) {
+        float inner, outer;
+        ZMath::Vec3D c = rng.vec(-100.0f, 100.0f);
+
+        shapes.push_back(Shape<T>::make(rng, c, inner, outer));
+
+        bool hit = rng.chance(config.hitRatio);
+        ZMath::Vec3D dir = rng.dir();
+        ZMath::Vec3D origin = c - dir*(outer + rng.uniform(1.0f, 5.0f));
+
+        rays.push_back(Ray3D(origin, hit ? dir : -dir));
+    }
+};
+
+// Make a packet of rays aimed at each shape. Each lane hits with a chance of config.hitRatio.
+template <typename T>
+static void makePackets(std::vector<T> &shapes, std::vector<RayPacket> &packets) {
+    Bench::Random rng(config.seed);
+
+    shapes.reserve(config.pairs);
+    packets.reserve(config.pairs);
+
+    for (int i = 0; i < config.pairs; ++i) {
+        float inner, outer;
+        ZMath::Vec3D c = rng.vec(-100.0f, 100.0f);
+        std::vector<Ray3D> rays;
+
+        shapes.push_back(Shape<T>::make(rng, c, inner, outer));
+
+        for (int j = 0; j < RAY_PACKET_SIZE; ++j) {
+            bool hit = rng.chance(config.hitRatio);
+            ZMath::Vec3D dir = rng.dir();
+            ZMath::Vec3D origin = c - dir*(outer + rng.uniform(1.0f, 5.0f));
+
+            rays.push_back(Ray3D(origin, hit ? dir : -dir));
+        }
+
+        packets.push_back(RayPacket(rays.data(), RAY_PACKET_SIZE));
+    }
+};
+
+// * ===================================
+// * Heightfield Inputs
+// * ===================================
+
+// ? Every heightfield benchmark shares the same rolling terrain with heights between 0 and 2.
+
+#define TERRAIN_CELLS 64
+#define TERRAIN_TILE_CELLS 32
+#define TERRAIN_MAX_HEIGHT 2.0f
+
+static Heightfield* terrain = nullptr;
+
+static void makeTerrain() {
+    terrain = new Heightfield(ZMath::Vec3D(-0.5f * TERRAIN_CELLS, -0.5f * TERRAIN_CELLS, 0.0f), TERRAIN_CELLS, TERRAIN_CELLS, 1.0f,
+                              TERRAIN_TILE_CELLS, HEIGHTFIELD_FLOAT);
+
+    int side = TERRAIN_TILE_CELLS + 1;
+    float* samples = new float[side * side];
+
+    for (int ty = 0; ty < TERRAIN_CELLS/TERRAIN_TILE_CELLS; ++ty) {
+        for (int tx = 0; tx < TERRAIN_CELLS/TERRAIN_TILE_CELLS; ++tx) {
+            for (int j = 0; j < side; ++j) {
+                for (int i = 0; i < side; ++i) {
+                    float x = (float) (tx * TERRAIN_TILE_CELLS + i), y = (float) (ty * TERRAIN_TILE_CELLS + j);
+                    samples[j * side + i] = 1.0f + 0.6f * sinf(0.35f * x) * cosf(0.25f * y) + 0.3f * sinf(0.9f * (x + y));
+                }
+            }
+
+            terrain->loadTile(tx, ty, samples);
+        }
+    }
+
+    delete[] samples;
+};
+
+// Random point on the surface of the terrain away from its edges.
+static ZMath::Vec3D getTerrainPoint(Bench::Random &rng) {
+    float h, half = 0.5f * TERRAIN_CELLS - 4.0f;
+    ZMath::Vec3D normal;
+    ZMath::Vec3D p(rng.uniform(-half, half), rng.uniform(-half, half), 0.0f);
+
+    terrain->getHeight(p.x, p.y, h, normal);
+    p.z = h;
+
+    return p;
+};
+
+// Make shapes which either straddle the surface of the terrain or float above its highest point.
+template <typename T>
+static void makeTerrainShapes(std::vector<T> &shapes) {
+    Bench::Random rng(config.seed);
+    shapes.reserve(config.pairs);
+
+    for (int i = 0; i < config.pairs; ++i) {
+        float inner, outer;
+        ZMath::Vec3D c = getTerrainPoint(rng);
+
+        bool hit = rng.chance(config.hitRatio);
+        float f = hit ? rng.uniform(-0.9f, 0.9f) : rng.uniform(1.1f, 2.0f);
+
+        Bench::Random sizer = rng;
+        Shape<T>::make(sizer, ZMath::Vec3D(), inner, outer);
+
+        c.z = hit ? c.z + f*inner : TERRAIN_MAX_HEIGHT + f*outer;
+        shapes.push_back(Shape<T>::make(rng, c, inner, outer));
+    }
+};
+
+// Make rays coming down onto the terrain, or leaving it upwards for a miss.
+static void makeTerrainRays(std::vector<Ray3D> &rays) {
+    Bench::Random rng(config.seed);
+    rays.reserve(config.pairs);
+
+    for (int i = 0; i < config.pairs; ++i) {
+        ZMath::Vec3D target = getTerrainPoint(rng);
+        bool hit = rng.chance(config.hitRatio);
+
+        ZMath::Vec3D dir = rng.dir();
+        dir.z = fabsf(dir.z) + 0.5f;
+        dir = dir.normalize();
+
+        ZMath::Vec3D origin = target + dir*rng.uniform(3.0f, 8.0f);
+        rays.push_back(Ray3D(origin, hit ? -dir : dir));
+    }
+};
+
+// * ===================================
+// * Frustum Inputs
+// * ===================================
+
+// Make camera frustums with a shape either in front of the camera or behind it for a miss.
+template <typename T>
+static void makeFrustumPairs(std::vector<Frustum> &frustums, std::vector<T> &shapes) {
+    Bench::Random rng(config.seed);
+
+    frustums.reserve(config.pairs);
+    shapes.reserve(config.pairs);
+
+    for (int i = 0; i < config.pairs; ++i) {
+        float inner, outer;
+        ZMath::Vec3D pos = rng.vec(-100.0f, 100.0f), forward = rng.dir();
+        ZMath::Vec3D up = forward.cross(fabsf(forward.z) < 0.9f ? ZMath::Vec3D(0, 0, 1) : ZMath::Vec3D(1, 0, 0)).normalize();
+
+        frustums.push_back(Frustum(pos, forward, up, 60.0f, 16.0f/9.0f, 0.1f, 10.0f));
+
+        bool hit = rng.chance(config.hitRatio);
+        float f = hit ? rng.uniform(1.0f, 9.0f) : rng.uniform(0.5f, 5.0f);
+
+        Bench::Random sizer = rng;
+        Shape<T>::make(sizer, ZMath::Vec3D(), inner, outer);
+
+        ZMath::Vec3D c = hit ? pos + forward*f : pos - forward*(outer + f);
+        shapes.push_back(Shape<T>::make(rng, c, inner, outer));
+    }
+};
+
+// * ===================================
+// * Runners
+// * ===================================
+
+template <typename A, typename B, typename Fn>
+static void runPair(char const* name, Fn fn) {
+    if (!selected(name)) { return; }
+
+    std::vector<A> as;
+    std::vector<B> bs;
+    makePairs(as, bs);
+
+    report(name, config.pairs, [&](int i) { return fn(as[i], bs[i]); });
+};
+
+template <typename T, typename Fn>
+static void runRay(char const* name, Fn fn) {
+    if (!selected(name)) { return; }
+
+    std::vector<T> shapes;
+    std::vector<Ray3D> rays;
+    makeRays(shapes, rays);
+
+    report(name, config.pairs, [&](int i) { return fn(shapes[i], rays[i]); });
+};
+
+// Times are per packet. The hit ratio is per lane.
+template <typename T, typename Fn>
+static void runPacket(char const* name, Fn fn) {
+    if (!selected(name)) { return; }
+
+    std::vector<T> shapes;
+    std::vector<RayPacket> packets;
+    makePackets(shapes, packets);
+
+    // count the lanes hit once up front as the runner only counts whether each call hit
+    int lanes = 0;
+
+    for (int i = 0; i < config.pairs; ++i) {
+        for (int hits = fn(shapes[i], packets[i]); hits; hits &= hits - 1) { ++lanes; }
+    }
+
+    report(name, config.pairs, [&](int i) { return fn(shapes[i], packets[i]) != 0; });
+    results.back().hitRatio = (double) lanes/((double) config.pairs * RAY_PACKET_SIZE);
+};
+
+template <typename T, typename Fn>
+static void runTerrain(char const* name, Fn fn) {
+    if (!selected(name)) { return; }
+
+    std::vector<T> shapes;
+    makeTerrainShapes(shapes);
+
+    report(name, config.pairs, [&](int i) { return fn(*terrain, shapes[i]); });
+};
+
+template <typename Fn>
+static void runTerrainRay(char const* name, Fn fn) {
+    if (!selected(name)) { return; }
+
+    std::vector<Ray3D> rays;
+    makeTerrainRays(rays);
+
+    report(name, config.pairs, [&](int i) { return fn(*terrain, rays[i]); });
+};
+
+template <typename T, typename Fn>
+static void runFrustum(char const* name, Fn fn) {
+    if (!selected(name)) { return; }
+
+    std::vector<Frustum> frustums;
+    std::vector<T> shapes;
+    makeFrustumPairs(frustums, shapes);
+
+    report(name, config.pairs, [&](int i) { return fn(frustums[i], shapes[i]); });
+};
+
+// Time the rigidbody dispatcher. The shapes are copied into bodies so this includes the switch over the collider types.
+template <typename A, typename B>
+static void runRigidBodies(char const* name) {
+    if (!selected(name)) { return; }
+
+    std::vector<A> as;
+    std::vector<B> bs;
+    std::vector<RigidBody3D> rb1, rb2;
+    makePairs(as, bs);
+
+    rb1.reserve(config.pairs);
+    rb2.reserve(config.pairs);
+
+    for (int i = 0; i < config.pairs; ++i) {
+        rb1.push_back(RigidBody3D(ZMath::Vec3D(), 1.0f, 0.5f, 1.0f, Shape<A>::rigidType(), new A(as[i])));
+        rb2.push_back(RigidBody3D(ZMath::Vec3D(), 1.0f, 0.5f, 1.0f, Shape<B>::rigidType(), new B(bs[i])));
+    }
+
+    report(name, config.pairs, [&](int i) {
+        CollisionManifold manifold = findCollisionFeatures(&rb1[i], &rb2[i]);
+        if (manifold.hit) { delete[] manifold.contactPoints; }
+
+        return manifold.hit;
+    });
+};
+
+// Time the staticbody against rigidbody dispatcher.
+template <typename A, typename B>
+static void runStaticBodies(char const* name) {
+    if (!selected(name)) { return; }
+
+    std::vector<A> as;
+    std::vector<B> bs;
+    std::vector<StaticBody3D> sbs;
+    std::vector<RigidBody3D> rbs;
+    makePairs(as, bs);
+
+    sbs.reserve(config.pairs);
+    rbs.reserve(config.pairs);
+
+    for (int i = 0; i < config.pairs; ++i) {
+        sbs.push_back(StaticBody3D(ZMath::Vec3D(), Shape<A>::staticType(), new A(as[i])));
+        rbs.push_back(RigidBody3D(ZMath::Vec3D(), 1.0f, 0.5f, 1.0f, Shape<B>::rigidType(), new B(bs[i])));
+    }
+
+    report(name, config.pairs, [&](int i) {
+        CollisionManifold manifold = findCollisionFeatures(&sbs[i], &rbs[i]);
+        if (manifold.hit) { delete[] manifold.contactPoints; }
+
+        return manifold.hit;
+    });
+};
+
+// * ===================================
+// * Benchmark Macros
+// * ===================================
+
+// ? The manifold benchmarks free the contact points they are handed as the handler would, so that cost is included.
+
+#define FREE_MANIFOLD(call) CollisionManifold manifold = call; if (manifold.hit) { delete[] manifold.contactPoints; } return manifold.hit
+
+#define BENCH_TEST(fn, A, B) runPair<A, B>(#fn "(" #A ", " #B ")", [](A const &a, B const &b) { return fn(a, b); })
+#define BENCH_TEST_NORMAL(fn, A, B) runPair<A, B>(#fn "(" #A ", " #B ", normal)", \
+        [](A const &a, B const &b) { ZMath::Vec3D normal; return fn(a, b, normal); })
+#define BENCH_MANIFOLD(A, B) runPair<A, B>("findCollisionFeatures(" #A ", " #B ")", \
+        [](A const &a, B const &b) { FREE_MANIFOLD(findCollisionFeatures(a, b)); })
+
+#define BENCH_RAY(T) runRay<T>("raycast(" #T ", Ray3D, dist)", [](T const &t, Ray3D const &ray) { float dist; return raycast(t, ray, dist); })
+#define BENCH_RAY_NORMAL(T) runRay<T>("raycast(" #T ", Ray3D, dist, normal)", \
+        [](T const &t, Ray3D const &ray) { float dist; ZMath::Vec3D normal; return raycast(t, ray, dist, normal); })
+#define BENCH_PACKET(T) runPacket<T>("raycast(" #T ", RayPacket, mask, dist, normal) per packet", [](T const &t, RayPacket const &packet) { \
+        float dist[RAY_PACKET_SIZE]; ZMath::Vec3D normal[RAY_PACKET_SIZE]; return raycast(t, packet, packet.getMask(), dist, normal); })
+
+#define BENCH_TERRAIN_TEST(fn, T) runTerrain<T>(#fn "(Heightfield, " #T ")", [](Heightfield const &hf, T const &t) { return fn(hf, t); })
+#define BENCH_TERRAIN_TEST_REVERSED(fn, T) runTerrain<T>(#fn "(" #T ", Heightfield)", [](Heightfield const &hf, T const &t) { return fn(t, hf); })
+#define BENCH_TERRAIN_TEST_NORMAL(fn, T) runTerrain<T>(#fn "(Heightfield, " #T ", normal)", \
+        [](Heightfield const &hf, T const &t) { ZMath::Vec3D normal; return fn(hf, t, normal); })
+#define BENCH_TERRAIN_MANIFOLD(T) runTerrain<T>("findCollisionFeatures(Heightfield, " #T ")", \
+        [](Heightfield const &hf, T const &t) { FREE_MANIFOLD(findCollisionFeatures(hf, t)); })
+
+#define BENCH_FRUSTUM_TEST(fn, T) runFrustum<T>(#fn "(Frustum, " #T ")", [](Frustum const &f, T const &t) { return fn(f, t); })
+#define BENCH_FRUSTUM_TEST_REVERSED(fn, T) runFrustum<T>(#fn "(" #T ", Frustum)", [](Frustum const &f, T const &t) { return fn(t, f); })
+
+#define BENCH_COMPOUND(T) runPair<Compound, T>("findCollisionFeatures(Compound, RigidBodyCollider, " #T ")", \
+        [](Compound const &a, T const &b) { FREE_MANIFOLD(findCollisionFeatures(a, Shape<T>::rigidType(), (void*) &b)); })
+#define BENCH_STATIC_COMPOUND(T) runPair<T, Compound>("findCollisionFeatures(StaticBodyCollider, " #T ", Compound)", \
+        [](T const &a, Compound const &b) { FREE_MANIFOLD(findCollisionFeatures(Shape<T>::staticType(), (void*) &a, b)); })
+
+#define BENCH_RIGID_BODIES(A, B) runRigidBodies<A, B>("findCollisionFeatures(RigidBody3D " #A ", RigidBody3D " #B ")")
+#define BENCH_STATIC_BODIES(A, B) runStaticBodies<A, B>("findCollisionFeatures(StaticBody3D " #A ", RigidBody3D " #B ")")
+
+// * ===================================
+// * Benchmarks
+// * ===================================
+
+static void benchIntersections() {
+    // * Point vs Primitives
+
+    BENCH_TEST(PointAndLine, Point, Line3D);
+    BENCH_TEST(PointAndPlane, Point, Plane);
+    BENCH_TEST(PointAndSphere, Point, Sphere);
+    BENCH_TEST(PointAndAABB, Point, AABB);
+    BENCH_TEST(PointAndCube, Point, Cube);
+    BENCH_TEST(PointAndCapsule, Point, Capsule);
+
+    // * Line vs Primitives
+
+    BENCH_TEST(LineAndPoint, Line3D, Point);
+    BENCH_TEST(LineAndLine, Line3D, Line3D);
+    BENCH_TEST(LineAndPlane, Line3D, Plane);
+    BENCH_TEST(LineAndSphere, Line3D, Sphere);
+    BENCH_TEST(LineAndAABB, Line3D, AABB);
+    BENCH_TEST(LineAndCube, Line3D, Cube);
+    BENCH_TEST(LineAndCapsule, Line3D, Capsule);
+
+    // * Plane vs Primitives
+
+    BENCH_TEST(PlaneAndPoint, Plane, Point);
+    BENCH_TEST(PlaneAndLine, Plane, Line3D);
+    BENCH_TEST(PlaneAndSphere, Plane, Sphere);
+    BENCH_TEST_NORMAL(PlaneAndSphere, Plane, Sphere);
+    BENCH_TEST(PlaneAndAABB, Plane, AABB);
+    BENCH_TEST_NORMAL(PlaneAndAABB, Plane, AABB);
+    BENCH_TEST(PlaneAndCube, Plane, Cube);
+    BENCH_TEST_NORMAL(PlaneAndCube, Plane, Cube);
+    BENCH_TEST(PlaneAndCapsule, Plane, Capsule);
+
+    // * Sphere vs Primitives
+
+    BENCH_TEST(SphereAndPoint, Sphere, Point);
+    BENCH_TEST(SphereAndLine, Sphere, Line3D);
+    BENCH_TEST(SphereAndPlane, Sphere, Plane);
+    BENCH_TEST(SphereAndSphere, Sphere, Sphere);
+    BENCH_TEST_NORMAL(SphereAndSphere, Sphere, Sphere);
+    BENCH_TEST(SphereAndAABB, Sphere, AABB);
+    BENCH_TEST_NORMAL(SphereAndAABB, Sphere, AABB);
+    BENCH_TEST(SphereAndCube, Sphere, Cube);
+    BENCH_TEST_NORMAL(SphereAndCube, Sphere, Cube);
+    BENCH_TEST(SphereAndCapsule, Sphere, Capsule);
+
+    // * AABB vs Primitives
+
+    BENCH_TEST(AABBAndPoint, AABB, Point);
+    BENCH_TEST(AABBAndLine, AABB, Line3D);
+    BENCH_TEST(AABBAndPlane, AABB, Plane);
+    BENCH_TEST(AABBAndSphere, AABB, Sphere);
+    BENCH_TEST_NORMAL(AABBAndSphere, AABB, Sphere);
+    BENCH_TEST(AABBAndAABB, AABB, AABB);
+    BENCH_TEST_NORMAL(AABBAndAABB, AABB, AABB);
+    BENCH_TEST(AABBAndCube, AABB, Cube);
+    BENCH_TEST_NORMAL(AABBAndCube, AABB, Cube);
+    BENCH_TEST(AABBAndCapsule, AABB, Capsule);
+
+    // * Cube vs Primitives
+
+    BENCH_TEST(CubeAndPoint, Cube, Point);
+    BENCH_TEST(CubeAndLine, Cube, Line3D);
+    BENCH_TEST(CubeAndPlane, Cube, Plane);
+    BENCH_TEST(CubeAndSphere, Cube, Sphere);
+    BENCH_TEST_NORMAL(CubeAndSphere, Cube, Sphere);
+    BENCH_TEST(CubeAndAABB, Cube, AABB);
+    BENCH_TEST_NORMAL(CubeAndAABB, Cube, AABB);
+    BENCH_TEST(CubeAndCube, Cube, Cube);
+    BENCH_TEST_NORMAL(CubeAndCube, Cube, Cube);
+    BENCH_TEST(CubeAndCapsule, Cube, Capsule);
+
+    // * Capsule vs Primitives
+
+    BENCH_TEST(CapsuleAndPoint, Capsule, Point);
+    BENCH_TEST(CapsuleAndLine, Capsule, Line3D);
+    BENCH_TEST(CapsuleAndPlane, Capsule, Plane);
+    BENCH_TEST(CapsuleAndSphere, Capsule, Sphere);
+    BENCH_TEST_NORMAL(CapsuleAndSphere, Capsule, Sphere);
+    BENCH_TEST(CapsuleAndAABB, Capsule, AABB);
+    BENCH_TEST(CapsuleAndCube, Capsule, Cube);
+    BENCH_TEST(CapsuleAndCapsule, Capsule, Capsule);
+    BENCH_TEST_NORMAL(CapsuleAndCapsule, Capsule, Capsule);
+
+    // * Triangles
+
+    runPair<Triangle, AABB>("triangleAndBox(Triangle, AABB)", [](Triangle const &t, AABB const &b) {
+        return triangleAndBox(t.a - b.pos, t.b - b.pos, t.c - b.pos, b.getHalfSize());
+    });
+
+    // * Heightfields
+
+    BENCH_TERRAIN_TEST(HeightfieldAndPoint, Point);
+    BENCH_TERRAIN_TEST(HeightfieldAndSphere, Sphere);
+    BENCH_TERRAIN_TEST_NORMAL(HeightfieldAndSphere, Sphere);
+    BENCH_TERRAIN_TEST(HeightfieldAndAABB, AABB);
+    BENCH_TERRAIN_TEST(HeightfieldAndCube, Cube);
+    BENCH_TERRAIN_TEST(HeightfieldAndCapsule, Capsule);
+    BENCH_TERRAIN_TEST_REVERSED(PointAndHeightfield, Point);
+    BENCH_TERRAIN_TEST_REVERSED(SphereAndHeightfield, Sphere);
+    BENCH_TERRAIN_TEST_REVERSED(AABBAndHeightfield, AABB);
+    BENCH_TERRAIN_TEST_REVERSED(CubeAndHeightfield, Cube);
+    BENCH_TERRAIN_TEST_REVERSED(CapsuleAndHeightfield, Capsule);
+
+    // * Frustums
+
+    BENCH_FRUSTUM_TEST(FrustumAndPoint, Point);
+    BENCH_FRUSTUM_TEST(FrustumAndSphere, Sphere);
+    BENCH_FRUSTUM_TEST(FrustumAndAABB, AABB);
+    BENCH_FRUSTUM_TEST_REVERSED(PointAndFrustum, Point);
+    BENCH_FRUSTUM_TEST_REVERSED(SphereAndFrustum, Sphere);
+    BENCH_FRUSTUM_TEST_REVERSED(AABBAndFrustum, AABB);
+};
+
+static void benchRaycasts() {
+    BENCH_RAY(Plane);
+    BENCH_RAY(Sphere);
+    BENCH_RAY(AABB);
+    BENCH_RAY(Cube);
+    BENCH_RAY(Capsule);
+
+    BENCH_RAY_NORMAL(Plane);
+    BENCH_RAY_NORMAL(Sphere);
+    BENCH_RAY_NORMAL(AABB);
+    BENCH_RAY_NORMAL(Cube);
+    BENCH_RAY_NORMAL(Capsule);
+
+    runRay<Triangle>("raycastTriangle(Triangle, Ray3D, dist)", [](Triangle const &t, Ray3D const &ray) {
+        float dist;
+        return raycastTriangle(t.a, t.b, t.c, ray, dist);
+    });
+
+    runTerrainRay("raycast(Heightfield, Ray3D, dist)", [](Heightfield const &hf, Ray3D const &ray) {
+        float dist;
+        return raycast(hf, ray, dist);
+    });
+
+    runTerrainRay("raycast(Heightfield, Ray3D, dist, normal)", [](Heightfield const &hf, Ray3D const &ray) {
+        float dist;
+        ZMath::Vec3D normal;
+        return raycast(hf, ray, dist, normal);
+    });
+
+    BENCH_PACKET(Plane);
+    BENCH_PACKET(Sphere);
+    BENCH_PACKET(AABB);
+    BENCH_PACKET(Cube);
+};
+
+static void benchManifolds() {
+    BENCH_MANIFOLD(Plane, Sphere);
+    BENCH_MANIFOLD(Plane, AABB);
+    BENCH_MANIFOLD(Plane, Cube);
+    BENCH_MANIFOLD(Plane, Capsule);
+
+    BENCH_MANIFOLD(Sphere, Sphere);
+    BENCH_MANIFOLD(Sphere, AABB);
+    BENCH_MANIFOLD(Sphere, Cube);
+
+    BENCH_MANIFOLD(AABB, AABB);
+    BENCH_MANIFOLD(AABB, Cube);
+    BENCH_MANIFOLD(AABB, Capsule);
+
+    BENCH_MANIFOLD(Cube, Cube);
+    BENCH_MANIFOLD(Cube, Capsule);
+
+    BENCH_MANIFOLD(Capsule, Sphere);
+    BENCH_MANIFOLD(Capsule, Capsule);
+
+    BENCH_TERRAIN_MANIFOLD(Sphere);
+    BENCH_TERRAIN_MANIFOLD(AABB);
+    BENCH_TERRAIN_MANIFOLD(Cube);
+    BENCH_TERRAIN_MANIFOLD(Capsule);
+
+    // * Compounds
+
+    BENCH_COMPOUND(Sphere);
+    BENCH_COMPOUND(AABB);
+    BENCH_COMPOUND(Cube);
+    BENCH_COMPOUND(Capsule);
+    BENCH_MANIFOLD(Compound, Compound);
+
+    BENCH_STATIC_COMPOUND(Plane);
+    BENCH_STATIC_COMPOUND(Sphere);
+    BENCH_STATIC_COMPOUND(AABB);
+    BENCH_STATIC_COMPOUND(Cube);
+    BENCH_STATIC_COMPOUND(Capsule);
+
+    // * Body Dispatch
+
+    BENCH_RIGID_BODIES(Sphere, Sphere);
+    BENCH_RIGID_BODIES(AABB, Cube);
+    BENCH_RIGID_BODIES(Cube, Cube);
+    BENCH_RIGID_BODIES(Capsule, Sphere);
+    BENCH_RIGID_BODIES(Compound, Cube);
+
+    BENCH_STATIC_BODIES(Plane, Sphere);
+    BENCH_STATIC_BODIES(AABB, Cube);
+    BENCH_STATIC_BODIES(Cube, Capsule);
+};
+
+// * ===================================
+// * Output
+// * ===================================
+
+static bool writeJSON(char const* path) {
+    FILE* file = fopen(path, "w");
+    if (!file) { return 0; }
+
+    fprintf(file, "{\"benchmark\":\"narrowphase\",\"seed\":%llu,\"pairs\":%d,\"hitRatio\":%.3f,\"results\":[",
+            (unsigned long long) config.seed, config.pairs, config.hitRatio);
+
+    for (size_t i = 0; i < results.size(); ++i) {
+        fprintf(file, "%s{\"name\":", i ? "," : "");
+        Bench::writeString(file, results[i].name);
+        fprintf(file, ",\"ns\":%.3f,\"allocs\":%.4f,\"hitRatio\":%.4f", results[i].ns, results[i].allocs, results[i].hitRatio);
+
+        if (results[i].hasCounters) {
+            fprintf(file, ",\"counters\":");
+            Bench::writeCounters(file, results[i].counters);
+        }
+
+        fputc('}', file);
+    }
+
+    fprintf(file, "]}\n");
+    return !fclose(file);
+};
+
+int main(int argc, char** argv) {
+    if (Bench::hasFlag(argc, argv, "--help")) {
+        printf("usage: narrowphase [--seed n] [--hit-ratio r] [--pairs n] [--time seconds] [--filter substring] [--json path] [--perf]\n");
+        return 0;
+    }
+
+    config.seed = strtoull(Bench::getArg(argc, argv, "--seed", "1"), nullptr, 10);
+    config.hitRatio = (float) atof(Bench::getArg(argc, argv, "--hit-ratio", "0.5"));
+    config.pairs = atoi(Bench::getArg(argc, argv, "--pairs", "4096"));
+    config.time = atof(Bench::getArg(argc, argv, "--time", "0.2"));
+    config.filter = Bench::getArg(argc, argv, "--filter", nullptr);
+
+    char const* json = Bench::getArg(argc, argv, "--json", nullptr);
+
+    if (config.pairs <= 0 || config.hitRatio < 0.0f || config.hitRatio > 1.0f) {
+        fprintf(stderr, "--pairs must be positive and --hit-ratio must be between 0 and 1\n");
+        return 1;
+    }
+
+    if (Bench::hasFlag(argc, argv, "--perf")) {
+        perf = new Bench::PerfCounters();
+        if (!perf->anyAvailable()) { fprintf(stderr, "no hardware counters are available. They will be reported as 0.\n"); }
+    }
+
+    makeTerrain();
+
+    printf("seed %llu, %d pairs, %.0f%% placed to hit\n\n", (unsigned long long) config.seed, config.pairs, config.hitRatio * 100.0f);
+    Bench::printHeader(perf != nullptr);
+
+    benchIntersections();
+    benchRaycasts();
+    benchManifolds();
+
+    delete terrain;
+    delete perf;
+
+    if (json && !writeJSON(json)) {
+        fprintf(stderr, "could not write %s\n", json);
+        return 1;
+    }
+
+    return 0;
+};
@@ -0,0 +1,144 @@
+// ? Hardware performance counters read through Linux's perf_event_open.
+// ? Each counter is opened on its own so the kernel can multiplex them when the CPU has fewer counters than requested.
+// ?  Multiplexed counts are scaled up by the fraction of the time they were actually counting.
+// ? Counters the CPU, kernel or permissions do not allow are unavailable and read as 0. This includes every counter off of Linux.
+// ?  Counting user space only needs /proc/sys/kernel/perf_event_paranoid to be 2 or lower.
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace Bench {
+    enum Counter {
+        COUNTER_CYCLES,
+        COUNTER_INSTRUCTIONS,
+        COUNTER_BRANCHES,
+        COUNTER_BRANCH_MISSES,
+        COUNTER_L1D_LOADS,
+        COUNTER_L1D_MISSES, // L1 data cache load misses
+        COUNTER_LLC_LOADS,
+        COUNTER_LLC_MISSES, // last level cache load misses
+        NUM_COUNTERS
+    };
+
+    static char const* const counterNames[NUM_COUNTERS] = {
+        "cycles", "instructions", "branches", "branchMisses", "l1dLoads", "l1dMisses", "llcLoads", "llcMisses"
+    };
+
+    // Counts of each counter. Unavailable counters are left at 0.
+    typedef struct CounterValues {
+        double values[NUM_COUNTERS];
+
+        inline double& operator [] (int i) { return values[i]; };
+        inline double operator [] (int i) const { return values[i]; };
+    } CounterValues;
+
+    // Counters for the calling thread. They start counting when created.
+    class PerfCounters {
+        private:
+            int fds[NUM_COUNTERS];
+
+#ifdef __linux__
+            static int open(uint32_t type, uint64_t config) {
+                perf_event_attr attr;
+                memset(&attr, 0, sizeof(attr));
+
+                attr.size = sizeof(attr);
+                attr.type = type;
+                attr.config = config;
+                attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+                attr.exclude_kernel = 1;
+                attr.exclude_hv = 1;
+
+                return (int) syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+            };
+
+            static uint64_t cache(uint64_t id, uint64_t result) {
+                return id | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (result << 16);
+            };
+#endif
+
+        public:
+            PerfCounters() {
+                for (int i = 0; i < NUM_COUNTERS; ++i) { fds[i] = -1; }
+
+#ifdef __linux__
+                fds[COUNTER_CYCLES] = open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+                fds[COUNTER_INSTRUCTIONS] = open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+                fds[COUNTER_BRANCHES] = open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_INSTRUCTIONS);
+                fds[COUNTER_BRANCH_MISSES] = open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+                fds[COUNTER_L1D_LOADS] = open(PERF_TYPE_HW_CACHE, cache(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_RESULT_ACCESS));
+                fds[COUNTER_L1D_MISSES] = open(PERF_TYPE_HW_CACHE, cache(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_RESULT_MISS));
+                fds[COUNTER_LLC_LOADS] = open(PERF_TYPE_HW_CACHE, cache(PERF_COUNT_HW_CACHE_LL, PERF_COUNT_HW_CACHE_RESULT_ACCESS));
+                fds[COUNTER_LLC_MISSES] = open(PERF_TYPE_HW_CACHE, cache(PERF_COUNT_HW_CACHE_LL, PERF_COUNT_HW_CACHE_RESULT_MISS));
+#endif
+            };
+
+            PerfCounters(PerfCounters const &counters) = delete;
+            PerfCounters& operator = (PerfCounters const &counters) = delete;
+
+            ~PerfCounters() {
+#ifdef __linux__
+                for (int i = 0; i < NUM_COUNTERS; ++i) {
+                    if (fds[i] >= 0) { close(fds[i]); }
+                }
+#endif
+            };
+
+            inline bool available(Counter counter) const { return fds[counter] >= 0; };
+
+            bool anyAvailable() const {
+                for (int i = 0; i < NUM_COUNTERS; ++i) {
+                    if (fds[i] >= 0) { return 1; }
+                }
+
+                return 0;
+            };
+
+            // Read the counts since the counters were created.
+            // ? Each read is a system call so reading costs around a microsecond per counter.
+            CounterValues read() const {
+                CounterValues counts;
+
+                for (int i = 0; i < NUM_COUNTERS; ++i) {
+                    counts[i] = 0.0;
+
+#ifdef __linux__
+                    uint64_t data[3]; // value, time enabled, time running
+                    if (fds[i] < 0 || ::read(fds[i], data, sizeof(data)) != sizeof(data) || !data[2]) { continue; }
+
+                    counts[i] = (double) data[0] * ((double) data[1]/data[2]);
+#endif
+                }
+
+                return counts;
+            };
+    };
+
+    // * ===================================
+    // * Derived Metrics
+    // * ===================================
+
+    // ? Each metric is 0 when the counters it needs are unavailable or did not count anything.
+
+    inline double ratio(double a, double b) { return b > 0.0 ? a/b : 0.0; };
+
+    inline CounterValues difference(CounterValues const &end, CounterValues const &start) {
+        CounterValues d;
+        for (int i = 0; i < NUM_COUNTERS; ++i) { d[i] = end[i] - start[i]; }
+
+        return d;
+    };
+
+    inline double getIPC(CounterValues const &c) { return ratio(c[COUNTER_INSTRUCTIONS], c[COUNTER_CYCLES]); };
+    inline double getBranchMissRate(CounterValues const &c) { return ratio(c[COUNTER_BRANCH_MISSES], c[COUNTER_BRANCHES]); };
+    inline double getL1DMissRate(CounterValues const &c) { return ratio(c[COUNTER_L1D_MISSES], c[COUNTER_L1D_LOADS]); };
+    inline double getLLCMissRate(CounterValues const &c) { return ratio(c[COUNTER_LLC_MISSES], c[COUNTER_LLC_LOADS]); };
+}
@@ -0,0 +1,173 @@
+// ? Checks that the bodies read from a replication stream stay within the quantization error bounds given by replication.h.
+// ? Random bodies are encoded and decoded over a run of frames. Each frame moves some of the bodies and acknowledges an
+// ?  earlier frame, with some frames sent in full, so both the full and the delta encoded paths are checked.
+// ? Some frames acknowledge the oldest frame still kept, whose baseline shares its slot with the frame being encoded.
+// ? A few bodies are placed outside of the quantization ranges; these are checked against their values clamped to the ranges.
+// ? Prints the largest error of each quantity next to its bound and returns a non-zero exit code if any bound is broken.
+// ?
+// ? Usage: quantization [--seed n] [--bodies n] [--frames n]
+
+#include "bench.h"
+#include <zeta/replication.h>
+
+using namespace Zeta;
+
+// ? The values are compared as floats so allow for the rounding of the values themselves on top of the bound.
+static const float ROUNDING = 1e-6f;
+
+// Number of frames the encoder and decoder keep as baselines.
+static const int KEPT_FRAMES = 8;
+
+// Largest error seen of a quantity compared to its bound.
+typedef struct ErrorStat {
+    char const* name;
+    float bound;
+    float scale; // size of the values, for the rounding allowance
+    float maxError = 0.0f;
+
+    ErrorStat(char const* name, float bound, float scale) : name(name), bound(bound), scale(scale) {};
+
+    inline void add(float error) { maxError = ZMath::max(maxError, error); };
+    inline bool passed() const { return maxError <= bound + ROUNDING * scale; };
+} ErrorStat;
+
+// Orientation with the sign of every component flipped if it is closer to the other orientation that way.
+static ZMath::Quaternion alignedTo(ZMath::Quaternion const &q, ZMath::Quaternion const &to) {
+    float dot = q.w*to.w + q.x*to.x + q.y*to.y + q.z*to.z;
+    return dot < 0.0f ? ZMath::Quaternion(-q.w, -q.x, -q.y, -q.z) : q;
+};
+
+// Give a body a random state. Some of the values land outside of the quantization ranges.
+static void randomize(Bench::Random &rng, QuantizationSettings const &settings, RigidBody3D* rb) {
+    float outside = rng.chance(0.05f) ? 1.5f : 1.0f;
+
+    rb->pos = settings.center + ZMath::Vec3D(rng.uniform(-settings.halfsize.x, settings.halfsize.x),
+                                             rng.uniform(-settings.halfsize.y, settings.halfsize.y),
+                                             rng.uniform(-settings.halfsize.z, settings.halfsize.z)) * outside;
+
+    rb->vel = rng.vec(-settings.maxSpeed, settings.maxSpeed) * outside;
+    rb->angVel = rng.vec(-settings.maxAngSpeed, settings.maxAngSpeed) * outside;
+    rb->orientation = ZMath::Quaternion(rng.uniform(-1.0f, 1.0f), rng.uniform(-1.0f, 1.0f), rng.uniform(-1.0f, 1.0f), rng.uniform(-1.0f, 1.0f)).normalize();
+};
+
+int main(int argc, char** argv) {
+    uint64_t seed = 1;
+    int numBodies = 1000, numFrames = 200;
+
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "--seed") && i + 1 < argc) { seed = strtoull(argv[++i], nullptr, 10); }
+        else if (!strcmp(argv[i], "--bodies") && i + 1 < argc) { numBodies = ZMath::max(1, atoi(argv[++i])); }
+        else if (!strcmp(argv[i], "--frames") && i + 1 < argc) { numFrames = ZMath::max(1, atoi(argv[++i])); }
+        else {
+            fprintf(stderr, "Usage: %s [--seed n] [--bodies n] [--frames n]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    Bench::Random rng(seed);
+
+    QuantizationSettings settings;
+    settings.center = ZMath::Vec3D(100.0f, -50.0f, 20.0f);
+    settings.halfsize = ZMath::Vec3D(512.0f, 512.0f, 64.0f);
+
+    std::vector<RigidBody3D*> bodies;
+
+    for (int i = 0; i < numBodies; ++i) {
+        bodies.push_back(new RigidBody3D(ZMath::Vec3D(), 1.0f, 0.2f, 0.999f, Sphere(ZMath::Vec3D(), 0.5f)));
+        randomize(rng, settings, bodies.back());
+    }
+
+    // * Error bounds
+
+    ZMath::Vec3D posError = getPositionError(settings);
+
+    // ? The component of the orientation left out is found from the other three. Its error to first order is the dot product of
+    // ?  the other components with their errors over the component left out. The other components have a length of at most
+    // ?  sqrt(3)/2 and the component left out is at least 1/2, so its error is at most 3 times a single component's.
+    ErrorStat stats[] = {
+        ErrorStat("position x", posError.x, fabsf(settings.center.x) + settings.halfsize.x),
+        ErrorStat("position y", posError.y, fabsf(settings.center.y) + settings.halfsize.y),
+        ErrorStat("position z", posError.z, fabsf(settings.center.z) + settings.halfsize.z),
+        ErrorStat("velocity", getVelocityError(settings), settings.maxSpeed),
+        ErrorStat("orientation", 3.0f * getOrientationError(settings), 1.0f),
+        ErrorStat("angular velocity", getAngularVelocityError(settings), settings.maxAngSpeed)
+    };
+
+    // * Encode and decode each frame
+
+    ReplicationEncoder encoder(settings, KEPT_FRAMES);
+    ReplicationDecoder decoder(settings, KEPT_FRAMES);
+
+    std::vector<uint8_t> stream(bodies.size() * sizeof(QuantizedBody) + 64);
+    std::vector<ReplicatedBody> decoded;
+    decoded.resize(bodies.size());
+
+    size_t totalBytes = 0;
+    int failedFrames = 0;
+    uint32_t acked = NO_FRAME;
+
+    for (int frame = 0; frame < numFrames; ++frame) {
+        // move some of the bodies so the others are sent against the baseline unchanged
+        if (frame) {
+            for (RigidBody3D* rb : bodies) {
+                if (rng.chance(0.3f)) { randomize(rng, settings, rb); }
+            }
+        }
+
+        size_t size = encoder.encode(bodies.data(), numBodies, (uint32_t) frame, acked, stream.data(), stream.size());
+
+        uint32_t decodedFrame;
+        int count = decoder.decode(stream.data(), size, decoded.data(), numBodies, decodedFrame);
+
+        if (!size || count != numBodies || decodedFrame != (uint32_t) frame) {
+            ++failedFrames;
+            continue;
+        }
+
+        totalBytes += size;
+
+        for (int i = 0; i < numBodies; ++i) {
+            RigidBody3D const* rb = bodies[i];
+            ReplicatedBody const &body = decoded[i];
+
+            for (int j = 0; j < 3; ++j) {
+                float c = (&settings.center.x)[j], h = (&settings.halfsize.x)[j];
+                stats[j].add(fabsf((&body.pos.x)[j] - ZMath::clamp((&rb->pos.x)[j], c - h, c + h)));
+
+                stats[3].add(fabsf((&body.vel.x)[j] - ZMath::clamp((&rb->vel.x)[j], -settings.maxSpeed, settings.maxSpeed)));
+                stats[5].add(fabsf((&body.angVel.x)[j] - ZMath::clamp((&rb->angVel.x)[j], -settings.maxAngSpeed, settings.maxAngSpeed)));
+            }
+
+            ZMath::Quaternion q = alignedTo(body.orientation, rb->orientation);
+
+            stats[4].add(ZMath::max(ZMath::max(fabsf(q.w - rb->orientation.w), fabsf(q.x - rb->orientation.x)),
+                                    ZMath::max(fabsf(q.y - rb->orientation.y), fabsf(q.z - rb->orientation.z))));
+        }
+
+        // acknowledge this frame most of the time, an older frame some of the time, and nothing every so often
+        if (frame % 25 == 24) { acked = NO_FRAME; }
+        else if (rng.chance(0.1f) && frame >= KEPT_FRAMES - 1) { acked = (uint32_t) (frame + 1 - KEPT_FRAMES); }
+        else if (rng.chance(0.2f) && frame >= 3) { acked = (uint32_t) (frame - 3); }
+        else { acked = (uint32_t) frame; }
+    }
+
+    // * Report
+
+    int failures = failedFrames;
+
+    printf("seed %llu, %d bodies, %d frames, %.1f bytes per body per frame\n\n", (unsigned long long) seed, numBodies, numFrames,
+           (double) totalBytes/((double) numBodies * numFrames));
+
+    printf("%-20s %14s %14s\n", "quantity", "max error", "bound");
+
+    for (ErrorStat const &stat : stats) {
+        printf("%-20s %14.8f %14.8f %s\n", stat.name, stat.maxError, stat.bound, stat.passed() ? "" : "FAILED");
+        failures += !stat.passed();
+    }
+
+    if (failedFrames) { printf("\n%d frames failed to encode or decode\n", failedFrames); }
+
+    for (RigidBody3D* rb : bodies) { delete rb; }
+
+    return failures != 0;
+};
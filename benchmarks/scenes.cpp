@@ -0,0 +1,614 @@
+// ? Headless benchmark of whole scenes run through the physics handler.
+// ? Each scene is built through the Handler API and stepped a fixed number of times.
+// ? Reports the per step timing percentiles, the heap's high-water mark and a hash of the final state of the rigidbodies.
+// ? A previous run's JSON can be passed as a baseline to fail when a scene gets slower or uses more memory than allowed.
+// ? With --perf, the hardware counters are read around each phase of every step through the handler's stats probe.
+// ?
+// ? Usage: scenes [--steps n] [--scale s] [--scene name] [--json path] [--baseline path] [--threshold t] [--fail-on-hash] [--perf]
+
+#define DISABLE_SPATIAL_PARTITIONING
+#define ENABLE_PHYSICS_STATS // needed for the stats probe. Recording the stats costs well under a microsecond per step.
+#include "bench.h"
+
+#include <algorithm>
+
+using namespace Zeta;
+
+// * ===================================
+// * Worlds
+// * ===================================
+
+typedef struct World {
+    Handler* handler;
+    std::vector<RigidBody3D*> rbs; // owned by the handler. Kept in the order they were added for the state hash.
+    std::vector<StaticBody3D*> sbs; // owned by the world as the handler does not delete its static bodies when it is destroyed
+    Bench::Random rng;
+    float scale; // multiplier on the number of bodies in each scene
+
+    World(float scale) : handler(new Handler(ZMath::Vec3D(0, 0, -9.8f), FPS_60)), rng(12345), scale(scale) {};
+
+    ~World() {
+        delete handler;
+        for (StaticBody3D* sb : sbs) { delete sb; }
+    };
+} World;
+
+// Scale a number of bodies.
+static int scaled(World const &world, int n) { return ZMath::max(1, (int) (n * world.scale + 0.5f)); };
+
+// Scale the side length of a square or triangular arrangement of bodies.
+static int scaledSide(World const &world, int n) { return ZMath::max(2, (int) (n * sqrtf(world.scale) + 0.5f)); };
+
+static void addStatic(World &world, StaticBody3D* sb) {
+    world.handler->addStaticBody(sb);
+    world.sbs.push_back(sb);
+};
+
+static void addWall(World &world, ZMath::Vec3D const &min, ZMath::Vec3D const &max) {
+    addStatic(world, new StaticBody3D((min + max) * 0.5f, AABB(min, max)));
+};
+
+// The collider is stored inline in the rigidbody.
+template <typename Shape>
+static RigidBody3D* addRigid(World &world, ZMath::Vec3D const &pos, float mass, Shape const &shape) {
+    RigidBody3D* rb = new RigidBody3D(pos, mass, 0.2f, 0.999f, shape);
+
+    world.handler->addRigidBody(rb);
+    world.rbs.push_back(rb);
+
+    return rb;
+};
+
+static RigidBody3D* addSphere(World &world, ZMath::Vec3D const &c, float r, float mass) {
+    return addRigid(world, c, mass, Sphere(c, r));
+};
+
+static RigidBody3D* addCube(World &world, ZMath::Vec3D const &c, ZMath::Vec3D const &halfSize, float angXY, float angXZ, float mass) {
+    return addRigid(world, c, mass, Cube(c - halfSize, c + halfSize, angXY, angXZ));
+};
+
+// Walled box with its floor's top face at z = 0.
+static void addBox(World &world, float halfWidth, float height) {
+    float w = halfWidth, t = 1.0f;
+
+    addWall(world, ZMath::Vec3D(-w - t, -w - t, -t), ZMath::Vec3D(w + t, w + t, 0.0f));
+    addWall(world, ZMath::Vec3D(-w - t, -w - t, 0.0f), ZMath::Vec3D(-w, w + t, height));
+    addWall(world, ZMath::Vec3D(w, -w - t, 0.0f), ZMath::Vec3D(w + t, w + t, height));
+    addWall(world, ZMath::Vec3D(-w, -w - t, 0.0f), ZMath::Vec3D(w, -w, height));
+    addWall(world, ZMath::Vec3D(-w, w, 0.0f), ZMath::Vec3D(w, w + t, height));
+};
+
+// * ===================================
+// * Scenes
+// * ===================================
+
+// 2D pyramid of unit cubes resting on the ground. Tests the stability and cost of stacked resting contacts.
+static void buildPyramid(World &world) {
+    addWall(world, ZMath::Vec3D(-50, -50, -1), ZMath::Vec3D(50, 50, 0));
+
+    int base = scaledSide(world, 20);
+
+    for (int row = 0; row < base; ++row) {
+        int n = base - row;
+
+        for (int i = 0; i < n; ++i) {
+            ZMath::Vec3D c((i - 0.5f*(n - 1)) * 1.05f, 0.0f, 0.5f + row);
+            addCube(world, c, ZMath::Vec3D(0.5f, 0.5f, 0.5f), 0.0f, 0.0f, 1.0f);
+        }
+    }
+};
+
+#define RAIN_PARTICLES 2000
+#define RAIN_WAVE 25 // particles spawned every other step
+
+static void buildRain(World &world) { addBox(world, 10.0f, 6.0f); };
+
+// Small fast spheres spawned in waves above a walled box.
+static void stepRain(World &world, int step) {
+    if (step % 2 || (int) world.rbs.size() >= scaled(world, RAIN_PARTICLES)) { return; }
+
+    for (int i = 0; i < RAIN_WAVE; ++i) {
+        ZMath::Vec3D c(world.rng.uniform(-9.5f, 9.5f), world.rng.uniform(-9.5f, 9.5f), world.rng.uniform(12.0f, 16.0f));
+
+        RigidBody3D* rb = addSphere(world, c, 0.2f, 0.1f);
+        rb->vel = ZMath::Vec3D(0.0f, 0.0f, -10.0f);
+    }
+};
+
+// 10k spheres dropped in a loose grid into a walled box.
+static void buildPile(World &world) {
+    int n = scaled(world, 10000), side = 25;
+    addBox(world, 15.0f, 40.0f);
+
+    for (int i = 0; i < n; ++i) {
+        int x = i % side, y = (i/side) % side, z = i/(side*side);
+        ZMath::Vec3D jitter = world.rng.vec(-0.05f, 0.05f);
+
+        addSphere(world, ZMath::Vec3D((x - 0.5f*(side - 1)) * 1.1f, (y - 0.5f*(side - 1)) * 1.1f, 0.6f + z * 1.1f) + jitter, 0.5f, 1.0f);
+    }
+};
+
+// Randomly sized and rotated cubes dropped onto the top of a steep ramp so they tumble down onto the ground.
+static void buildAvalanche(World &world) {
+    int n = scaled(world, 500);
+
+    addWall(world, ZMath::Vec3D(-60, -30, -1), ZMath::Vec3D(60, 30, 0));
+    addStatic(world, new StaticBody3D(ZMath::Vec3D(0, 0, 8), Cube(ZMath::Vec3D(-20, -10, 7.5f), ZMath::Vec3D(20, 10, 8.5f), 0.0f, 25.0f)));
+
+    for (int i = 0; i < n; ++i) {
+        ZMath::Vec3D c(world.rng.uniform(-18.0f, -8.0f), world.rng.uniform(-9.0f, 9.0f), 20.0f + 1.5f * (i/40) + world.rng.uniform(0.0f, 1.0f));
+        ZMath::Vec3D h = world.rng.vec(0.3f, 0.6f);
+
+        addCube(world, c, h, world.rng.uniform(0.0f, 360.0f), world.rng.uniform(0.0f, 360.0f), 8.0f * h.x * h.y * h.z);
+    }
+};
+
+// Every kind of collider: dynamic spheres, boxes, cubes and capsules falling through static pillars onto rolling terrain
+//  with a sensor covering part of the ground.
+static void buildMixed(World &world) {
+    int cells = 64, tileCells = 32, side = tileCells + 1;
+
+    Heightfield* hf = new Heightfield(ZMath::Vec3D(-0.5f * cells, -0.5f * cells, 0.0f), cells, cells, 1.0f, tileCells, HEIGHTFIELD_FLOAT);
+    float* samples = new float[side * side];
+
+    for (int ty = 0; ty < cells/tileCells; ++ty) {
+        for (int tx = 0; tx < cells/tileCells; ++tx) {
+            for (int j = 0; j < side; ++j) {
+                for (int i = 0; i < side; ++i) {
+                    float x = (float) (tx * tileCells + i), y = (float) (ty * tileCells + j);
+                    samples[j * side + i] = 1.0f + 0.6f * sinf(0.35f * x) * cosf(0.25f * y);
+                }
+            }
+
+            hf->loadTile(tx, ty, samples);
+        }
+    }
+
+    delete[] samples;
+    addStatic(world, new StaticBody3D(ZMath::Vec3D(0, 0, 1), STATIC_HEIGHTFIELD_COLLIDER, hf));
+
+    // * Static pillars
+
+    for (int i = 0; i < 40; ++i) {
+        ZMath::Vec3D c(world.rng.uniform(-25.0f, 25.0f), world.rng.uniform(-25.0f, 25.0f), 4.0f);
+
+        switch (i % 3) {
+            case 0: { addStatic(world, new StaticBody3D(c, Capsule(c - ZMath::Vec3D(0, 0, 3), c + ZMath::Vec3D(0, 0, 3), 0.75f))); break; }
+            case 1: { addStatic(world, new StaticBody3D(c, Cube(c - ZMath::Vec3D(0.75f, 0.75f, 3), c + ZMath::Vec3D(0.75f, 0.75f, 3), world.rng.uniform(0.0f, 90.0f), 0.0f))); break; }
+            case 2: { addStatic(world, new StaticBody3D(c, Sphere(c, 1.5f))); break; }
+        }
+    }
+
+    // * Sensor
+
+    world.handler->addSensor(new StaticBody3D(ZMath::Vec3D(0, 0, 2), AABB(ZMath::Vec3D(-10, -10, 0), ZMath::Vec3D(10, 10, 4))));
+
+    // * Dynamic bodies
+
+    int n = scaled(world, 800);
+
+    for (int i = 0; i < n; ++i) {
+        ZMath::Vec3D c(world.rng.uniform(-28.0f, 28.0f), world.rng.uniform(-28.0f, 28.0f), world.rng.uniform(10.0f, 30.0f));
+
+        switch (i % 4) {
+            case 0: { addSphere(world, c, world.rng.uniform(0.3f, 0.6f), 1.0f); break; }
+            case 1: {
+                ZMath::Vec3D h = world.rng.vec(0.3f, 0.6f);
+                addRigid(world, c, 1.0f, AABB(c - h, c + h));
+                break;
+            }
+
+            case 2: { addCube(world, c, world.rng.vec(0.3f, 0.6f), world.rng.uniform(0.0f, 360.0f), world.rng.uniform(0.0f, 360.0f), 1.0f); break; }
+            case 3: {
+                ZMath::Vec3D d = world.rng.dir() * 0.4f;
+                addRigid(world, c, 1.0f, Capsule(c - d, c + d, 0.3f));
+                break;
+            }
+        }
+    }
+};
+
+typedef struct Scene {
+    char const* name;
+    void (*build)(World &world);
+    void (*step)(World &world, int step); // called before each step. nullptr if the scene does not change after it is built.
+    int steps; // default number of steps to run
+} Scene;
+
+// ? The handler tests every pair of bodies so the pile runs far fewer steps by default.
+static Scene const scenes[] = {
+    {"pyramid", buildPyramid, nullptr, 300},
+    {"rain", buildRain, stepRain, 300},
+    {"pile", buildPile, nullptr, 20},
+    {"avalanche", buildAvalanche, nullptr, 300},
+    {"mixed", buildMixed, nullptr, 120}
+};
+
+// * ===================================
+// * Phase Counters
+// * ===================================
+
+#define NUM_PHASES 4
+
+// Timing stats of the handler's phases in the order they run.
+static StatType const phaseTypes[NUM_PHASES] = {STAT_INTEGRATION_TIME, STAT_COLLISION_TIME, STAT_SOLVER_TIME, STAT_EVENT_TIME};
+static char const* const phaseNames[NUM_PHASES] = {"integration", "collision", "solver", "events"};
+
+// Reads the hardware counters around each phase of the handler's steps and totals them by phase.
+class PhaseCounters : public StatsProbe {
+    private:
+        Bench::PerfCounters const &perf;
+        Bench::CounterValues start;
+        Bench::Clock::time_point startTime;
+
+    public:
+        Bench::CounterValues counters[NUM_STAT_TYPES];
+        double ms[NUM_STAT_TYPES];
+
+        PhaseCounters(Bench::PerfCounters const &perf) : perf(perf) {
+            memset(counters, 0, sizeof(counters));
+            memset(ms, 0, sizeof(ms));
+        };
+
+        void beginPhase() override {
+            start = perf.read();
+            startTime = Bench::Clock::now();
+        };
+
+        void endPhase(StatType type) override {
+            ms[type] += Bench::secondsSince(startTime) * 1000.0;
+            Bench::CounterValues d = Bench::difference(perf.read(), start);
+
+            for (int i = 0; i < Bench::NUM_COUNTERS; ++i) { counters[type][i] += d[i]; }
+        };
+};
+
+// * ===================================
+// * Running
+// * ===================================
+
+typedef struct SceneResult {
+    char const* name;
+    int rigidBodies, staticBodies, steps;
+    double mean, p50, p90, p99, max; // milliseconds per step
+    size_t peakBytes; // high-water mark of the heap while the scene was built and run, above what was allocated before it
+    double allocsPerStep;
+    uint64_t hash; // hash of the final state of the rigidbodies
+
+    bool hasCounters; // 1 if the hardware counters were read
+    double phaseMs[NUM_PHASES]; // milliseconds per step spent in each phase, including the time to read the counters
+    Bench::CounterValues phaseCounters[NUM_PHASES]; // hardware counts per step in each phase
+} SceneResult;
+
+// Find a percentile of sorted values using the nearest rank.
+static double percentile(std::vector<double> const &sorted, double p) {
+    int rank = (int) (p * sorted.size() + 0.5) - 1;
+    rank = rank < 0 ? 0 : (rank >= (int) sorted.size() ? (int) sorted.size() - 1 : rank);
+
+    return sorted[rank];
+};
+
+// FNV-1a hash of the bits of a list of floats.
+static uint64_t hashFloats(uint64_t hash, float const* values, int n) {
+    for (int i = 0; i < n; ++i) {
+        uint32_t bits;
+        memcpy(&bits, values + i, sizeof(bits));
+
+        for (int b = 0; b < 4; ++b) {
+            hash ^= (bits >> (8*b)) & 0xFF;
+            hash *= 0x100000001B3ull;
+        }
+    }
+
+    return hash;
+};
+
+// ? The hash only matches between runs which did the exact same floating point math.
+// ? A different compiler, flags or platform can change it without the physics being wrong.
+static uint64_t hashState(World const &world) {
+    uint64_t hash = 0xCBF29CE484222325ull;
+
+    for (RigidBody3D const* rb : world.rbs) {
+        float state[13] = {
+            rb->pos.x, rb->pos.y, rb->pos.z,
+            rb->vel.x, rb->vel.y, rb->vel.z,
+            rb->orientation.w, rb->orientation.x, rb->orientation.y, rb->orientation.z,
+            rb->angVel.x, rb->angVel.y, rb->angVel.z
+        };
+
+        hash = hashFloats(hash, state, 13);
+    }
+
+    return hash;
+};
+
+/**
+ * @brief Build and run a scene.
+ *
+ * @param scene The scene.
+ * @param steps The number of steps to run.
+ * @param scale The multiplier on the number of bodies.
+ * @param perf Hardware counters to read around each phase. nullptr to skip reading them.
+ * @return (SceneResult) The scene's results.
+ */
+static SceneResult runScene(Scene const &scene, int steps, float scale, Bench::PerfCounters const* perf) {
+    SceneResult result;
+    memset(&result, 0, sizeof(result));
+
+    result.name = scene.name;
+    result.steps = steps;
+
+    size_t startBytes = Bench::liveBytes;
+    Bench::resetPeakBytes();
+
+    std::vector<double> times(steps);
+    World* world = new World(scale);
+    scene.build(*world);
+
+    PhaseCounters* phases = perf ? new PhaseCounters(*perf) : nullptr;
+    world->handler->setStatsProbe(phases);
+
+    uint64_t startAllocs = Bench::allocations;
+
+    for (int i = 0; i < steps; ++i) {
+        if (scene.step) { scene.step(*world, i); }
+
+        float dt = FPS_60;
+        Bench::Clock::time_point start = Bench::Clock::now();
+
+        world->handler->update(dt);
+
+        times[i] = Bench::secondsSince(start) * 1000.0;
+    }
+
+    result.allocsPerStep = (double) (Bench::allocations - startAllocs)/steps;
+    result.rigidBodies = (int) world->rbs.size();
+    result.staticBodies = (int) world->sbs.size();
+    result.hash = hashState(*world);
+    result.peakBytes = Bench::peakBytes - startBytes;
+
+    delete world;
+
+    if (phases) {
+        result.hasCounters = 1;
+
+        for (int i = 0; i < NUM_PHASES; ++i) {
+            result.phaseMs[i] = phases->ms[phaseTypes[i]]/steps;
+            for (int j = 0; j < Bench::NUM_COUNTERS; ++j) { result.phaseCounters[i][j] = phases->counters[phaseTypes[i]][j]/steps; }
+        }
+
+        delete phases;
+    }
+
+    double sum = 0.0;
+    for (double t : times) { sum += t; }
+
+    std::sort(times.begin(), times.end());
+
+    result.mean = sum/steps;
+    result.p50 = percentile(times, 0.5);
+    result.p90 = percentile(times, 0.9);
+    result.p99 = percentile(times, 0.99);
+    result.max = times.back();
+
+    return result;
+};
+
+// * ===================================
+// * Output
+// * ===================================
+
+static void printHeader() {
+    printf("%-10s %7s %7s %6s %9s %9s %9s %9s %9s %10s %11s  %s\n", "scene", "rigid", "static", "steps",
+           "mean ms", "p50 ms", "p90 ms", "p99 ms", "max ms", "peak MB", "allocs/step", "state hash");
+};
+
+static void printResult(SceneResult const &r) {
+    printf("%-10s %7d %7d %6d %9.3f %9.3f %9.3f %9.3f %9.3f %10.2f %11.1f  %016llx\n", r.name, r.rigidBodies, r.staticBodies, r.steps,
+           r.mean, r.p50, r.p90, r.p99, r.max, r.peakBytes/(1024.0*1024.0), r.allocsPerStep, (unsigned long long) r.hash);
+
+    if (!r.hasCounters) { return; }
+
+    // the cycles are per step
+    printf("  %-12s %9s", "phase", "ms/step");
+    Bench::printCounterHeader();
+    printf("\n");
+
+    for (int i = 0; i < NUM_PHASES; ++i) {
+        printf("  %-12s %9.3f", phaseNames[i], r.phaseMs[i]);
+        Bench::printCounters(r.phaseCounters[i], 1.0);
+        printf("\n");
+    }
+};
+
+static bool writeJSON(char const* path, std::vector<SceneResult> const &results, float scale) {
+    FILE* file = fopen(path, "w");
+    if (!file) { return 0; }
+
+    fprintf(file, "{\"benchmark\":\"scenes\",\"scale\":%.3f,\"scenes\":[", scale);
+
+    for (size_t i = 0; i < results.size(); ++i) {
+        SceneResult const &r = results[i];
+
+        fprintf(file, "%s{\"name\":", i ? "," : "");
+        Bench::writeString(file, r.name);
+        fprintf(file, ",\"rigidBodies\":%d,\"staticBodies\":%d,\"steps\":%d,\"mean\":%.4f,\"p50\":%.4f,\"p90\":%.4f,\"p99\":%.4f,\"max\":%.4f,"
+                "\"peakBytes\":%llu,\"allocsPerStep\":%.2f,\"hash\":\"%016llx\"", r.rigidBodies, r.staticBodies, r.steps, r.mean,
+                r.p50, r.p90, r.p99, r.max, (unsigned long long) r.peakBytes, r.allocsPerStep, (unsigned long long) r.hash);
+
+        // ? The phases come last as their nested objects would end the scene's entry early for findBaselineValue.
+        if (r.hasCounters) {
+            fprintf(file, ",\"phases\":[");
+
+            for (int j = 0; j < NUM_PHASES; ++j) {
+                fprintf(file, "%s{\"phase\":\"%s\",\"ms\":%.4f,\"counters\":", j ? "," : "", phaseNames[j], r.phaseMs[j]);
+                Bench::writeCounters(file, r.phaseCounters[j]);
+                fputc('}', file);
+            }
+
+            fputc(']', file);
+        }
+
+        fputc('}', file);
+    }
+
+    fprintf(file, "]}\n");
+    return !fclose(file);
+};
+
+// * ===================================
+// * Baseline Comparison
+// * ===================================
+
+// Read a whole file into a null terminated string. Returns nullptr if it cannot be read.
+static char* readFile(char const* path) {
+    FILE* file = fopen(path, "rb");
+    if (!file) { return nullptr; }
+
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    char* data = new char[size + 1];
+    size_t read = fread(data, 1, size, file);
+    data[read] = '\0';
+
+    fclose(file);
+    return data;
+};
+
+// Find the value of a key in a scene's entry of a baseline.
+// ? The baseline is expected to have been written by writeJSON so the entries are flat and the names are never escaped.
+static char const* findBaselineValue(char const* json, char const* scene, char const* key) {
+    char pattern[64];
+
+    snprintf(pattern, sizeof(pattern), "{\"name\":\"%s\"", scene);
+    char const* entry = strstr(json, pattern);
+    if (!entry) { return nullptr; }
+
+    char const* end = strchr(entry, '}');
+
+    snprintf(pattern, sizeof(pattern), "\"%s\":", key);
+    char const* value = strstr(entry, pattern);
+
+    return value && value < end ? value + strlen(pattern) : nullptr;
+};
+
+/**
+ * @brief Compare a scene's results against a baseline.
+ *
+ * @param json The baseline.
+ * @param r The scene's results.
+ * @param threshold The fraction a stat can grow by before it counts as a regression. For example, 0.1 for 10%.
+ * @param failOnHash Count a change in the final state as a regression.
+ * @return (int) The number of regressions found.
+ */
+static int compareScene(char const* json, SceneResult const &r, double threshold, bool failOnHash) {
+    char const* steps = findBaselineValue(json, r.name, "steps");
+
+    if (!steps) {
+        printf("  %-10s not in the baseline\n", r.name);
+        return 0;
+    }
+
+    if (atoi(steps) != r.steps) { printf("  %-10s baseline ran %d steps instead of %d\n", r.name, atoi(steps), r.steps); }
+
+    int regressions = 0;
+
+    char const* keys[4] = {"mean", "p50", "p99", "peakBytes"};
+    double values[4] = {r.mean, r.p50, r.p99, (double) r.peakBytes};
+
+    for (int i = 0; i < 4; ++i) {
+        char const* value = findBaselineValue(json, r.name, keys[i]);
+        if (!value) { continue; }
+
+        double old = strtod(value, nullptr);
+        double change = old > 0.0 ? values[i]/old - 1.0 : 0.0;
+        bool regressed = change > threshold;
+
+        printf("  %-10s %-10s %14.4f -> %14.4f  %+7.1f%%%s\n", r.name, keys[i], old, values[i], change * 100.0, regressed ? "  REGRESSION" : "");
+        regressions += regressed;
+    }
+
+    char const* hash = findBaselineValue(json, r.name, "hash");
+    char current[20];
+    snprintf(current, sizeof(current), "\"%016llx\"", (unsigned long long) r.hash);
+
+    if (hash && strncmp(hash, current, 18)) {
+        printf("  %-10s final state changed from %.18s to %s%s\n", r.name, hash, current, failOnHash ? "  REGRESSION" : "");
+        regressions += failOnHash;
+    }
+
+    return regressions;
+};
+
+int main(int argc, char** argv) {
+    if (Bench::hasFlag(argc, argv, "--help")) {
+        printf("usage: scenes [--steps n] [--scale s] [--scene name] [--json path] [--baseline path] [--threshold t] [--fail-on-hash] [--perf]\n");
+        return 0;
+    }
+
+    int steps = atoi(Bench::getArg(argc, argv, "--steps", "0")); // 0 to use each scene's default
+    float scale = (float) atof(Bench::getArg(argc, argv, "--scale", "1"));
+    double threshold = atof(Bench::getArg(argc, argv, "--threshold", "0.1"));
+    char const* only = Bench::getArg(argc, argv, "--scene", nullptr);
+    char const* json = Bench::getArg(argc, argv, "--json", nullptr);
+    char const* baselinePath = Bench::getArg(argc, argv, "--baseline", nullptr);
+    bool failOnHash = Bench::hasFlag(argc, argv, "--fail-on-hash");
+
+    if (steps < 0 || scale <= 0.0f) {
+        fprintf(stderr, "--steps cannot be negative and --scale must be positive\n");
+        return 1;
+    }
+
+    char* baseline = nullptr;
+
+    if (baselinePath && !(baseline = readFile(baselinePath))) {
+        fprintf(stderr, "could not read %s\n", baselinePath);
+        return 1;
+    }
+
+    Bench::PerfCounters* perf = nullptr;
+
+    if (Bench::hasFlag(argc, argv, "--perf")) {
+        perf = new Bench::PerfCounters();
+        if (!perf->anyAvailable()) { fprintf(stderr, "no hardware counters are available. They will be reported as 0.\n"); }
+    }
+
+    std::vector<SceneResult> results;
+
+    printf("scale %.2f\n\n", scale);
+    printHeader();
+
+    for (Scene const &scene : scenes) {
+        if (only && strcmp(only, scene.name)) { continue; }
+
+        results.push_back(runScene(scene, steps ? steps : scene.steps, scale, perf));
+        printResult(results.back());
+        fflush(stdout);
+    }
+
+    delete perf;
+
+    if (json && !writeJSON(json, results, scale)) {
+        fprintf(stderr, "could not write %s\n", json);
+        return 1;
+    }
+
+    if (!baseline) { return 0; }
+
+    printf("\ncompared to %s (threshold %.1f%%)\n", baselinePath, threshold * 100.0);
+
+    int regressions = 0;
+    for (SceneResult const &r : results) { regressions += compareScene(baseline, r, threshold, failOnHash); }
+
+    delete[] baseline;
+
+    if (regressions) {
+        printf("\n%d regression%s\n", regressions, regressions == 1 ? "" : "s");
+        return 1;
+    }
+
+    printf("\nno regressions\n");
+    return 0;
+};
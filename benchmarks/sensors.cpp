@@ -0,0 +1,75 @@
+// ? Checks the sensor events produced by the physics handler for a few hand placed cases.
+// ? Each case places a single rigid body against a single sensor with no gravity and steps once.
+// ? The rotated cases are placed so an axis aligned test would give the wrong answer.
+// ? Prints each case and returns a non-zero exit code if any case produces the wrong number of enter events.
+// ?
+// ? Usage: sensors
+
+#define DISABLE_SPATIAL_PARTITIONING
+#include <cstdio>
+#include <zeta/physicshandler.h>
+
+using namespace Zeta;
+
+typedef struct SensorCase {
+    char const* name;
+    StaticBody3D* sensor;
+    RigidBody3D* rb;
+    int expected; // number of enter events after one step
+} SensorCase;
+
+// Step a handler holding only the sensor and the rigid body once and count the enter events.
+static int countEnterEvents(StaticBody3D* sensor, RigidBody3D* rb) {
+    Handler handler(ZMath::Vec3D(0, 0, 0), FPS_60);
+    handler.addSensor(sensor);
+    handler.addRigidBody(rb);
+
+    float dt = FPS_60;
+    handler.update(dt);
+
+    int count, enters = 0;
+    SensorEvent const* events = handler.getSensorEvents(count);
+
+    for (int i = 0; i < count; ++i) { enters += events[i].type == SENSOR_ENTER; }
+
+    return enters;
+};
+
+int main() {
+    // unit cube at the origin turned 45 degrees about the z axis so its corners reach out to sqrt(2) along the x and y axes
+    Cube turned(ZMath::Vec3D(-1), ZMath::Vec3D(1), 45.0f, 0.0f);
+
+    SensorCase cases[] = {
+        // sphere sitting in the corner of the turned cube past where the unturned cube would end
+        {"sphere in turned cube sensor", new StaticBody3D(ZMath::Vec3D(), turned),
+            new RigidBody3D(ZMath::Vec3D(1.3f, 0, 0), 1.0f, 0.2f, 0.999f, Sphere(ZMath::Vec3D(1.3f, 0, 0), 0.2f)), 1},
+
+        // sphere inside the unturned cube's corner which the turned cube has cut away
+        {"sphere beside turned cube sensor", new StaticBody3D(ZMath::Vec3D(), turned),
+            new RigidBody3D(ZMath::Vec3D(1, 1, 0), 1.0f, 0.2f, 0.999f, Sphere(ZMath::Vec3D(1, 1, 0), 0.2f)), 0},
+
+        // turned cube reaching into a box sensor with its corner
+        {"turned cube in box sensor", new StaticBody3D(ZMath::Vec3D(), AABB(ZMath::Vec3D(-1), ZMath::Vec3D(1))),
+            new RigidBody3D(ZMath::Vec3D(2.3f, 0, 0), 1.0f, 0.2f, 0.999f, Cube(ZMath::Vec3D(1.3f, -1, -1), ZMath::Vec3D(3.3f, 1, 1), 45.0f, 0.0f)), 1},
+
+        // turned cube next to a box sensor with its face towards the sensor's corner
+        {"turned cube beside box sensor", new StaticBody3D(ZMath::Vec3D(), AABB(ZMath::Vec3D(-1), ZMath::Vec3D(1))),
+            new RigidBody3D(ZMath::Vec3D(2.3f, 2.3f, 0), 1.0f, 0.2f, 0.999f, Cube(ZMath::Vec3D(1.3f, 1.3f, -1), ZMath::Vec3D(3.3f, 3.3f, 1), 45.0f, 0.0f)), 0},
+
+        // sphere in a box sensor
+        {"sphere in box sensor", new StaticBody3D(ZMath::Vec3D(), AABB(ZMath::Vec3D(-1), ZMath::Vec3D(1))),
+            new RigidBody3D(ZMath::Vec3D(1.1f, 0, 0), 1.0f, 0.2f, 0.999f, Sphere(ZMath::Vec3D(1.1f, 0, 0), 0.2f)), 1}
+    };
+
+    int failures = 0;
+
+    for (SensorCase const &c : cases) {
+        int enters = countEnterEvents(c.sensor, c.rb);
+        bool passed = enters == c.expected;
+
+        printf("%-40s %d enter events, expected %d %s\n", c.name, enters, c.expected, passed ? "" : "FAILED");
+        failures += !passed;
+    }
+
+    return failures != 0;
+};
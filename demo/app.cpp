@@ -658,8 +658,10 @@ void app_update(float &time_step, float dt){
     birch_10_entity->initialized = false;
     pine_5_entity->initialized = false;
 
-    ((Zeta::Cube *)(debug_xmover_entity->sb->collider))->theta += dt * 100.0f;
-    ((Zeta::Cube *)(debug_xmover_entity->sb->collider))->phi += dt * 100.0f;
+    Zeta::Cube* debug_xmover_cube = (Zeta::Cube *)(debug_xmover_entity->sb->collider);
+    debug_xmover_cube->theta += dt * 100.0f;
+    debug_xmover_cube->phi += dt * 100.0f;
+    debug_xmover_cube->updateRotation();
 
     // render_entities(&global_rd, &camera, em.entity_pointers, em.index, &textures_manager, &global_im);  
     //glBindTexture(GL_TEXTURE_2D, textures_manager.GetTextureIdentifier(TEXTURE_STALL));
@@ -2,15 +2,23 @@
 
 #pragma once
 
+#include <cassert>
+#include <new>
 #include <utility>
 #include "primitives.h"
 
+// Max depth of the AABB tree of a compound collider.
+// The tree is built by splitting at the median so its depth is at most log2 of the number of children, which is below this for any int.
+#define COMPOUND_MAX_DEPTH 32
+
 namespace Zeta {
     enum RigidBodyCollider {
         RIGID_SPHERE_COLLIDER,
         RIGID_AABB_COLLIDER,
         RIGID_CUBE_COLLIDER,
         RIGID_TRI_PY_COLLIDER,
+        RIGID_CAPSULE_COLLIDER,
+        RIGID_COMPOUND_COLLIDER,
         RIGID_CUSTOM_COLLIDER,
         RIGID_NONE
     };
@@ -20,6 +28,8 @@ namespace Zeta {
         STATIC_SPHERE_COLLIDER,
         STATIC_AABB_COLLIDER,
         STATIC_CUBE_COLLIDER,
+        STATIC_HEIGHTFIELD_COLLIDER,
+        STATIC_CAPSULE_COLLIDER,
         STATIC_CUSTOM_COLLIDER,
         STATIC_NONE
     };
@@ -34,6 +44,598 @@ namespace Zeta {
         KINEMATIC_NONE
     };
 
+    // * ===================================
+    // * Compound Colliders
+    // * ===================================
+
+    inline static bool getBounds(RigidBodyCollider type, void const* collider, ZMath::Vec3D &min, ZMath::Vec3D &max);
+
+    // A single shape attached to a compound collider.
+    struct CompoundChild {
+        // Type of the shape. This must be RIGID_SPHERE_COLLIDER, RIGID_AABB_COLLIDER, RIGID_CUBE_COLLIDER, or RIGID_CAPSULE_COLLIDER.
+        RigidBodyCollider type;
+
+        // The shape in global coordinates. This is owned by the compound collider.
+        void* collider;
+
+        // Position of the shape relative to the compound's origin.
+        ZMath::Vec3D offset;
+    };
+
+    // Models a collider made up of several shapes which move as one.
+    // The children are stored in a small AABB tree so that only children whose bounds overlap another collider are checked.
+    // This is far cheaper than joining several rigidbodies as it adds no extra bodies to the solver.
+    // Compound colliders should only be used as colliders for rigid bodies and cannot be nested.
+    class Compound {
+        private:
+            // Node of the AABB tree.
+            // Leaves store the index of their child. Branches store the index of their left and right nodes.
+            struct Node {
+                ZMath::Vec3D min, max; // bounds relative to the compound's origin
+                int left, right;
+                int child; // -1 if this is not a leaf
+            };
+
+            Node* nodes;
+            int numNodes;
+
+            // Recursively build the tree over a range of children.
+            // Returns the index of the node created.
+            int build(int* indices, int count, ZMath::Vec3D const* centers, ZMath::Vec3D const* mins, ZMath::Vec3D const* maxes, int depth) {
+                assert(depth <= COMPOUND_MAX_DEPTH && "A compound's tree is deeper than the stacks used to traverse it.");
+
+                int n = numNodes++;
+
+                nodes[n].min = mins[indices[0]];
+                nodes[n].max = maxes[indices[0]];
+
+                for (int i = 1; i < count; ++i) {
+                    ZMath::Vec3D const &lo = mins[indices[i]], &hi = maxes[indices[i]];
+                    nodes[n].min.set(ZMath::min(nodes[n].min.x, lo.x), ZMath::min(nodes[n].min.y, lo.y), ZMath::min(nodes[n].min.z, lo.z));
+                    nodes[n].max.set(ZMath::max(nodes[n].max.x, hi.x), ZMath::max(nodes[n].max.y, hi.y), ZMath::max(nodes[n].max.z, hi.z));
+                }
+
+                if (count == 1) {
+                    nodes[n].left = nodes[n].right = -1;
+                    nodes[n].child = indices[0];
+                    return n;
+                }
+
+                // split at the median of the longest axis
+                ZMath::Vec3D size = nodes[n].max - nodes[n].min;
+                int axis = size.x >= size.y && size.x >= size.z ? 0 : size.y >= size.z ? 1 : 2;
+
+                // insertion sort as there will only be a handful of children
+                for (int i = 1; i < count; ++i) {
+                    int idx = indices[i], j = i - 1;
+                    float key = axis == 0 ? centers[idx].x : axis == 1 ? centers[idx].y : centers[idx].z;
+
+                    for (; j >= 0; --j) {
+                        ZMath::Vec3D const &c = centers[indices[j]];
+                        if ((axis == 0 ? c.x : axis == 1 ? c.y : c.z) <= key) { break; }
+                        indices[j + 1] = indices[j];
+                    }
+
+                    indices[j + 1] = idx;
+                }
+
+                int half = count/2;
+
+                nodes[n].child = -1;
+                nodes[n].left = build(indices, half, centers, mins, maxes, depth + 1);
+                nodes[n].right = build(indices + half, count - half, centers, mins, maxes, depth + 1);
+
+                return n;
+            };
+
+            // Build the AABB tree from the current positions of the children.
+            void buildTree() {
+                ZMath::Vec3D* centers = new ZMath::Vec3D[numChildren];
+                ZMath::Vec3D* mins = new ZMath::Vec3D[numChildren];
+                ZMath::Vec3D* maxes = new ZMath::Vec3D[numChildren];
+                int* indices = new int[numChildren];
+
+                for (int i = 0; i < numChildren; ++i) {
+                    getBounds(children[i].type, children[i].collider, mins[i], maxes[i]);
+                    mins[i] -= pos;
+                    maxes[i] -= pos;
+                    centers[i] = (mins[i] + maxes[i]) * 0.5f;
+                    indices[i] = i;
+                }
+
+                nodes = new Node[2*numChildren - 1];
+                numNodes = 0;
+                build(indices, numChildren, centers, mins, maxes, 0);
+
+                delete[] centers;
+                delete[] mins;
+                delete[] maxes;
+                delete[] indices;
+            };
+
+            // Move a child's shape so it sits at the given position.
+            static void moveChild(CompoundChild &child, ZMath::Vec3D const &p) {
+                switch (child.type) {
+                    case RIGID_SPHERE_COLLIDER:  { ((Sphere*) child.collider)->c = p;    break; }
+                    case RIGID_AABB_COLLIDER:    { ((AABB*) child.collider)->pos = p;    break; }
+                    case RIGID_CUBE_COLLIDER:    { ((Cube*) child.collider)->pos = p;    break; }
+                    case RIGID_CAPSULE_COLLIDER: { ((Capsule*) child.collider)->pos = p; break; }
+                    default:                     {                                       break; }
+                }
+            };
+
+            // Get the position of a child's shape.
+            static ZMath::Vec3D getChildPos(CompoundChild const &child) {
+                switch (child.type) {
+                    case RIGID_SPHERE_COLLIDER:  { return ((Sphere*) child.collider)->c;    }
+                    case RIGID_AABB_COLLIDER:    { return ((AABB*) child.collider)->pos;    }
+                    case RIGID_CUBE_COLLIDER:    { return ((Cube*) child.collider)->pos;    }
+                    case RIGID_CAPSULE_COLLIDER: { return ((Capsule*) child.collider)->pos; }
+                    default:                     { return ZMath::Vec3D();                   }
+                }
+            };
+
+            // Deep copy the children and tree of another compound.
+            void copy(Compound const &c) {
+                pos = c.pos;
+                numChildren = c.numChildren;
+                numNodes = c.numNodes;
+
+                children = new CompoundChild[numChildren];
+                nodes = new Node[numNodes];
+
+                for (int i = 0; i < numNodes; ++i) { nodes[i] = c.nodes[i]; }
+
+                for (int i = 0; i < numChildren; ++i) {
+                    children[i] = c.children[i];
+
+                    switch (children[i].type) {
+                        case RIGID_SPHERE_COLLIDER:  { children[i].collider = new Sphere(*((Sphere*) c.children[i].collider));   break; }
+                        case RIGID_AABB_COLLIDER:    { children[i].collider = new AABB(*((AABB*) c.children[i].collider));       break; }
+                        case RIGID_CUBE_COLLIDER:    { children[i].collider = new Cube(*((Cube*) c.children[i].collider));       break; }
+                        case RIGID_CAPSULE_COLLIDER: { children[i].collider = new Capsule(*((Capsule*) c.children[i].collider)); break; }
+                        default:                     { children[i].collider = nullptr;                                           break; }
+                    }
+                }
+            };
+
+            void freeChildren() {
+                for (int i = 0; i < numChildren; ++i) {
+                    switch (children[i].type) {
+                        case RIGID_SPHERE_COLLIDER:  { delete (Sphere*) children[i].collider;  break; }
+                        case RIGID_AABB_COLLIDER:    { delete (AABB*) children[i].collider;    break; }
+                        case RIGID_CUBE_COLLIDER:    { delete (Cube*) children[i].collider;    break; }
+                        case RIGID_CAPSULE_COLLIDER: { delete (Capsule*) children[i].collider; break; }
+                        default:                     {                                         break; }
+                    }
+                }
+
+                delete[] children;
+                delete[] nodes;
+            };
+
+        public:
+            ZMath::Vec3D pos; // Origin of the compound. Each child is placed at pos + offset.
+
+            CompoundChild* children;
+            int numChildren;
+
+            /**
+             * @brief Create a compound collider.
+             *
+             * @param pos The origin of the compound. This should match the position of the rigidbody it is attached to.
+             * @param types The type of each child.
+             * @param colliders The shape of each child in global coordinates. The compound takes ownership of these so they must be
+             *                   allocated with new and should not be deleted by the caller.
+             * @param numChildren The number of children. This must be strictly greater than 0.
+             */
+            Compound(ZMath::Vec3D const &pos, RigidBodyCollider const* types, void* const* colliders, int numChildren)
+                    : pos(pos), numChildren(numChildren)
+            {
+                children = new CompoundChild[numChildren];
+
+                for (int i = 0; i < numChildren; ++i) {
+                    children[i].type = types[i];
+                    children[i].collider = colliders[i];
+                    children[i].offset = getChildPos(children[i]) - pos;
+                }
+
+                buildTree();
+            };
+
+
+            // * ===================
+            // * Rule of 5 Stuff
+            // * ===================
+
+            Compound(Compound const &c) { copy(c); };
+
+            Compound(Compound &&c) : nodes(c.nodes), numNodes(c.numNodes), pos(c.pos), children(c.children), numChildren(c.numChildren) {
+                c.nodes = nullptr;
+                c.children = nullptr;
+                c.numChildren = 0;
+            };
+
+            Compound& operator = (Compound const &c) {
+                if (this != &c) {
+                    freeChildren();
+                    copy(c);
+                }
+
+                return *this;
+            };
+
+            Compound& operator = (Compound &&c) {
+                if (this != &c) {
+                    freeChildren();
+
+                    pos = c.pos;
+                    nodes = c.nodes;
+                    numNodes = c.numNodes;
+                    children = c.children;
+                    numChildren = c.numChildren;
+
+                    c.nodes = nullptr;
+                    c.children = nullptr;
+                    c.numChildren = 0;
+                }
+
+                return *this;
+            };
+
+            ~Compound() { freeChildren(); };
+
+
+            // * ==============
+            // * Functions
+            // * ==============
+
+            // Move the compound and all of its children.
+            // The tree is stored relative to the compound's origin so it does not need to be rebuilt.
+            void setPos(ZMath::Vec3D const &p) {
+                pos = p;
+                for (int i = 0; i < numChildren; ++i) { moveChild(children[i], pos + children[i].offset); }
+            };
+
+            // Get the min vertex of the compound's bounds.
+            inline ZMath::Vec3D getMin() const { return pos + nodes[0].min; };
+
+            // Get the max vertex of the compound's bounds.
+            inline ZMath::Vec3D getMax() const { return pos + nodes[0].max; };
+
+            /**
+             * @brief Find the children whose bounds overlap a region.
+             *
+             * @param min The min vertex of the region in global coordinates.
+             * @param max The max vertex of the region in global coordinates.
+             * @param out Filled with the indices of the overlapping children.
+             * @param capacity The max number of indices that can be written to out.
+             * @return (int) The number of indices written to out.
+             */
+            int query(ZMath::Vec3D const &min, ZMath::Vec3D const &max, int* out, int capacity) const {
+                ZMath::Vec3D lo = min - pos, hi = max - pos;
+                int top = 0, count = 0;
+
+                // ? Each branch popped pushes both of its children, so the stack holds at most one node per level plus one.
+                int stack[COMPOUND_MAX_DEPTH + 1];
+
+                stack[top++] = 0;
+
+                while (top && count < capacity) {
+                    Node const &node = nodes[stack[--top]];
+
+                    if (node.min.x > hi.x || node.max.x < lo.x || node.min.y > hi.y || node.max.y < lo.y || node.min.z > hi.z || node.max.z < lo.z) { continue; }
+
+                    if (node.child >= 0) { out[count++] = node.child; }
+                    else {
+                        stack[top++] = node.left;
+                        stack[top++] = node.right;
+                    }
+                }
+
+                return count;
+            };
+
+            /**
+             * @brief Find the pairs of children from this and another compound whose bounds overlap.
+             * Both trees are descended together so subtrees which do not overlap are never visited.
+             *
+             * @param c The other compound.
+             * @param out Filled with the overlapping pairs. out[i][0] is a child of this and out[i][1] is a child of c.
+             * @param capacity The max number of pairs that can be written to out.
+             * @return (int) The number of pairs written to out.
+             */
+            int queryPairs(Compound const &c, int (*out)[2], int capacity) const {
+                ZMath::Vec3D offset = c.pos - pos; // converts from c's local space to ours
+                int top = 0, count = 0;
+
+                // ? Each pair popped pushes two pairs with one node a level deeper, so the stack holds at most one pair per level of both trees plus one.
+                int stack[2*COMPOUND_MAX_DEPTH + 1][2];
+
+                stack[top][0] = 0;
+                stack[top++][1] = 0;
+
+                while (top && count < capacity) {
+                    --top;
+                    Node const &a = nodes[stack[top][0]];
+                    Node const &b = c.nodes[stack[top][1]];
+
+                    ZMath::Vec3D bMin = b.min + offset, bMax = b.max + offset;
+                    if (a.min.x > bMax.x || a.max.x < bMin.x || a.min.y > bMax.y || a.max.y < bMin.y || a.min.z > bMax.z || a.max.z < bMin.z) { continue; }
+
+                    if (a.child >= 0 && b.child >= 0) {
+                        out[count][0] = a.child;
+                        out[count++][1] = b.child;
+                        continue;
+                    }
+
+                    int ai = stack[top][0], bi = stack[top][1];
+
+                    // descend into the larger node first so both trees shrink evenly
+                    ZMath::Vec3D aSize = a.max - a.min, bSize = b.max - b.min;
+                    bool splitA = b.child >= 0 || (a.child < 0 && aSize.magSq() >= bSize.magSq());
+
+                    if (splitA) {
+                        stack[top][0] = a.left;    stack[top++][1] = bi;
+                        stack[top][0] = a.right;   stack[top++][1] = bi;
+
+                    } else {
+                        stack[top][0] = ai;        stack[top++][1] = b.left;
+                        stack[top][0] = ai;        stack[top++][1] = b.right;
+                    }
+                }
+
+                return count;
+            };
+    };
+
+    // * ===================================
+    // * Collider Bounds
+    // * ===================================
+
+    /**
+     * @brief Find the bounds of a collider which can be attached to a rigidbody.
+     *
+     * @param type The type of the collider.
+     * @param collider The collider.
+     * @param min Set to the min vertex of the collider's bounds.
+     * @param max Set to the max vertex of the collider's bounds.
+     * @return (bool) 1 if the bounds could be determined and 0 otherwise (ex: custom colliders).
+     */
+    inline static bool getBounds(RigidBodyCollider type, void const* collider, ZMath::Vec3D &min, ZMath::Vec3D &max) {
+        switch (type) {
+            case RIGID_SPHERE_COLLIDER: {
+                Sphere const* sphere = (Sphere const*) collider;
+                min = sphere->c - sphere->r;
+                max = sphere->c + sphere->r;
+                return 1;
+            }
+
+            case RIGID_AABB_COLLIDER: {
+                min = ((AABB const*) collider)->getMin();
+                max = ((AABB const*) collider)->getMax();
+                return 1;
+            }
+
+            case RIGID_CUBE_COLLIDER: {
+                Cube const* cube = (Cube const*) collider;
+                ZMath::Vec3D extents = ZMath::abs(cube->rot) * cube->getHalfSize();
+                min = cube->pos - extents;
+                max = cube->pos + extents;
+                return 1;
+            }
+
+            case RIGID_CAPSULE_COLLIDER: {
+                min = ((Capsule const*) collider)->getMin();
+                max = ((Capsule const*) collider)->getMax();
+                return 1;
+            }
+
+            case RIGID_COMPOUND_COLLIDER: {
+                min = ((Compound const*) collider)->getMin();
+                max = ((Compound const*) collider)->getMax();
+                return 1;
+            }
+
+            default: { return 0; }
+        }
+    };
+
+    /**
+     * @brief Find the bounds of a collider which can be attached to a staticbody.
+     *
+     * @param type The type of the collider.
+     * @param collider The collider.
+     * @param min Set to the min vertex of the collider's bounds.
+     * @param max Set to the max vertex of the collider's bounds.
+     * @return (bool) 1 if the bounds could be determined and 0 otherwise (ex: custom colliders).
+     */
+    inline static bool getBounds(StaticBodyCollider type, void const* collider, ZMath::Vec3D &min, ZMath::Vec3D &max) {
+        switch (type) {
+            case STATIC_PLANE_COLLIDER: {
+                Plane const* plane = (Plane const*) collider;
+                ZMath::Vec2D h = plane->getHalfSize();
+                ZMath::Vec3D extents = ZMath::abs(plane->rot) * ZMath::Vec3D(h.x, h.y, 0.0f);
+                min = plane->pos - extents;
+                max = plane->pos + extents;
+                return 1;
+            }
+
+            case STATIC_SPHERE_COLLIDER:  { return getBounds(RIGID_SPHERE_COLLIDER, collider, min, max); }
+            case STATIC_AABB_COLLIDER:    { return getBounds(RIGID_AABB_COLLIDER, collider, min, max); }
+            case STATIC_CUBE_COLLIDER:    { return getBounds(RIGID_CUBE_COLLIDER, collider, min, max); }
+            case STATIC_CAPSULE_COLLIDER: { return getBounds(RIGID_CAPSULE_COLLIDER, collider, min, max); }
+
+            case STATIC_HEIGHTFIELD_COLLIDER: {
+                min = ((Heightfield const*) collider)->getMin();
+                max = ((Heightfield const*) collider)->getMax();
+                return 1;
+            }
+
+            default: { return 0; }
+        }
+    };
+
+
+    // * ===================================
+    // * Collision Filtering
+    // * ===================================
+
+    // Determines which bodies can collide with each other.
+    // Bodies in the same nonzero group always collide if the group is positive and never collide if it is negative.
+    // Otherwise, two bodies only collide if each body's category is in the other's mask.
+    typedef struct CollisionFilter {
+        uint32_t category = 1; // layers the body belongs to, one per bit
+        uint32_t mask = 0xFFFFFFFF; // layers the body collides with
+        int32_t group = 0; // 0 for no group
+    } CollisionFilter;
+
+    inline static bool shouldCollide(CollisionFilter const &a, CollisionFilter const &b) {
+        if (a.group && a.group == b.group) { return a.group > 0; }
+        return (a.category & b.mask) && (b.category & a.mask);
+    };
+
+
+    // * ===================================
+    // * Inline Collider Storage
+    // * ===================================
+
+    // Space for a collider stored inside its body instead of being allocated separately.
+    // ? Bodies made from a shape rather than a pointer keep their collider here, right next to the rest of the body,
+    // ?  so reaching the collider does not miss the cache and making or copying the body does not allocate.
+    // ? Compound, heightfield, and custom colliders own other memory or can be any size so they are always allocated.
+    union ColliderStorage {
+        Plane plane;
+        Sphere sphere;
+        AABB aabb;
+        Cube cube;
+        TriangularPyramid triPy;
+        Capsule capsule;
+
+        ColliderStorage() {};
+    };
+
+    // Collider type of each shape which can be stored inline. NONE if a kind of body cannot use the shape.
+    template <typename Shape> struct ColliderTypeOf {
+        static const RigidBodyCollider rigid = RIGID_NONE;
+        static const StaticBodyCollider stat = STATIC_NONE;
+        static const KinematicBodyCollider kinematic = KINEMATIC_NONE;
+    };
+
+    template <> struct ColliderTypeOf<Plane> {
+        static const RigidBodyCollider rigid = RIGID_NONE;
+        static const StaticBodyCollider stat = STATIC_PLANE_COLLIDER;
+        static const KinematicBodyCollider kinematic = KINEMATIC_PLANE_COLLIDER;
+    };
+
+    template <> struct ColliderTypeOf<Sphere> {
+        static const RigidBodyCollider rigid = RIGID_SPHERE_COLLIDER;
+        static const StaticBodyCollider stat = STATIC_SPHERE_COLLIDER;
+        static const KinematicBodyCollider kinematic = KINEMATIC_SPHERE_COLLIDER;
+    };
+
+    template <> struct ColliderTypeOf<AABB> {
+        static const RigidBodyCollider rigid = RIGID_AABB_COLLIDER;
+        static const StaticBodyCollider stat = STATIC_AABB_COLLIDER;
+        static const KinematicBodyCollider kinematic = KINEMATIC_AABB_COLLIDER;
+    };
+
+    template <> struct ColliderTypeOf<Cube> {
+        static const RigidBodyCollider rigid = RIGID_CUBE_COLLIDER;
+        static const StaticBodyCollider stat = STATIC_CUBE_COLLIDER;
+        static const KinematicBodyCollider kinematic = KINEMATIC_CUBE_COLLIDER;
+    };
+
+    template <> struct ColliderTypeOf<TriangularPyramid> {
+        static const RigidBodyCollider rigid = RIGID_TRI_PY_COLLIDER;
+        static const StaticBodyCollider stat = STATIC_NONE;
+        static const KinematicBodyCollider kinematic = KINEMATIC_TRI_PY_COLLIDER;
+    };
+
+    template <> struct ColliderTypeOf<Capsule> {
+        static const RigidBodyCollider rigid = RIGID_CAPSULE_COLLIDER;
+        static const StaticBodyCollider stat = STATIC_CAPSULE_COLLIDER;
+        static const KinematicBodyCollider kinematic = KINEMATIC_NONE;
+    };
+
+    // Copy a collider into a body's storage, or allocate a copy if it cannot be stored inline. Returns the copy.
+    inline static void* copyCollider(RigidBodyCollider type, void const* collider, ColliderStorage &storage) {
+        switch(type) {
+            case RIGID_SPHERE_COLLIDER:   { return new (&storage) Sphere(*((Sphere const*) collider));                       }
+            case RIGID_AABB_COLLIDER:     { return new (&storage) AABB(*((AABB const*) collider));                           }
+            case RIGID_CUBE_COLLIDER:     { return new (&storage) Cube(*((Cube const*) collider));                           }
+            case RIGID_TRI_PY_COLLIDER:   { return new (&storage) TriangularPyramid(*((TriangularPyramid const*) collider)); }
+            case RIGID_CAPSULE_COLLIDER:  { return new (&storage) Capsule(*((Capsule const*) collider));                     }
+            case RIGID_COMPOUND_COLLIDER: { return new Compound(*((Compound const*) collider));                              }
+            default:                      { return nullptr;                                                                  }
+        }
+    };
+
+    inline static void* copyCollider(StaticBodyCollider type, void const* collider, ColliderStorage &storage) {
+        switch(type) {
+            case STATIC_PLANE_COLLIDER:       { return new (&storage) Plane(*((Plane const*) collider));     }
+            case STATIC_SPHERE_COLLIDER:      { return new (&storage) Sphere(*((Sphere const*) collider));   }
+            case STATIC_AABB_COLLIDER:        { return new (&storage) AABB(*((AABB const*) collider));       }
+            case STATIC_CUBE_COLLIDER:        { return new (&storage) Cube(*((Cube const*) collider));       }
+            case STATIC_CAPSULE_COLLIDER:     { return new (&storage) Capsule(*((Capsule const*) collider)); }
+            case STATIC_HEIGHTFIELD_COLLIDER: { return new Heightfield(*((Heightfield const*) collider));    }
+            default:                          { return nullptr;                                              }
+        }
+    };
+
+    inline static void* copyCollider(KinematicBodyCollider type, void const* collider, ColliderStorage &storage) {
+        switch(type) {
+            case KINEMATIC_PLANE_COLLIDER:  { return new (&storage) Plane(*((Plane const*) collider));                         }
+            case KINEMATIC_SPHERE_COLLIDER: { return new (&storage) Sphere(*((Sphere const*) collider));                       }
+            case KINEMATIC_AABB_COLLIDER:   { return new (&storage) AABB(*((AABB const*) collider));                           }
+            case KINEMATIC_CUBE_COLLIDER:   { return new (&storage) Cube(*((Cube const*) collider));                           }
+            case KINEMATIC_TRI_PY_COLLIDER: { return new (&storage) TriangularPyramid(*((TriangularPyramid const*) collider)); }
+            default:                        { return nullptr;                                                                  }
+        }
+    };
+
+    // Delete a collider unless it is stored in the body.
+    inline static void deleteCollider(RigidBodyCollider type, void* collider, ColliderStorage const &storage) {
+        if (collider == &storage) { return; }
+
+        switch(type) {
+            case RIGID_SPHERE_COLLIDER:   { delete (Sphere*) collider;            break; }
+            case RIGID_AABB_COLLIDER:     { delete (AABB*) collider;              break; }
+            case RIGID_CUBE_COLLIDER:     { delete (Cube*) collider;              break; }
+            case RIGID_TRI_PY_COLLIDER:   { delete (TriangularPyramid*) collider; break; }
+            case RIGID_CAPSULE_COLLIDER:  { delete (Capsule*) collider;           break; }
+            case RIGID_COMPOUND_COLLIDER: { delete (Compound*) collider;          break; }
+            default:                      {                                       break; }
+        }
+    };
+
+    inline static void deleteCollider(StaticBodyCollider type, void* collider, ColliderStorage const &storage) {
+        if (collider == &storage) { return; }
+
+        switch(type) {
+            case STATIC_PLANE_COLLIDER:       { delete (Plane*) collider;       break; }
+            case STATIC_SPHERE_COLLIDER:      { delete (Sphere*) collider;      break; }
+            case STATIC_AABB_COLLIDER:        { delete (AABB*) collider;        break; }
+            case STATIC_CUBE_COLLIDER:        { delete (Cube*) collider;        break; }
+            case STATIC_HEIGHTFIELD_COLLIDER: { delete (Heightfield*) collider; break; }
+            case STATIC_CAPSULE_COLLIDER:     { delete (Capsule*) collider;     break; }
+            default:                          {                                 break; }
+        }
+    };
+
+    inline static void deleteCollider(KinematicBodyCollider type, void* collider, ColliderStorage const &storage) {
+        if (collider == &storage) { return; }
+
+        switch(type) {
+            case KINEMATIC_PLANE_COLLIDER:  { delete (Plane*) collider;             break; }
+            case KINEMATIC_SPHERE_COLLIDER: { delete (Sphere*) collider;            break; }
+            case KINEMATIC_AABB_COLLIDER:   { delete (AABB*) collider;              break; }
+            case KINEMATIC_CUBE_COLLIDER:   { delete (Cube*) collider;              break; }
+            case KINEMATIC_TRI_PY_COLLIDER: { delete (TriangularPyramid*) collider; break; }
+            default:                        {                                       break; }
+        }
+    };
+
     class RigidBody3D {
         public:
             // * =====================
@@ -43,7 +645,10 @@ namespace Zeta {
             // * Handle and store the collider.
 
             RigidBodyCollider colliderType;
-            void* collider;
+            void* collider; // points to colliderStorage when the collider is stored inline
+
+            // Holds the collider when the rigidbody was made from a shape or copied, so it does not need to be allocated.
+            ColliderStorage colliderStorage;
 
             // * Handle and store the physics.
 
@@ -64,6 +669,34 @@ namespace Zeta {
             ZMath::Vec3D vel; // velocity of the rigidbody.
             ZMath::Vec3D netForce; // sum of all forces acting on the rigidbody.
 
+            // * Handle and store the rotation.
+
+            // Angular damping. Acts as rotational friction on the rigidbody.
+            // Defaults to the linear damping.
+            float angularDamping = 1.0f;
+
+            ZMath::Quaternion orientation; // rotation from the rigidbody's local space to global space.
+            ZMath::Vec3D angVel; // angular velocity of the rigidbody in radians per second, in global coordinates.
+            ZMath::Vec3D netTorque; // sum of all torques acting on the rigidbody.
+
+            // Inverse of the moments of inertia about the rigidbody's local axes.
+            // 0 for an axis the rigidbody cannot rotate about. Set by computeInertia.
+            ZMath::Vec3D invInertiaLocal;
+
+            // Half the length of a capsule collider's segment, which lies along the rigidbody's local z axis. Set by computeInertia.
+            // ? The segment is rebuilt from this when the rigidbody rotates so its length never picks up rounding error.
+            float capsuleHalfLength = 0.0f;
+
+            // Inverse inertia tensor in global coordinates. Cached once per step from the orientation.
+            ZMath::Mat3D invInertia = ZMath::Mat3D(0, 0, 0, 0, 0, 0, 0, 0, 0);
+
+            // Enable continuous collision detection for this rigidbody.
+            // Only set this for small, fast moving bodies which could otherwise pass through things in a single update.
+            bool ccd = 0;
+
+            // Which bodies this rigidbody can collide with.
+            CollisionFilter filter;
+
 
             // * ================
             // * Constructors
@@ -84,14 +717,35 @@ namespace Zeta {
              *                   cause undefined behavior to occur. If you specify RIGID_NONE, this should be set to nullptr. 
              */
             RigidBody3D(ZMath::Vec3D const &pos, float mass, float cor, float linearDamping, RigidBodyCollider colliderType, void* collider) 
-                    : pos(pos), mass(mass), invMass(1.0f/mass), cor(cor), linearDamping(linearDamping), 
-                      colliderType(colliderType), collider(collider) {};
+                    : colliderType(colliderType), collider(collider), mass(mass), invMass(1.0f/mass), cor(cor), linearDamping(linearDamping),
+                      pos(pos), angularDamping(linearDamping) { computeInertia(); };
+
+            /**
+             * @brief Create a 3D RigidBody which stores its collider inline rather than pointing to a separately allocated one.
+             *
+             * @param pos Centerpoint of the rigidbody.
+             * @param mass Mass of the rigidbody.
+             * @param linearDamping The linear damping of the rigid body. This should fall on (0, 1].
+             * @param shape The collider, which is copied into the rigidbody. This must be a Sphere, AABB, Cube, TriangularPyramid, or Capsule.
+             */
+            template <typename Shape>
+            RigidBody3D(ZMath::Vec3D const &pos, float mass, float cor, float linearDamping, Shape const &shape)
+                    : colliderType(ColliderTypeOf<Shape>::rigid), mass(mass), invMass(1.0f/mass), cor(cor), linearDamping(linearDamping),
+                      pos(pos), angularDamping(linearDamping) {
+
+                static_assert(ColliderTypeOf<Shape>::rigid != RIGID_NONE, "This shape cannot be stored inline in a rigidbody.");
+
+                collider = copyCollider(colliderType, &shape, colliderStorage);
+                computeInertia();
+            };
 
 
             // * ===================
             // * Rule of 5 Stuff
             // * ===================
 
+            // ? Copies store their collider inline if it can be stored inline, no matter how the original stores it.
+
             // Create a 3D rigidbody from another 3D rigidbody.
             RigidBody3D(RigidBody3D const &rb) {
                 pos = rb.pos;
@@ -99,15 +753,15 @@ namespace Zeta {
                 invMass = rb.invMass;
                 cor = rb.cor;
                 linearDamping = rb.linearDamping;
+                angularDamping = rb.angularDamping;
+                orientation = rb.orientation;
+                invInertiaLocal = rb.invInertiaLocal;
+                capsuleHalfLength = rb.capsuleHalfLength;
+                invInertia = rb.invInertia;
+                ccd = rb.ccd;
+                filter = rb.filter;
                 colliderType = rb.colliderType;
-
-                switch(colliderType) {
-                    case RIGID_SPHERE_COLLIDER: { collider = new Sphere(*((Sphere*) rb.collider));                       break; }
-                    case RIGID_AABB_COLLIDER:   { collider = new AABB(*((AABB*) rb.collider));                           break; }
-                    case RIGID_CUBE_COLLIDER:   { collider = new Cube(*((Cube*) rb.collider));                           break; }
-                    case RIGID_TRI_PY_COLLIDER: { collider = new TriangularPyramid(*((TriangularPyramid*) rb.collider)); break; }
-                    case RIGID_NONE:            { collider = nullptr;                                                    break; }
-                }
+                collider = copyCollider(colliderType, rb.collider, colliderStorage);
             };
 
             // Create a 3D rigidbody from another 3D rigidbody.
@@ -117,40 +771,45 @@ namespace Zeta {
                 invMass = rb.invMass;
                 cor = rb.cor;
                 linearDamping = rb.linearDamping;
+                angularDamping = rb.angularDamping;
+                orientation = rb.orientation;
+                invInertiaLocal = rb.invInertiaLocal;
+                capsuleHalfLength = rb.capsuleHalfLength;
+                invInertia = rb.invInertia;
+                ccd = rb.ccd;
+                filter = rb.filter;
                 colliderType = rb.colliderType;
-                collider = rb.collider;
+
+                // ? An inline collider has to be copied as it lives in the other rigidbody.
+                collider = rb.collider == &rb.colliderStorage ? copyCollider(colliderType, rb.collider, colliderStorage) : rb.collider;
                 rb.collider = nullptr;
             };
 
             RigidBody3D& operator = (RigidBody3D const &rb) {
                 if (this != &rb) { 
-                    if (collider) {
-                        switch(colliderType) {
-                            case RIGID_SPHERE_COLLIDER: { delete (Sphere*) collider;            break; }
-                            case RIGID_AABB_COLLIDER:   { delete (AABB*) collider;              break; }
-                            case RIGID_CUBE_COLLIDER:   { delete (Cube*) collider;              break; }
-                            case RIGID_TRI_PY_COLLIDER: { delete (TriangularPyramid*) collider; break; }
-                        }
-                    }
+                    deleteCollider(colliderType, collider, colliderStorage);
 
                     pos = rb.pos;
                     mass = rb.mass;
                     invMass = rb.invMass;
                     cor = rb.cor;
                     linearDamping = rb.linearDamping;
+                    angularDamping = rb.angularDamping;
+                    orientation = rb.orientation;
+                    invInertiaLocal = rb.invInertiaLocal;
+                    capsuleHalfLength = rb.capsuleHalfLength;
+                    invInertia = rb.invInertia;
+                    ccd = rb.ccd;
+                    filter = rb.filter;
                     colliderType = rb.colliderType;
 
                     // zero the velocity and net force
                     vel.zero();
                     netForce.zero();
+                    angVel.zero();
+                    netTorque.zero();
 
-                    switch(colliderType) {
-                        case RIGID_SPHERE_COLLIDER: { collider = new Sphere(*((Sphere*) rb.collider));                       break; }
-                        case RIGID_AABB_COLLIDER:   { collider = new AABB(*((AABB*) rb.collider));                           break; }
-                        case RIGID_CUBE_COLLIDER:   { collider = new Cube(*((Cube*) rb.collider));                           break; }
-                        case RIGID_TRI_PY_COLLIDER: { collider = new TriangularPyramid(*((TriangularPyramid*) rb.collider)); break; }
-                        case RIGID_NONE:            { collider = nullptr;                                                    break; }
-                    }
+                    collider = copyCollider(colliderType, rb.collider, colliderStorage);
                 }
 
                 return *this;
@@ -158,31 +817,35 @@ namespace Zeta {
 
             RigidBody3D& operator = (RigidBody3D &&rb) {
                 if (this != &rb) {
+                    deleteCollider(colliderType, collider, colliderStorage);
+
                     pos = std::move(rb.pos);
                     mass = rb.mass;
                     invMass = rb.invMass;
                     cor = rb.cor;
                     linearDamping = rb.linearDamping;
+                    angularDamping = rb.angularDamping;
+                    orientation = rb.orientation;
+                    invInertiaLocal = rb.invInertiaLocal;
+                    capsuleHalfLength = rb.capsuleHalfLength;
+                    invInertia = rb.invInertia;
+                    ccd = rb.ccd;
+                    filter = rb.filter;
                     colliderType = rb.colliderType;
-                    collider = rb.collider;
+                    collider = rb.collider == &rb.colliderStorage ? copyCollider(colliderType, rb.collider, colliderStorage) : rb.collider;
                     rb.collider = nullptr;
 
                     // zero the velocity and net force
                     vel.zero();
                     netForce.zero();
+                    angVel.zero();
+                    netTorque.zero();
                 }
 
                 return *this;
             };
 
-            ~RigidBody3D() {
-                switch(colliderType) {
-                    case RIGID_SPHERE_COLLIDER: { delete (Sphere*) collider;            break; }
-                    case RIGID_AABB_COLLIDER:   { delete (AABB*) collider;              break; }
-                    case RIGID_CUBE_COLLIDER:   { delete (Cube*) collider;              break; }
-                    case RIGID_TRI_PY_COLLIDER: { delete (TriangularPyramid*) collider; break; }
-                }
-            };
+            ~RigidBody3D() { deleteCollider(colliderType, collider, colliderStorage); };
 
 
             // * ===================
@@ -190,20 +853,152 @@ namespace Zeta {
             // * ===================
 
             void update(ZMath::Vec3D const &g, float dt) {
+                integrateVel(g, dt);
+                integratePos(dt);
+            };
+
+            // Apply gravity and the net force to the velocity, and the net torque to the angular velocity.
+            // The handler calls this before resolving collisions so contacts can cancel out the velocity gained this step.
+            void integrateVel(ZMath::Vec3D const &g, float dt) {
                 // ? assuming g is gravity, and it is already negative
                 netForce += g * mass;
                 vel += (netForce * invMass) * dt;
-                pos += vel * dt;
+                netForce.zero();
 
+                // the solver uses the inverse inertia for the rest of the step
+                updateInertia();
+                angVel += invInertia * (netTorque * dt);
+                netTorque.zero();
+            };
+
+            // Move the rigidbody by its velocity and rotate it by its angular velocity.
+            void integratePos(float dt) {
+                pos += vel * dt;
                 vel *= linearDamping;
-                netForce.zero();
 
-                // Update the pos of the collider.
+                // ? The collider's rotation is only updated when the rigidbody is actually rotating.
+                if (angVel.magSq()) {
+                    orientation = orientation.integrate(angVel, dt);
+                    angVel *= angularDamping;
+                    syncRotation();
+                }
+
+                syncCollider();
+            };
+
+            // Apply a force at a point in global coordinates. Off-center forces also apply a torque.
+            void applyForce(ZMath::Vec3D const &force, ZMath::Vec3D const &point) {
+                netForce += force;
+                netTorque += (point - pos).cross(force);
+            };
+
+            // Update the global inverse inertia tensor from the orientation.
+            void updateInertia() {
+                if (!invInertiaLocal.magSq()) { return; }
+
+                // R * I^-1 * R^T
+                ZMath::Mat3D rot = orientation.toMat3D();
+                invInertia = ZMath::Mat3D(rot.c1 * invInertiaLocal.x, rot.c2 * invInertiaLocal.y, rot.c3 * invInertiaLocal.z) * rot.transpose();
+            };
+
+            // Compute the orientation and moments of inertia from the collider.
+            // This is called by the constructor. Call it again after changing the mass or collider.
+            // ? AABBs cannot rotate. Compound colliders do not support rotation yet.
+            void computeInertia() {
+                invInertiaLocal.zero();
+                invInertia = ZMath::Mat3D(0, 0, 0, 0, 0, 0, 0, 0, 0);
+                orientation = ZMath::Quaternion();
+
+                switch(colliderType) {
+                    case RIGID_SPHERE_COLLIDER: {
+                        float r = ((Sphere*) collider)->r;
+                        invInertiaLocal.set(2.5f/(mass * r*r));
+                        break;
+                    }
+
+                    case RIGID_CUBE_COLLIDER: {
+                        Cube* cube = (Cube*) collider;
+                        ZMath::Vec3D h = cube->getHalfSize();
+
+                        // a box's local axes are its principal axes
+                        orientation = ZMath::Quaternion::fromMat3D(cube->rot);
+                        invInertiaLocal.set(3.0f/(mass * (h.y*h.y + h.z*h.z)), 3.0f/(mass * (h.x*h.x + h.z*h.z)), 3.0f/(mass * (h.x*h.x + h.y*h.y)));
+                        break;
+                    }
+
+                    case RIGID_TRI_PY_COLLIDER: {
+                        TriangularPyramid* triPy = (TriangularPyramid*) collider;
+
+                        // ? The inertia of a regular tetrahedron is the same about every axis through its center.
+                        orientation = ZMath::Quaternion::fromMat3D(triPy->rot);
+                        invInertiaLocal.set(20.0f/(mass * triPy->sideLength * triPy->sideLength));
+                        break;
+                    }
+
+                    case RIGID_CAPSULE_COLLIDER: {
+                        Capsule* capsule = (Capsule*) collider;
+                        ZMath::Vec3D h = capsule->getHalfSegment();
+                        float len = h.mag(), r = capsule->r;
+
+                        capsuleHalfLength = len;
+
+                        // ? The capsule's segment lies along its local z axis, so rotate the z axis onto the segment.
+                        if (len) {
+                            ZMath::Vec3D d = h * (1.0f/len);
+
+                            if (d.z < -0.9999f) { orientation = ZMath::Quaternion(0.0f, 1.0f, 0.0f, 0.0f); }
+                            else { orientation = ZMath::Quaternion(1.0f + d.z, -d.y, d.x, 0.0f).normalize(); }
+                        }
+
+                        // ? Rebuild the segment the same way syncRotation does so the segment only depends on the orientation.
+                        capsule->setHalfSegment(orientation.rotate(ZMath::Vec3D(0.0f, 0.0f, len)));
+
+                        // split the mass between the cylinder and the hemispheres by volume
+                        float height = 2.0f*len;
+                        float cylinder = height * r*r, spheres = (4.0f/3.0f) * r*r*r;
+                        float mc = mass * cylinder/(cylinder + spheres), ms = mass - mc;
+
+                        float axial = mc * r*r * 0.5f + ms * r*r * 0.4f;
+                        float transverse = mc * (height*height/12.0f + r*r * 0.25f) + ms * (r*r * 0.4f + height*height * 0.25f + 0.375f * height * r);
+
+                        invInertiaLocal.set(1.0f/transverse, 1.0f/transverse, 1.0f/axial);
+                        break;
+                    }
+
+                    default: { return; }
+                }
+
+                updateInertia();
+            };
+
+            // Update the pos of the collider to match the pos of the rigidbody.
+            // Call this after moving the rigidbody manually.
+            void syncCollider() {
                 switch(colliderType) {
-                    case RIGID_SPHERE_COLLIDER: { ((Sphere*) collider)->c = pos;              break; }
-                    case RIGID_AABB_COLLIDER:   { ((AABB*) collider)->pos = pos;              break; }
-                    case RIGID_CUBE_COLLIDER:   { ((Cube*) collider)->pos = pos;              break; }
-                    case RIGID_TRI_PY_COLLIDER: { ((TriangularPyramid*) collider)->pos = pos; break; }
+                    case RIGID_SPHERE_COLLIDER:   { ((Sphere*) collider)->c = pos;              break; }
+                    case RIGID_AABB_COLLIDER:     { ((AABB*) collider)->pos = pos;              break; }
+                    case RIGID_CUBE_COLLIDER:     { ((Cube*) collider)->pos = pos;              break; }
+                    case RIGID_TRI_PY_COLLIDER:   { ((TriangularPyramid*) collider)->pos = pos; break; }
+                    case RIGID_CAPSULE_COLLIDER:  { ((Capsule*) collider)->pos = pos;           break; }
+                    case RIGID_COMPOUND_COLLIDER: { ((Compound*) collider)->setPos(pos);        break; }
+                    default:                      {                                             break; }
+                }
+            };
+
+            // Update the rotation of the collider to match the orientation of the rigidbody.
+            // Call this after changing the orientation manually.
+            void syncRotation() {
+                switch(colliderType) {
+                    case RIGID_CUBE_COLLIDER:    { ((Cube*) collider)->rot = orientation.toMat3D();              break; }
+                    case RIGID_TRI_PY_COLLIDER:  { ((TriangularPyramid*) collider)->rot = orientation.toMat3D(); break; }
+
+                    case RIGID_CAPSULE_COLLIDER: {
+                        Capsule* capsule = (Capsule*) collider;
+                        capsule->setHalfSegment(orientation.rotate(ZMath::Vec3D(0.0f, 0.0f, capsuleHalfLength)));
+                        break;
+                    }
+
+                    default:                     {                                                                break; }
                 }
             };
     };
@@ -224,54 +1019,50 @@ namespace Zeta {
             StaticBody3D(ZMath::Vec3D const &pos, StaticBodyCollider colliderType, void* collider)
                     : pos(pos), colliderType(colliderType), collider(collider) {};
 
+            /**
+             * @brief Create a 3D staticbody which stores its collider inline rather than pointing to a separately allocated one.
+             *
+             * @param pos The centerpoint of the staticbody.
+             * @param shape The collider, which is copied into the staticbody. This must be a Plane, Sphere, AABB, Cube, or Capsule.
+             */
+            template <typename Shape>
+            StaticBody3D(ZMath::Vec3D const &pos, Shape const &shape) : pos(pos), colliderType(ColliderTypeOf<Shape>::stat) {
+                static_assert(ColliderTypeOf<Shape>::stat != STATIC_NONE, "This shape cannot be stored inline in a staticbody.");
+                collider = copyCollider(colliderType, &shape, colliderStorage);
+            };
+
 
             // * ===================
             // * Rule of 5 Stuff
             // * ===================
 
+            // ? Copies store their collider inline if it can be stored inline, no matter how the original stores it.
+
             // Create a 3D staticbody from another staticbody.
             StaticBody3D(StaticBody3D const &sb) {
                 pos = sb.pos;
                 colliderType = sb.colliderType;
-
-                switch(colliderType) {
-                    case STATIC_PLANE_COLLIDER:  { collider = new Plane(*((Plane*) sb.collider));   break; }
-                    case STATIC_SPHERE_COLLIDER: { collider = new Sphere(*((Sphere*) sb.collider)); break; }
-                    case STATIC_AABB_COLLIDER:   { collider = new AABB(*((AABB*) sb.collider));     break; }
-                    case STATIC_CUBE_COLLIDER:   { collider = new Cube(*((Cube*) sb.collider));     break; }
-                    case STATIC_NONE:            { collider = nullptr;                              break; }
-                }
+                filter = sb.filter;
+                collider = copyCollider(colliderType, sb.collider, colliderStorage);
             };
 
             // Create a 3D staticbody from another staticbody.
             StaticBody3D(StaticBody3D &&sb) {
                 pos = std::move(sb.pos);
                 colliderType = sb.colliderType;
-                collider = sb.collider;
+                filter = sb.filter;
+                collider = sb.collider == &sb.colliderStorage ? copyCollider(colliderType, sb.collider, colliderStorage) : sb.collider;
                 sb.collider = nullptr;
             };
 
             StaticBody3D& operator = (StaticBody3D const &sb) {
                 if (this != &sb) {
-                    if (collider) {
-                        switch(colliderType) {
-                            case STATIC_PLANE_COLLIDER:  { delete (Plane*) collider;  break; }
-                            case STATIC_SPHERE_COLLIDER: { delete (Sphere*) collider; break; }
-                            case STATIC_AABB_COLLIDER:   { delete (AABB*) collider;   break; }
-                            case STATIC_CUBE_COLLIDER:   { delete (Cube*) collider;   break; }
-                        }
-                    }
+                    deleteCollider(colliderType, collider, colliderStorage);
 
                     pos = sb.pos;
                     colliderType = sb.colliderType;
-
-                    switch(colliderType) {
-                        case STATIC_PLANE_COLLIDER:  { collider = new Plane(*((Plane*) sb.collider));   break; }
-                        case STATIC_SPHERE_COLLIDER: { collider = new Sphere(*((Sphere*) sb.collider)); break; }
-                        case STATIC_AABB_COLLIDER:   { collider = new AABB(*((AABB*) sb.collider));     break; }
-                        case STATIC_CUBE_COLLIDER:   { collider = new Cube(*((Cube*) sb.collider));     break; }
-                        case STATIC_NONE:            { collider = nullptr;                              break; }
-                    }
+                    filter = sb.filter;
+                    collider = copyCollider(colliderType, sb.collider, colliderStorage);
                 }
 
                 return *this;
@@ -279,23 +1070,19 @@ namespace Zeta {
 
             StaticBody3D& operator = (StaticBody3D &&sb) {
                 if (this != &sb) {
+                    deleteCollider(colliderType, collider, colliderStorage);
+
                     pos = std::move(sb.pos);
                     colliderType = sb.colliderType;
-                    collider = sb.collider;
+                    filter = sb.filter;
+                    collider = sb.collider == &sb.colliderStorage ? copyCollider(colliderType, sb.collider, colliderStorage) : sb.collider;
                     sb.collider = nullptr;
                 }
 
                 return *this;
             };
 
-            ~StaticBody3D() {
-                switch(colliderType) {
-                    case STATIC_PLANE_COLLIDER:  { delete (Plane*) collider;  break; }
-                    case STATIC_SPHERE_COLLIDER: { delete (Sphere*) collider; break; }
-                    case STATIC_AABB_COLLIDER:   { delete (AABB*) collider;   break; }
-                    case STATIC_CUBE_COLLIDER:   { delete (Cube*) collider;   break; }
-                }
-            };
+            ~StaticBody3D() { deleteCollider(colliderType, collider, colliderStorage); };
 
 
             // * ========================
@@ -309,7 +1096,13 @@ namespace Zeta {
             // * Handle and store the collider.
 
             StaticBodyCollider colliderType;
-            void* collider;
+            void* collider; // points to colliderStorage when the collider is stored inline
+
+            // Which bodies this staticbody can collide with.
+            CollisionFilter filter;
+
+            // Holds the collider when the staticbody was made from a shape or copied, so it does not need to be allocated.
+            ColliderStorage colliderStorage;
     };
 
     class KinematicBody3D {
@@ -327,14 +1120,33 @@ namespace Zeta {
                 *                   cause undefined behavior to occur. If you specify KINEMATIC_NONE, this should be set to nullptr. 
                 */
             KinematicBody3D(ZMath::Vec3D const &pos, float mass, float cor, float linearDamping, KinematicBodyCollider colliderType, void* collider) 
-                    : pos(pos), mass(mass), invMass(1.0f/mass), cor(cor), linearDamping(linearDamping),
+                    : mass(mass), invMass(1.0f/mass), cor(cor), linearDamping(linearDamping), pos(pos),
                         colliderType(colliderType), collider(collider) {};
 
+            /**
+                * @brief Create a 3D KinematicBody which stores its collider inline rather than pointing to a separately allocated one.
+                * 
+                * @param pos Centerpoint of the kinematicbody.
+                * @param mass Mass of the kinematicbody.
+                * @param linearDamping The linear damping of the kinematicbody. This should fall on (0, 1].
+                * @param shape The collider, which is copied into the kinematicbody. This must be a Plane, Sphere, AABB, Cube, or TriangularPyramid.
+                */
+            template <typename Shape>
+            KinematicBody3D(ZMath::Vec3D const &pos, float mass, float cor, float linearDamping, Shape const &shape)
+                    : mass(mass), invMass(1.0f/mass), cor(cor), linearDamping(linearDamping), pos(pos),
+                        colliderType(ColliderTypeOf<Shape>::kinematic) {
+
+                static_assert(ColliderTypeOf<Shape>::kinematic != KINEMATIC_NONE, "This shape cannot be stored inline in a kinematicbody.");
+                collider = copyCollider(colliderType, &shape, colliderStorage);
+            };
+
 
             // * ===================
             // * Rule of 5 Stuff
             // * ===================
 
+            // ? Copies store their collider inline if it can be stored inline, no matter how the original stores it.
+
             KinematicBody3D(KinematicBody3D const &kb) {
                 pos = kb.pos;
                 colliderType = kb.colliderType;
@@ -342,20 +1154,13 @@ namespace Zeta {
                 invMass = kb.invMass;
                 cor = kb.cor;
                 linearDamping = kb.linearDamping;
-
-                switch(colliderType) {
-                    case KINEMATIC_SPHERE_COLLIDER: { collider = new Sphere(*(Sphere*) kb.collider);                        break; }
-                    case KINEMATIC_AABB_COLLIDER:   { collider = new AABB(*(AABB*) kb.collider);                            break; }
-                    case KINEMATIC_CUBE_COLLIDER:   { collider = new Cube(*(Cube*) kb.collider);                            break; }
-                    case KINEMATIC_TRI_PY_COLLIDER: { collider = new TriangularPyramid(*(TriangularPyramid*) kb.collider);  break; }
-                    case KINEMATIC_NONE:            { collider = nullptr;                                                   break; }
-                }
+                collider = copyCollider(colliderType, kb.collider, colliderStorage);
             };
 
             KinematicBody3D(KinematicBody3D &&kb) {
                 pos = std::move(kb.pos);
                 colliderType = kb.colliderType;
-                collider = kb.collider;
+                collider = kb.collider == &kb.colliderStorage ? copyCollider(colliderType, kb.collider, colliderStorage) : kb.collider;
 
                 mass = kb.mass;
                 invMass = kb.invMass;
@@ -367,14 +1172,7 @@ namespace Zeta {
 
             KinematicBody3D& operator = (KinematicBody3D const &kb) {
                 if (this != &kb) {
-                    if (collider) {
-                        switch(colliderType) {
-                            case KINEMATIC_SPHERE_COLLIDER: { delete (Sphere*) collider;            break; }
-                            case KINEMATIC_AABB_COLLIDER:   { delete (AABB*) collider;              break; }
-                            case KINEMATIC_CUBE_COLLIDER:   { delete (Cube*) collider;              break; }
-                            case KINEMATIC_TRI_PY_COLLIDER: { delete (TriangularPyramid*) collider; break; }
-                        }
-                    }
+                    deleteCollider(colliderType, collider, colliderStorage);
 
                     pos = kb.pos;
                     colliderType = kb.colliderType;
@@ -382,14 +1180,7 @@ namespace Zeta {
                     invMass = kb.invMass;
                     cor = kb.cor;
                     linearDamping = kb.linearDamping;
-
-                    switch(colliderType) {
-                        case KINEMATIC_SPHERE_COLLIDER:   { collider = new Sphere(*(Sphere*) kb.collider);                       break; }
-                        case KINEMATIC_AABB_COLLIDER:     { collider = new AABB(*(AABB*) kb.collider);                           break; }
-                        case KINEMATIC_CUBE_COLLIDER:     { collider = new Cube(*(Cube*) kb.collider);                           break; }
-                        case KINEMATIC_TRI_PY_COLLIDER:   { collider = new TriangularPyramid(*(TriangularPyramid*) kb.collider); break; }
-                        case KINEMATIC_NONE:              { collider = nullptr;                                                  break; }
-                    }
+                    collider = copyCollider(colliderType, kb.collider, colliderStorage);
 
                     // zero the velocity and net force
                     vel.zero();
@@ -401,9 +1192,11 @@ namespace Zeta {
 
             KinematicBody3D& operator = (KinematicBody3D &&kb) {
                 if (this != &kb) {
+                    deleteCollider(colliderType, collider, colliderStorage);
+
                     pos = std::move(kb.pos);
                     colliderType = kb.colliderType;
-                    collider = kb.collider;
+                    collider = kb.collider == &kb.colliderStorage ? copyCollider(colliderType, kb.collider, colliderStorage) : kb.collider;
                     kb.collider = nullptr;
 
                     mass = kb.mass;
@@ -419,14 +1212,7 @@ namespace Zeta {
                 return *this;
             };
 
-            ~KinematicBody3D() {
-                switch(colliderType) {
-                    case KINEMATIC_SPHERE_COLLIDER:   { delete (Sphere*) collider;            break; }
-                    case KINEMATIC_AABB_COLLIDER:     { delete (AABB*) collider;              break; }
-                    case KINEMATIC_CUBE_COLLIDER:     { delete (Cube*) collider;              break; }
-                    case KINEMATIC_TRI_PY_COLLIDER:   { delete (TriangularPyramid*) collider; break; }
-                }
-            };
+            ~KinematicBody3D() { deleteCollider(colliderType, collider, colliderStorage); };
 
 
             // * ========================
@@ -455,7 +1241,10 @@ namespace Zeta {
             // * Handle and store the collider.
 
             KinematicBodyCollider colliderType;
-            void* collider;
+            void* collider; // points to colliderStorage when the collider is stored inline
+
+            // Holds the collider when the kinematicbody was made from a shape or copied, so it does not need to be allocated.
+            ColliderStorage colliderStorage;
 
             void update(ZMath::Vec3D const &g, float dt) {
                 // ? This assumes that g (gravity) is already negative.
@@ -472,6 +1261,7 @@ namespace Zeta {
                     case KINEMATIC_AABB_COLLIDER:   { ((AABB*) collider)->pos = pos;              break; }
                     case KINEMATIC_CUBE_COLLIDER:   { ((Cube*) collider)->pos = pos;              break; }
                     case KINEMATIC_TRI_PY_COLLIDER: { ((TriangularPyramid*) collider)->pos = pos; break; }
+                    default:                        {                                             break; }
                 }
             };
     };
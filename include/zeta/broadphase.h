@@ -0,0 +1,553 @@
+#pragma once
+
+#include <algorithm>
+#include "collisions.h"
+
+#if defined(__SSE__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+
+// Max number of items stored in a leaf of a BVH.
+#define BVH_LEAF_SIZE 4
+
+// Max size of the stack used when traversing a BVH.
+// BVHs are built by splitting at the median so they are balanced and this is far more than enough.
+#define BVH_STACK_SIZE 64
+
+namespace Zeta {
+    // * ====================================================
+    // * Bounding Volume Hierarchy
+    // * ====================================================
+
+    // AABB tree over a set of items identified by their index.
+    // The tree is rebuilt from scratch rather than updated as building it is cheap and keeps it balanced.
+    // Memory is only allocated when the number of items grows past what has been seen before.
+    class BVH {
+        public:
+            // Node of the tree.
+            // Branches store the index of their left child in first and the right child is always first + 1.
+            // Leaves store the index of their first item in first.
+            struct Node {
+                ZMath::Vec3D min, max;
+                int first;
+                int count; // number of items in a leaf. 0 if this is a branch.
+            };
+
+        private:
+            Node* nodes = nullptr;
+            int numNodes = 0;
+
+            int* items = nullptr; // item indices referenced by the leaves
+
+            // Set while the nodes and items belong to someone else, such as a mapped scene file. They are never written to.
+            bool borrowed = 0;
+
+            // scratch space for building
+            ZMath::Vec3D* mins = nullptr;
+            ZMath::Vec3D* maxes = nullptr;
+            ZMath::Vec3D* centers = nullptr;
+
+            int capacity = 0;
+
+            // Recursively build a node over the range [begin, end) of items.
+            void build(int n, int begin, int end) {
+                Node &node = nodes[n];
+
+                node.min = mins[items[begin]];
+                node.max = maxes[items[begin]];
+
+                for (int i = begin + 1; i < end; ++i) {
+                    ZMath::Vec3D const &lo = mins[items[i]], &hi = maxes[items[i]];
+                    node.min.set(ZMath::min(node.min.x, lo.x), ZMath::min(node.min.y, lo.y), ZMath::min(node.min.z, lo.z));
+                    node.max.set(ZMath::max(node.max.x, hi.x), ZMath::max(node.max.y, hi.y), ZMath::max(node.max.z, hi.z));
+                }
+
+                if (end - begin <= BVH_LEAF_SIZE) {
+                    node.first = begin;
+                    node.count = end - begin;
+                    return;
+                }
+
+                // split at the median of the longest axis
+                ZMath::Vec3D size = node.max - node.min;
+                int mid = (begin + end)/2;
+
+                if (size.x >= size.y && size.x >= size.z) {
+                    std::nth_element(items + begin, items + mid, items + end, [this](int a, int b) { return centers[a].x < centers[b].x; });
+                } else if (size.y >= size.z) {
+                    std::nth_element(items + begin, items + mid, items + end, [this](int a, int b) { return centers[a].y < centers[b].y; });
+                } else {
+                    std::nth_element(items + begin, items + mid, items + end, [this](int a, int b) { return centers[a].z < centers[b].z; });
+                }
+
+                int left = numNodes;
+                numNodes += 2;
+
+                node.first = left;
+                node.count = 0;
+
+                build(left, begin, mid);
+                build(left + 1, mid, end);
+            };
+
+            // Find where a ray enters a node. Returns 0 if it misses or enters further than maxDist.
+            static inline bool rayEnters(Node const &node, ZMath::Vec3D const &origin, ZMath::Vec3D const &invDir, float maxDist, float &t) {
+                float t1 = (node.min.x - origin.x)*invDir.x;
+                float t2 = (node.max.x - origin.x)*invDir.x;
+                float t3 = (node.min.y - origin.y)*invDir.y;
+                float t4 = (node.max.y - origin.y)*invDir.y;
+                float t5 = (node.min.z - origin.z)*invDir.z;
+                float t6 = (node.max.z - origin.z)*invDir.z;
+
+                float tMin = ZMath::max(ZMath::max(ZMath::min(t1, t2), ZMath::min(t3, t4)), ZMath::min(t5, t6));
+                float tMax = ZMath::min(ZMath::min(ZMath::max(t1, t2), ZMath::max(t3, t4)), ZMath::max(t5, t6));
+
+                t = ZMath::max(tMin, 0.0f);
+                return tMax >= t && t <= maxDist;
+            };
+
+            // Find the lanes of a packet which enter a node within their max distance.
+            // ? This uses SSE for 4-wide packets and AVX for 8-wide packets when available.
+            static inline int packetEnters(Node const &node, RayPacket const &packet, float const* maxDist, int mask, float* t) {
+#if RAY_PACKET_SIZE == 4 && (defined(__SSE__) || defined(_M_X64))
+                __m128 t1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.min.x), _mm_load_ps(packet.ox)), _mm_load_ps(packet.ix));
+                __m128 t2 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.max.x), _mm_load_ps(packet.ox)), _mm_load_ps(packet.ix));
+                __m128 t3 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.min.y), _mm_load_ps(packet.oy)), _mm_load_ps(packet.iy));
+                __m128 t4 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.max.y), _mm_load_ps(packet.oy)), _mm_load_ps(packet.iy));
+                __m128 t5 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.min.z), _mm_load_ps(packet.oz)), _mm_load_ps(packet.iz));
+                __m128 t6 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.max.z), _mm_load_ps(packet.oz)), _mm_load_ps(packet.iz));
+
+                __m128 tMin = _mm_max_ps(_mm_max_ps(_mm_min_ps(t1, t2), _mm_min_ps(t3, t4)), _mm_min_ps(t5, t6));
+                __m128 tMax = _mm_min_ps(_mm_min_ps(_mm_max_ps(t1, t2), _mm_max_ps(t3, t4)), _mm_max_ps(t5, t6));
+
+                tMin = _mm_max_ps(tMin, _mm_setzero_ps());
+                _mm_storeu_ps(t, tMin);
+
+                return _mm_movemask_ps(_mm_and_ps(_mm_cmpge_ps(tMax, tMin), _mm_cmple_ps(tMin, _mm_loadu_ps(maxDist)))) & mask;
+
+#elif RAY_PACKET_SIZE == 8 && defined(__AVX__)
+                __m256 t1 = _mm256_mul_ps(_mm256_sub_ps(_mm256_set1_ps(node.min.x), _mm256_load_ps(packet.ox)), _mm256_load_ps(packet.ix));
+                __m256 t2 = _mm256_mul_ps(_mm256_sub_ps(_mm256_set1_ps(node.max.x), _mm256_load_ps(packet.ox)), _mm256_load_ps(packet.ix));
+                __m256 t3 = _mm256_mul_ps(_mm256_sub_ps(_mm256_set1_ps(node.min.y), _mm256_load_ps(packet.oy)), _mm256_load_ps(packet.iy));
+                __m256 t4 = _mm256_mul_ps(_mm256_sub_ps(_mm256_set1_ps(node.max.y), _mm256_load_ps(packet.oy)), _mm256_load_ps(packet.iy));
+                __m256 t5 = _mm256_mul_ps(_mm256_sub_ps(_mm256_set1_ps(node.min.z), _mm256_load_ps(packet.oz)), _mm256_load_ps(packet.iz));
+                __m256 t6 = _mm256_mul_ps(_mm256_sub_ps(_mm256_set1_ps(node.max.z), _mm256_load_ps(packet.oz)), _mm256_load_ps(packet.iz));
+
+                __m256 tMin = _mm256_max_ps(_mm256_max_ps(_mm256_min_ps(t1, t2), _mm256_min_ps(t3, t4)), _mm256_min_ps(t5, t6));
+                __m256 tMax = _mm256_min_ps(_mm256_min_ps(_mm256_max_ps(t1, t2), _mm256_max_ps(t3, t4)), _mm256_max_ps(t5, t6));
+
+                tMin = _mm256_max_ps(tMin, _mm256_setzero_ps());
+                _mm256_storeu_ps(t, tMin);
+
+                __m256 hit = _mm256_and_ps(_mm256_cmp_ps(tMax, tMin, _CMP_GE_OQ), _mm256_cmp_ps(tMin, _mm256_loadu_ps(maxDist), _CMP_LE_OQ));
+                return _mm256_movemask_ps(hit) & mask;
+
+#else
+                int hits = 0;
+
+                for (int i = 0; i < RAY_PACKET_SIZE; ++i) {
+                    float t1 = (node.min.x - packet.ox[i])*packet.ix[i];
+                    float t2 = (node.max.x - packet.ox[i])*packet.ix[i];
+                    float t3 = (node.min.y - packet.oy[i])*packet.iy[i];
+                    float t4 = (node.max.y - packet.oy[i])*packet.iy[i];
+                    float t5 = (node.min.z - packet.oz[i])*packet.iz[i];
+                    float t6 = (node.max.z - packet.oz[i])*packet.iz[i];
+
+                    float tMin = ZMath::max(ZMath::max(ZMath::min(t1, t2), ZMath::min(t3, t4)), ZMath::min(t5, t6));
+                    float tMax = ZMath::min(ZMath::min(ZMath::max(t1, t2), ZMath::max(t3, t4)), ZMath::max(t5, t6));
+
+                    t[i] = ZMath::max(tMin, 0.0f);
+                    hits |= (tMax >= t[i] && t[i] <= maxDist[i]) << i;
+                }
+
+                return hits & mask;
+#endif
+            };
+
+            // Traverse the subtree under a node with a single ray, nearest first.
+            template <typename Visitor>
+            void traverse(int root, ZMath::Vec3D const &origin, ZMath::Vec3D const &invDir, float maxDist, Visitor &&visit) const {
+                int stack[BVH_STACK_SIZE];
+                float entry[BVH_STACK_SIZE];
+                int top = 0;
+                float t;
+
+                if (!rayEnters(nodes[root], origin, invDir, maxDist, t)) { return; }
+
+                stack[top] = root;
+                entry[top++] = t;
+
+                while (top) {
+                    --top;
+
+                    // the closest hit may have moved since this node was pushed
+                    if (entry[top] > maxDist) { continue; }
+
+                    Node const &node = nodes[stack[top]];
+
+                    if (node.count) {
+                        for (int i = node.first; i < node.first + node.count; ++i) {
+                            maxDist = visit(items[i], maxDist);
+                            if (maxDist < 0.0f) { return; }
+                        }
+
+                        continue;
+                    }
+
+                    float tLeft, tRight;
+                    bool left = rayEnters(nodes[node.first], origin, invDir, maxDist, tLeft);
+                    bool right = rayEnters(nodes[node.first + 1], origin, invDir, maxDist, tRight);
+
+                    // push the further child first so the nearer one is visited first
+                    if (left && right) {
+                        bool leftFirst = tLeft <= tRight;
+
+                        stack[top] = leftFirst ? node.first + 1 : node.first;
+                        entry[top++] = leftFirst ? tRight : tLeft;
+                        stack[top] = leftFirst ? node.first : node.first + 1;
+                        entry[top++] = leftFirst ? tLeft : tRight;
+
+                    } else if (left) {
+                        stack[top] = node.first;
+                        entry[top++] = tLeft;
+
+                    } else if (right) {
+                        stack[top] = node.first + 1;
+                        entry[top++] = tRight;
+                    }
+                }
+            };
+
+        public:
+            int numItems = 0;
+
+            BVH() {};
+
+            // Number of nodes in the tree.
+            inline int getNumNodes() const { return numNodes; };
+
+            // The nodes of the tree, with the root first.
+            inline Node const* getNodes() const { return nodes; };
+
+            // The item indices referenced by the leaves.
+            inline int const* getItems() const { return items; };
+
+            // Bytes held by the tree.
+            inline size_t getMemoryUsage() const {
+                if (borrowed) { return numItems * 2*sizeof(ZMath::Vec3D); }
+                return capacity * (2*sizeof(Node) + sizeof(int) + 3*sizeof(ZMath::Vec3D));
+            };
+
+            // The tree is only used as a cache so copying it is not allowed.
+            BVH(BVH const &bvh) = delete;
+            BVH& operator = (BVH const &bvh) = delete;
+
+            ~BVH() {
+                if (!borrowed) {
+                    delete[] nodes;
+                    delete[] items;
+                }
+
+                delete[] mins;
+                delete[] maxes;
+                delete[] centers;
+            };
+
+            /**
+             * @brief Build the tree.
+             *
+             * @param n The number of items.
+             * @param getItemBounds Callable with the signature void(int item, ZMath::Vec3D &min, ZMath::Vec3D &max) setting the bounds of an item.
+             */
+            template <typename BoundsFn>
+            void build(int n, BoundsFn getItemBounds) {
+                if (borrowed) {
+                    nodes = nullptr;
+                    items = nullptr;
+                    borrowed = 0;
+                }
+
+                if (n > capacity) {
+                    delete[] nodes;
+                    delete[] items;
+                    delete[] mins;
+                    delete[] maxes;
+                    delete[] centers;
+
+                    capacity = n;
+                    nodes = new Node[2*n];
+                    items = new int[n];
+                    mins = new ZMath::Vec3D[n];
+                    maxes = new ZMath::Vec3D[n];
+                    centers = new ZMath::Vec3D[n];
+                }
+
+                numItems = n;
+                numNodes = 0;
+
+                if (!n) { return; }
+
+                for (int i = 0; i < n; ++i) {
+                    getItemBounds(i, mins[i], maxes[i]);
+                    centers[i] = (mins[i] + maxes[i]) * 0.5f;
+                    items[i] = i;
+                }
+
+                numNodes = 1;
+                build(0, 0, n);
+            };
+
+            /**
+             * @brief Use a tree built ahead of time, such as one stored in a scene file, without copying it.
+             *        The tree is used until the next call to build.
+             *
+             * @param nodes The nodes, with the root first. These must stay alive and unchanged while they are used.
+             * @param numNodes Number of nodes.
+             * @param items The item indices referenced by the leaves. These must stay alive and unchanged while they are used.
+             * @param n Number of items.
+             * @param getItemBounds Callable with the signature void(int item, ZMath::Vec3D &min, ZMath::Vec3D &max) setting the bounds of an item.
+             *                       These must match the bounds the tree was built from.
+             */
+            template <typename BoundsFn>
+            void borrow(Node const* nodes, int numNodes, int const* items, int n, BoundsFn getItemBounds) {
+                // ? The memory owned by the tree is freed as a borrowed tree is usually large and long lived.
+                if (!borrowed) {
+                    delete[] this->nodes;
+                    delete[] this->items;
+                }
+
+                delete[] mins;
+                delete[] maxes;
+                delete[] centers;
+
+                // ? The nodes only hold the bounds of each leaf, so the bounds of the items are still needed by query and nearest.
+                mins = new ZMath::Vec3D[n];
+                maxes = new ZMath::Vec3D[n];
+                centers = nullptr;
+                capacity = 0;
+
+                for (int i = 0; i < n; ++i) { getItemBounds(i, mins[i], maxes[i]); }
+
+                // ? The nodes are never written to while borrowed, so casting away const is safe.
+                this->nodes = (Node*) nodes;
+                this->items = (int*) items;
+                this->numNodes = numNodes;
+                numItems = n;
+                borrowed = 1;
+            };
+
+            /**
+             * @brief Visit the items whose bounds a ray passes through, nearest first.
+             *
+             * @param ray The ray.
+             * @param maxDist Only visit items whose bounds the ray enters within this distance.
+             * @param visit Callable with the signature float(int item, float maxDist). This should return the new max distance,
+             *               usually the distance to the closest hit so far, allowing anything further to be skipped.
+             *               Return a negative value to stop the traversal.
+             */
+            template <typename Visitor>
+            void raycast(Ray3D const &ray, float maxDist, Visitor &&visit) const {
+                if (!numNodes) { return; }
+
+                ZMath::Vec3D invDir(1.0f/ray.dir.x, 1.0f/ray.dir.y, 1.0f/ray.dir.z);
+                traverse(0, ray.origin, invDir, maxDist, visit);
+            };
+
+            /**
+             * @brief Visit the items whose bounds the rays in a packet pass through, roughly nearest first.
+             * ? Each node is tested against every active lane at once. Once only a single lane remains active in a subtree,
+             * ?  that lane continues on its own as the packet has diverged.
+             *
+             * @param packet The rays.
+             * @param maxDist Array with the max distance for each lane. Only visit items whose bounds a lane enters within its max distance.
+             *                 The visitor should lower these as it finds closer hits.
+             * @param visit Callable with the signature void(int item, int mask) where mask has a bit set for each lane to test.
+             */
+            template <typename Visitor>
+            void raycast(RayPacket const &packet, float const* maxDist, Visitor &&visit) const {
+                if (!numNodes) { return; }
+
+                int stack[BVH_STACK_SIZE];
+                int masks[BVH_STACK_SIZE];
+                alignas(4*RAY_PACKET_SIZE) float entry[BVH_STACK_SIZE][RAY_PACKET_SIZE];
+                alignas(4*RAY_PACKET_SIZE) float tLeft[RAY_PACKET_SIZE], tRight[RAY_PACKET_SIZE];
+                int top = 0;
+
+                masks[top] = packetEnters(nodes[0], packet, maxDist, packet.getMask(), entry[top]);
+                stack[top++] = 0;
+
+                while (top) {
+                    --top;
+
+                    // drop the lanes whose closest hit moved in front of this node since it was pushed
+                    int mask = masks[top];
+                    for (int i = 0; i < RAY_PACKET_SIZE; ++i) { mask &= ~((entry[top][i] > maxDist[i]) << i); }
+
+                    if (!mask) { continue; }
+
+                    int n = stack[top];
+                    Node const &node = nodes[n];
+
+                    // a single lane left means the packet diverged so continue with that ray alone
+                    if (!(mask & (mask - 1))) {
+                        int lane = 0;
+                        while (!(mask & (1 << lane))) { ++lane; }
+
+                        ZMath::Vec3D origin(packet.ox[lane], packet.oy[lane], packet.oz[lane]);
+                        ZMath::Vec3D invDir(packet.ix[lane], packet.iy[lane], packet.iz[lane]);
+
+                        traverse(n, origin, invDir, maxDist[lane], [&](int item, float) {
+                            visit(item, mask);
+                            return maxDist[lane];
+                        });
+
+                        continue;
+                    }
+
+                    if (node.count) {
+                        for (int i = node.first; i < node.first + node.count; ++i) { visit(items[i], mask); }
+                        continue;
+                    }
+
+                    int left = packetEnters(nodes[node.first], packet, maxDist, mask, tLeft);
+                    int right = packetEnters(nodes[node.first + 1], packet, maxDist, mask, tRight);
+
+                    if (!(left | right)) { continue; }
+
+                    // push the child further for the first active lane first so the nearer one is visited first
+                    int lane = 0;
+                    while (!((left | right) & (1 << lane))) { ++lane; }
+
+                    bool leftFirst = !right || (left && tLeft[lane] <= tRight[lane]);
+                    int first = leftFirst ? node.first : node.first + 1;
+                    int firstMask = leftFirst ? left : right, secondMask = leftFirst ? right : left;
+                    float const* firstEntry = leftFirst ? tLeft : tRight;
+                    float const* secondEntry = leftFirst ? tRight : tLeft;
+
+                    if (secondMask) {
+                        for (int i = 0; i < RAY_PACKET_SIZE; ++i) { entry[top][i] = secondEntry[i]; }
+                        masks[top] = secondMask;
+                        stack[top++] = leftFirst ? node.first + 1 : node.first;
+                    }
+
+                    if (firstMask) {
+                        for (int i = 0; i < RAY_PACKET_SIZE; ++i) { entry[top][i] = firstEntry[i]; }
+                        masks[top] = firstMask;
+                        stack[top++] = first;
+                    }
+                }
+            };
+
+            /**
+             * @brief Visit the items whose bounds pass a test, such as overlapping a query volume.
+             *
+             * @param test Callable with the signature bool(ZMath::Vec3D const &min, ZMath::Vec3D const &max) determining if bounds
+             *              should be visited. This is used on the bounds of the nodes as well as the items, so it must also
+             *              pass the bounds of any node containing bounds which pass.
+             * @param visit Callable with the signature bool(int item). Return 0 to stop the query.
+             * @return (bool) 0 if the query was stopped by the visitor and 1 otherwise.
+             */
+            template <typename Test, typename Visitor>
+            bool query(Test &&test, Visitor &&visit) const {
+                if (!numNodes) { return 1; }
+
+                int stack[BVH_STACK_SIZE];
+                int top = 0;
+
+                stack[top++] = 0;
+
+                while (top) {
+                    Node const &node = nodes[stack[--top]];
+                    if (!test(node.min, node.max)) { continue; }
+
+                    if (node.count) {
+                        for (int i = node.first; i < node.first + node.count; ++i) {
+                            if (test(mins[items[i]], maxes[items[i]]) && !visit(items[i])) { return 0; }
+                        }
+
+                        continue;
+                    }
+
+                    stack[top++] = node.first;
+                    stack[top++] = node.first + 1;
+                }
+
+                return 1;
+            };
+
+            /**
+             * @brief Visit the items whose bounds overlap an AABB.
+             *
+             * @param min The min vertex of the AABB.
+             * @param max The max vertex of the AABB.
+             * @param visit Callable with the signature bool(int item). Return 0 to stop the query.
+             * @return (bool) 0 if the query was stopped by the visitor and 1 otherwise.
+             */
+            template <typename Visitor>
+            bool query(ZMath::Vec3D const &min, ZMath::Vec3D const &max, Visitor &&visit) const {
+                return query([&min, &max](ZMath::Vec3D const &lo, ZMath::Vec3D const &hi) {
+                    return lo.x <= max.x && hi.x >= min.x && lo.y <= max.y && hi.y >= min.y && lo.z <= max.z && hi.z >= min.z;
+                }, visit);
+            };
+
+            /**
+             * @brief Visit the items whose bounds are near a point, roughly nearest first.
+             *
+             * @param point The point.
+             * @param maxDist Only visit items whose bounds are within this distance of the point.
+             * @param visit Callable with the signature float(int item, float distSq, float maxDist) where distSq is the squared distance
+             *               from the point to the bounds of the item. This should return the new max distance, allowing anything
+             *               further to be skipped. Return a negative value to stop the traversal.
+             */
+            template <typename Visitor>
+            void nearest(ZMath::Vec3D const &point, float maxDist, Visitor &&visit) const {
+                if (!numNodes) { return; }
+
+                int stack[BVH_STACK_SIZE];
+                float distSq[BVH_STACK_SIZE];
+                int top = 0;
+                float maxDistSq = maxDist*maxDist;
+
+                stack[top] = 0;
+                distSq[top++] = point.distSq(ZMath::clamp(point, nodes[0].min, nodes[0].max));
+
+                while (top) {
+                    --top;
+                    if (distSq[top] > maxDistSq) { continue; }
+
+                    Node const &node = nodes[stack[top]];
+
+                    if (node.count) {
+                        for (int i = node.first; i < node.first + node.count; ++i) {
+                            float d = point.distSq(ZMath::clamp(point, mins[items[i]], maxes[items[i]]));
+                            if (d > maxDistSq) { continue; }
+
+                            maxDist = visit(items[i], d, maxDist);
+                            if (maxDist < 0.0f) { return; }
+
+                            maxDistSq = maxDist*maxDist;
+                        }
+
+                        continue;
+                    }
+
+                    float dLeft = point.distSq(ZMath::clamp(point, nodes[node.first].min, nodes[node.first].max));
+                    float dRight = point.distSq(ZMath::clamp(point, nodes[node.first + 1].min, nodes[node.first + 1].max));
+
+                    // push the further child first so the nearer one is visited first
+                    bool leftFirst = dLeft <= dRight;
+
+                    stack[top] = leftFirst ? node.first + 1 : node.first;
+                    distSq[top++] = leftFirst ? dRight : dLeft;
+                    stack[top] = leftFirst ? node.first : node.first + 1;
+                    distSq[top++] = leftFirst ? dLeft : dRight;
+                }
+            };
+
+            // Get the bounds of an item from when the tree was built.
+            inline void getItemBounds(int item, ZMath::Vec3D &min, ZMath::Vec3D &max) const {
+                min = mins[item];
+                max = maxes[item];
+            };
+    };
+}
@@ -38,19 +38,22 @@ namespace Zeta {
 
     // todo go through and replace direct assignment of vectors to using .set()
 
-    static CollisionManifold findCollisionFeatures(Plane const &plane, Sphere const &sphere) {
+    inline static CollisionManifold findCollisionFeatures(Plane const &plane, Sphere const &sphere) {
         CollisionManifold result;
 
         ZMath::Vec3D closest = sphere.c - plane.pos;
         ZMath::Vec2D min = plane.getLocalMin(), max = plane.getLocalMax();
 
         // rotate the center of the sphere into the plane's local coords
-        closest = plane.rot * closest + plane.pos;
+        closest = plane.rot.transpose() * closest + plane.pos;
 
         closest.x = ZMath::clamp(closest.x, min.x, max.x);
         closest.y = ZMath::clamp(closest.y, min.y, max.y);
         closest.z = plane.pos.z;
 
+        // rotate the closest point back into global coords
+        closest = plane.rot * (closest - plane.pos) + plane.pos;
+
         result.hit = closest.distSq(sphere.c) <= sphere.r*sphere.r;
 
         if (!result.hit) { return result; }
@@ -64,10 +67,10 @@ namespace Zeta {
 
         // determine the penetration distance and collision normal
 
-        ZMath::Vec3D diff = closest - sphere.c;
+        ZMath::Vec3D diff = sphere.c - closest;
         float d = diff.mag(); // allows us to only take the sqrt once
         result.pDist = sphere.r - d;
-        result.normal = diff * (1.0f/d);
+        result.normal = d ? diff * (1.0f/d) : plane.rot.c3;
 
         return result;
     };
@@ -77,68 +80,35 @@ namespace Zeta {
     // * Helper Functions for 3D Box Collision Manifolds
     // * ====================================================
 
+    // ? Planes, AABBs, and cubes are all treated as boxes. A plane is a box with no height and an AABB is a box with no rotation.
+
     /**
-     * @brief Determine the 4 vertices comprising the incident face when the incident cube is an AABB.
+     * @brief Clip a convex polygon against a plane, keeping the part where n * v <= offset.
      * 
-     * @param v Array which gets filled with the 4 vertices making up the incident face.
-     * @param h Halfsize of the incident AABB.
-     * @param pos The position of the incident AABB.
-     * @param normal The normal vector of the collision (points towards B away from A).
+     * @param vOut Array which gets filled with the clipped polygon. This should have room for nIn + 1 vertices.
+     * @param vIn Array containing the vertices of the polygon in order.
+     * @param nIn The number of vertices in vIn.
+     * @param n Normal of the clipping plane.
+     * @param offset Distance from the origin to the clipping plane along n.
+     * @return (int) The number of vertices in the clipped polygon.
      */
-    static void computeIncidentFaceAABB(ZMath::Vec3D v[4], const ZMath::Vec3D& h, const ZMath::Vec3D& pos, const ZMath::Vec3D& normal) {
-        // Take the absolute value of the normal for comparisons.
-        ZMath::Vec3D nAbs = ZMath::abs(normal);
+    inline static int clipPolygonToPlane(ZMath::Vec3D* vOut, ZMath::Vec3D const* vIn, int nIn, ZMath::Vec3D const &n, float offset) {
+        int np = 0;
 
-        // Determine the vertices in terms of halfsize.
-        // Vertex array starts in the bottom left corner when considering the face as a 2D box and goes around counterclockwise.
-        if (nAbs.x > nAbs.y && nAbs.x > nAbs.z) { // x > y && x > z
-            if (normal.x > 0.0f) { // incident cube is intersecting on its -x side
-                v[0] = ZMath::Vec3D(-h.x, -h.y, -h.z);
-                v[1] = ZMath::Vec3D(-h.x, h.y, -h.z);
-                v[2] = ZMath::Vec3D(-h.x, h.y, h.z);
-                v[3] = ZMath::Vec3D(-h.x, -h.y, h.z);
-
-            } else { // incident cube is intersecting on its +x side
-                v[0] = ZMath::Vec3D(h.x, -h.y, -h.z);
-                v[1] = ZMath::Vec3D(h.x, h.y, -h.z);
-                v[2] = ZMath::Vec3D(h.x, h.y, h.z);
-                v[3] = ZMath::Vec3D(h.x, -h.y, h.z);
-            }
+        for (int i = 0; i < nIn; ++i) {
+            ZMath::Vec3D const &v1 = vIn[i];
+            ZMath::Vec3D const &v2 = vIn[(i + 1) % nIn];
 
-        } else if (nAbs.y > nAbs.z) { // y >= x && y > z
-            if (normal.y > 0.0f) { // incident cube is intersecting on its -y side
-                v[0] = ZMath::Vec3D(-h.x, -h.y, -h.z);
-                v[1] = ZMath::Vec3D(h.x, -h.y, -h.z);
-                v[2] = ZMath::Vec3D(h.x, -h.y, h.z);
-                v[3] = ZMath::Vec3D(-h.x, -h.y, h.z);
-
-            } else { // incident cube is intersecting on its +y side
-                v[0] = ZMath::Vec3D(-h.x, h.y, -h.z);
-                v[1] = ZMath::Vec3D(h.x, h.y, -h.z);
-                v[2] = ZMath::Vec3D(h.x, h.y, h.z);
-                v[3] = ZMath::Vec3D(-h.x, h.y, h.z);
-            }
+            float d1 = n * v1 - offset;
+            float d2 = n * v2 - offset;
 
-        } else { // z >= y && z >= x
-            if (normal.z > 0.0f) { // incident cube is intersecting on its -z side
-                v[0] = ZMath::Vec3D(-h.x, -h.y, -h.z);
-                v[1] = ZMath::Vec3D(-h.x, h.y, -h.z);
-                v[2] = ZMath::Vec3D(h.x, h.y, -h.z);
-                v[3] = ZMath::Vec3D(h.x, -h.y, -h.z);
-
-            } else { // incdient cube is intersecting on its +z side
-                v[0] = ZMath::Vec3D(-h.x, -h.y, h.z);
-                v[1] = ZMath::Vec3D(-h.x, h.y, h.z);
-                v[2] = ZMath::Vec3D(h.x, h.y, h.z);
-                v[3] = ZMath::Vec3D(h.x, -h.y, h.z);
-            }
+            if (d1 <= 0.0f) { vOut[np++] = v1; }
+
+            // the edge crosses the plane
+            if (d1 * d2 < 0.0f) { vOut[np++] = v1 + (v2 - v1) * (d1/(d1 - d2)); }
         }
 
-        // translate the vertices to their proper positions
-        v[0] = pos + v[0];
-        v[1] = pos + v[1];
-        v[2] = pos + v[2];
-        v[3] = pos + v[3];
+        return np;
     };
 
     /**
@@ -148,168 +118,106 @@ namespace Zeta {
      * @param h Halfsize of the incident cube.
      * @param pos The position of the incident cube.
      * @param rot The rotation matrix of the incident cube.
-     * @param normal The normal vector of the collision.
+     * @param normal The normal of the reference face. This points towards the incident cube.
      */
-    static void computeIncidentFace(ZMath::Vec3D v[4], const ZMath::Vec3D& h, const ZMath::Vec3D& pos, 
-                                    const ZMath::Mat3D& rot, const ZMath::Vec3D& normal) {
+    inline static void computeIncidentFace(ZMath::Vec3D v[4], ZMath::Vec3D const &h, ZMath::Vec3D const &pos, 
+                                    ZMath::Mat3D const &rot, ZMath::Vec3D const &normal) {
+
+        // ? The incident face is the face of the incident cube most facing the reference face.
 
         // Rotate the normal to the incident cube's local space.
         ZMath::Vec3D n = rot.transpose() * normal;
         ZMath::Vec3D nAbs = ZMath::abs(n);
 
         // Determine the vertices in terms of halfsize.
-        // Vertex array starts in bottom left corner when considering the face as a 2D box and goes around counterclockwise.
+        // Vertices go around the face in order.
         if (nAbs.x > nAbs.y && nAbs.x > nAbs.z) { // x > y && x > z
-            if (n.x > 0.0f) { // incident cube is intersecting on its -x side
-                v[0] = ZMath::Vec3D(-h.x, -h.y, -h.z);
-                v[1] = ZMath::Vec3D(-h.x, h.y, -h.z);
-                v[2] = ZMath::Vec3D(-h.x, h.y, h.z);
-                v[3] = ZMath::Vec3D(-h.x, -h.y, h.z);
-
-            } else { // incident cube is intersecting on its +x side
-                v[0] = ZMath::Vec3D(h.x, -h.y, -h.z);
-                v[1] = ZMath::Vec3D(h.x, h.y, -h.z);
-                v[2] = ZMath::Vec3D(h.x, h.y, h.z);
-                v[3] = ZMath::Vec3D(h.x, -h.y, h.z);
-            }
+            float x = n.x > 0.0f ? -h.x : h.x;
+
+            v[0] = ZMath::Vec3D(x, -h.y, -h.z);
+            v[1] = ZMath::Vec3D(x, h.y, -h.z);
+            v[2] = ZMath::Vec3D(x, h.y, h.z);
+            v[3] = ZMath::Vec3D(x, -h.y, h.z);
 
         } else if (nAbs.y > nAbs.z) { // y >= x && y > z
-            if (n.y > 0.0f) { // incident cube is intersecting on its -y side
-                v[0] = ZMath::Vec3D(-h.x, -h.y, -h.z);
-                v[1] = ZMath::Vec3D(h.x, -h.y, -h.z);
-                v[2] = ZMath::Vec3D(h.x, -h.y, h.z);
-                v[3] = ZMath::Vec3D(-h.x, -h.y, h.z);
-
-            } else { // incident cube is intersecting on its +y side
-                v[0] = ZMath::Vec3D(-h.x, h.y, -h.z);
-                v[1] = ZMath::Vec3D(h.x, h.y, -h.z);
-                v[2] = ZMath::Vec3D(h.x, h.y, h.z);
-                v[3] = ZMath::Vec3D(-h.x, h.y, h.z);
-            }
+            float y = n.y > 0.0f ? -h.y : h.y;
+
+            v[0] = ZMath::Vec3D(-h.x, y, -h.z);
+            v[1] = ZMath::Vec3D(h.x, y, -h.z);
+            v[2] = ZMath::Vec3D(h.x, y, h.z);
+            v[3] = ZMath::Vec3D(-h.x, y, h.z);
 
         } else { // z >= y && z >= x
-            if (n.z > 0.0f) { // incident cube is intersecting on its -z side
-                v[0] = ZMath::Vec3D(-h.x, -h.y, -h.z);
-                v[1] = ZMath::Vec3D(-h.x, h.y, -h.z);
-                v[2] = ZMath::Vec3D(h.x, h.y, -h.z);
-                v[3] = ZMath::Vec3D(h.x, -h.y, -h.z);
-
-            } else { // incdient cube is intersecting on its +z side
-                v[0] = ZMath::Vec3D(-h.x, -h.y, h.z);
-                v[1] = ZMath::Vec3D(-h.x, h.y, h.z);
-                v[2] = ZMath::Vec3D(h.x, h.y, h.z);
-                v[3] = ZMath::Vec3D(h.x, -h.y, h.z);
-            }
+            float z = n.z > 0.0f ? -h.z : h.z;
+
+            v[0] = ZMath::Vec3D(-h.x, -h.y, z);
+            v[1] = ZMath::Vec3D(-h.x, h.y, z);
+            v[2] = ZMath::Vec3D(h.x, h.y, z);
+            v[3] = ZMath::Vec3D(h.x, -h.y, z);
         }
 
         // rotate vertices back into global coordinates and translate them to their proper positions
-        v[0] = pos + rot * v[0];
-        v[1] = pos + rot * v[1];
-        v[2] = pos + rot * v[2];
-        v[3] = pos + rot * v[3];
+        ZMath::transform(rot, v, v, 4, pos);
     };
 
     /**
-     * @brief Compute the clipping points given input points.
+     * @brief Find the collision features between two boxes using the separating axis theorem.
+     *        Contacts are found by clipping the incident face against the sides of the reference face.
      * 
-     * @param vOut Array which gets filled with the clipping points.
-     * @param vIn Array containing the input points.
-     * @param n1 Side normal 1.
-     * @param n2 Side normal 2.
-     * @param offset1 Distance to the side corresponding with side normal 1.
-     * @param offset2 Distance to the side corresponding with side normal 2.
-     * @return (int) The number of clipping points. If this does not return 4, there is not an intersection on this axis.
+     * @param posA Center of box A.
+     * @param rotA Rotation of box A. The columns should be A's axes in global coordinates.
+     * @param hA Halfsize of box A.
+     * @param posB Center of box B.
+     * @param rotB Rotation of box B. The columns should be B's axes in global coordinates.
+     * @param hB Halfsize of box B.
+     * @return (CollisionManifold) The collision manifold. The normal points towards B and away from A.
      */
-    static int clipSegmentToLine(ZMath::Vec3D vOut[4], ZMath::Vec3D vIn[4], const ZMath::Vec3D &n1, const ZMath::Vec3D &n2, float offset1, float offset2) {
-        // begin with 0 output points
-        int np = 0;
-
-        // calculate the distance
-        // first set of distances
-        float d0 = n1 * vIn[0] - offset1;
-        float d1 = n1 * vIn[1] - offset1;
-
-        // second set of distances
-        float d2 = n2 * vIn[0] - offset2;
-        float d3 = n2 * vIn[3] - offset2;
-
-        // * Compute the clipping points.
-        // ? If the points are outside the reference cube's clipping plane (more or less inside the cube), add them as clipping points.
-        // ? Otherwise, check if the vertices are separated by the edge of the reference cube used for this clipping plane.
-        
-        // cache the interpolation values for efficiency
-        float i1 = (d0/(d1 + d0));
-        float i2 = (d2/(d3 + d2));
-        float i3 = (d1/(d1 + d0));
-        float i4 = (d3/(d3 + d2));
-
-        // first input point
-        if (d0 <= 0.0f && d2 <= 0.0f) { vOut[np++] = vIn[0]; }
-        else if (d0 * d1 < 0.0f && d2 * d3 < 0.0f) { vOut[np++] = vIn[0] + (vIn[1] - vIn[0]) * i1 + (vIn[3] - vIn[0]) * i2; }
-        else if (d0 * d1 < 0.0f) { vOut[np++] = vIn[0] + (vIn[1] - vIn[0]) * i1; } 
-        else if (d2 * d3 < 0.0f) { vOut[np++] = vIn[0] + (vIn[3] - vIn[0]) * i2; }
-
-        // second input point
-        if (d1 <= 0.0f && d2 <= 0.0f) { vOut[np++] = vIn[1]; }
-        else if (d0 * d1 < 0.0f && d2 * d3 < 0.0f) { vOut[np++] = vIn[1] + (vIn[0] - vIn[1]) * i3 + (vIn[2] - vIn[1]) * i2; }
-        else if (d0 * d1 < 0.0f) { vOut[np++] = vIn[1] + (vIn[0] - vIn[1]) * i3; }
-        else if (d2 * d3 < 0.0f) { vOut[np++] = vIn[1] + (vIn[2] - vIn[1]) * i2; }
-
-        // third input point
-        if (d1 <= 0.0f && d3 <= 0.0f) { vOut[np++] = vIn[2]; }
-        else if (d0 * d1 < 0.0f && d2 * d3 < 0.0f) { vOut[np++] = vIn[2] + (vIn[3] - vIn[2]) * i3 + (vIn[1] - vIn[2]) * i4; }
-        else if (d0 * d1 < 0.0f) { vOut[np++] = vIn[2] + (vIn[3] - vIn[2]) * i3; }
-        else if (d2 * d3 < 0.0f) { vOut[np++] = vIn[2] + (vIn[1] - vIn[2]) * i4; }
-
-        // fourth input point
-        if (d0 <= 0.0f && d3 <= 0.0f) { vOut[np++] = vIn[3]; }
-        else if (d0 * d1 < 0.0f && d2 * d3 < 0.0f) { vOut[np++] = vIn[3] + (vIn[2] - vIn[3]) * i1 + (vIn[0] - vIn[3]) * i4; }
-        else if (d0 * d1 < 0.0f) { vOut[np++] = vIn[3] + (vIn[2] - vIn[3]) * i1; }
-        else if (d2 * d3 < 0.0f) { vOut[np++] = vIn[3] + (vIn[0] - vIn[3]) * i4; }
-
-        return np;
-    };
+    inline static CollisionManifold findBoxFeatures(ZMath::Vec3D const &posA, ZMath::Mat3D const &rotA, ZMath::Vec3D const &hA,
+                                             ZMath::Vec3D const &posB, ZMath::Mat3D const &rotB, ZMath::Vec3D const &hB) {
 
-
-    static CollisionManifold findCollisionFeatures(Plane const &plane, AABB const &aabb) {
         CollisionManifold result;
 
-        // halfsize of the plane (A) and aabb (B)
-        ZMath::Vec2D planeH = plane.getHalfSize();
-        ZMath::Vec3D hA(planeH.x, planeH.y, 0.0f), hB = aabb.getHalfSize();
+        // * determine the rotation matrices of A and B
 
-        // * Determine the rotation matrices of A and B
+        // rotate anything from global space to A's local space
+        ZMath::Mat3D rotAT = rotA.transpose();
 
-        // rotate anything from global space (B's local space) to A's local space
-        ZMath::Mat3D rotAT = plane.rot.transpose();
+        // rotate anything from gobal space to B's local space
+        ZMath::Mat3D rotBT = rotB.transpose();
 
         // determine the difference between the positions
-        // Note: global space is the AABB's local space
-        ZMath::Vec3D dB = aabb.pos - plane.pos;
-        ZMath::Vec3D dA = rotAT * dB;
+        ZMath::Vec3D dP = posB - posA;
+        ZMath::Vec3D dA = rotAT * dP;
+        ZMath::Vec3D dB = rotBT * dP;
+
+        // Rotate anything from B's local space into A's
+        ZMath::Mat3D C = ZMath::abs(rotAT * rotB);
+
+        // Rotate anything from A's local space into B's
+        ZMath::Mat3D CT = C.transpose();
 
         // * Check for intersections with the separating axis theorem
 
         // amount of penetration along A's axes
-        ZMath::Vec3D faceA = ZMath::abs(dA) - hA - rotAT * hB;
+        ZMath::Vec3D faceA = ZMath::abs(dA) - hA - C * hB;
         if (faceA.x > 0 || faceA.y > 0 || faceA.z > 0) {
             result.hit = 0;
             return result;
         }
 
         // amount of penetration along B's axes
-        ZMath::Vec3D faceB = ZMath::abs(dB) - hB - plane.rot * hA;
+        ZMath::Vec3D faceB = ZMath::abs(dB) - hB - CT * hA;
         if (faceB.x > 0 || faceB.y > 0 || faceB.z > 0) {
             result.hit = 0;
             return result;
         }
 
-        // * Find the best axis (i.e. the axis with the least penetration)
+        // * Find the best axis (i.e. the axis with the least amount of penetration).
 
-        // Assume A's x-axis is the best axis first
-        Axis axis = FACE_A_X;
-        float separation = faceA.x;
-        result.normal = dA.x > 0.0f ? plane.rot.c1 : -plane.rot.c1;
+        ZMath::Vec3D axesA[3] = {rotA.c1, rotA.c2, rotA.c3}, axesB[3] = {rotB.c1, rotB.c2, rotB.c3};
+        float sepA[3] = {faceA.x, faceA.y, faceA.z}, sepB[3] = {faceB.x, faceB.y, faceB.z};
+        float dirA[3] = {dA.x, dA.y, dA.z}, dirB[3] = {dB.x, dB.y, dB.z};
+        float halfA[3] = {hA.x, hA.y, hA.z}, halfB[3] = {hB.x, hB.y, hB.z};
 
         // tolerance values
         float relativeTol = 0.95f;
@@ -318,1371 +226,1643 @@ namespace Zeta {
         // ? check if there is another axis better than A's x axis by checking if the penetration along
         // ?  the current axis being checked is greater than that of the current penetration
         // ?  (as greater value = less negative = less penetration).
+        // ? The tolerances favor A's axes and earlier axes to keep the chosen face from flip flopping between frames.
 
-        // A's remaining axes
-        if (faceA.y > relativeTol * separation + absoluteTol * hA.y) {
-            axis = FACE_A_Y;
-            separation = faceA.y;
-            result.normal = dA.y > 0.0f ? plane.rot.c2 : -plane.rot.c2;
-        }
-
-        if (faceA.z > relativeTol * separation + absoluteTol * hA.z) {
-            axis = FACE_A_Z;
-            separation = faceA.z;
-            result.normal = dA.z > 0.0f ? plane.rot.c3 : -plane.rot.c3;
-        }
-
-        // B's axes
-        if (faceB.x > relativeTol * separation + absoluteTol * hB.x) {
-            axis = FACE_B_X;
-            separation = faceB.x;
-            result.normal = dB.x > 0.0f ? ZMath::Vec3D(1, 0, 0) : ZMath::Vec3D(-1, 0, 0);
-        }
+        Axis axis = FACE_A_X;
+        float separation = sepA[0];
 
-        if (faceB.y > relativeTol * separation + absoluteTol * hB.y) {
-            axis = FACE_B_Y;
-            separation = faceB.y;
-            result.normal = dB.y > 0.0f ? ZMath::Vec3D(0, 1, 0) : ZMath::Vec3D(0, -1, 0);
+        for (int i = 1; i < 3; ++i) {
+            if (sepA[i] > relativeTol * separation + absoluteTol * halfA[i]) {
+                axis = (Axis) (FACE_A_X + i);
+                separation = sepA[i];
+            }
         }
 
-        if (faceB.z > relativeTol * separation + absoluteTol * hB.z) {
-            axis = FACE_B_Z;
-            separation = faceB.z;
-            result.normal = dB.z > 0.0f ? ZMath::Vec3D(0, 0, 1) : ZMath::Vec3D(0, 0, -1);
+        for (int i = 0; i < 3; ++i) {
+            if (sepB[i] > relativeTol * separation + absoluteTol * halfB[i]) {
+                axis = (Axis) (FACE_B_X + i);
+                separation = sepB[i];
+            }
         }
 
-        // * Setup clipping plane data based on the best axis
+        // * Setup the reference face based on the best axis
 
-        ZMath::Vec3D sideNormal1, sideNormal2;
-        ZMath::Vec3D incidentFace[4]; // 4 vertices for the collision in 3D
-        float front, negSide1, negSide2, posSide1, posSide2;
+        // ? The reference face belongs to the box whose axis was chosen. The other box provides the incident face.
+        bool refIsA = axis <= FACE_A_Z;
+        int k = refIsA ? axis - FACE_A_X : axis - FACE_B_X;
 
-        // * Compute the clipping lines and line segment to be clipped
+        ZMath::Vec3D const* refAxes = refIsA ? axesA : axesB;
+        float const* refHalf = refIsA ? halfA : halfB;
+        ZMath::Vec3D const &refPos = refIsA ? posA : posB;
 
-        // todo check my work for this tomorrow or after a couple days
+        if (refIsA) { result.normal = dirA[k] > 0.0f ? axesA[k] : -axesA[k]; }
+        else { result.normal = dirB[k] > 0.0f ? axesB[k] : -axesB[k]; }
 
-        switch(axis) {
-            case FACE_A_X: {
-                front = plane.pos * result.normal + hA.x;
-                sideNormal1 = plane.rot.c2; // yNormal
-                sideNormal2 = plane.rot.c3; // zNormal
-                float ySide = plane.pos * sideNormal1;
-                float zSide = plane.pos * sideNormal2;
+        // normal of the reference face pointing towards the incident box
+        ZMath::Vec3D frontNormal = refIsA ? result.normal : -result.normal;
+        float front = refPos * frontNormal + refHalf[k];
 
-                negSide1 = -ySide + hA.y; // negSideY
-                posSide1 = ySide + hA.y; // posSideY
-                negSide2 = -zSide + hA.z; // negSideZ
-                posSide2 = zSide + hA.z; // posSideZ
+        ZMath::Vec3D incidentFace[4];
+        if (refIsA) { computeIncidentFace(incidentFace, hB, posB, rotB, frontNormal); }
+        else { computeIncidentFace(incidentFace, hA, posA, rotA, frontNormal); }
 
-                computeIncidentFaceAABB(incidentFace, hB, aabb.pos, result.normal);
-                break;
-            }
+        // * Clip the incident face with the sides of the reference face.
 
-            case FACE_A_Y: {
-                front = plane.pos * result.normal + hA.y;
-                sideNormal1 = plane.rot.c1; // xNormal
-                sideNormal2 = plane.rot.c3; // zNormal
-                float xSide = plane.pos * sideNormal1;
-                float zSide = plane.pos * sideNormal2;
+        // ? Clipping a quad against 4 planes can add up to 1 vertex per plane.
+        ZMath::Vec3D clipPoints1[8];
+        ZMath::Vec3D clipPoints2[8];
+        int np = 4;
 
-                negSide1 = -xSide + hA.x; // negSideX
-                posSide1 = xSide + hA.x; // posSideX
-                negSide2 = -zSide + hA.z; // negSideZ
-                posSide2 = zSide + hA.z; // posSideZ
+        for (int i = 0; i < 4; ++i) { clipPoints1[i] = incidentFace[i]; }
 
-                computeIncidentFaceAABB(incidentFace, hB, aabb.pos, result.normal);
-                break;
-            }
+        for (int i = 1; i < 3 && np; ++i) {
+            ZMath::Vec3D const &sideNormal = refAxes[(k + i) % 3];
+            float side = refPos * sideNormal, h = refHalf[(k + i) % 3];
 
-            case FACE_A_Z: {
-                front = plane.pos * result.normal + hA.z;
-                sideNormal1 = plane.rot.c1; // xNormal
-                sideNormal2 = plane.rot.c2; // yNormal
-                float xSide = plane.pos * sideNormal1;
-                float ySide = plane.pos * sideNormal2;
+            np = clipPolygonToPlane(clipPoints2, clipPoints1, np, sideNormal, side + h);
+            np = clipPolygonToPlane(clipPoints1, clipPoints2, np, -sideNormal, -side + h);
+        }
 
-                negSide1 = -xSide + hA.x; // negSideX
-                posSide1 = xSide + hA.x; // posSideX
-                negSide2 = -ySide + hA.y; // negSideY
-                posSide2 = ySide + hA.y; // posSideY
+        // * clipPoints1 now contains the clipping points.
+        // * Compute the contact points.
 
-                computeIncidentFaceAABB(incidentFace, hB, aabb.pos, result.normal);
-                break;
-            }
+        // store the conatct points in here and add them to the dynamic array after they are determined
+        ZMath::Vec3D contactPoints[8];
+        int numContacts = 0;
+        result.pDist = 0.0f;
 
-            case FACE_B_X: {
-                front = aabb.pos * result.normal + hB.x;
-                sideNormal1.set(0, 1, 0); // yNormal
-                sideNormal2.set(0, 0, 1); // zNormal
-                float ySide = aabb.pos * sideNormal1;
-                float zSide = aabb.pos * sideNormal2;
-
-                negSide1 = -ySide + hB.y; // negSideY
-                posSide1 = ySide + hB.y; // posSideY
-                negSide2 = -zSide + hB.z; // negSideZ
-                posSide2 = zSide + hB.z; // posSideZ
-
-                // ? We know when the plane serves as the incident face, it must be the plane's only 3D face.
-                // ? In other words, we take the plane's 4 vertices.
-
-                // Determine the incident face in terms of halfSize. hA.z will always be 0.
-                incidentFace[0].set(-hA.x, -hA.y, 0.0f);
-                incidentFace[1].set(-hA.x, hA.y, 0.0f);
-                incidentFace[2].set(hA.x, hA.y, 0.0f);
-                incidentFace[3].set(hA.x, -hA.y, 0.0f);
-
-                // Rotate the incident face into global coordinates
-                incidentFace[0].set(plane.pos + plane.rot * incidentFace[0]);
-                incidentFace[1].set(plane.pos + plane.rot * incidentFace[1]);
-                incidentFace[2].set(plane.pos + plane.rot * incidentFace[2]);
-                incidentFace[3].set(plane.pos + plane.rot * incidentFace[3]);
+        for (int i = 0; i < np; ++i) {
+            separation = frontNormal * clipPoints1[i] - front;
 
-                break;
+            if (separation <= 0) {
+                // project the point onto the reference face
+                contactPoints[numContacts++] = clipPoints1[i] - frontNormal * separation;
+                if (result.pDist < -separation) { result.pDist = -separation; }
             }
+        }
 
-            case FACE_B_Y: {
-                front = aabb.pos * result.normal + hB.y;
-                sideNormal1.set(1, 0, 0); // xNormal
-                sideNormal2.set(0, 0, 1); // zNormal
-                float xSide = aabb.pos * sideNormal1;
-                float zSide = aabb.pos * sideNormal2;
-
-                negSide1 = -xSide + hB.x; // negSideX
-                posSide1 = xSide + hB.x; // posSideX
-                negSide2 = -zSide + hB.z; // negSideZ
-                posSide2 = zSide + hB.z; // posSideZ
-
-                // ? We know when the plane serves as the incident face, it must be the plane's only 3D face.
-                // ? In other words, we take the plane's 4 vertices.
-
-                // Determine the incident face in terms of halfSize. hA.z will always be 0.
-                incidentFace[0].set(-hA.x, -hA.y, 0.0f);
-                incidentFace[1].set(-hA.x, hA.y, 0.0f);
-                incidentFace[2].set(hA.x, hA.y, 0.0f);
-                incidentFace[3].set(hA.x, -hA.y, 0.0f);
-
-                // Rotate the incident face into global coordinates
-                incidentFace[0].set(plane.pos + plane.rot * incidentFace[0]);
-                incidentFace[1].set(plane.pos + plane.rot * incidentFace[1]);
-                incidentFace[2].set(plane.pos + plane.rot * incidentFace[2]);
-                incidentFace[3].set(plane.pos + plane.rot * incidentFace[3]);
+        if (!numContacts) {
+            result.hit = 0;
+            return result;
+        }
 
-                break;
-            }
+        // * update the manifold to contain the results.
 
-            case FACE_B_Z: {
-                front = aabb.pos * result.normal + hB.z;
-                sideNormal1.set(1, 0, 0); // xNormal
-                sideNormal2.set(0, 1, 0); // yNormal
-                float xSide = aabb.pos * sideNormal1;
-                float ySide = aabb.pos * sideNormal2;
-
-                negSide1 = -xSide + hB.x; // negSideX
-                posSide1 = xSide + hB.x; // posSideX
-                negSide2 = -ySide + hB.y; // negSideY
-                posSide2 = ySide + hB.y; // posSideY
-
-                // ? We know when the plane serves as the incident face, it must be the plane's only 3D face.
-                // ? In other words, we take the plane's 4 vertices.
-
-                // Determine the incident face in terms of halfSize. hA.z will always be 0.
-                incidentFace[0].set(-hA.x, -hA.y, 0.0f);
-                incidentFace[1].set(-hA.x, hA.y, 0.0f);
-                incidentFace[2].set(hA.x, hA.y, 0.0f);
-                incidentFace[3].set(hA.x, -hA.y, 0.0f);
-
-                // Rotate the incident face into global coordinates
-                incidentFace[0].set(plane.pos + plane.rot * incidentFace[0]);
-                incidentFace[1].set(plane.pos + plane.rot * incidentFace[1]);
-                incidentFace[2].set(plane.pos + plane.rot * incidentFace[2]);
-                incidentFace[3].set(plane.pos + plane.rot * incidentFace[3]);
+        result.hit = 1;
+        result.numPoints = numContacts;
+        result.contactPoints = new ZMath::Vec3D[numContacts];
 
-                break;
-            }
-        }
+        for (int i = 0; i < numContacts; ++i) { result.contactPoints[i] = contactPoints[i]; }
 
-        // * Clip the incident edge with box planes.
+        return result;
+    };
 
-        ZMath::Vec3D clipPoints1[4];
-        ZMath::Vec3D clipPoints2[4];
+    inline static CollisionManifold findCollisionFeatures(Plane const &plane, AABB const &aabb) {
+        ZMath::Vec2D h = plane.getHalfSize();
+        return findBoxFeatures(plane.pos, plane.rot, ZMath::Vec3D(h.x, h.y, 0.0f), aabb.pos, ZMath::Mat3D(1, 0, 0, 0, 1, 0, 0, 0, 1), aabb.getHalfSize());
+    };
 
-        // Clip to side 1
-        int np = clipSegmentToLine(clipPoints1, incidentFace, -sideNormal1, -sideNormal2, negSide1, negSide2);
+    inline static CollisionManifold findCollisionFeatures(Plane const &plane, Cube const &cube) {
+        ZMath::Vec2D h = plane.getHalfSize();
+        return findBoxFeatures(plane.pos, plane.rot, ZMath::Vec3D(h.x, h.y, 0.0f), cube.pos, cube.rot, cube.getHalfSize());
+    };
 
-        if (np < 4) {
-            result.hit = 0;
-            return result;
-        }
+    inline static CollisionManifold findCollisionFeatures(Sphere const &sphere1, Sphere const &sphere2) {
+        CollisionManifold result;
 
-        // Clip to the negative side 1
-        np = clipSegmentToLine(clipPoints2, clipPoints1, sideNormal1, sideNormal2, posSide1, posSide2);
+        float r = sphere1.r + sphere2.r;
+        ZMath::Vec3D sphereDiff = sphere2.c - sphere1.c;
 
-        if (np < 4) {
-            result.hit = 0;
-            return result;
-        }
+        result.hit = sphereDiff.magSq() <= r*r;
 
-        // * ClipPoints2 now contains the clipping points.
-        // * Compute the contact points.
+        if (!result.hit) { return result; }
         
-        // store the conatct points in here and add them to the dynamic array after they are determined
-        ZMath::Vec3D contactPoints[4];
-        np = 0;
-        result.pDist = 0.0f;
-
-        for (int i = 0; i < 4; ++i) {
-            separation = result.normal * clipPoints2[i] - front;
-
-            if (separation <= 0) {
-                contactPoints[np++] = clipPoints2[i] - result.normal * separation;
-                if (result.pDist < separation) { result.pDist = separation; }
-            }
-        }
+        float d = sphereDiff.mag(); // allows us to only take the sqrt once
 
-        // * update the manifold to contain the results.
+        result.pDist = sphere1.r + sphere2.r - d;
+        result.normal = sphereDiff * (1.0f/d);
 
-        result.pDist = -result.pDist;
-        result.hit = 1;
-        result.numPoints = np;
-        result.contactPoints = new ZMath::Vec3D[np];
+        // determine the contact point
+        result.numPoints = 1;
+        result.contactPoints = new ZMath::Vec3D[result.numPoints];
+        result.contactPoints[0] = sphere1.c + (result.normal * (sphere1.r - result.pDist * 0.5f));
 
-        for (int i = 0; i < np; ++i) { result.contactPoints[i] = contactPoints[i]; }
-        
         return result;
     };
 
-    static CollisionManifold findCollisionFeatures(Plane const &plane, Cube const &cube) {
+    /**
+     * @brief Find the collision features between a sphere and a box.
+     * 
+     * @param sphere The sphere (A).
+     * @param pos The center of the box (B).
+     * @param rot The rotation of the box. The columns should be the box's axes in global coordinates.
+     * @param halfSize The halfsize of the box.
+     * @return (CollisionManifold) The collision manifold. The normal points towards the box and away from the sphere.
+     */
+    inline static CollisionManifold findSphereBoxFeatures(Sphere const &sphere, ZMath::Vec3D const &pos, ZMath::Mat3D const &rot, ZMath::Vec3D const &halfSize) {
         CollisionManifold result;
 
-        // halfsize of the plane (A) and cube (B)
-        ZMath::Vec2D planeH = plane.getHalfSize();
-        ZMath::Vec3D hA(planeH.x, planeH.y, 0.0f), hB = cube.getHalfSize();
+        // ? We know a sphere and box would intersect if the distance from the closest point to the center on the box
+        // ?  from the center is less than or equal to the radius of the sphere.
+        // ? We can determine the closet point by clamping the center of the sphere in the box's local coordinates.
+        // ? From here, we can check the distance from this point to the sphere's center.
 
-        // * Determine the rotation matrices of A and B
+        // rotate the center of the sphere into the UVW coordinates of our box
+        ZMath::Vec3D c = rot.transpose() * (sphere.c - pos);
+        ZMath::Vec3D closest = ZMath::clamp(c, -halfSize, halfSize);
 
-        // rotate anything from global space to A's local space
-        ZMath::Mat3D rotAT = plane.rot.transpose();
+        result.hit = closest.distSq(c) <= sphere.r*sphere.r;
 
-        // rotate anything from global space to B's local space
-        ZMath::Mat3D rotBT = cube.rot.transpose();
+        if (!result.hit) { return result; }
 
-        // determine the difference between the positions
-        ZMath::Vec3D dP = cube.pos - plane.pos;
-        ZMath::Vec3D dA = rotAT * dP;
-        ZMath::Vec3D dB = rotBT * dP;
+        // determine the penetration distance and collision normal
 
-        // * Rotation matrices for switching between local spaces
+        ZMath::Vec3D diff = closest - c;
+        float d = diff.mag(); // allows us to only take the sqrt once
 
-        // ! When scenes are developed test if we actually need the absolute value
+        if (d) {
+            result.pDist = sphere.r - d;
+            result.normal = rot * (diff * (1.0f/d));
 
-        // Rotate anything from B's local space into A's
-        ZMath::Mat3D C = ZMath::abs(rotAT * cube.rot);
+        } else {
+            // ? The center of the sphere is inside of the box so push it out through the closest face.
 
-        // Rotate anything from A's local space into B's
-        ZMath::Mat3D CT = C.transpose();
+            ZMath::Vec3D toFace = halfSize - ZMath::abs(c);
+            ZMath::Vec3D n;
+            float depth;
 
-        // * Check for intersections with the separating axis theorem
+            if (toFace.x <= toFace.y && toFace.x <= toFace.z) {
+                depth = toFace.x;
+                n = ZMath::Vec3D(c.x > 0.0f ? -1.0f : 1.0f, 0, 0);
+                closest.x = c.x > 0.0f ? halfSize.x : -halfSize.x;
 
-        // amount of penetration along A's axes
-        ZMath::Vec3D faceA = ZMath::abs(dA) - hA - C * hB;
-        if (faceA.x > 0 || faceA.y > 0 || faceA.z > 0) {
-            result.hit = 0;
-            return result;
-        }
+            } else if (toFace.y <= toFace.z) {
+                depth = toFace.y;
+                n = ZMath::Vec3D(0, c.y > 0.0f ? -1.0f : 1.0f, 0);
+                closest.y = c.y > 0.0f ? halfSize.y : -halfSize.y;
 
-        // amount of penetration along B's axes
-        ZMath::Vec3D faceB = ZMath::abs(dB) - hB - CT * hA;
-        if (faceB.x > 0 || faceB.y > 0 || faceB.z > 0) {
-            result.hit = 0;
-            return result;
+            } else {
+                depth = toFace.z;
+                n = ZMath::Vec3D(0, 0, c.z > 0.0f ? -1.0f : 1.0f);
+                closest.z = c.z > 0.0f ? halfSize.z : -halfSize.z;
+            }
+
+            result.pDist = sphere.r + depth;
+            result.normal = rot * n;
         }
 
-        // * Find the best axis (i.e. the axis with the least penetration)
+        // The closest point to the sphere's center will be our contact point rotated back into global coordinates.
 
-        // Assume A's x-axis is the best axis first
-        Axis axis = FACE_A_X;
-        float separation = faceA.x;
-        result.normal = dA.x > 0.0f ? plane.rot.c1 : -plane.rot.c1;
+        result.numPoints = 1;
+        result.contactPoints = new ZMath::Vec3D[1];
+        result.contactPoints[0] = rot * closest + pos;
 
-        // tolerance values
-        float relativeTol = 0.95f;
-        float absoluteTol = 0.01f;
+        return result;
+    };
 
-        // ? check if there is another axis better than A's x axis by checking if the penetration along
-        // ?  the current axis being checked is greater than that of the current penetration
-        // ?  (as greater value = less negative = less penetration).
+    inline static CollisionManifold findCollisionFeatures(Sphere const &sphere, AABB const &aabb) {
+        return findSphereBoxFeatures(sphere, aabb.pos, ZMath::Mat3D(1, 0, 0, 0, 1, 0, 0, 0, 1), aabb.getHalfSize());
+    };
 
-        // A's remaining axes
-        if (faceA.y > relativeTol * separation + absoluteTol * hA.y) {
-            axis = FACE_A_Y;
-            separation = faceA.y;
-            result.normal = dA.y > 0.0f ? plane.rot.c2 : -plane.rot.c2;
-        }
+    inline static CollisionManifold findCollisionFeatures(Sphere const &sphere, Cube const &cube) {
+        return findSphereBoxFeatures(sphere, cube.pos, cube.rot, cube.getHalfSize());
+    };
 
-        if (faceA.z > relativeTol * separation + absoluteTol * hA.z) {
-            axis = FACE_A_Z;
-            separation = faceA.z;
-            result.normal = dA.z > 0.0f ? plane.rot.c3 : -plane.rot.c3;
-        }
+    // ? Normal points towards B and away from A
 
-        // B's axes
-        if (faceB.x > relativeTol * separation + absoluteTol * hB.x) {
-            axis = FACE_B_X;
-            separation = faceB.x;
-            result.normal = dB.x > 0.0f ? cube.rot.c1 : -cube.rot.c1;
-        }
+    inline static CollisionManifold findCollisionFeatures(AABB const &aabb1, AABB const &aabb2) {
+        ZMath::Mat3D identity(1, 0, 0, 0, 1, 0, 0, 0, 1);
+        return findBoxFeatures(aabb1.pos, identity, aabb1.getHalfSize(), aabb2.pos, identity, aabb2.getHalfSize());
+    };
 
-        if (faceB.y > relativeTol * separation + absoluteTol * hB.y) {
-            axis = FACE_B_Y;
-            separation = faceB.y;
-            result.normal = dB.y > 0.0f ? cube.rot.c2 : -cube.rot.c2;
-        }
+    // ? Normal points towards B and away from A
+
+    inline static CollisionManifold findCollisionFeatures(AABB const &aabb, Cube const &cube) {
+        return findBoxFeatures(aabb.pos, ZMath::Mat3D(1, 0, 0, 0, 1, 0, 0, 0, 1), aabb.getHalfSize(), cube.pos, cube.rot, cube.getHalfSize());
+    };
+
+    // ? Normal points towards B and away from A.
+
+    inline static CollisionManifold findCollisionFeatures(Cube const &cube1, Cube const &cube2) {
+        return findBoxFeatures(cube1.pos, cube1.rot, cube1.getHalfSize(), cube2.pos, cube2.rot, cube2.getHalfSize());
+    };
+
+    // * ====================================================
+    // * Heightfield Collision Manifolds
+    // * ====================================================
+
+    inline static CollisionManifold findCollisionFeatures(Heightfield const &hf, Sphere const &sphere) {
+        CollisionManifold result;
 
-        if (faceB.z > relativeTol * separation + absoluteTol * hB.z) {
-            axis = FACE_B_Z;
-            separation = faceB.z;
-            result.normal = dB.z > 0.0f ? cube.rot.c3 : -cube.rot.c3;
+        float h;
+        ZMath::Vec3D n, closest;
+
+        // ? If the center of the sphere fell through the surface, the closest point would push it further down.
+        // ? Instead, push it back out along the normal of the triangle it is under.
+
+        if (hf.getHeight(sphere.c.x, sphere.c.y, h, n) && sphere.c.z <= h) {
+            result.hit = 1;
+            result.normal = n.normalize();
+            result.pDist = (h - sphere.c.z) * result.normal.z + sphere.r;
+
+            result.numPoints = 1;
+            result.contactPoints = new ZMath::Vec3D[1];
+            result.contactPoints[0] = sphere.c - result.normal * (sphere.r - result.pDist);
+
+            return result;
         }
 
-        // * Setup clipping plane data based on the best axis
+        result.hit = closestPointOnHeightfield(hf, sphere.c, sphere.r, closest);
 
-        ZMath::Vec3D sideNormal1, sideNormal2;
-        ZMath::Vec3D incidentFace[4]; // 4 vertices for the collision in 3D
-        float front, negSide1, negSide2, posSide1, posSide2;
+        if (!result.hit) { return result; }
 
-        // * Compute the clipping lines and line segment to be clipped
+        result.numPoints = 1;
+        result.contactPoints = new ZMath::Vec3D[1];
+        result.contactPoints[0] = closest;
 
-        // todo check my work for this tomorrow or after a couple days
+        ZMath::Vec3D diff = sphere.c - closest;
+        float d = diff.mag(); // allows us to only take the sqrt once
+        result.pDist = sphere.r - d;
+        result.normal = diff * (1.0f/d);
 
-        switch(axis) {
-            case FACE_A_X: {
-                front = plane.pos * result.normal + hA.x;
-                sideNormal1 = plane.rot.c2; // yNormal
-                sideNormal2 = plane.rot.c3; // zNormal
-                float ySide = plane.pos * sideNormal1;
-                float zSide = plane.pos * sideNormal2;
+        return result;
+    };
 
-                negSide1 = -ySide + hA.y; // negSideY
-                posSide1 = ySide + hA.y; // posSideY
-                negSide2 = -zSide + hA.z; // negSideZ
-                posSide2 = zSide + hA.z; // posSideZ
+    // Add a contact to a heightfield manifold, replacing the shallowest contact if there are already 4.
+    inline static void addHeightfieldContact(ZMath::Vec3D points[4], ZMath::Vec3D normals[4], float depths[4], int &np,
+                                      ZMath::Vec3D const &p, ZMath::Vec3D const &n, float depth) {
+        int i = np;
 
-                computeIncidentFace(incidentFace, hB, cube.pos, cube.rot, result.normal);
-                break;
-            }
+        if (np == 4) {
+            i = 0;
+            for (int j = 1; j < 4; ++j) { if (depths[j] < depths[i]) { i = j; } }
+            if (depths[i] >= depth) { return; }
 
-            case FACE_A_Y: {
-                front = plane.pos * result.normal + hA.y;
-                sideNormal1 = plane.rot.c1; // xNormal
-                sideNormal2 = plane.rot.c3; // zNormal
-                float xSide = plane.pos * sideNormal1;
-                float zSide = plane.pos * sideNormal2;
+        } else { ++np; }
 
-                negSide1 = -xSide + hA.x; // negSideX
-                posSide1 = xSide + hA.x; // posSideX
-                negSide2 = -zSide + hA.z; // negSideZ
-                posSide2 = zSide + hA.z; // posSideZ
+        points[i] = p;
+        normals[i] = n;
+        depths[i] = depth;
+    };
 
-                computeIncidentFace(incidentFace, hB, cube.pos, cube.rot, result.normal);
-                break;
-            }
+    /**
+     * @brief Find the collision features between a heightfield and a box.
+     *
+     * @param hf The heightfield.
+     * @param pos The center of the box.
+     * @param rot The rotation of the box. The columns should be the box's axes in global coordinates.
+     * @param halfSize The half size of the box.
+     * @return (CollisionManifold) The collision features. The normal points towards the box.
+     */
+    inline static CollisionManifold findHeightfieldBoxFeatures(Heightfield const &hf, ZMath::Vec3D const &pos, ZMath::Mat3D const &rot, ZMath::Vec3D const &halfSize) {
+        CollisionManifold result;
 
-            case FACE_A_Z: {
-                front = plane.pos * result.normal + hA.z;
-                sideNormal1 = plane.rot.c1; // xNormal
-                sideNormal2 = plane.rot.c2; // yNormal
-                float xSide = plane.pos * sideNormal1;
-                float ySide = plane.pos * sideNormal2;
+        // ? Two kinds of contacts can occur:
+        // ?  1) A vertex of the box is below the surface. It is pushed out along the normal of the triangle it is over.
+        // ?  2) A sample of the heightfield is inside of the box (ex: the box rests on a peak). It is pushed out the nearest face of the box.
+        // ? We keep the 4 deepest contacts and average their normals weighted by depth.
 
-                negSide1 = -xSide + hA.x; // negSideX
-                posSide1 = xSide + hA.x; // posSideX
-                negSide2 = -ySide + hA.y; // negSideY
-                posSide2 = ySide + hA.y; // posSideY
+        ZMath::Vec3D extents = ZMath::abs(rot) * halfSize;
+        uint32_t cx0, cy0, cx1, cy1;
+        float maxZ;
 
-                computeIncidentFace(incidentFace, hB, cube.pos, cube.rot, result.normal);
-                break;
-            }
+        result.hit = hf.getCellRange(pos - extents, pos + extents, cx0, cy0, cx1, cy1)
+                  && hf.getMaxHeight(cx0, cy0, cx1, cy1, maxZ) && pos.z - extents.z <= maxZ;
 
-            case FACE_B_X: {
-                front = cube.pos * result.normal + hB.x;
-                sideNormal1 = cube.rot.c2; // yNormal
-                sideNormal2 = cube.rot.c3; // zNormal
-                float ySide = cube.pos * sideNormal1;
-                float zSide = cube.pos * sideNormal2;
-
-                negSide1 = -ySide + hB.y; // negSideY
-                posSide1 = ySide + hB.y; // posSideY
-                negSide2 = -zSide + hB.z; // negSideZ
-                posSide2 = zSide + hB.z; // posSideZ
-
-                // ? We know when the plane serves as the incident face, it must be the plane's only 3D face.
-                // ? In other words, we take the plane's 4 vertices.
-
-                // Determine the incident face in terms of halfSize. hA.z will always be 0.
-                incidentFace[0].set(-hA.x, -hA.y, 0.0f);
-                incidentFace[1].set(-hA.x, hA.y, 0.0f);
-                incidentFace[2].set(hA.x, hA.y, 0.0f);
-                incidentFace[3].set(hA.x, -hA.y, 0.0f);
-
-                // Rotate the incident face into global coordinates
-                incidentFace[0].set(plane.pos + plane.rot * incidentFace[0]);
-                incidentFace[1].set(plane.pos + plane.rot * incidentFace[1]);
-                incidentFace[2].set(plane.pos + plane.rot * incidentFace[2]);
-                incidentFace[3].set(plane.pos + plane.rot * incidentFace[3]);
+        if (!result.hit) { return result; }
 
-                break;
-            }
+        ZMath::Vec3D points[4], normals[4];
+        float depths[4];
+        int np = 0;
 
-            case FACE_B_Y: {
-                front = cube.pos * result.normal + hB.y;
-                sideNormal1 = cube.rot.c1; // xNormal
-                sideNormal2 = cube.rot.c3; // zNormal
-                float xSide = cube.pos * sideNormal1;
-                float zSide = cube.pos * sideNormal2;
-
-                negSide1 = -xSide + hB.x; // negSideX
-                posSide1 = xSide + hB.x; // posSideX
-                negSide2 = -zSide + hB.z; // negSideZ
-                posSide2 = zSide + hB.z; // posSideZ
-
-                // ? We know when the plane serves as the incident face, it must be the plane's only 3D face.
-                // ? In other words, we take the plane's 4 vertices.
-
-                // Determine the incident face in terms of halfSize. hA.z will always be 0.
-                incidentFace[0].set(-hA.x, -hA.y, 0.0f);
-                incidentFace[1].set(-hA.x, hA.y, 0.0f);
-                incidentFace[2].set(hA.x, hA.y, 0.0f);
-                incidentFace[3].set(hA.x, -hA.y, 0.0f);
-
-                // Rotate the incident face into global coordinates
-                incidentFace[0].set(plane.pos + plane.rot * incidentFace[0]);
-                incidentFace[1].set(plane.pos + plane.rot * incidentFace[1]);
-                incidentFace[2].set(plane.pos + plane.rot * incidentFace[2]);
-                incidentFace[3].set(plane.pos + plane.rot * incidentFace[3]);
+        // vertices of the box below the surface
+        float h;
+        ZMath::Vec3D n, vertices[8];
 
-                break;
-            }
+        for (int i = 0; i < 8; ++i) { vertices[i] = ZMath::Vec3D(i & 1 ? halfSize.x : -halfSize.x, i & 2 ? halfSize.y : -halfSize.y, i & 4 ? halfSize.z : -halfSize.z); }
+        ZMath::transform(rot, vertices, vertices, 8, pos);
 
-            case FACE_B_Z: {
-                front = cube.pos * result.normal + hB.z;
-                sideNormal1 = cube.rot.c1; // xNormal
-                sideNormal2 = cube.rot.c2; // yNormal
-                float xSide = cube.pos * sideNormal1;
-                float ySide = cube.pos * sideNormal2;
-
-                negSide1 = -xSide + hB.x; // negSideX
-                posSide1 = xSide + hB.x; // posSideX
-                negSide2 = -ySide + hB.y; // negSideY
-                posSide2 = ySide + hB.y; // posSideY
-
-                // ? We know when the plane serves as the incident face, it must be the plane's only 3D face.
-                // ? In other words, we take the plane's 4 vertices.
-
-                // Determine the incident face in terms of halfSize. hA.z will always be 0.
-                incidentFace[0].set(-hA.x, -hA.y, 0.0f);
-                incidentFace[1].set(-hA.x, hA.y, 0.0f);
-                incidentFace[2].set(hA.x, hA.y, 0.0f);
-                incidentFace[3].set(hA.x, -hA.y, 0.0f);
-
-                // Rotate the incident face into global coordinates
-                incidentFace[0].set(plane.pos + plane.rot * incidentFace[0]);
-                incidentFace[1].set(plane.pos + plane.rot * incidentFace[1]);
-                incidentFace[2].set(plane.pos + plane.rot * incidentFace[2]);
-                incidentFace[3].set(plane.pos + plane.rot * incidentFace[3]);
+        for (int i = 0; i < 8; ++i) {
+            ZMath::Vec3D const &v = vertices[i];
 
-                break;
+            if (hf.getHeight(v.x, v.y, h, n) && v.z <= h) {
+                n = n.normalize();
+                addHeightfieldContact(points, normals, depths, np, v, n, (h - v.z) * n.z);
             }
         }
 
-        // * Clip the incident edge with box planes.
+        // samples inside of the box
+        ZMath::Mat3D invRot = rot.transpose();
+        ZMath::Vec3D s;
 
-        ZMath::Vec3D clipPoints1[4];
-        ZMath::Vec3D clipPoints2[4];
+        for (uint32_t sy = cy0; sy <= cy1 + 1; ++sy) {
+            for (uint32_t sx = cx0; sx <= cx1 + 1; ++sx) {
+                if (!hf.getSample(sx, sy, s)) { continue; }
 
-        // Clip to side 1
-        int np = clipSegmentToLine(clipPoints1, incidentFace, -sideNormal1, -sideNormal2, negSide1, negSide2);
+                ZMath::Vec3D l = invRot * (s - pos);
+                ZMath::Vec3D exit = halfSize - ZMath::abs(l);
 
-        if (np < 4) {
-            result.hit = 0;
-            return result;
+                if (exit.x < 0.0f || exit.y < 0.0f || exit.z < 0.0f) { continue; }
+
+                // push the box out through its nearest face
+                if (exit.x <= exit.y && exit.x <= exit.z) { addHeightfieldContact(points, normals, depths, np, s, l.x > 0.0f ? -rot.c1 : rot.c1, exit.x); }
+                else if (exit.y <= exit.z) { addHeightfieldContact(points, normals, depths, np, s, l.y > 0.0f ? -rot.c2 : rot.c2, exit.y); }
+                else { addHeightfieldContact(points, normals, depths, np, s, l.z > 0.0f ? -rot.c3 : rot.c3, exit.z); }
+            }
         }
 
-        // Clip to the negative side 1
-        np = clipSegmentToLine(clipPoints2, clipPoints1, sideNormal1, sideNormal2, posSide1, posSide2);
+        result.hit = np > 0;
 
-        if (np < 4) {
-            result.hit = 0;
-            return result;
-        }
+        if (!result.hit) { return result; }
 
-        // * ClipPoints2 now contains the clipping points.
-        // * Compute the contact points.
-        
-        // store the conatct points in here and add them to the dynamic array after they are determined
-        ZMath::Vec3D contactPoints[4];
-        np = 0;
+        result.normal = ZMath::Vec3D();
         result.pDist = 0.0f;
 
-        for (int i = 0; i < 4; ++i) {
-            separation = result.normal * clipPoints2[i] - front;
-
-            if (separation <= 0) {
-                contactPoints[np++] = clipPoints2[i] - result.normal * separation;
-                if (result.pDist < separation) { result.pDist = separation; }
-            }
+        for (int i = 0; i < np; ++i) {
+            result.normal += normals[i] * depths[i];
+            if (depths[i] > result.pDist) { result.pDist = depths[i]; }
         }
 
-        // * update the manifold to contain the results.
+        // all of the contacts are exactly touching
+        if (result.normal.magSq() == 0.0f) { result.normal = normals[0]; }
+        else { result.normal = result.normal.normalize(); }
 
-        result.pDist = -result.pDist;
-        result.hit = 1;
         result.numPoints = np;
         result.contactPoints = new ZMath::Vec3D[np];
 
-        for (int i = 0; i < np; ++i) { result.contactPoints[i] = contactPoints[i]; }
-        
+        for (int i = 0; i < np; ++i) { result.contactPoints[i] = points[i]; }
+
         return result;
     };
 
-    static CollisionManifold findCollisionFeatures(Sphere const &sphere1, Sphere const &sphere2) {
+    inline static CollisionManifold findCollisionFeatures(Heightfield const &hf, AABB const &aabb) {
+        return findHeightfieldBoxFeatures(hf, aabb.pos, ZMath::Mat3D(1, 0, 0, 0, 1, 0, 0, 0, 1), aabb.getHalfSize());
+    };
+
+    inline static CollisionManifold findCollisionFeatures(Heightfield const &hf, Cube const &cube) {
+        return findHeightfieldBoxFeatures(hf, cube.pos, cube.rot, cube.getHalfSize());
+    };
+
+    // * ====================================================
+    // * Capsule Collision Manifolds
+    // * ====================================================
+
+    inline static CollisionManifold findCollisionFeatures(Capsule const &capsule, Sphere const &sphere) {
         CollisionManifold result;
 
-        float r = sphere1.r + sphere2.r;
-        ZMath::Vec3D sphereDiff = sphere2.c - sphere1.c;
+        // ? The closest point on the capsule's segment to the sphere acts as the center of a sphere with the capsule's radius.
 
-        result.hit = sphereDiff.magSq() <= r*r;
+        ZMath::Vec3D closest = closestPointOnSegment(sphere.c, capsule.getStart(), capsule.getEnd());
+        ZMath::Vec3D diff = sphere.c - closest;
+        float r = capsule.r + sphere.r;
+
+        result.hit = diff.magSq() <= r*r;
 
         if (!result.hit) { return result; }
-        
-        float d = sphereDiff.mag(); // allows us to only take the sqrt once
 
-        result.pDist = (sphere1.r + sphere2.r - d) * 0.5f;
-        result.normal = sphereDiff * (1.0f/d);
+        float d = diff.mag(); // allows us to only take the sqrt once
+
+        result.pDist = r - d;
+        result.normal = d ? diff * (1.0f/d) : ZMath::Vec3D(0, 0, 1);
 
-        // determine the contact point
         result.numPoints = 1;
-        result.contactPoints = new ZMath::Vec3D[result.numPoints];
-        result.contactPoints[0] = sphere1.c + (result.normal * (sphere1.r - result.pDist));
+        result.contactPoints = new ZMath::Vec3D[1];
+        result.contactPoints[0] = closest + result.normal * (capsule.r - result.pDist * 0.5f);
 
         return result;
     };
 
-    static CollisionManifold findCollisionFeatures(Sphere const &sphere, AABB const &aabb) {
+    inline static CollisionManifold findCollisionFeatures(Capsule const &capsule1, Capsule const &capsule2) {
         CollisionManifold result;
 
-        // ? We know a sphere and AABB would intersect if the distance from the closest point to the center on the AABB
-        // ?  from the center is less than or equal to the radius of the sphere.
-        // ? We can determine the closet point by clamping the value of the sphere's center between the min and max of the AABB.
-        // ? From here, we can check the distance from this point to the sphere's center.
+        ZMath::Vec3D c1, c2;
+        float r = capsule1.r + capsule2.r;
+        float dSq = closestPointsSegmentSegment(capsule1.getStart(), capsule1.getEnd(), capsule2.getStart(), capsule2.getEnd(), c1, c2);
 
-        ZMath::Vec3D min = aabb.getMin(), max = aabb.getMax();
-        ZMath::Vec3D closest = ZMath::clamp(closest, min, max);
-        result.hit = closest.distSq(sphere.c) <= sphere.r*sphere.r;
+        result.hit = dSq <= r*r;
 
         if (!result.hit) { return result; }
 
-        // The closest point to the sphere's center will be our contact point.
-        // Therefore, we just set our contact point to closest.
+        float d = sqrtf(dSq);
 
-        result.numPoints = 1;
-        result.contactPoints = new ZMath::Vec3D[1];
-        result.contactPoints[0] = closest;
+        result.pDist = r - d;
 
-        // determine the penetration distance and collision normal
+        // the segments cross so fall back on the direction between the capsules
+        if (d) { result.normal = (c2 - c1) * (1.0f/d); }
+        else if (capsule1.pos.distSq(capsule2.pos)) { result.normal = (capsule2.pos - capsule1.pos).normalize(); }
+        else { result.normal = ZMath::Vec3D(0, 0, 1); }
 
-        ZMath::Vec3D diff = closest - sphere.c;
-        float d = diff.mag(); // allows us to only take the sqrt once
-        result.pDist = sphere.r - d;
-        result.normal = diff * (1.0f/d);
+        result.numPoints = 1;
+        result.contactPoints = new ZMath::Vec3D[1];
+        result.contactPoints[0] = c1 + result.normal * (capsule1.r - result.pDist * 0.5f);
 
         return result;
     };
 
-    static CollisionManifold findCollisionFeatures(Sphere const &sphere, Cube const &cube) {
+    /**
+     * @brief Find the collision features between a box and a capsule.
+     *
+     * @param pos The center of the box.
+     * @param rot The rotation of the box. The columns should be the box's axes in global coordinates.
+     * @param halfSize The half size of the box.
+     * @param capsule The capsule.
+     * @return (CollisionManifold) The collision features. The normal points towards the capsule.
+     */
+    inline static CollisionManifold findBoxCapsuleFeatures(ZMath::Vec3D const &pos, ZMath::Mat3D const &rot, ZMath::Vec3D const &halfSize, Capsule const &capsule) {
         CollisionManifold result;
 
-        ZMath::Vec3D closest = sphere.c - cube.pos;
-        ZMath::Vec3D min = cube.getLocalMin(), max = cube.getLocalMax();
+        // ? Work in the box's local coordinates.
+        // ? If the segment is outside of the box, push the capsule away from the closest point on the box.
+        // ? If the segment passes through the box, push it out along whichever face axis requires the least movement.
 
-        // rotate the center of the sphere into the UVW coordinates of our cube
-        closest = cube.rot * closest + cube.pos;
-        
-        // perform the check as if it was an AABB vs Sphere
-        closest = ZMath::clamp(closest, min, max);
-        result.hit = closest.distSq(sphere.c) <= sphere.r*sphere.r;
+        ZMath::Mat3D rotT = rot.transpose();
+        ZMath::Vec3D a = rotT * (capsule.getStart() - pos), b = rotT * (capsule.getEnd() - pos);
+        ZMath::Vec3D onSeg, onBox;
 
+        result.hit = capsuleNearBox(a, b, halfSize, capsule.r);
         if (!result.hit) { return result; }
 
-        // the closest point to the sphere's center will be our contact point rotated back into global coordinates coordinates
+        float dSq = closestPointsSegmentBox(a, b, halfSize, onSeg, onBox);
+        result.hit = dSq <= capsule.r*capsule.r;
 
-        closest -= cube.pos;
-        closest = cube.rot.transpose() * closest + cube.pos;
+        if (!result.hit) { return result; }
 
-        result.numPoints = 1;
-        result.contactPoints = new ZMath::Vec3D[1];
-        result.contactPoints[0] = closest;
+        ZMath::Vec3D contactPoints[2];
+        ZMath::Vec3D normal;
+        int np = 1;
 
-        // determine the penetration distance and the collision normal
+        if (dSq) {
+            float d = sqrtf(dSq);
 
-        ZMath::Vec3D diff = closest - sphere.c;
-        float d = diff.mag(); // allows us to only take the sqrt once
-        result.pDist = sphere.r - d;
-        result.normal = diff * (1.0f/d);
+            normal = (onSeg - onBox) * (1.0f/d);
+            result.pDist = capsule.r - d;
+            contactPoints[0] = onBox;
 
-        return result;
-    };
+            // when the capsule lies along a face, both ends of the segment touch
+            ZMath::Vec3D ends[2] = {a, b};
 
-    // ? Normal points towards B and away from A
+            for (int i = 0; i < 2; ++i) {
+                ZMath::Vec3D cp = ZMath::clamp(ends[i], -halfSize, halfSize);
 
-    static CollisionManifold findCollisionFeatures(AABB const &aabb1, AABB const &aabb2) {
-        CollisionManifold result;
+                if (ends[i].distSq(cp) <= capsule.r*capsule.r && cp.distSq(onBox) > EPSILON) {
+                    contactPoints[np++] = cp;
+                    break;
+                }
+            }
 
-        // half size of AABB a and b respectively
-        ZMath::Vec3D hA = aabb1.getHalfSize(), hB = aabb2.getHalfSize();
+        } else {
+            ZMath::Vec3D segMin(ZMath::min(a.x, b.x), ZMath::min(a.y, b.y), ZMath::min(a.z, b.z));
+            ZMath::Vec3D segMax(ZMath::max(a.x, b.x), ZMath::max(a.y, b.y), ZMath::max(a.z, b.z));
 
-        // * Check for intersections using the separating axis theorem.
-        // because both are axis aligned, global space is the same as the local space of both AABBs.
+            // distance the capsule must travel along each axis to separate
+            ZMath::Vec3D up = halfSize - segMin + capsule.r, down = segMax + halfSize + capsule.r;
 
-        // distance between the two
-        ZMath::Vec3D dP = aabb2.pos - aabb1.pos;
-        ZMath::Vec3D absDP = ZMath::abs(dP);
+            result.pDist = up.x;
+            normal.set(1, 0, 0);
 
-        // penetration along A's (and B's) axes
-        ZMath::Vec3D faceA = absDP - hA - hB;
-        if (faceA.x > 0 || faceA.y > 0 || faceA.z > 0) {
-            result.hit = 0;
-            return result;
+            if (down.x < result.pDist) { result.pDist = down.x; normal.set(-1, 0, 0); }
+            if (up.y < result.pDist)   { result.pDist = up.y;   normal.set(0, 1, 0); }
+            if (down.y < result.pDist) { result.pDist = down.y; normal.set(0, -1, 0); }
+            if (up.z < result.pDist)   { result.pDist = up.z;   normal.set(0, 0, 1); }
+            if (down.z < result.pDist) { result.pDist = down.z; normal.set(0, 0, -1); }
+
+            // the deepest end of the segment along the normal is our contact point
+            contactPoints[0] = ZMath::clamp(a * normal < b * normal ? a : b, -halfSize, halfSize);
         }
 
-        // ? Since they are axis aligned, the penetration between the two will be the same on any given axis.
-        // ?  Therefore, we only need to check for A.
+        // convert back to global coordinates
+        result.normal = rot * normal;
+        result.numPoints = np;
+        result.contactPoints = new ZMath::Vec3D[np];
 
-        // * Find the best axis (i.e. the axis with the least amount of penetration).
+        ZMath::transform(rot, contactPoints, result.contactPoints, np, pos);
 
-        // Assume A's x-axis is the best axis first
-        Axis axis = FACE_A_X;
-        float separation = faceA.x;
-        result.normal = dP.x > 0.0f ? ZMath::Vec3D(1, 0, 0) : ZMath::Vec3D(-1, 0, 0);
+        return result;
+    };
 
-        // tolerance values
-        float relativeTol = 0.95f;
-        float absoluteTol = 0.01f;
+    inline static CollisionManifold findCollisionFeatures(Plane const &plane, Capsule const &capsule) {
+        ZMath::Vec2D h = plane.getHalfSize();
+        return findBoxCapsuleFeatures(plane.pos, plane.rot, ZMath::Vec3D(h.x, h.y, 0.0f), capsule);
+    };
 
-        // ? check if there is another axis better than A's x axis by checking if the penetration along
-        // ?  the current axis being checked is greater than that of the current penetration
-        // ?  (as greater value = less negative = less penetration).
+    inline static CollisionManifold findCollisionFeatures(AABB const &aabb, Capsule const &capsule) {
+        return findBoxCapsuleFeatures(aabb.pos, ZMath::Mat3D(1, 0, 0, 0, 1, 0, 0, 0, 1), aabb.getHalfSize(), capsule);
+    };
 
-        // A's remaining axes
-        if (faceA.y > relativeTol * separation + absoluteTol * hA.y) {
-            axis = FACE_A_Y;
-            separation = faceA.y;
-            result.normal = dP.y > 0.0f ? ZMath::Vec3D(0, 1, 0) : ZMath::Vec3D(0, -1, 0);
-        }
+    inline static CollisionManifold findCollisionFeatures(Cube const &cube, Capsule const &capsule) {
+        return findBoxCapsuleFeatures(cube.pos, cube.rot, cube.getHalfSize(), capsule);
+    };
 
-        if (faceA.z > relativeTol * separation + absoluteTol * hA.z) {
-            axis = FACE_A_Z;
-            separation = faceA.z;
-            result.normal = dP.z > 0.0f ? ZMath::Vec3D(0, 0, 1) : ZMath::Vec3D(0, 0, -1);
-        }
+    inline static CollisionManifold findCollisionFeatures(Heightfield const &hf, Capsule const &capsule) {
+        CollisionManifold result;
 
-        // * Setup clipping plane data based on the best axis
+        // ? Collide a sphere at each end of the capsule with the heightfield.
+        // ? If neither end touches, the middle of the capsule may still rest on a ridge so we use the closest point between the segment and the surface.
 
-        ZMath::Vec3D sideNormal1, sideNormal2;
-        ZMath::Vec3D incidentFace[4]; // 4 vertices for the collision in 3D
-        float front, negSide1, negSide2, posSide1, posSide2;
+        ZMath::Vec3D ends[2] = {capsule.getStart(), capsule.getEnd()};
+        ZMath::Vec3D contactPoints[8];
+        int np = 0;
 
-        // * Compute the clipping lines and line segment to be clipped
+        result.normal = ZMath::Vec3D();
+        result.pDist = 0.0f;
 
-        switch(axis) {
-            case FACE_A_X: {
-                front = aabb1.pos * result.normal + hA.x;
-                sideNormal1 = ZMath::Vec3D(0, 1, 0); // yNormal
-                sideNormal2 = ZMath::Vec3D(0, 0, 1); // zNormal
+        for (int i = 0; i < 2; ++i) {
+            Manifold manifold = findCollisionFeatures(hf, Sphere(ends[i], capsule.r));
+            if (!manifold.hit) { continue; }
 
-                negSide1 = aabb1.pos.y - hA.y; // negSideY
-                posSide1 = aabb1.pos.y + hA.y; // posSideY
-                negSide2 = aabb1.pos.z - hA.z; // negSideZ
-                posSide2 = aabb1.pos.z + hA.z; // posSideZ
+            result.normal += manifold.normal * manifold.pDist;
+            if (manifold.pDist > result.pDist) { result.pDist = manifold.pDist; }
 
-                computeIncidentFaceAABB(incidentFace, hB, aabb2.pos, result.normal);
-                break;
-            }
+            for (int j = 0; j < manifold.numPoints; ++j) { contactPoints[np++] = manifold.contactPoints[j]; }
+            delete[] manifold.contactPoints;
+        }
 
-            case FACE_A_Y: {
-                front = aabb1.pos * result.normal + hA.y;
-                sideNormal1 = ZMath::Vec3D(1, 0, 0); // xNormal
-                sideNormal2 = ZMath::Vec3D(0, 0, 1); // zNormal
+        if (np) {
+            result.hit = 1;
+            result.normal = result.normal.magSq() ? result.normal.normalize() : ZMath::Vec3D(0, 0, 1);
+            result.numPoints = np;
+            result.contactPoints = new ZMath::Vec3D[np];
 
-                negSide1 = aabb1.pos.x - hA.x; // negSideX
-                posSide1 = aabb1.pos.x + hA.x; // posSideX
-                negSide2 = aabb1.pos.z - hA.z; // negSideZ
-                posSide2 = aabb1.pos.z + hA.z; // posSideZ
+            for (int i = 0; i < np; ++i) { result.contactPoints[i] = contactPoints[i]; }
 
-                computeIncidentFaceAABB(incidentFace, hB, aabb2.pos, result.normal);
-                break;
-            }
+            return result;
+        }
 
-            case FACE_A_Z: {
-                front = aabb1.pos * result.normal + hA.z;
-                sideNormal1 = ZMath::Vec3D(1, 0, 0); // xNormal
-                sideNormal2 = ZMath::Vec3D(0, 1, 0); // yNormal
+        // the middle of the capsule
+        uint32_t cx0, cy0, cx1, cy1;
+        float maxZ;
 
-                negSide1 = aabb1.pos.x - hA.x; // negSideX
-                posSide1 = aabb1.pos.x + hA.x; // posSideX
-                negSide2 = aabb1.pos.y - hA.y; // negSideY
-                posSide2 = aabb1.pos.y + hA.y; // posSideY
+        ZMath::Vec3D min = capsule.getMin(), max = capsule.getMax();
+        result.hit = hf.getCellRange(min, max, cx0, cy0, cx1, cy1) && hf.getMaxHeight(cx0, cy0, cx1, cy1, maxZ) && min.z <= maxZ;
 
-                computeIncidentFaceAABB(incidentFace, hB, aabb2.pos, result.normal);
-                break;
+        if (!result.hit) { return result; }
+
+        float best = capsule.r*capsule.r;
+        ZMath::Vec3D v[4], onSeg, onTri, closestSeg, closestTri;
+
+        result.hit = 0;
+
+        for (uint32_t cy = cy0; cy <= cy1; ++cy) {
+            for (uint32_t cx = cx0; cx <= cx1; ++cx) {
+                if (!hf.getCellVertices(cx, cy, v)) { continue; }
+
+                for (int i = 0; i < 2; ++i) {
+                    float dSq = i ? closestPointsSegmentTriangle(ends[0], ends[1], v[0], v[3], v[2], onSeg, onTri)
+                                  : closestPointsSegmentTriangle(ends[0], ends[1], v[0], v[1], v[3], onSeg, onTri);
+
+                    if (dSq <= best) {
+                        best = dSq;
+                        closestSeg = onSeg;
+                        closestTri = onTri;
+                        result.hit = 1;
+                    }
+                }
             }
         }
 
-        // * Clip the incident edge with box planes.
+        if (!result.hit) { return result; }
 
-        ZMath::Vec3D clipPoints1[4];
-        ZMath::Vec3D clipPoints2[4];
+        float d = sqrtf(best);
 
-        // Clip to side 1
-        int np = clipSegmentToLine(clipPoints1, incidentFace, -sideNormal1, -sideNormal2, negSide1, negSide2);
+        result.pDist = capsule.r - d;
+        result.normal = d ? (closestSeg - closestTri) * (1.0f/d) : ZMath::Vec3D(0, 0, 1);
+        result.numPoints = 1;
+        result.contactPoints = new ZMath::Vec3D[1];
+        result.contactPoints[0] = closestTri;
 
-        if (np < 4) {
-            result.hit = 0;
-            return result;
-        }
+        return result;
+    };
 
-        // Clip to the negative side 1
-        np = clipSegmentToLine(clipPoints2, clipPoints1, sideNormal1, sideNormal2, posSide1, posSide2);
+    // * ====================================================
+    // * Compound Collision Manifolds
+    // * ====================================================
 
-        if (np < 4) {
-            result.hit = 0;
-            return result;
-        }
+    // Max number of contact points kept when merging the manifolds of a compound's children.
+    #define COMPOUND_MAX_CONTACTS 16
 
-        // * ClipPoints2 now contains the clipping points.
-        // * Compute the contact points.
-        
-        // store the conatct points in here and add them to the dynamic array after they are determined
-        ZMath::Vec3D contactPoints[4];
-        np = 0;
-        result.pDist = 0.0f;
+    // Max number of overlapping children (or pairs of children) checked in a single compound collision.
+    #define COMPOUND_MAX_PAIRS 64
 
-        for (int i = 0; i < 4; ++i) {
-            separation = result.normal * clipPoints2[i] - front;
+    // ? Compound colliders dispatch each of their overlapping children back through the regular collider dispatch.
+    // ? These are declared here as the dispatch for compounds and their children depend on each other.
 
-            if (separation <= 0) {
-                contactPoints[np++] = clipPoints2[i] - result.normal * separation;
-                if (result.pDist < separation) { result.pDist = separation; }
-            }
-        }
+    inline static CollisionManifold findCollisionFeatures(RigidBodyCollider type1, void* collider1, RigidBodyCollider type2, void* collider2);
+    inline static CollisionManifold findCollisionFeatures(StaticBodyCollider sType, void* sCollider, RigidBodyCollider rType, void* rCollider);
 
-        // * update the manifold to contain the results.
+    // Merge the manifold of a pair of children into the manifold for the whole compound.
+    // The child's contact points are freed.
+    inline static void mergeCompoundManifold(CollisionManifold &result, ZMath::Vec3D contactPoints[COMPOUND_MAX_CONTACTS], CollisionManifold &manifold) {
+        if (!manifold.hit) { return; }
+
+        // weight the normals by penetration so the deepest contacts dominate
+        result.normal += manifold.normal * manifold.pDist;
+        if (manifold.pDist > result.pDist) { result.pDist = manifold.pDist; }
+
+        for (int i = 0; i < manifold.numPoints && result.numPoints < COMPOUND_MAX_CONTACTS; ++i) {
+            contactPoints[result.numPoints++] = manifold.contactPoints[i];
+        }
 
-        result.pDist = -result.pDist;
         result.hit = 1;
-        result.numPoints = np;
-        result.contactPoints = new ZMath::Vec3D[np];
+        delete[] manifold.contactPoints;
+    };
+
+    // Finish building the manifold for a compound once all of its children have been merged.
+    inline static CollisionManifold finalizeCompoundManifold(CollisionManifold &result, ZMath::Vec3D contactPoints[COMPOUND_MAX_CONTACTS]) {
+        if (!result.hit) { return {ZMath::Vec3D(), nullptr, -1.0f, 0, 0}; }
+
+        // all of the contacts are exactly touching
+        if (result.normal.magSq() == 0.0f) { result.normal = ZMath::Vec3D(0, 0, 1); }
+        else { result.normal = result.normal.normalize(); }
+
+        result.contactPoints = new ZMath::Vec3D[result.numPoints];
+        for (int i = 0; i < result.numPoints; ++i) { result.contactPoints[i] = contactPoints[i]; }
 
-        for (int i = 0; i < np; ++i) { result.contactPoints[i] = contactPoints[i]; }
-        
         return result;
     };
 
-    // ? Normal points towards B and away from A
+    // Find the collision features between a compound and another collider which can be attached to a rigidbody.
+    // The normal points towards the other collider.
+    inline static CollisionManifold findCollisionFeatures(Compound const &compound, RigidBodyCollider type, void* collider) {
+        CollisionManifold result = {ZMath::Vec3D(), nullptr, 0.0f, 0, 0};
+        ZMath::Vec3D contactPoints[COMPOUND_MAX_CONTACTS];
+        ZMath::Vec3D min, max;
 
-    static CollisionManifold findCollisionFeatures(AABB const &aabb, Cube const &cube) {
-        CollisionManifold result;
+        if (!getBounds(type, collider, min, max)) { return {ZMath::Vec3D(), nullptr, -1.0f, 0, 0}; }
 
-        // half size of a and b respectively
-        ZMath::Vec3D hA = aabb.getHalfSize(), hB = cube.getHalfSize();
+        int children[COMPOUND_MAX_PAIRS];
+        int n = compound.query(min, max, children, COMPOUND_MAX_PAIRS);
 
-        // * determine the rotation matrices of A and B
-        // * global space is A's local space so we do not need a rotation matrix for it
+        for (int i = 0; i < n; ++i) {
+            CompoundChild const &child = compound.children[children[i]];
+            Manifold manifold = findCollisionFeatures(child.type, child.collider, type, collider);
+            mergeCompoundManifold(result, contactPoints, manifold);
+        }
 
-        // rotate anything from gobal space to B's local space
-        ZMath::Mat3D rotBT = cube.rot.transpose();
+        return finalizeCompoundManifold(result, contactPoints);
+    };
 
-        // determine the difference between the positions
-        ZMath::Vec3D dA = cube.pos - aabb.pos;
-        ZMath::Vec3D dB = rotBT * dA;
+    // Find the collision features between two compounds. Only children whose bounds overlap are checked.
+    // The normal points towards the second compound.
+    inline static CollisionManifold findCollisionFeatures(Compound const &compound1, Compound const &compound2) {
+        CollisionManifold result = {ZMath::Vec3D(), nullptr, 0.0f, 0, 0};
+        ZMath::Vec3D contactPoints[COMPOUND_MAX_CONTACTS];
 
-        // * Check for intersections with the separating axis theorem
+        int pairs[COMPOUND_MAX_PAIRS][2];
+        int n = compound1.queryPairs(compound2, pairs, COMPOUND_MAX_PAIRS);
 
-        // amount of penetration along A's axes
-        ZMath::Vec3D faceA = ZMath::abs(dA) - hA - hB;
-        if (faceA.x > 0 || faceA.y > 0 || faceA.z > 0) {
-            result.hit = 0;
-            return result;
-        }
+        for (int i = 0; i < n; ++i) {
+            CompoundChild const &child1 = compound1.children[pairs[i][0]];
+            CompoundChild const &child2 = compound2.children[pairs[i][1]];
 
-        // amount of penetration along B's axes
-        ZMath::Vec3D faceB = ZMath::abs(dB) - hB - rotBT * hA;
-        if (faceB.x > 0 || faceB.y > 0 || faceB.z > 0) {
-            result.hit = 0;
-            return result;
+            Manifold manifold = findCollisionFeatures(child1.type, child1.collider, child2.type, child2.collider);
+            mergeCompoundManifold(result, contactPoints, manifold);
         }
 
-        // * Find the best axis (i.e. the axis with the least amount of penetration).
-
-        // Assume A's x-axis is the best axis first
-        Axis axis = FACE_A_X;
-        float separation = faceA.x;
-        result.normal = dA.x > 0.0f ? ZMath::Vec3D(1, 0, 0) : ZMath::Vec3D(-1, 0, 0);
+        return finalizeCompoundManifold(result, contactPoints);
+    };
 
-        // tolerance values
-        float relativeTol = 0.95f;
-        float absoluteTol = 0.01f;
+    // Find the collision features between a collider which can be attached to a staticbody and a compound.
+    // The normal points towards the compound.
+    inline static CollisionManifold findCollisionFeatures(StaticBodyCollider sType, void* sCollider, Compound const &compound) {
+        CollisionManifold result = {ZMath::Vec3D(), nullptr, 0.0f, 0, 0};
+        ZMath::Vec3D contactPoints[COMPOUND_MAX_CONTACTS];
+        ZMath::Vec3D min, max;
 
-        // ? check if there is another axis better than A's x axis by checking if the penetration along
-        // ?  the current axis being checked is greater than that of the current penetration
-        // ?  (as greater value = less negative = less penetration).
+        if (!getBounds(sType, sCollider, min, max)) { return {ZMath::Vec3D(), nullptr, -1.0f, 0, 0}; }
 
-        // A's remaining axes
-        if (faceA.y > relativeTol * separation + absoluteTol * hA.y) {
-            axis = FACE_A_Y;
-            separation = faceA.y;
-            result.normal = dA.y > 0.0f ? ZMath::Vec3D(0, 1, 0) : ZMath::Vec3D(0, -1, 0);
-        }
+        int children[COMPOUND_MAX_PAIRS];
+        int n = compound.query(min, max, children, COMPOUND_MAX_PAIRS);
 
-        if (faceA.z > relativeTol * separation + absoluteTol * hA.z) {
-            axis = FACE_A_Z;
-            separation = faceA.z;
-            result.normal = dA.z > 0.0f ? ZMath::Vec3D(0, 0, 1) : ZMath::Vec3D(0, 0, -1);
+        for (int i = 0; i < n; ++i) {
+            CompoundChild const &child = compound.children[children[i]];
+            Manifold manifold = findCollisionFeatures(sType, sCollider, child.type, child.collider);
+            mergeCompoundManifold(result, contactPoints, manifold);
         }
 
-        // B's axes
-        if (faceB.x > relativeTol * separation + absoluteTol * hB.x) {
-            axis = FACE_B_X;
-            separation = faceB.x;
-            result.normal = dB.x > 0.0f ? cube.rot.c1 : -cube.rot.c1;
-        }
+        return finalizeCompoundManifold(result, contactPoints);
+    };
 
-        if (faceB.y > relativeTol * separation + absoluteTol * hB.y) {
-            axis = FACE_B_Y;
-            separation = faceB.y;
-            result.normal = dB.y > 0.0f ? cube.rot.c2 : -cube.rot.c2;
+    /**
+     * @brief Find the collision features between two colliders that can be attached to rigidbodies.
+     * The collision normal will point towards the second collider and away from the first.
+     *
+     * @param type1 The type of the first collider.
+     * @param collider1 The first collider.
+     * @param type2 The type of the second collider.
+     * @param collider2 The second collider.
+     * @return (CollisionManifold) The collision features.
+     */
+    inline static CollisionManifold findCollisionFeatures(RigidBodyCollider type1, void* collider1, RigidBodyCollider type2, void* collider2) {
+        // compounds can collide with any other collider so handle them first
+        if (type1 == RIGID_COMPOUND_COLLIDER) {
+            if (type2 == RIGID_COMPOUND_COLLIDER) { return findCollisionFeatures(*((Compound*) collider1), *((Compound*) collider2)); }
+            return findCollisionFeatures(*((Compound*) collider1), type2, collider2);
         }
 
-        if (faceB.z > relativeTol * separation + absoluteTol * hB.z) {
-            axis = FACE_B_Z;
-            separation = faceB.z;
-            result.normal = dB.z > 0.0f ? cube.rot.c3 : -cube.rot.c3;
+        if (type2 == RIGID_COMPOUND_COLLIDER) {
+            Manifold manifold = findCollisionFeatures(*((Compound*) collider2), type1, collider1);
+            manifold.normal = -manifold.normal; // flip the direction as the original order passed in was reversed
+            return manifold;
         }
 
-        // * Setup clipping plane data based on the best axis
+        switch (type1) {
+            case RIGID_SPHERE_COLLIDER: {
+                if (type2 == RIGID_SPHERE_COLLIDER) { return findCollisionFeatures(*((Sphere*) collider1), *((Sphere*) collider2)); }
+                if (type2 == RIGID_AABB_COLLIDER) { return findCollisionFeatures(*((Sphere*) collider1), *((AABB*) collider2)); }
+                if (type2 == RIGID_CUBE_COLLIDER) { return findCollisionFeatures(*((Sphere*) collider1), *((Cube*) collider2)); }
 
-        ZMath::Vec3D sideNormal1, sideNormal2;
-        ZMath::Vec3D incidentFace[4]; // 4 vertices for the collision in 3D
-        float front, negSide1, negSide2, posSide1, posSide2;
+                if (type2 == RIGID_CAPSULE_COLLIDER) {
+                    Manifold manifold = findCollisionFeatures(*((Capsule*) collider2), *((Sphere*) collider1));
+                    manifold.normal = -manifold.normal; // flip the direction as the original order passed in was reversed
+                    return manifold;
+                }
 
-        // * Compute the clipping lines and line segment to be clipped
+                break;
+            }
 
-        switch(axis) {
-            case FACE_A_X: {
-                front = aabb.pos * result.normal + hA.x;
-                sideNormal1 = ZMath::Vec3D(0, 1, 0); // yNormal
-                sideNormal2 = ZMath::Vec3D(0, 0, 1); // zNormal
+            case RIGID_AABB_COLLIDER: {
+                if (type2 == RIGID_SPHERE_COLLIDER) {
+                    Manifold manifold = findCollisionFeatures(*((Sphere*) collider2), *((AABB*) collider1));
+                    manifold.normal = -manifold.normal; // flip the direction as the original order passed in was reversed
+                    return manifold;
+                }
 
-                negSide1 = aabb.pos.y - hA.y; // negSideY
-                posSide1 = aabb.pos.y + hA.y; // posSideY
-                negSide2 = aabb.pos.z - hA.z; // negSideZ
-                posSide2 = aabb.pos.z + hA.z; // posSideZ
+                if (type2 == RIGID_AABB_COLLIDER) { return findCollisionFeatures(*((AABB*) collider1), *((AABB*) collider2)); }
+                if (type2 == RIGID_CUBE_COLLIDER) { return findCollisionFeatures(*((AABB*) collider1), *((Cube*) collider2)); }
+                if (type2 == RIGID_CAPSULE_COLLIDER) { return findCollisionFeatures(*((AABB*) collider1), *((Capsule*) collider2)); }
 
-                computeIncidentFace(incidentFace, hB, cube.pos, cube.rot, result.normal);
                 break;
             }
 
-            case FACE_A_Y: {
-                front = aabb.pos * result.normal + hA.y;
-                sideNormal1 = ZMath::Vec3D(1, 0, 0); // xNormal
-                sideNormal2 = ZMath::Vec3D(0, 0, 1); // zNormal
+            case RIGID_CUBE_COLLIDER: {
+                if (type2 == RIGID_SPHERE_COLLIDER) {
+                    Manifold manifold = findCollisionFeatures(*((Sphere*) collider2), *((Cube*) collider1));
+                    manifold.normal = -manifold.normal; // flip the direction as the original order passed in was reversed
+                    return manifold;
+                }
 
-                negSide1 = aabb.pos.x - hA.x; // negSideX
-                posSide1 = aabb.pos.x + hA.x; // posSideX
-                negSide2 = aabb.pos.z - hA.z; // negSideZ
-                posSide2 = aabb.pos.z + hA.z; // posSideZ
+                if (type2 == RIGID_AABB_COLLIDER) {
+                    Manifold manifold = findCollisionFeatures(*((AABB*) collider2), *((Cube*) collider1));
+                    manifold.normal = -manifold.normal; // flip the direction as the original order passed in was reversed
+                    return manifold;
+                }
+
+                if (type2 == RIGID_CUBE_COLLIDER) { return findCollisionFeatures(*((Cube*) collider1), *((Cube*) collider2)); }
+                if (type2 == RIGID_CAPSULE_COLLIDER) { return findCollisionFeatures(*((Cube*) collider1), *((Capsule*) collider2)); }
 
-                computeIncidentFace(incidentFace, hB, cube.pos, cube.rot, result.normal);
                 break;
             }
 
-            case FACE_A_Z: {
-                front = aabb.pos * result.normal + hA.z;
-                sideNormal1 = ZMath::Vec3D(1, 0, 0); // xNormal
-                sideNormal2 = ZMath::Vec3D(0, 1, 0); // yNormal
+            case RIGID_CAPSULE_COLLIDER: {
+                if (type2 == RIGID_SPHERE_COLLIDER) { return findCollisionFeatures(*((Capsule*) collider1), *((Sphere*) collider2)); }
+
+                if (type2 == RIGID_AABB_COLLIDER) {
+                    Manifold manifold = findCollisionFeatures(*((AABB*) collider2), *((Capsule*) collider1));
+                    manifold.normal = -manifold.normal; // flip the direction as the original order passed in was reversed
+                    return manifold;
+                }
+
+                if (type2 == RIGID_CUBE_COLLIDER) {
+                    Manifold manifold = findCollisionFeatures(*((Cube*) collider2), *((Capsule*) collider1));
+                    manifold.normal = -manifold.normal; // flip the direction as the original order passed in was reversed
+                    return manifold;
+                }
 
-                negSide1 = aabb.pos.x - hA.x; // negSideX
-                posSide1 = aabb.pos.x + hA.x; // posSideX
-                negSide2 = aabb.pos.y - hA.y; // negSideY
-                posSide2 = aabb.pos.y + hA.y; // posSideY
+                if (type2 == RIGID_CAPSULE_COLLIDER) { return findCollisionFeatures(*((Capsule*) collider1), *((Capsule*) collider2)); }
 
-                computeIncidentFace(incidentFace, hB, cube.pos, cube.rot, result.normal);
                 break;
             }
 
-            case FACE_B_X: {
-                front = cube.pos * result.normal + hB.x;
-                sideNormal1 = cube.rot.c2; // yNormal
-                sideNormal2 = cube.rot.c3; // zNormal
-                float ySide = cube.pos * sideNormal1;
-                float zSide = cube.pos * sideNormal2;
+            // * User defined types go here.
+
+            default: { break; }
+        }
+
+        return {ZMath::Vec3D(), nullptr, -1.0f, 0, 0};
+    };
+
+    // Find the collision features and resolve the impulse between two rigidbodies.
+    inline static CollisionManifold findCollisionFeatures(RigidBody3D* rb1, RigidBody3D* rb2) {
+        return findCollisionFeatures(rb1->colliderType, rb1->collider, rb2->colliderType, rb2->collider);
+    };
 
-                negSide1 = -ySide + hB.y; // negSideY
-                posSide1 = ySide + hB.y; // posSideY
-                negSide2 = -zSide + hB.z; // negSideZ
-                posSide2 = zSide + hB.z; // posSideZ
+    /**
+     * @brief Find the collision features between a collider that can be attached to a staticbody and one that can be attached to a rigidbody.
+     * The collision normal will point towards the rigid collider and away from the static collider.
+     *
+     * @param sType The type of the static collider.
+     * @param sCollider The static collider.
+     * @param rType The type of the rigid collider.
+     * @param rCollider The rigid collider.
+     * @return (CollisionManifold) The collision features.
+     */
+    inline static CollisionManifold findCollisionFeatures(StaticBodyCollider sType, void* sCollider, RigidBodyCollider rType, void* rCollider) {
+        // ? The normal points towards B and away from A so we want to pass the rigid body's colliders second.
+
+        if (rType == RIGID_COMPOUND_COLLIDER) { return findCollisionFeatures(sType, sCollider, *((Compound*) rCollider)); }
+
+        switch (sType) {
+            case STATIC_PLANE_COLLIDER: {
+                switch (rType) {
+                    case RIGID_SPHERE_COLLIDER: { return findCollisionFeatures(*((Plane*) sCollider), *((Sphere*) rCollider)); }
+                    case RIGID_AABB_COLLIDER: { return findCollisionFeatures(*((Plane*) sCollider), *((AABB*) rCollider)); }
+                    case RIGID_CUBE_COLLIDER: { return findCollisionFeatures(*((Plane*) sCollider), *((Cube*) rCollider)); }
+                    case RIGID_CAPSULE_COLLIDER: { return findCollisionFeatures(*((Plane*) sCollider), *((Capsule*) rCollider)); }
+                    default: { break; }
+                }
 
-                computeIncidentFaceAABB(incidentFace, hA, aabb.pos, result.normal);
                 break;
             }
 
-            case FACE_B_Y: {
-                front = cube.pos * result.normal + hB.y;
-                sideNormal1 = cube.rot.c1; // xNormal
-                sideNormal2 = cube.rot.c3; // zNormal
-                float xSide = cube.pos * sideNormal1;
-                float zSide = cube.pos * sideNormal2;
+            case STATIC_SPHERE_COLLIDER: {
+                switch (rType) {
+                    case RIGID_SPHERE_COLLIDER: { return findCollisionFeatures(*((Sphere*) sCollider), *((Sphere*) rCollider)); }
+                    case RIGID_AABB_COLLIDER: { return findCollisionFeatures(*((Sphere*) sCollider), *((AABB*) rCollider)); }
+                    case RIGID_CUBE_COLLIDER: { return findCollisionFeatures(*((Sphere*) sCollider), *((Cube*) rCollider)); }
 
-                negSide1 = -xSide + hB.x; // negSideX
-                posSide1 = xSide + hB.x; // posSideX
-                negSide2 = -zSide + hB.z; // negSideZ
-                posSide2 = zSide + hB.z; // posSideZ
+                    case RIGID_CAPSULE_COLLIDER: {
+                        Manifold manifold = findCollisionFeatures(*((Capsule*) rCollider), *((Sphere*) sCollider));
+                        manifold.normal = -manifold.normal; // flip the direction as the original order passed in was reversed
+                        return manifold;
+                    }
+                    default: { break; }
+                }
 
-                computeIncidentFaceAABB(incidentFace, hA, aabb.pos, result.normal);
                 break;
             }
 
-            case FACE_B_Z: {
-                front = cube.pos * result.normal + hB.z;
-                sideNormal1 = cube.rot.c1; // xNormal
-                sideNormal2 = cube.rot.c2; // yNormal
-                float xSide = cube.pos * sideNormal1;
-                float ySide = cube.pos * sideNormal2;
+            case STATIC_AABB_COLLIDER: {
+                switch (rType) {
+                    case RIGID_SPHERE_COLLIDER: {
+                        Manifold manifold = findCollisionFeatures(*((Sphere*) rCollider), *((AABB*) sCollider));
+                        manifold.normal = -manifold.normal; // flip the direction as the original order passed in was reversed
+                        return manifold;
+                    }
 
-                negSide1 = -xSide + hB.x; // negSideX
-                posSide1 = xSide + hB.x; // posSideX
-                negSide2 = -ySide + hB.y; // negSideY
-                posSide2 = ySide + hB.y; // posSideY
+                    case RIGID_AABB_COLLIDER: { return findCollisionFeatures(*((AABB*) sCollider), *((AABB*) rCollider)); }
+                    case RIGID_CUBE_COLLIDER: { return findCollisionFeatures(*((AABB*) sCollider), *((Cube*) rCollider)); }
+                    case RIGID_CAPSULE_COLLIDER: { return findCollisionFeatures(*((AABB*) sCollider), *((Capsule*) rCollider)); }
+                    default: { break; }
+                }
 
-                computeIncidentFaceAABB(incidentFace, hA, aabb.pos, result.normal);
                 break;
             }
-        }
 
-        // * Clip the incident edge with box planes.
+            case STATIC_CUBE_COLLIDER: {
+                switch (rType) {
+                    case RIGID_SPHERE_COLLIDER: {
+                        Manifold manifold = findCollisionFeatures(*((Sphere*) rCollider), *((Cube*) sCollider));
+                        manifold.normal = -manifold.normal; // flip the direction as the original order passed in was reversed
+                        return manifold;
+                    }
 
-        ZMath::Vec3D clipPoints1[4];
-        ZMath::Vec3D clipPoints2[4];
+                    case RIGID_AABB_COLLIDER: {
+                        Manifold manifold = findCollisionFeatures(*((AABB*) rCollider), *((Cube*) sCollider));
+                        manifold.normal = -manifold.normal; // flip the direction as the original order passed in was reversed
+                        return manifold;
+                    }
 
-        // Clip to side 1
-        int np = clipSegmentToLine(clipPoints1, incidentFace, -sideNormal1, -sideNormal2, negSide1, negSide2);
+                    case RIGID_CUBE_COLLIDER: { return findCollisionFeatures(*((Cube*) sCollider), *((Cube*) rCollider)); }
+                    case RIGID_CAPSULE_COLLIDER: { return findCollisionFeatures(*((Cube*) sCollider), *((Capsule*) rCollider)); }
+                    default: { break; }
+                }
 
-        if (np < 4) {
-            result.hit = 0;
-            return result;
-        }
+                break;
+            }
 
-        // Clip to the negative side 1
-        np = clipSegmentToLine(clipPoints2, clipPoints1, sideNormal1, sideNormal2, posSide1, posSide2);
+            case STATIC_HEIGHTFIELD_COLLIDER: {
+                switch (rType) {
+                    case RIGID_SPHERE_COLLIDER: { return findCollisionFeatures(*((Heightfield*) sCollider), *((Sphere*) rCollider)); }
+                    case RIGID_AABB_COLLIDER: { return findCollisionFeatures(*((Heightfield*) sCollider), *((AABB*) rCollider)); }
+                    case RIGID_CUBE_COLLIDER: { return findCollisionFeatures(*((Heightfield*) sCollider), *((Cube*) rCollider)); }
+                    case RIGID_CAPSULE_COLLIDER: { return findCollisionFeatures(*((Heightfield*) sCollider), *((Capsule*) rCollider)); }
+                    default: { break; }
+                }
 
-        if (np < 4) {
-            result.hit = 0;
-            return result;
-        }
+                break;
+            }
 
-        // * ClipPoints2 now contains the clipping points.
-        // * Compute the contact points.
-        
-        // store the conatct points in here and add them to the dynamic array after they are determined
-        ZMath::Vec3D contactPoints[4];
-        np = 0;
-        result.pDist = 0.0f;
+            case STATIC_CAPSULE_COLLIDER: {
+                switch (rType) {
+                    case RIGID_SPHERE_COLLIDER: { return findCollisionFeatures(*((Capsule*) sCollider), *((Sphere*) rCollider)); }
 
-        for (int i = 0; i < 4; ++i) {
-            separation = result.normal * clipPoints2[i] - front;
+                    case RIGID_AABB_COLLIDER: {
+                        Manifold manifold = findCollisionFeatures(*((AABB*) rCollider), *((Capsule*) sCollider));
+                        manifold.normal = -manifold.normal; // flip the direction as the original order passed in was reversed
+                        return manifold;
+                    }
 
-            if (separation <= 0) {
-                contactPoints[np++] = clipPoints2[i] - result.normal * separation;
-                if (result.pDist < separation) { result.pDist = separation; }
+                    case RIGID_CUBE_COLLIDER: {
+                        Manifold manifold = findCollisionFeatures(*((Cube*) rCollider), *((Capsule*) sCollider));
+                        manifold.normal = -manifold.normal; // flip the direction as the original order passed in was reversed
+                        return manifold;
+                    }
+
+                    case RIGID_CAPSULE_COLLIDER: { return findCollisionFeatures(*((Capsule*) sCollider), *((Capsule*) rCollider)); }
+                    default: { break; }
+                }
+
+                break;
             }
-        }
 
-        // * update the manifold to contain the results.
+            case STATIC_CUSTOM_COLLIDER: {
+                // * User defined types go here.
+                break;
+            }
 
-        result.pDist = -result.pDist;
-        result.hit = 1;
-        result.numPoints = np;
-        result.contactPoints = new ZMath::Vec3D[np];
+            default: { break; }
+        }
 
-        for (int i = 0; i < np; ++i) { result.contactPoints[i] = contactPoints[i]; }
-        
-        return result;
+        return {ZMath::Vec3D(), nullptr, -1.0f, 0, 0};
     };
 
-    // ? Normal points towards B and away from A.
+    // Find the collision features and resolve the impulse between a staticbody and a rigidbody.
+    // The collision normal will point towards the rigid body and away from the static body.
+    inline static CollisionManifold findCollisionFeatures(StaticBody3D* sb, RigidBody3D* rb) {
+        return findCollisionFeatures(sb->colliderType, sb->collider, rb->colliderType, rb->collider);
+    };
 
-    static CollisionManifold findCollisionFeatures(Cube const &cube1, Cube const &cube2) {
-        CollisionManifold result;
+    // * ====================================================
+    // * Speculative Contacts
+    // * ====================================================
 
-        // half size of cube a and b respectively
-        ZMath::Vec3D hA = cube1.getHalfSize(), hB = cube2.getHalfSize();
+    // ? A speculative contact is generated for bodies which are not touching yet, but could touch within the next step.
+    // ? These have a negative pDist equal to the gap between the bodies.
+    // ? The solver allows the bodies to close the gap, but removes any velocity which would cause them to overlap.
+    // ? This is cheaper than CCD and keeps contacts stable at larger time steps.
 
-        // * determine the rotation matrices of A and B
+    // Check if the bounds of a collider swept by disp could overlap the bounds of another collider.
+    inline static bool boundsInReach(ZMath::Vec3D const &min1, ZMath::Vec3D const &max1, ZMath::Vec3D const &min2, ZMath::Vec3D const &max2, ZMath::Vec3D const &disp) {
+        return min1.x <= max2.x + ZMath::max(disp.x, 0.0f) && max1.x >= min2.x + ZMath::min(disp.x, 0.0f) &&
+               min1.y <= max2.y + ZMath::max(disp.y, 0.0f) && max1.y >= min2.y + ZMath::min(disp.y, 0.0f) &&
+               min1.z <= max2.z + ZMath::max(disp.z, 0.0f) && max1.z >= min2.z + ZMath::min(disp.z, 0.0f);
+    };
 
-        // rotate anything from global space to A's local space
-        ZMath::Mat3D rotAT = cube1.rot.transpose();
+    // Turn the manifold of a collision found after moving B by disp into a speculative contact for B's original position.
+    inline static void makeSpeculative(CollisionManifold &manifold, ZMath::Vec3D const &disp) {
+        // ? B closes the gap between the bodies by -(disp * normal) as the normal points towards B.
+        // ? What is left over is the penetration found after moving it.
+        float gap = -(disp * manifold.normal) - manifold.pDist;
 
-        // rotate anything from gobal space to B's local space
-        ZMath::Mat3D rotBT = cube2.rot.transpose();
+        manifold.pDist = -ZMath::max(gap, 0.0f);
+        for (int i = 0; i < manifold.numPoints; ++i) { manifold.contactPoints[i] -= disp; }
+    };
 
-        // determine the difference between the positions
-        ZMath::Vec3D dP = cube2.pos - cube1.pos;
-        ZMath::Vec3D dA = rotAT * dP;
-        ZMath::Vec3D dB = rotBT * dP;
+    /**
+     * @brief Find a speculative contact between two rigidbodies which do not currently intersect.
+     * This should be called after their velocities have been updated for the step.
+     *
+     * @param rb1 The first rigidbody.
+     * @param rb2 The second rigidbody.
+     * @param dt The length of the step.
+     * @return (CollisionManifold) The speculative contact. hit will be 0 if the bodies cannot touch within the step.
+     *          The normal points towards rb2 and pDist is the negative of the gap between the bodies.
+     */
+    inline static CollisionManifold findSpeculativeFeatures(RigidBody3D* rb1, RigidBody3D* rb2, float dt) {
+        ZMath::Vec3D disp = (rb2->vel - rb1->vel) * dt;
+        ZMath::Vec3D min1, max1, min2, max2;
 
-        // * rotation matrices for switching between local spaces
+        if (!disp.magSq() || !getBounds(rb1->colliderType, rb1->collider, min1, max1) || !getBounds(rb2->colliderType, rb2->collider, min2, max2)
+            || !boundsInReach(min1, max1, min2, max2, disp)) {
+            return {ZMath::Vec3D(), nullptr, -1.0f, 0, 0};
+        }
 
-        // ! When scenes are developed test if we actually need the absolute value
+        // check where rb2 will be relative to rb1 at the end of the step
+        ZMath::Vec3D pos = rb2->pos;
+        rb2->pos += disp;
+        rb2->syncCollider();
 
-        // Rotate anything from B's local space into A's
-        ZMath::Mat3D C = ZMath::abs(rotAT * cube2.rot);
+        CollisionManifold manifold = findCollisionFeatures(rb1, rb2);
 
-        // Rotate anything from A's local space into B's
-        ZMath::Mat3D CT = C.transpose();
+        rb2->pos = pos;
+        rb2->syncCollider();
 
-        // * Check for intersections with the separating axis theorem
+        if (manifold.hit) { makeSpeculative(manifold, disp); }
+        return manifold;
+    };
 
-        // amount of penetration along A's axes
-        ZMath::Vec3D faceA = ZMath::abs(dA) - hA - C * hB;
-        if (faceA.x > 0 || faceA.y > 0 || faceA.z > 0) {
-            result.hit = 0;
-            return result;
-        }
+    /**
+     * @brief Find a speculative contact between a staticbody and a rigidbody which do not currently intersect.
+     * This should be called after the rigidbody's velocity has been updated for the step.
+     *
+     * @param sb The staticbody.
+     * @param rb The rigidbody.
+     * @param dt The length of the step.
+     * @return (CollisionManifold) The speculative contact. hit will be 0 if the bodies cannot touch within the step.
+     *          The normal points towards the rigidbody and pDist is the negative of the gap between the bodies.
+     */
+    inline static CollisionManifold findSpeculativeFeatures(StaticBody3D* sb, RigidBody3D* rb, float dt) {
+        ZMath::Vec3D disp = rb->vel * dt;
+        ZMath::Vec3D min1, max1, min2, max2;
 
-        // amount of penetration along B's axes
-        ZMath::Vec3D faceB = ZMath::abs(dB) - hB - CT * hA;
-        if (faceB.x > 0 || faceB.y > 0 || faceB.z > 0) {
-            result.hit = 0;
-            return result;
+        if (!disp.magSq() || !getBounds(sb->colliderType, sb->collider, min1, max1) || !getBounds(rb->colliderType, rb->collider, min2, max2)
+            || !boundsInReach(min1, max1, min2, max2, disp)) {
+            return {ZMath::Vec3D(), nullptr, -1.0f, 0, 0};
         }
 
-        // * Find the best axis (i.e. the axis with the least amount of penetration).
+        ZMath::Vec3D pos = rb->pos;
+        rb->pos += disp;
+        rb->syncCollider();
 
-        // Assume A's x-axis is the best axis first.
-        Axis axis = FACE_A_X;
-        float separation = faceA.x;
-        result.normal = dA.x > 0.0f ? cube1.rot.c1 : -cube1.rot.c1;
+        CollisionManifold manifold = findCollisionFeatures(sb, rb);
 
-        // tolerance values
-        float relativeTol = 0.95f;
-        float absoluteTol = 0.01f;
+        rb->pos = pos;
+        rb->syncCollider();
 
-        // ? check if there is another axis better than A's x axis by checking if the penetration along
-        // ?  the current axis being checked is greater than that of the current penetration
-        // ?  (as greater value = less negative = less penetration).
+        if (manifold.hit) { makeSpeculative(manifold, disp); }
+        return manifold;
+    };
 
-        // A's remaining axes
-        if (faceA.y > relativeTol * separation + absoluteTol * hA.y) {
-            axis = FACE_A_Y;
-            separation = faceA.y;
-            result.normal = dA.y > 0.0f ? cube1.rot.c2 : -cube1.rot.c2;
-        }
+    // * ====================================================
+    // * Continuous Collision Detection
+    // * ====================================================
 
-        if (faceA.z > relativeTol * separation + absoluteTol * hA.z) {
-            axis = FACE_A_Z;
-            separation = faceA.z;
-            result.normal = dA.z > 0.0f ? cube1.rot.c3 : -cube1.rot.c3;
-        }
+    // ? Fast bodies are approximated by a sphere which fits inside of their collider.
+    // ? Using an inner sphere means a body is never stopped before its collider actually touches anything.
+    // ? Any remaining overlap is then handled by the regular discrete collision detection.
 
-        // B's axes
-        if (faceB.x > relativeTol * separation + absoluteTol * hB.x) {
-            axis = FACE_B_X;
-            separation = faceB.x;
-            result.normal = dB.x > 0.0f ? cube2.rot.c1 : -cube2.rot.c1;
-        }
+    // Max number of times a fast body can hit something in a single update.
+    #define CCD_MAX_SUBSTEPS 4
+
+    // Max number of iterations when using conservative advancement.
+    #define CCD_MAX_ITERATIONS 32
+
+    // Bodies within this distance of each other are considered touching when using conservative advancement.
+    #define CCD_TOLERANCE 0.001f
 
-        if (faceB.y > relativeTol * separation + absoluteTol * hB.y) {
-            axis = FACE_B_Y;
-            separation = faceB.y;
-            result.normal = dB.y > 0.0f ? cube2.rot.c2 : -cube2.rot.c2;
+    /**
+     * @brief Find the time of impact of a sphere moving towards a box.
+     *
+     * @param sphere The sphere at the start of its motion.
+     * @param disp The displacement of the sphere over its motion.
+     * @param pos The center of the box.
+     * @param rot The rotation of the box. The columns should be the box's axes in global coordinates.
+     * @param halfSize The half size of the box.
+     * @param toi Set to the fraction of disp the sphere travels before touching the box.
+     * @param normal Set to the collision normal at the time of impact. This points towards the sphere.
+     * @return (bool) 1 if the sphere hits the box during its motion and 0 otherwise. 0 is also returned if they already intersect.
+     */
+    inline static bool sweepSphereBox(Sphere const &sphere, ZMath::Vec3D const &disp, ZMath::Vec3D const &pos, ZMath::Mat3D const &rot,
+                               ZMath::Vec3D const &halfSize, float &toi, ZMath::Vec3D &normal) {
+        // ? The sphere hits the box when its center hits the box grown by the radius of the sphere (the Minkowski sum).
+        // ? The Minkowski sum is made up of the box stretched by r along each of its axes and a capsule of radius r around each edge.
+        // ? Raycasting the center against each of those and taking the closest hit is exact.
+
+        ZMath::Mat3D rotT = rot.transpose();
+        ZMath::Vec3D o = rotT * (sphere.c - pos), d = rotT * disp;
+
+        // already touching
+        if (o.distSq(ZMath::clamp(o, -halfSize, halfSize)) <= sphere.r*sphere.r) { return 0; }
+
+        float len = d.mag();
+        if (!len) { return 0; }
+
+        Ray3D ray(o, d * (1.0f/len));
+        float best = len, t;
+
+        ZMath::Vec3D stretched[3] = {
+            ZMath::Vec3D(halfSize.x + sphere.r, halfSize.y, halfSize.z),
+            ZMath::Vec3D(halfSize.x, halfSize.y + sphere.r, halfSize.z),
+            ZMath::Vec3D(halfSize.x, halfSize.y, halfSize.z + sphere.r)
+        };
+
+        for (int i = 0; i < 3; ++i) {
+            if (raycast(AABB(-stretched[i], stretched[i]), ray, t) && t < best) { best = t; }
         }
 
-        if (faceB.z > relativeTol * separation + absoluteTol * hB.z) {
-            axis = FACE_B_Z;
-            separation = faceB.z;
-            result.normal = dB.z > 0.0f ? cube2.rot.c3 : -cube2.rot.c3;
+        for (int i = 0; i < 4; ++i) {
+            float u = i & 1 ? 1.0f : -1.0f, v = i & 2 ? 1.0f : -1.0f;
+
+            Capsule edges[3] = {
+                Capsule(ZMath::Vec3D(-halfSize.x, u * halfSize.y, v * halfSize.z), ZMath::Vec3D(halfSize.x, u * halfSize.y, v * halfSize.z), sphere.r),
+                Capsule(ZMath::Vec3D(u * halfSize.x, -halfSize.y, v * halfSize.z), ZMath::Vec3D(u * halfSize.x, halfSize.y, v * halfSize.z), sphere.r),
+                Capsule(ZMath::Vec3D(u * halfSize.x, v * halfSize.y, -halfSize.z), ZMath::Vec3D(u * halfSize.x, v * halfSize.y, halfSize.z), sphere.r)
+            };
+
+            for (int j = 0; j < 3; ++j) {
+                if (raycast(edges[j], ray, t) && t < best) { best = t; }
+            }
         }
 
-        // * Setup clipping plane data based on the best axis
+        if (best >= len) { return 0; }
 
-        ZMath::Vec3D sideNormal1, sideNormal2;
-        ZMath::Vec3D incidentFace[4]; // 4 vertices for the collision in 3D
-        float front, negSide1, negSide2, posSide1, posSide2;
+        // the normal points from the closest point on the box to the center of the sphere at the time of impact
+        ZMath::Vec3D c = o + ray.dir * best;
+        ZMath::Vec3D diff = c - ZMath::clamp(c, -halfSize, halfSize);
 
-        // * Compute the clipping lines and line segment to be clipped
+        toi = best/len;
+        normal = rot * (diff.magSq() ? diff.normalize() : -ray.dir);
 
-        switch(axis) {
-            case FACE_A_X: {
-                front = cube1.pos * result.normal + hA.x;
-                sideNormal1 = cube1.rot.c2; // yNormal
-                sideNormal2 = cube1.rot.c3; // zNormal
-                float ySide = cube1.pos * sideNormal1;
-                float zSide = cube1.pos * sideNormal2;
+        return 1;
+    };
 
-                negSide1 = -ySide + hA.y; // negSideY
-                posSide1 = ySide + hA.y; // posSideY
-                negSide2 = -zSide + hA.z; // negSideZ
-                posSide2 = zSide + hA.z; // posSideZ
+    /**
+     * @brief Find the time of impact of a sphere moving towards a capsule.
+     * A sphere is a capsule with no length so this also handles moving spheres vs spheres.
+     *
+     * @param sphere The sphere at the start of its motion.
+     * @param disp The displacement of the sphere over its motion.
+     * @param capsule The capsule.
+     * @param toi Set to the fraction of disp the sphere travels before touching the capsule.
+     * @param normal Set to the collision normal at the time of impact. This points towards the sphere.
+     * @return (bool) 1 if the sphere hits the capsule during its motion and 0 otherwise. 0 is also returned if they already intersect.
+     */
+    inline static bool sweepSphereCapsule(Sphere const &sphere, ZMath::Vec3D const &disp, Capsule const &capsule, float &toi, ZMath::Vec3D &normal) {
+        // ? The Minkowski sum of a capsule and a sphere is a capsule with the sum of their radii.
 
-                computeIncidentFace(incidentFace, hB, cube2.pos, cube2.rot, result.normal);
-                break;
-            }
+        ZMath::Vec3D start = capsule.getStart(), end = capsule.getEnd();
+        float r = capsule.r + sphere.r;
 
-            case FACE_A_Y: {
-                front = cube1.pos * result.normal + hA.y;
-                sideNormal1 = cube1.rot.c1; // xNormal
-                sideNormal2 = cube1.rot.c3; // zNormal
-                float xSide = cube1.pos * sideNormal1;
-                float zSide = cube1.pos * sideNormal2;
+        if (closestPointOnSegment(sphere.c, start, end).distSq(sphere.c) <= r*r) { return 0; }
 
-                negSide1 = -xSide + hA.x; // negSideX
-                posSide1 = xSide + hA.x; // posSideX
-                negSide2 = -zSide + hA.z; // negSideZ
-                posSide2 = zSide + hA.z; // posSideZ
+        float len = disp.mag(), t;
+        if (!len) { return 0; }
 
-                computeIncidentFace(incidentFace, hB, cube2.pos, cube2.rot, result.normal);
-                break;
-            }
+        Ray3D ray(sphere.c, disp * (1.0f/len));
+        if (!raycast(Capsule(start, end, r), ray, t) || t >= len) { return 0; }
 
-            case FACE_A_Z: {
-                front = cube1.pos * result.normal + hA.z;
-                sideNormal1 = cube1.rot.c1; // xNormal
-                sideNormal2 = cube1.rot.c2; // yNormal
-                float xSide = cube1.pos * sideNormal1;
-                float ySide = cube1.pos * sideNormal2;
+        ZMath::Vec3D c = sphere.c + ray.dir * t;
 
-                negSide1 = -xSide + hA.x; // negSideX
-                posSide1 = xSide + hA.x; // posSideX
-                negSide2 = -ySide + hA.y; // negSideY
-                posSide2 = ySide + hA.y; // posSideY
+        toi = t/len;
+        normal = (c - closestPointOnSegment(c, start, end)).normalize();
 
-                computeIncidentFace(incidentFace, hB, cube2.pos, cube2.rot, result.normal);
-                break;
+        return 1;
+    };
+
+    /**
+     * @brief Find the time of impact of a sphere moving towards a heightfield using conservative advancement.
+     *
+     * @param sphere The sphere at the start of its motion.
+     * @param disp The displacement of the sphere over its motion.
+     * @param hf The heightfield.
+     * @param toi Set to the fraction of disp the sphere travels before touching the heightfield.
+     * @param normal Set to the collision normal at the time of impact. This points towards the sphere.
+     * @return (bool) 1 if the sphere hits the heightfield during its motion and 0 otherwise. 0 is also returned if they already intersect.
+     */
+    inline static bool sweepSphereHeightfield(Sphere const &sphere, ZMath::Vec3D const &disp, Heightfield const &hf, float &toi, ZMath::Vec3D &normal) {
+        // ? The distance to the surface is a lower bound on how far the sphere can move before hitting it.
+        // ? Repeatedly step forward by that distance until we are touching or have moved the full displacement.
+
+        if (HeightfieldAndSphere(hf, sphere)) { return 0; }
+
+        float len = disp.mag();
+        if (!len) { return 0; }
+
+        float maxDist = len + sphere.r; // nothing further than this can be hit
+        float t = 0.0f;
+        ZMath::Vec3D c = sphere.c, closest;
+
+        for (int i = 0; i < CCD_MAX_ITERATIONS; ++i) {
+            float h;
+
+            // the center passed through the surface between samples
+            if (hf.getHeight(c.x, c.y, h, normal) && c.z <= h) {
+                toi = t;
+                normal = normal.normalize();
+                return 1;
             }
 
-            case FACE_B_X: {
-                front = cube2.pos * result.normal + hB.x;
-                sideNormal1 = cube2.rot.c2; // yNormal
-                sideNormal2 = cube2.rot.c3; // zNormal
-                float ySide = cube2.pos * sideNormal1;
-                float zSide = cube2.pos * sideNormal2;
+            if (!closestPointOnHeightfield(hf, c, maxDist, closest)) { return 0; }
 
-                negSide1 = -ySide + hB.y; // negSideY
-                posSide1 = ySide + hB.y; // posSideY
-                negSide2 = -zSide + hB.z; // negSideZ
-                posSide2 = zSide + hB.z; // posSideZ
+            float dist = c.dist(closest) - sphere.r;
 
-                computeIncidentFace(incidentFace, hA, cube1.pos, cube1.rot, result.normal);
-                break;
+            if (dist <= CCD_TOLERANCE) {
+                normal = (c - closest).normalize();
+                if (disp * normal >= 0.0f) { return 0; } // touching but moving away
+
+                toi = t;
+                return 1;
             }
 
-            case FACE_B_Y: {
-                front = cube2.pos * result.normal + hB.y;
-                sideNormal1 = cube2.rot.c1; // xNormal
-                sideNormal2 = cube2.rot.c3; // zNormal
-                float xSide = cube2.pos * sideNormal1;
-                float zSide = cube2.pos * sideNormal2;
+            t += dist/len;
+            if (t >= 1.0f) { return 0; }
 
-                negSide1 = -xSide + hB.x; // negSideX
-                posSide1 = xSide + hB.x; // posSideX
-                negSide2 = -zSide + hB.z; // negSideZ
-                posSide2 = zSide + hB.z; // posSideZ
+            c = sphere.c + disp * t;
+        }
 
-                computeIncidentFace(incidentFace, hA, cube1.pos, cube1.rot, result.normal);
-                break;
+        // did not converge so stop where we are to be safe
+        toi = t;
+        normal = (c - closest).normalize();
+
+        return 1;
+    };
+
+    /**
+     * @brief Find the time of impact of a sphere moving towards a collider which can be attached to a staticbody.
+     *
+     * @param sphere The sphere at the start of its motion.
+     * @param disp The displacement of the sphere over its motion.
+     * @param type The type of the static collider.
+     * @param collider The static collider.
+     * @param toi Set to the fraction of disp the sphere travels before touching the collider.
+     * @param normal Set to the collision normal at the time of impact. This points towards the sphere.
+     * @return (bool) 1 if the sphere hits the collider during its motion and 0 otherwise. 0 is also returned if they already intersect.
+     */
+    inline static bool sweepSphere(Sphere const &sphere, ZMath::Vec3D const &disp, StaticBodyCollider type, void* collider, float &toi, ZMath::Vec3D &normal) {
+        switch (type) {
+            case STATIC_PLANE_COLLIDER: {
+                Plane const* plane = (Plane const*) collider;
+                ZMath::Vec2D h = plane->getHalfSize();
+                return sweepSphereBox(sphere, disp, plane->pos, plane->rot, ZMath::Vec3D(h.x, h.y, 0.0f), toi, normal);
             }
 
-            case FACE_B_Z: {
-                front = cube2.pos * result.normal + hB.z;
-                sideNormal1 = cube2.rot.c1; // xNormal
-                sideNormal2 = cube2.rot.c2; // yNormal
-                float xSide = cube2.pos * sideNormal1;
-                float ySide = cube2.pos * sideNormal2;
+            case STATIC_SPHERE_COLLIDER: {
+                Sphere const* s = (Sphere const*) collider;
+                return sweepSphereCapsule(sphere, disp, Capsule(s->c, s->c, s->r), toi, normal);
+            }
 
-                negSide1 = -xSide + hB.x; // negSideX
-                posSide1 = xSide + hB.x; // posSideX
-                negSide2 = -ySide + hB.y; // negSideY
-                posSide2 = ySide + hB.y; // posSideY
+            case STATIC_AABB_COLLIDER: {
+                AABB const* aabb = (AABB const*) collider;
+                return sweepSphereBox(sphere, disp, aabb->pos, ZMath::Mat3D(1, 0, 0, 0, 1, 0, 0, 0, 1), aabb->getHalfSize(), toi, normal);
+            }
 
-                computeIncidentFace(incidentFace, hA, cube1.pos, cube1.rot, result.normal);
-                break;
+            case STATIC_CUBE_COLLIDER: {
+                Cube const* cube = (Cube const*) collider;
+                return sweepSphereBox(sphere, disp, cube->pos, cube->rot, cube->getHalfSize(), toi, normal);
             }
+
+            case STATIC_HEIGHTFIELD_COLLIDER: { return sweepSphereHeightfield(sphere, disp, *((Heightfield const*) collider), toi, normal); }
+            case STATIC_CAPSULE_COLLIDER:     { return sweepSphereCapsule(sphere, disp, *((Capsule const*) collider), toi, normal); }
+
+            default: { return 0; }
         }
+    };
 
-        // * Clip the incident edge with box planes.
+    /**
+     * @brief Find the time of impact between two moving spheres using conservative advancement.
+     *
+     * @param sphere1 The first sphere at the start of its motion.
+     * @param disp1 The displacement of the first sphere over its motion.
+     * @param sphere2 The second sphere at the start of its motion.
+     * @param disp2 The displacement of the second sphere over its motion.
+     * @param toi Set to the fraction of the motion before the spheres touch.
+     * @return (bool) 1 if the spheres touch during their motion and 0 otherwise. 0 is also returned if they already intersect.
+     */
+    inline static bool conservativeAdvancement(Sphere const &sphere1, ZMath::Vec3D const &disp1, Sphere const &sphere2, ZMath::Vec3D const &disp2, float &toi) {
+        // ? Neither sphere can close the gap between them faster than their relative speed.
+        // ? Therefore, we can safely advance both by gap/relativeSpeed and repeat until the gap closes.
 
-        ZMath::Vec3D clipPoints1[4];
-        ZMath::Vec3D clipPoints2[4];
+        ZMath::Vec3D rel = disp1 - disp2;
+        float relLen = rel.mag();
+        float r = sphere1.r + sphere2.r;
+        float dist = sphere1.c.dist(sphere2.c) - r;
 
-        // Clip to side 1
-        int np = clipSegmentToLine(clipPoints1, incidentFace, -sideNormal1, -sideNormal2, negSide1, negSide2);
+        if (!relLen || dist <= 0.0f) { return 0; }
 
-        if (np < 4) {
-            result.hit = 0;
-            return result;
-        }
+        float t = 0.0f;
 
-        // Clip to the negative side 1
-        np = clipSegmentToLine(clipPoints2, clipPoints1, sideNormal1, sideNormal2, posSide1, posSide2);
+        for (int i = 0; i < CCD_MAX_ITERATIONS && dist > CCD_TOLERANCE; ++i) {
+            t += dist/relLen;
+            if (t >= 1.0f) { return 0; }
 
-        if (np < 4) {
-            result.hit = 0;
-            return result;
+            dist = (sphere1.c + disp1 * t).dist(sphere2.c + disp2 * t) - r;
         }
 
-        // * ClipPoints2 now contains the clipping points.
-        // * Compute the contact points.
-        
-        // store the conatct points in here and add them to the dynamic array after they are determined
-        ZMath::Vec3D contactPoints[4];
-        np = 0;
-        result.pDist = 0.0f;
+        // spheres which are touching but moving apart do not collide
+        if (rel * ((sphere2.c + disp2 * t) - (sphere1.c + disp1 * t)) <= 0.0f) { return 0; }
 
-        for (int i = 0; i < 4; ++i) {
-            separation = result.normal * clipPoints2[i] - front;
+        toi = t;
+        return 1;
+    };
 
-            if (separation <= 0) {
-                contactPoints[np++] = clipPoints2[i] - result.normal * separation;
-                if (result.pDist < separation) { result.pDist = separation; }
+    // Find the radius of the largest sphere centered on a rigidbody that fits inside of its collider.
+    // This is used to approximate the rigidbody when using continuous collision detection.
+    inline static float getCCDRadius(RigidBodyCollider type, void const* collider) {
+        switch (type) {
+            case RIGID_SPHERE_COLLIDER:  { return ((Sphere const*) collider)->r; }
+            case RIGID_CAPSULE_COLLIDER: { return ((Capsule const*) collider)->r; }
+
+            default: {
+                ZMath::Vec3D min, max;
+                if (!getBounds(type, collider, min, max)) { return 0.0f; }
+
+                ZMath::Vec3D h = (max - min) * 0.5f;
+                return ZMath::min(h.x, ZMath::min(h.y, h.z));
             }
         }
+    };
 
-        // * update the manifold to contain the results.
+    // * ====================================================
+    // * Shape Casting
+    // * ====================================================
 
-        result.pDist = -result.pDist;
-        result.hit = 1;
-        result.numPoints = np;
-        result.contactPoints = new ZMath::Vec3D[np];
+    // ? Spheres and boxes are swept analytically against spheres and boxes (planes are boxes with no height).
+    // ? Other pairs are swept by testing for overlap at steps no longer than the radius of the largest sphere inside of the shape,
+    // ?  then bisecting between the last step without overlap and the first with it.
 
-        for (int i = 0; i < np; ++i) { result.contactPoints[i] = contactPoints[i]; }
-        
-        return result;
-    };
+    // Max number of overlap tests used to step a shape along its sweep before bisecting.
+    #define SWEEP_MAX_STEPS 64
 
-    // Find the collision features and resolve the impulse between two rigidbodies.
-    static CollisionManifold findCollisionFeatures(RigidBody3D* rb1, RigidBody3D* rb2) {
-        switch (rb1->colliderType) {
-            case RIGID_SPHERE_COLLIDER: {
-                if (rb2->colliderType == RIGID_SPHERE_COLLIDER) { return findCollisionFeatures(*((Sphere*) rb1->collider), *((Sphere*) rb2->collider)); }
-                if (rb2->colliderType == RIGID_AABB_COLLIDER) { return findCollisionFeatures(*((Sphere*) rb1->collider), *((AABB*) rb2->collider)); }
-                if (rb2->colliderType == RIGID_CUBE_COLLIDER) { return findCollisionFeatures(*((Sphere*) rb1->collider), *((Cube*) rb2->collider)); }
+    /**
+     * @brief Find the time of impact of a box moving towards another box with the separating axis theorem.
+     *
+     * @param posA The center of the moving box at the start of its motion.
+     * @param rotA The rotation of the moving box. The columns should be the box's axes in global coordinates.
+     * @param hA The half size of the moving box.
+     * @param disp The displacement of the moving box over its motion.
+     * @param posB The center of the other box.
+     * @param rotB The rotation of the other box. The columns should be the box's axes in global coordinates.
+     * @param hB The half size of the other box.
+     * @param toi Set to the fraction of disp the moving box travels before touching the other box.
+     * @param normal Set to the collision normal at the time of impact. This points towards the moving box.
+     * @return (bool) 1 if the boxes touch during the motion and 0 otherwise. 0 is also returned if they already intersect.
+     */
+    inline static bool sweepBoxBox(ZMath::Vec3D const &posA, ZMath::Mat3D const &rotA, ZMath::Vec3D const &hA, ZMath::Vec3D const &disp,
+                            ZMath::Vec3D const &posB, ZMath::Mat3D const &rotB, ZMath::Vec3D const &hB, float &toi, ZMath::Vec3D &normal) {
+        // ? The boxes overlap when their projections overlap on every separating axis.
+        // ? Along each axis, find the interval of time their projections overlap. The boxes first touch at the latest start of those intervals.
 
-                break;
-            }
+        ZMath::Vec3D a[3] = {rotA.c1, rotA.c2, rotA.c3}, b[3] = {rotB.c1, rotB.c2, rotB.c3};
+        ZMath::Vec3D axes[15];
+        int numAxes = 0;
 
-            case RIGID_AABB_COLLIDER: {
-                if (rb2->colliderType == RIGID_SPHERE_COLLIDER) {
-                    Manifold manifold = findCollisionFeatures(*((Sphere*) rb2->collider), *((AABB*) rb1->collider));
-                    manifold.normal = -manifold.normal; // flip the direction as the original order passed in was reversed
-                    return manifold;
-                }
+        for (int i = 0; i < 3; ++i) { axes[numAxes++] = a[i]; }
+        for (int i = 0; i < 3; ++i) { axes[numAxes++] = b[i]; }
 
-                if (rb2->colliderType == RIGID_AABB_COLLIDER) { return findCollisionFeatures(*((AABB*) rb1->collider), *((AABB*) rb2->collider)); }
-                if (rb2->colliderType == RIGID_CUBE_COLLIDER) { return findCollisionFeatures(*((AABB*) rb1->collider), *((Cube*) rb2->collider)); }
+        for (int i = 0; i < 3; ++i) {
+            for (int j = 0; j < 3; ++j) {
+                ZMath::Vec3D axis = a[i].cross(b[j]);
 
-                break;
+                // parallel edges are already covered by the face axes
+                if (axis.magSq() > EPSILON*EPSILON) { axes[numAxes++] = axis.normalize(); }
             }
+        }
 
-            case RIGID_CUBE_COLLIDER: {
-                if (rb2->colliderType == RIGID_SPHERE_COLLIDER) {
-                    Manifold manifold = findCollisionFeatures(*((Sphere*) rb2->collider), *((Cube*) rb1->collider));
-                    manifold.normal = -manifold.normal; // flip the direction as the original order passed in was reversed
-                    return manifold;
-                }
+        ZMath::Vec3D offset = posA - posB;
+        float tFirst = -FLT_MAX, tLast = FLT_MAX;
 
-                if (rb2->colliderType == RIGID_AABB_COLLIDER) {
-                    Manifold manifold = findCollisionFeatures(*((AABB*) rb2->collider), *((Cube*) rb1->collider));
-                    manifold.normal = -manifold.normal; // flip the direction as the original order passed in was reversed
-                    return manifold;
-                }
+        for (int i = 0; i < numAxes; ++i) {
+            ZMath::Vec3D const &L = axes[i];
 
-                if (rb2->colliderType == RIGID_CUBE_COLLIDER) { return findCollisionFeatures(*((Cube*) rb1->collider), *((Cube*) rb2->collider)); }
+            float r = hA.x*fabsf(a[0]*L) + hA.y*fabsf(a[1]*L) + hA.z*fabsf(a[2]*L) + hB.x*fabsf(b[0]*L) + hB.y*fabsf(b[1]*L) + hB.z*fabsf(b[2]*L);
+            float p = offset * L, v = disp * L;
 
-                break;
+            // not moving along this axis so the projections must already overlap
+            if (fabsf(v) < EPSILON*EPSILON) {
+                if (fabsf(p) > r) { return 0; }
+                continue;
             }
 
-            // * User defined types go here.
+            float t1 = (-r - p)/v, t2 = (r - p)/v;
+            if (t1 > t2) { float temp = t1; t1 = t2; t2 = temp; }
+
+            if (t1 > tFirst) {
+                tFirst = t1;
+                normal = v > 0.0f ? -L : L;
+            }
+
+            if (t2 < tLast) { tLast = t2; }
+            if (tFirst > tLast || tFirst > 1.0f || tLast < 0.0f) { return 0; }
         }
 
-        return {ZMath::Vec3D(), nullptr, -1.0f, 0, 0};
-    };
+        // already intersecting
+        if (tFirst < 0.0f) { return 0; }
 
-    // Find the collision features and resolve the impulse between a staticbody and a rigidbody.
-    // The collision normal will point towards the rigid body and away from the static body.
-    static CollisionManifold findCollisionFeatures(StaticBody3D* sb, RigidBody3D* rb) {
-        // ? The normal points towards B and away from A so we want to pass the rigid body's colliders second.
+        toi = tFirst;
+        return 1;
+    };
 
-        switch (sb->colliderType) {
+    // Get the box a collider which can be attached to a staticbody represents. Returns 0 if the collider is not a box.
+    inline static bool getBox(StaticBodyCollider type, void const* collider, ZMath::Vec3D &pos, ZMath::Mat3D &rot, ZMath::Vec3D &halfSize) {
+        switch (type) {
             case STATIC_PLANE_COLLIDER: {
-                switch (rb->colliderType) {
-                    case RIGID_SPHERE_COLLIDER: { return findCollisionFeatures(*((Plane*) sb->collider), *((Sphere*) rb->collider)); }
-                    case RIGID_AABB_COLLIDER: { return findCollisionFeatures(*((Plane*) sb->collider), *((AABB*) rb->collider)); }
-                    case RIGID_CUBE_COLLIDER: { return findCollisionFeatures(*((Plane*) sb->collider), *((Cube*) rb->collider)); }
-                }
-
-                break;
+                Plane const* plane = (Plane const*) collider;
+                ZMath::Vec2D h = plane->getHalfSize();
+                pos = plane->pos;
+                rot = plane->rot;
+                halfSize.set(h.x, h.y, 0.0f);
+                return 1;
             }
 
-            case STATIC_SPHERE_COLLIDER: {
-                switch (rb->colliderType) {
-                    case RIGID_SPHERE_COLLIDER: { return findCollisionFeatures(*((Sphere*) sb->collider), *((Sphere*) rb->collider)); }
-                    case RIGID_AABB_COLLIDER: { return findCollisionFeatures(*((Sphere*) sb->collider), *((AABB*) rb->collider)); }
-                    case RIGID_CUBE_COLLIDER: { return findCollisionFeatures(*((Sphere*) sb->collider), *((Cube*) rb->collider)); }
-                }
+            case STATIC_AABB_COLLIDER: {
+                pos = ((AABB const*) collider)->pos;
+                rot = ZMath::Mat3D(1, 0, 0, 0, 1, 0, 0, 0, 1);
+                halfSize = ((AABB const*) collider)->getHalfSize();
+                return 1;
+            }
 
-                break;
+            case STATIC_CUBE_COLLIDER: {
+                pos = ((Cube const*) collider)->pos;
+                rot = ((Cube const*) collider)->rot;
+                halfSize = ((Cube const*) collider)->getHalfSize();
+                return 1;
             }
 
-            case STATIC_AABB_COLLIDER: {
-                switch (rb->colliderType) {
-                    case RIGID_SPHERE_COLLIDER: {
-                        Manifold manifold = findCollisionFeatures(*((Sphere*) rb->collider), *((AABB*) sb->collider));
-                        manifold.normal = -manifold.normal; // flip the direction as the original order passed in was reversed
-                        return manifold;
-                    }
+            default: { return 0; }
+        }
+    };
 
-                    case RIGID_AABB_COLLIDER: { return findCollisionFeatures(*((AABB*) sb->collider), *((AABB*) rb->collider)); }
-                    case RIGID_CUBE_COLLIDER: { return findCollisionFeatures(*((AABB*) sb->collider), *((Cube*) rb->collider)); }
-                }
+    // Get the static collider type with the same shape as a rigid collider type. Returns STATIC_NONE if there is none.
+    inline static StaticBodyCollider getStaticType(RigidBodyCollider type) {
+        switch (type) {
+            case RIGID_SPHERE_COLLIDER:  { return STATIC_SPHERE_COLLIDER;  }
+            case RIGID_AABB_COLLIDER:    { return STATIC_AABB_COLLIDER;    }
+            case RIGID_CUBE_COLLIDER:    { return STATIC_CUBE_COLLIDER;    }
+            case RIGID_CAPSULE_COLLIDER: { return STATIC_CAPSULE_COLLIDER; }
+            default:                     { return STATIC_NONE;             }
+        }
+    };
 
-                break;
+    // ? The sweepAnalytic functions return 1 for a hit, 0 for a miss, and -1 if the collider is not handled analytically.
+
+    inline static int sweepAnalytic(Sphere const &sphere, ZMath::Vec3D const &disp, StaticBodyCollider type, void* collider, float &toi, ZMath::Vec3D &normal) {
+        if (type == STATIC_CUSTOM_COLLIDER || type == STATIC_NONE) { return -1; }
+        return sweepSphere(sphere, disp, type, collider, toi, normal);
+    };
+
+    inline static int sweepAnalyticBox(ZMath::Vec3D const &pos, ZMath::Mat3D const &rot, ZMath::Vec3D const &halfSize, ZMath::Vec3D const &disp,
+                                StaticBodyCollider type, void* collider, float &toi, ZMath::Vec3D &normal) {
+        ZMath::Vec3D otherPos, otherHalfSize;
+        ZMath::Mat3D otherRot;
+
+        if (getBox(type, collider, otherPos, otherRot, otherHalfSize)) {
+            return sweepBoxBox(pos, rot, halfSize, disp, otherPos, otherRot, otherHalfSize, toi, normal);
+        }
+
+        if (type == STATIC_SPHERE_COLLIDER) {
+            // ? This is the same as the sphere moving towards the box in the opposite direction.
+            if (!sweepSphereBox(*((Sphere const*) collider), -disp, pos, rot, halfSize, toi, normal)) { return 0; }
+
+            normal = -normal;
+            return 1;
+        }
+
+        return -1;
+    };
+
+    inline static int sweepAnalytic(AABB const &aabb, ZMath::Vec3D const &disp, StaticBodyCollider type, void* collider, float &toi, ZMath::Vec3D &normal) {
+        return sweepAnalyticBox(aabb.pos, ZMath::Mat3D(1, 0, 0, 0, 1, 0, 0, 0, 1), aabb.getHalfSize(), disp, type, collider, toi, normal);
+    };
+
+    inline static int sweepAnalytic(Cube const &cube, ZMath::Vec3D const &disp, StaticBodyCollider type, void* collider, float &toi, ZMath::Vec3D &normal) {
+        return sweepAnalyticBox(cube.pos, cube.rot, cube.getHalfSize(), disp, type, collider, toi, normal);
+    };
+
+    inline static int sweepAnalytic(Capsule const &capsule, ZMath::Vec3D const &disp, StaticBodyCollider type, void* collider, float &toi, ZMath::Vec3D &normal) {
+        if (type != STATIC_SPHERE_COLLIDER) { return -1; }
+
+        // ? This is the same as the sphere moving towards the capsule in the opposite direction.
+        if (!sweepSphereCapsule(*((Sphere const*) collider), -disp, capsule, toi, normal)) { return 0; }
+
+        normal = -normal;
+        return 1;
+    };
+
+    // Move a copy of a shape by an offset.
+    static inline Sphere translate(Sphere shape, ZMath::Vec3D const &offset) { shape.c += offset; return shape; };
+    static inline AABB translate(AABB shape, ZMath::Vec3D const &offset) { shape.pos += offset; return shape; };
+    static inline Cube translate(Cube shape, ZMath::Vec3D const &offset) { shape.pos += offset; return shape; };
+    static inline Capsule translate(Capsule shape, ZMath::Vec3D const &offset) { shape.pos += offset; return shape; };
+
+    // Determine if a shape moved by disp * t overlaps a static collider.
+    // normal is set to the collision normal, pointing towards the shape, if they overlap.
+    template <typename Shape>
+    inline static bool overlapsAt(Shape const &shape, RigidBodyCollider shapeType, ZMath::Vec3D const &disp, float t,
+                           StaticBodyCollider type, void* collider, ZMath::Vec3D &normal) {
+        Shape moved = translate(shape, disp * t);
+        Manifold manifold = findCollisionFeatures(type, collider, shapeType, &moved);
+
+        if (!manifold.hit) { return 0; }
+
+        normal = manifold.normal;
+        delete[] manifold.contactPoints;
+        return 1;
+    };
+
+    /**
+     * @brief Find the time of impact of a shape moving towards a static collider by stepping along its motion.
+     * 
+     * @param shape The shape at the start of its motion.
+     * @param shapeType The type of the shape.
+     * @param disp The displacement of the shape over its motion.
+     * @param type The type of the static collider.
+     * @param collider The static collider.
+     * @param toi Set to the fraction of disp the shape travels before touching the collider.
+     * @param normal Set to the collision normal at the time of impact. This points towards the shape.
+     * @return (bool) 1 if the shape hits the collider during its motion and 0 otherwise. 0 is also returned if they already intersect.
+     */
+    template <typename Shape>
+    inline static bool sweepStepped(Shape const &shape, RigidBodyCollider shapeType, ZMath::Vec3D const &disp,
+                             StaticBodyCollider type, void* collider, float &toi, ZMath::Vec3D &normal) {
+        // ? Only step through the part of the motion where the bounds of the shape overlap the bounds of the collider.
+
+        ZMath::Vec3D min, max, otherMin, otherMax;
+        if (!getBounds(shapeType, &shape, min, max) || !getBounds(type, collider, otherMin, otherMax)) { return 0; }
+
+        float d[3] = {disp.x, disp.y, disp.z};
+        float lo[3] = {otherMin.x - max.x, otherMin.y - max.y, otherMin.z - max.z};
+        float hi[3] = {otherMax.x - min.x, otherMax.y - min.y, otherMax.z - min.z};
+        float tEnter = 0.0f, tExit = 1.0f;
+
+        for (int i = 0; i < 3; ++i) {
+            if (fabsf(d[i]) < EPSILON*EPSILON) {
+                if (lo[i] > 0.0f || hi[i] < 0.0f) { return 0; }
+                continue;
             }
 
-            case STATIC_CUBE_COLLIDER: {
-                switch (rb->colliderType) {
-                    case RIGID_SPHERE_COLLIDER: {
-                        Manifold manifold = findCollisionFeatures(*((Sphere*) rb->collider), *((Cube*) sb->collider));
-                        manifold.normal = -manifold.normal; // flip the direction as the original order passed in was reversed
-                        return manifold;
-                    }
+            float t1 = lo[i]/d[i], t2 = hi[i]/d[i];
+            if (t1 > t2) { float temp = t1; t1 = t2; t2 = temp; }
 
-                    case RIGID_AABB_COLLIDER: {
-                        Manifold manifold = findCollisionFeatures(*((AABB*) rb->collider), *((Cube*) sb->collider));
-                        manifold.normal = -manifold.normal; // flip the direction as the original order passed in was reversed
-                        return manifold;
-                    }
+            tEnter = ZMath::max(tEnter, t1);
+            tExit = ZMath::min(tExit, t2);
+            if (tEnter > tExit) { return 0; }
+        }
 
-                    case RIGID_CUBE_COLLIDER: { return findCollisionFeatures(*((Cube*) sb->collider), *((Cube*) rb->collider)); }
-                }
+        float len = disp.mag();
+        float step = ZMath::max(getCCDRadius(shapeType, &shape)/len, (tExit - tEnter)/SWEEP_MAX_STEPS);
+        float t = tEnter, clear = 0.0f;
 
-                break;
+        while (!overlapsAt(shape, shapeType, disp, t, type, collider, normal)) {
+            if (t >= tExit) { return 0; }
+
+            clear = t;
+            t = ZMath::min(t + step, tExit);
+        }
+
+        // bisect between the last step without overlap and the first with it
+        for (int i = 0; i < CCD_MAX_ITERATIONS && (t - clear)*len > CCD_TOLERANCE; ++i) {
+            float mid = (clear + t) * 0.5f;
+            ZMath::Vec3D n;
+
+            if (overlapsAt(shape, shapeType, disp, mid, type, collider, n)) {
+                t = mid;
+                normal = n;
+            } else {
+                clear = mid;
             }
+        }
 
-            case STATIC_CUSTOM_COLLIDER: {
-                // * User defined types go here.
-                break;
+        toi = clear;
+        return 1;
+    };
+
+    /**
+     * @brief Find the time of impact of a shape moving towards a collider which can be attached to a staticbody.
+     * ? A shape which starts out touching the collider hits it immediately if it is moving into it and ignores it otherwise.
+     * 
+     * @param shape The shape at the start of its motion. This must be a Sphere, AABB, Cube, or Capsule.
+     * @param shapeType The type of the shape.
+     * @param disp The displacement of the shape over its motion.
+     * @param type The type of the static collider.
+     * @param collider The static collider.
+     * @param toi Set to the fraction of disp the shape travels before touching the collider.
+     * @param normal Set to the collision normal at the time of impact. This points towards the shape.
+     * @return (bool) 1 if the shape hits the collider during its motion and 0 otherwise.
+     */
+    template <typename Shape>
+    inline static bool sweepShape(Shape const &shape, RigidBodyCollider shapeType, ZMath::Vec3D const &disp,
+                           StaticBodyCollider type, void* collider, float &toi, ZMath::Vec3D &normal) {
+        if (type == STATIC_CUSTOM_COLLIDER || type == STATIC_NONE || !disp.magSq()) { return 0; }
+
+        if (overlapsAt(shape, shapeType, disp, 0.0f, type, collider, normal)) {
+            toi = 0.0f;
+            return disp * normal < 0.0f;
+        }
+
+        int result = sweepAnalytic(shape, disp, type, collider, toi, normal);
+        if (result >= 0) { return result; }
+
+        return sweepStepped(shape, shapeType, disp, type, collider, toi, normal);
+    };
+
+    /**
+     * @brief Find the time of impact of a shape moving towards a collider which can be attached to a rigidbody.
+     * ? A shape which starts out touching the collider hits it immediately if it is moving into it and ignores it otherwise.
+     * 
+     * @param shape The shape at the start of its motion. This must be a Sphere, AABB, Cube, or Capsule.
+     * @param shapeType The type of the shape.
+     * @param disp The displacement of the shape over its motion.
+     * @param type The type of the rigid collider.
+     * @param collider The rigid collider.
+     * @param toi Set to the fraction of disp the shape travels before touching the collider.
+     * @param normal Set to the collision normal at the time of impact. This points towards the shape.
+     * @return (bool) 1 if the shape hits the collider during its motion and 0 otherwise.
+     */
+    template <typename Shape>
+    inline static bool sweepShape(Shape const &shape, RigidBodyCollider shapeType, ZMath::Vec3D const &disp,
+                           RigidBodyCollider type, void* collider, float &toi, ZMath::Vec3D &normal) {
+        if (type == RIGID_COMPOUND_COLLIDER) {
+            // ? The first child hit is the hit on the compound.
+            Compound const* compound = (Compound const*) collider;
+            bool hit = 0;
+            float t;
+            ZMath::Vec3D n;
+
+            for (int i = 0; i < compound->numChildren; ++i) {
+                CompoundChild const &child = compound->children[i];
+
+                if (sweepShape(shape, shapeType, disp, child.type, child.collider, t, n) && (!hit || t < toi)) {
+                    hit = 1;
+                    toi = t;
+                    normal = n;
+                }
             }
+
+            return hit;
         }
 
-        return {ZMath::Vec3D(), nullptr, -1.0f, 0, 0};
+        // the rigid primitives are swept in the same way as their static counterparts
+        // todo add sweeps against triangular pyramids
+        return sweepShape(shape, shapeType, disp, getStaticType(type), collider, toi, normal);
     };
 }
@@ -0,0 +1,300 @@
+// ? Ring of the physics handler's states over its last few steps, used to rewind it for rollback or lag compensation.
+// ? Each state is stored as the XOR of the state with a keyframe, with the runs of zero bytes left out.
+// ?  Bodies which did not change since the keyframe leave nothing but zeros, so they take up almost no memory.
+// ? A new keyframe is taken once the current one is as old as the ring is long. The previous keyframe is kept alongside it,
+// ?  as the older states in the ring still depend on it, so every state in the ring can be decoded from a single keyframe.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace Zeta {
+    class StateHistory {
+        private:
+            // ? Zero runs shorter than this are kept in the literals as each run costs at least 2 bytes to encode.
+            static const size_t MIN_ZERO_RUN = 4;
+
+            typedef struct Entry {
+                uint8_t* data = nullptr; // encoded state
+                size_t size = 0; // bytes of encoded state
+                size_t capacity = 0;
+                size_t rawSize = 0; // bytes of the decoded state
+                int64_t step = 0; // number of states pushed before this one
+                int key = 0; // keyframe the state is encoded against
+            } Entry;
+
+            Entry* entries = nullptr;
+            int capacity = 0; // max number of states kept
+            int count = 0; // number of states kept
+            int newest = -1; // index of the newest state
+
+            // ? Bytes past the end of a keyframe are kept zeroed so states larger than the keyframe can be XORed with it directly.
+            uint8_t* keys[2] = {nullptr, nullptr};
+            size_t keyCapacities[2] = {0, 0};
+            int64_t keySteps[2] = {-1, -1}; // step each keyframe was taken at. -1 if unused.
+
+            int64_t steps = 0; // number of states pushed since the history was cleared
+
+            // * Scratch space reused between calls so recording and rewinding only allocate while the states grow.
+
+            uint8_t* scratch = nullptr; // raw state being pushed or saved
+            size_t scratchCapacity = 0;
+
+            uint8_t* encoded = nullptr; // state being encoded
+            size_t encodedCapacity = 0;
+
+            uint8_t* decoded = nullptr; // last state decoded
+            size_t decodedCapacity = 0;
+
+            // Make sure a buffer holds at least size bytes. The contents are only kept if keep is set. New bytes are zeroed.
+            static void reserve(uint8_t* &buffer, size_t &bufferCapacity, size_t size, bool keep) {
+                if (size <= bufferCapacity) { return; }
+
+                size_t newCapacity = bufferCapacity ? bufferCapacity : 64;
+                while (newCapacity < size) { newCapacity *= 2; }
+
+                uint8_t* temp = new uint8_t[newCapacity];
+
+                if (keep) { memcpy(temp, buffer, bufferCapacity); }
+                else { bufferCapacity = 0; }
+
+                memset(temp + bufferCapacity, 0, newCapacity - bufferCapacity);
+
+                delete[] buffer;
+                buffer = temp;
+                bufferCapacity = newCapacity;
+            };
+
+            static inline uint8_t* writeVarint(uint8_t* p, size_t value) {
+                while (value >= 0x80) {
+                    *p++ = (uint8_t) (value | 0x80);
+                    value >>= 7;
+                }
+
+                *p++ = (uint8_t) value;
+                return p;
+            };
+
+            static inline uint8_t const* readVarint(uint8_t const* p, size_t &value) {
+                int shift = 0;
+                value = 0;
+
+                for (; *p & 0x80; shift += 7) { value |= (size_t) (*p++ & 0x7F) << shift; }
+                value |= (size_t) *p++ << shift;
+
+                return p;
+            };
+
+            // Get the index of the state a number of steps before the newest.
+            inline int getIndex(int stepsBack) const { return (newest - stepsBack + capacity) % capacity; };
+
+        public:
+            // * ===================================
+            // * Constructors, Destructors, Etc.
+            // * ===================================
+
+            StateHistory() {};
+
+            StateHistory(StateHistory const &history) = delete;
+            StateHistory& operator = (StateHistory const &history) = delete;
+
+            ~StateHistory() {
+                for (int i = 0; i < capacity; ++i) { delete[] entries[i].data; }
+                delete[] entries;
+
+                delete[] keys[0];
+                delete[] keys[1];
+                delete[] scratch;
+                delete[] encoded;
+                delete[] decoded;
+            };
+
+
+            // * ============================
+            // * Functions
+            // * ============================
+
+            // Set the number of states kept. This clears the history. 0 frees everything but the scratch space.
+            void resize(int size) {
+                for (int i = 0; i < capacity; ++i) { delete[] entries[i].data; }
+                delete[] entries;
+
+                capacity = size > 0 ? size : 0;
+                entries = capacity ? new Entry[capacity] : nullptr;
+
+                if (!capacity) {
+                    delete[] keys[0];
+                    delete[] keys[1];
+
+                    keys[0] = keys[1] = nullptr;
+                    keyCapacities[0] = keyCapacities[1] = 0;
+                }
+
+                clear();
+            };
+
+            // Forget every state. The memory is kept for the states recorded next.
+            void clear() {
+                count = 0;
+                newest = -1;
+                steps = 0;
+                keySteps[0] = keySteps[1] = -1;
+            };
+
+            inline int getCapacity() const { return capacity; };
+            inline int getCount() const { return count; };
+
+            // Get a buffer to save a state to before pushing it. This is only valid until the next call to getScratch.
+            inline uint8_t* getScratch(size_t size) {
+                reserve(scratch, scratchCapacity, size, 0);
+                return scratch;
+            };
+
+            /**
+             * @brief Add the newest state, dropping the oldest state if the history is full.
+             *
+             * @param state The state. This can be the buffer from getScratch.
+             * @param size Size of the state in bytes.
+             */
+            void push(uint8_t const* state, size_t size) {
+                if (!capacity) { return; }
+
+                // * Pick the keyframe, taking a new one if the current one is too old.
+
+                int key = count ? entries[newest].key : 0;
+
+                if (!count || steps - keySteps[key] >= capacity) {
+                    if (count) { key ^= 1; }
+
+                    reserve(keys[key], keyCapacities[key], size, 0);
+                    memcpy(keys[key], state, size);
+                    memset(keys[key] + size, 0, keyCapacities[key] - size);
+                    keySteps[key] = steps;
+                } else { reserve(keys[key], keyCapacities[key], size, 1); }
+
+                uint8_t const* k = keys[key];
+
+                // * Encode the XOR with the keyframe as alternating runs of zero bytes and literal bytes.
+                // ? Each run is written as the number of zero bytes, the number of literal bytes, then the literal bytes.
+                // ?  Every run but the first covers at least MIN_ZERO_RUN + 1 bytes of the state, so 2*size + 20 bytes always fits.
+
+                reserve(encoded, encodedCapacity, 2*size + 20, 0);
+                uint8_t* out = encoded;
+                size_t i = 0;
+
+                while (i < size) {
+                    size_t start = i;
+
+                    // skip whole words of zeros first as most of a state is usually unchanged
+                    while (i + 8 <= size) {
+                        uint64_t a, b;
+                        memcpy(&a, state + i, 8);
+                        memcpy(&b, k + i, 8);
+                        if (a != b) { break; }
+                        i += 8;
+                    }
+
+                    while (i < size && state[i] == k[i]) { ++i; }
+                    if (i == size) { break; } // trailing zeros do not need to be stored
+
+                    size_t zeros = i - start;
+                    start = i;
+
+                    // the literals end at the next run of zeros long enough to be worth encoding
+                    for (size_t run = 0; i < size; ++i) {
+                        if (state[i] != k[i]) { run = 0; continue; }
+                        if (++run == MIN_ZERO_RUN) { i -= MIN_ZERO_RUN - 1; break; }
+                    }
+
+                    if (i == size) {
+                        while (state[i - 1] == k[i - 1]) { --i; }
+                    }
+
+                    out = writeVarint(out, zeros);
+                    out = writeVarint(out, i - start);
+
+                    for (size_t j = start; j < i; ++j) { *out++ = state[j] ^ k[j]; }
+                }
+
+                // * Store the encoded state in the oldest slot.
+
+                newest = (newest + 1) % capacity;
+                if (count < capacity) { ++count; }
+
+                Entry &entry = entries[newest];
+                size_t encodedSize = out - encoded;
+
+                if (encodedSize) {
+                    reserve(entry.data, entry.capacity, encodedSize, 0);
+                    memcpy(entry.data, encoded, encodedSize);
+                }
+
+                entry.size = encodedSize;
+                entry.rawSize = size;
+                entry.step = steps++;
+                entry.key = key;
+            };
+
+            /**
+             * @brief Decode a state.
+             *
+             * @param stepsBack Number of states before the newest. 0 for the newest state.
+             * @param size Set to the size of the state in bytes.
+             * @return (uint8_t const*) The state, valid until the next call to get. nullptr if the history does not go back that far.
+             */
+            uint8_t const* get(int stepsBack, size_t &size) {
+                size = 0;
+                if (stepsBack < 0 || stepsBack >= count) { return nullptr; }
+
+                Entry const &entry = entries[getIndex(stepsBack)];
+
+                // ? The keyframe is copied first so only the bytes which changed need to be written.
+                reserve(decoded, decodedCapacity, entry.rawSize, 0);
+                memcpy(decoded, keys[entry.key], entry.rawSize);
+
+                uint8_t const* p = entry.data;
+                uint8_t const* end = entry.data + entry.size;
+                size_t i = 0;
+
+                while (p < end) {
+                    size_t zeros, literals;
+                    p = readVarint(p, zeros);
+                    p = readVarint(p, literals);
+
+                    i += zeros;
+                    for (size_t j = 0; j < literals; ++j, ++i) { decoded[i] ^= *p++; }
+                }
+
+                size = entry.rawSize;
+                return decoded;
+            };
+
+            // Drop the newest states, such as after rewinding to an older one.
+            void drop(int num) {
+                if (num <= 0) { return; }
+                if (num >= count) { clear(); return; }
+
+                count -= num;
+                newest = getIndex(num);
+                steps = entries[newest].step + 1;
+            };
+
+            // Bytes held by the history, including the scratch space.
+            size_t getMemoryUsage() const {
+                size_t bytes = capacity * sizeof(Entry) + keyCapacities[0] + keyCapacities[1] + scratchCapacity + encodedCapacity + decodedCapacity;
+                for (int i = 0; i < capacity; ++i) { bytes += entries[i].capacity; }
+
+                return bytes;
+            };
+
+            // Bytes taken by the encoded states.
+            size_t getEncodedSize() const {
+                size_t bytes = 0;
+                for (int i = 0; i < count; ++i) { bytes += entries[getIndex(i)].size; }
+
+                return bytes;
+            };
+    };
+}
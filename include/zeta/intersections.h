@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cfloat>
 #include "bodies.h"
 
 namespace Zeta {
@@ -8,7 +9,7 @@ namespace Zeta {
     // * ===================================
 
     // Determine if a point lies on a line.
-    static bool PointAndLine(ZMath::Vec3D const &point, Line3D const &line) {
+    inline static bool PointAndLine(ZMath::Vec3D const &point, Line3D const &line) {
         // ? Determine the distance between the line and point using the projection of that point to a point on the line.
         // ? D = ||PQ x u||/||u||
         // ? If this distance is 0, we know it lies on the line.
@@ -24,7 +25,7 @@ namespace Zeta {
     };
 
     // Determine if a point lies on a plane.
-    static bool PointAndPlane(ZMath::Vec3D const &point, Plane const &plane) {
+    inline static bool PointAndPlane(ZMath::Vec3D const &point, Plane const &plane) {
         ZMath::Vec2D min = plane.getLocalMin(), max = plane.getLocalMax();
         ZMath::Vec3D p = point - plane.pos; // allows for rotation
 
@@ -36,16 +37,16 @@ namespace Zeta {
     };
 
     // Determine if a point lies within a sphere.
-    static bool PointAndSphere(ZMath::Vec3D const &point, Sphere const &sphere) { return sphere.c.distSq(point) <= sphere.r*sphere.r; };
+    inline static bool PointAndSphere(ZMath::Vec3D const &point, Sphere const &sphere) { return sphere.c.distSq(point) <= sphere.r*sphere.r; };
 
     // Determine if a point lies within an unrotated cube.
-    static bool PointAndAABB(ZMath::Vec3D const &point, AABB const &aabb) {
+    inline static bool PointAndAABB(ZMath::Vec3D const &point, AABB const &aabb) {
         ZMath::Vec3D min = aabb.getMin(), max = aabb.getMax();
         return point.x <= max.x && point.y <= max.y && point.z <= max.z && point.x >= min.x && point.y >= min.y && point.z >= min.z;
     };
 
     // Determine if a point lies within a rotated cube.
-    static bool PointAndCube(ZMath::Vec3D const &point, Cube const &cube) {
+    inline static bool PointAndCube(ZMath::Vec3D const &point, Cube const &cube) {
         ZMath::Vec3D min = cube.getLocalMin(), max = cube.getLocalMax();
         ZMath::Vec3D p = point - cube.pos; // create a copy so we can rotate into our local cords
 
@@ -60,10 +61,10 @@ namespace Zeta {
     // * ===================================
 
     // Determine if a line intersects a point.
-    static bool LineAndPoint(Line3D const &line, ZMath::Vec3D const &point) { return PointAndLine(point, line); };
+    inline static bool LineAndPoint(Line3D const &line, ZMath::Vec3D const &point) { return PointAndLine(point, line); };
 
     // Determine if a line intersects another line.
-    static bool LineAndLine(Line3D const &line1, Line3D const &line2) {
+    inline static bool LineAndLine(Line3D const &line1, Line3D const &line2) {
         // ? First check if the lines are parallel.
         // ? If the lines are parallel, we check to ensure overlap and that the start point of line2 lies on line1 if the lines were infinite.
         // ? If the lines are not parallel, we then solve for the point of intersection using the parametric equations for a 3D line.
@@ -125,7 +126,7 @@ namespace Zeta {
     };
 
     // Determine if a line intersects a plane.
-    static bool LineAndPlane(Line3D const &line, Plane const &plane) {
+    inline static bool LineAndPlane(Line3D const &line, Plane const &plane) {
         Line3D l(line.start - plane.pos, line.end - plane.pos); // copy so we can rotate it
 
         // rotate the line into the plane's local coordinates
@@ -156,7 +157,7 @@ namespace Zeta {
     };
 
     // Determine if a line intersects a sphere.
-    static bool LineAndSphere(Line3D const &line, Sphere const &sphere) {
+    inline static bool LineAndSphere(Line3D const &line, Sphere const &sphere) {
         // ? Use the parametric equations for a 3D line.
         // ? Relate the parametric equations with the distance squared to the center of the sphere.
         // ? Since we define our start point as the point at t_0 and end point as the point at t_1,
@@ -185,7 +186,7 @@ namespace Zeta {
 
     // Determine if a line intersects an unrotated cube.
     // todo this might not work
-    static bool LineAndAABB(Line3D const &line, AABB const &aabb) {
+    inline static bool LineAndAABB(Line3D const &line, AABB const &aabb) {
         // ? Check if the line has any point within the AABB's bounds.
 
         ZMath::Vec3D minL = line.getMin(), maxL = line.getMax();
@@ -196,7 +197,7 @@ namespace Zeta {
 
     // Determine if a line intersects a cube.
     // todo this might not work
-    static bool LineAndCube(Line3D const &line, Cube const &cube) {
+    inline static bool LineAndCube(Line3D const &line, Cube const &cube) {
         // ? Rotate into the Cube's UVW coordinates.
         // ? Check to see if the line is within the cube's bounds.
 
@@ -222,7 +223,7 @@ namespace Zeta {
     // Determine if a ray intersects a plane.
     // dist will be modified to equal the distance from the ray it hits the plane.
     // dist is set to -1 if there is no intersection.
-    static bool raycast(Plane const &plane, Ray3D const &ray, float &dist) {
+    inline static bool raycast(Plane const &plane, Ray3D const &ray, float &dist) {
         float dot = plane.normal * ray.dir;
 
         // check if the ray is parallel to the plane
@@ -244,56 +245,31 @@ namespace Zeta {
     // Determine if a ray intersects a sphere.
     // dist will be modified to equal the distance from the ray it hits the sphere.
     // dist is set to -1 if there is no intersection.
-    static bool raycast(Sphere const &sphere, Ray3D const &ray, float &dist) {
-        // todo at some point we may want to get the hit point.
-        // todo if we do, we simply do hit = ray.origin + dist*ray.dir;
+    inline static bool raycast(Sphere const &sphere, Ray3D const &ray, float &dist) {
+        // ? The hits are the roots of |m + t*dir|^2 = r^2 with m = origin - center, which is t^2 + 2bt + c = 0 as dir is normalized.
+        // ? c is positive when the ray starts outside of the sphere, in which case b must be negative for the ray to point towards it.
+        // ? A ray starting inside of the sphere always hits it at the larger root, where it leaves the sphere.
 
-        // ? First we find the closest point on the ray to the sphere.
-        // ? To find this point, we find the distance to it using dir * (center - origin).
-        // ? Next we solve origin + t*origin to find the closest point.
-        // ? If the distance of that closest point to the center is less than or equal to the radius, we have an intersection.
+        ZMath::Vec3D m = ray.origin - sphere.c;
+        float b = m * ray.dir, c = m * m - sphere.r*sphere.r;
 
-        // determine the closest point and the distance to that point
-        float t = ray.dir * (sphere.c - ray.origin);
-
-        // the sphere is behind the ray
-        if (t < 0) {
-            dist = -1.0f;
-            return 0;
-        }
-
-        ZMath::Vec3D close = ray.origin + ray.dir * t;
-
-        float dSq = sphere.c.distSq(close);
-        float rSq = sphere.r*sphere.r;
-
-        // no intersection
-        if (dSq > rSq) {
-            dist = -1.0f;
-            return 0;
-        }
+        dist = -1.0f;
 
-        // lands on the circumference
-        if (dSq == rSq) {
-            dist = t;
-            return 1;
-        }
+        // the ray starts outside of the sphere and points away from it
+        if (c > 0.0f && b > 0.0f) { return 0; }
 
-        // ray started in the sphere
-        if (t < sphere.r) {
-            dist = t + sqrtf(rSq - dSq);
-            return 1;
-        }
+        // the ray misses the sphere
+        float disc = b*b - c;
+        if (disc < 0.0f) { return 0; }
 
-        // standard intersection
-        dist = t - sqrtf(rSq - dSq);
+        dist = c > 0.0f ? -b - sqrtf(disc) : -b + sqrtf(disc);
         return 1;
     };
 
     // Determine if a ray intersects an AABB.
     // dist will be modified to equal the distance from the ray it hits the AABB.
     // dist is set to -1 if there is no intersection.
-    static bool raycast(AABB const &aabb, Ray3D const &ray, float &dist) {
+    inline static bool raycast(AABB const &aabb, Ray3D const &ray, float &dist) {
         // ? We can determine the distance from the ray to a certain edge by dividing a select min or max vector component
         // ?  by the corresponding component from the unit directional vector.
         // ? We know if tMin > tMax, then we have no intersection and if tMax is negative the AABB is behind us and we do not have a hit.
@@ -337,7 +313,7 @@ namespace Zeta {
     // Determine if a ray intersects a cube.
     // dist will be modified to equal the distance from the ray it hits the cube.
     // dist is set to -1 if there is no intersection.
-    static bool raycast(Cube const &cube, Ray3D const &ray, float &dist) {
+    inline static bool raycast(Cube const &cube, Ray3D const &ray, float &dist) {
         // http://groups.csail.mit.edu/graphics/classes/6.837/F02/lectures/6.837-10_rayCast.pdf
         // Slide 47, basically they recommend to convert ray to object space and check aabb, dunno
         // if its faster but MIT slides says its a good start
@@ -346,21 +322,233 @@ namespace Zeta {
         ZMath::Vec3D cubeMin = cube.getLocalMin();
         ZMath::Vec3D cubeMax = cube.getLocalMax();
 
-        ZMath::Vec3D rayOrigin = ray.origin - cube.pos;
-        ZMath::Vec3D rayDir = ray.dir;
+        // ? cube.rot takes the cube's local space to global space so its transpose takes the ray into the cube's local space.
+        // ? The rotation keeps lengths the same so the distance along the local ray is the distance along the original ray.
+        ZMath::Mat3D rotT = cube.rot.transpose();
 
-        // todo unsure if this will work for angles outside the first quadrant; it should, though (I think)
-        // ! test although im p sure it should work
+        Ray3D newRay(rotT * (ray.origin - cube.pos) + cube.pos, rotT * ray.dir);
+        AABB newCube(cubeMin, cubeMax);
 
-        rayOrigin = cube.rot * rayOrigin + cube.pos;
-        rayDir = cube.rot * rayDir;
+        return raycast(newCube, newRay, dist);
+    };
 
-        AABB newCube(cube.getLocalMin(), cube.getLocalMax());
-        Ray3D newRay(rayOrigin, rayDir);
+    // ? The following raycasts also find the normal of the surface hit.
+    // ? Unlike the raycasts above, these ignore shapes containing the origin of the ray so a ray cast from inside of a body does not hit it.
+
+    /**
+     * @brief Determine if a ray intersects a box and find the normal of the face hit.
+     * 
+     * @param pos The center of the box.
+     * @param rot The rotation of the box. The columns should be the box's axes in global coordinates.
+     * @param halfSize The halfsize of the box.
+     * @param ray The ray.
+     * @param dist Set to the distance along the ray to the hit. Set to -1 if there is no intersection.
+     * @param normal Set to the normal of the face hit. This faces against the ray.
+     * @return (bool) 1 if the ray hits the box and 0 otherwise.
+     */
+    inline static bool raycastBox(ZMath::Vec3D const &pos, ZMath::Mat3D const &rot, ZMath::Vec3D const &halfSize, Ray3D const &ray, float &dist, ZMath::Vec3D &normal) {
+        // ? Use the slab test in the box's local coordinates and keep track of the axis the ray enters through.
+
+        ZMath::Mat3D rotT = rot.transpose();
+        ZMath::Vec3D o = rotT * (ray.origin - pos), d = rotT * ray.dir;
+
+        float origin[3] = {o.x, o.y, o.z}, dir[3] = {d.x, d.y, d.z}, h[3] = {halfSize.x, halfSize.y, halfSize.z};
+        float tMin = -FLT_MAX, tMax = FLT_MAX;
+        int axis = -1;
 
-        float d2 = 0; // ! simply for making it pass the unit tests
+        dist = -1.0f;
+
+        for (int i = 0; i < 3; ++i) {
+            // parallel to the slab so the origin must be between its sides
+            if (fabsf(dir[i]) < EPSILON) {
+                if (fabsf(origin[i]) > h[i]) { return 0; }
+                continue;
+            }
+
+            float inv = 1.0f/dir[i];
+            float t1 = (-h[i] - origin[i]) * inv, t2 = (h[i] - origin[i]) * inv;
+            if (t1 > t2) { float temp = t1; t1 = t2; t2 = temp; }
+
+            if (t1 > tMin) {
+                tMin = t1;
+                axis = i;
+            }
+
+            if (t2 < tMax) { tMax = t2; }
+            if (tMin > tMax) { return 0; }
+        }
 
-        return raycast(newCube, newRay, d2);
+        // the box is behind the ray or contains its origin
+        if (axis < 0 || tMin < 0.0f) { return 0; }
+
+        float n[3] = {0.0f, 0.0f, 0.0f};
+        n[axis] = dir[axis] > 0.0f ? -1.0f : 1.0f;
+
+        dist = tMin;
+        normal = rot * ZMath::Vec3D(n[0], n[1], n[2]);
+
+        return 1;
+    };
+
+    // Determine if a ray intersects a plane and find the normal of the plane facing the ray.
+    // dist is set to -1 if there is no intersection.
+    inline static bool raycast(Plane const &plane, Ray3D const &ray, float &dist, ZMath::Vec3D &normal) {
+        ZMath::Vec2D h = plane.getHalfSize();
+        return raycastBox(plane.pos, plane.rot, ZMath::Vec3D(h.x, h.y, 0.0f), ray, dist, normal);
+    };
+
+    // Determine if a ray intersects a sphere and find the normal of the sphere at the hit.
+    // dist is set to -1 if there is no intersection.
+    inline static bool raycast(Sphere const &sphere, Ray3D const &ray, float &dist, ZMath::Vec3D &normal) {
+        ZMath::Vec3D m = ray.origin - sphere.c;
+        float b = m * ray.dir, c = m * m - sphere.r*sphere.r;
+
+        dist = -1.0f;
+
+        // the ray starts inside of the sphere or points away from it
+        if (c <= 0.0f || b > 0.0f) { return 0; }
+
+        float disc = b*b - c;
+        if (disc < 0.0f) { return 0; }
+
+        dist = -b - sqrtf(disc);
+        normal = (m + ray.dir * dist) * (1.0f/sphere.r);
+
+        return 1;
+    };
+
+    // Determine if a ray intersects an AABB and find the normal of the face hit.
+    // dist is set to -1 if there is no intersection.
+    inline static bool raycast(AABB const &aabb, Ray3D const &ray, float &dist, ZMath::Vec3D &normal) {
+        return raycastBox(aabb.pos, ZMath::Mat3D(1, 0, 0, 0, 1, 0, 0, 0, 1), aabb.getHalfSize(), ray, dist, normal);
+    };
+
+    // Determine if a ray intersects a cube and find the normal of the face hit.
+    // dist is set to -1 if there is no intersection.
+    inline static bool raycast(Cube const &cube, Ray3D const &ray, float &dist, ZMath::Vec3D &normal) {
+        return raycastBox(cube.pos, cube.rot, cube.getHalfSize(), ray, dist, normal);
+    };
+
+    // * ========================
+    // * Ray Packets
+    // * ========================
+
+    // ? The packet functions test every lane at once with branchless loops over the packet's arrays so the compiler can vectorize them.
+    // ? They take a mask of the lanes to test and return a mask of the lanes which hit.
+
+    /**
+     * @brief Determine which rays in a packet intersect a box. Lanes match raycastBox.
+     * 
+     * @param pos The center of the box.
+     * @param rot The rotation of the box.
+     * @param halfSize The halfsize of the box.
+     * @param packet The rays.
+     * @param mask The lanes to test.
+     * @param dist Set to the distance along each ray to its hit for the lanes hit.
+     * @param normal Set to the normal of the face hit for the lanes hit.
+     * @return (int) Mask of the lanes which hit the box.
+     */
+    inline static int raycastBox(ZMath::Vec3D const &pos, ZMath::Mat3D const &rot, ZMath::Vec3D const &halfSize, RayPacket const &packet, int mask, float* dist, ZMath::Vec3D* normal) {
+        alignas(4*RAY_PACKET_SIZE) float tMin[RAY_PACKET_SIZE], tMax[RAY_PACKET_SIZE], sign[RAY_PACKET_SIZE];
+        int axis[RAY_PACKET_SIZE];
+        int hits = 0;
+
+        for (int i = 0; i < RAY_PACKET_SIZE; ++i) {
+            tMin[i] = -FLT_MAX;
+            tMax[i] = FLT_MAX;
+            sign[i] = 0.0f;
+            axis[i] = -1;
+        }
+
+        float h[3] = {halfSize.x, halfSize.y, halfSize.z};
+
+        for (int a = 0; a < 3; ++a) {
+            // column a of rot is the box's local axis a in global coordinates
+            ZMath::Vec3D const &u = a == 0 ? rot.c1 : (a == 1 ? rot.c2 : rot.c3);
+
+            for (int i = 0; i < RAY_PACKET_SIZE; ++i) {
+                float o = u.x*(packet.ox[i] - pos.x) + u.y*(packet.oy[i] - pos.y) + u.z*(packet.oz[i] - pos.z);
+                float d = u.x*packet.dx[i] + u.y*packet.dy[i] + u.z*packet.dz[i];
+
+                // parallel to the slab so the origin must be between its sides
+                bool parallel = fabsf(d) < EPSILON;
+                bool inside = fabsf(o) <= h[a];
+
+                float inv = 1.0f/(parallel ? 1.0f : d);
+                float t1 = (-h[a] - o) * inv, t2 = (h[a] - o) * inv;
+                float near = ZMath::min(t1, t2), far = ZMath::max(t1, t2);
+
+                near = parallel ? (inside ? -FLT_MAX : FLT_MAX) : near;
+                far = parallel ? (inside ? FLT_MAX : -FLT_MAX) : far;
+
+                bool entered = near > tMin[i];
+                tMin[i] = entered ? near : tMin[i];
+                axis[i] = entered ? a : axis[i];
+                sign[i] = entered ? (d > 0.0f ? -1.0f : 1.0f) : sign[i];
+                tMax[i] = ZMath::min(far, tMax[i]);
+            }
+        }
+
+        // the box must be in front of the ray and not contain its origin
+        for (int i = 0; i < RAY_PACKET_SIZE; ++i) {
+            hits |= (axis[i] >= 0 && tMin[i] >= 0.0f && tMin[i] <= tMax[i]) << i;
+        }
+
+        hits &= mask;
+
+        for (int i = 0; i < RAY_PACKET_SIZE; ++i) {
+            if (!(hits & (1 << i))) { continue; }
+
+            dist[i] = tMin[i];
+            normal[i] = (axis[i] == 0 ? rot.c1 : (axis[i] == 1 ? rot.c2 : rot.c3)) * sign[i];
+        }
+
+        return hits;
+    };
+
+    // Determine which rays in a packet intersect a plane. Returns a mask of the lanes which hit.
+    inline static int raycast(Plane const &plane, RayPacket const &packet, int mask, float* dist, ZMath::Vec3D* normal) {
+        ZMath::Vec2D h = plane.getHalfSize();
+        return raycastBox(plane.pos, plane.rot, ZMath::Vec3D(h.x, h.y, 0.0f), packet, mask, dist, normal);
+    };
+
+    // Determine which rays in a packet intersect a sphere. Returns a mask of the lanes which hit.
+    inline static int raycast(Sphere const &sphere, RayPacket const &packet, int mask, float* dist, ZMath::Vec3D* normal) {
+        alignas(4*RAY_PACKET_SIZE) float t[RAY_PACKET_SIZE];
+        int hits = 0;
+        float r2 = sphere.r*sphere.r;
+
+        for (int i = 0; i < RAY_PACKET_SIZE; ++i) {
+            float mx = packet.ox[i] - sphere.c.x, my = packet.oy[i] - sphere.c.y, mz = packet.oz[i] - sphere.c.z;
+            float b = mx*packet.dx[i] + my*packet.dy[i] + mz*packet.dz[i];
+            float c = mx*mx + my*my + mz*mz - r2;
+            float disc = b*b - c;
+
+            // the ray must start outside of the sphere and point towards it
+            t[i] = -b - sqrtf(ZMath::max(disc, 0.0f));
+            hits |= (c > 0.0f && b <= 0.0f && disc >= 0.0f) << i;
+        }
+
+        hits &= mask;
+
+        for (int i = 0; i < RAY_PACKET_SIZE; ++i) {
+            if (!(hits & (1 << i))) { continue; }
+
+            dist[i] = t[i];
+            normal[i] = (ZMath::Vec3D(packet.ox[i], packet.oy[i], packet.oz[i]) + ZMath::Vec3D(packet.dx[i], packet.dy[i], packet.dz[i])*t[i] - sphere.c) * (1.0f/sphere.r);
+        }
+
+        return hits;
+    };
+
+    // Determine which rays in a packet intersect an AABB. Returns a mask of the lanes which hit.
+    inline static int raycast(AABB const &aabb, RayPacket const &packet, int mask, float* dist, ZMath::Vec3D* normal) {
+        return raycastBox(aabb.pos, ZMath::Mat3D(1, 0, 0, 0, 1, 0, 0, 0, 1), aabb.getHalfSize(), packet, mask, dist, normal);
+    };
+
+    // Determine which rays in a packet intersect a cube. Returns a mask of the lanes which hit.
+    inline static int raycast(Cube const &cube, RayPacket const &packet, int mask, float* dist, ZMath::Vec3D* normal) {
+        return raycastBox(cube.pos, cube.rot, cube.getHalfSize(), packet, mask, dist, normal);
     };
 
     // * ===================================
@@ -368,13 +556,13 @@ namespace Zeta {
     // * ===================================
 
     // Determine if a plane intersects a point.
-    static bool PlaneAndPoint(Plane const &plane, ZMath::Vec3D const &point) { return PointAndPlane(point, plane); };
+    inline static bool PlaneAndPoint(Plane const &plane, ZMath::Vec3D const &point) { return PointAndPlane(point, plane); };
 
     // Determine if a plane intersects a line.
-    static bool PlaneAndLine(Plane const &plane, Line3D const &line) { return LineAndPlane(line, plane); };
+    inline static bool PlaneAndLine(Plane const &plane, Line3D const &line) { return LineAndPlane(line, plane); };
 
     // Determine if a plane intersects a sphere.
-    static bool PlaneAndSphere(Plane const &plane, Sphere const &sphere) {
+    inline static bool PlaneAndSphere(Plane const &plane, Sphere const &sphere) {
         // ? A line from the center of the sphere along the normal of the plane will eventually
         // ?  intersect an infinite plane at the closest point of intersection.
         // ? Using this, we can take the distance to the plane from that point using the equation
@@ -399,7 +587,7 @@ namespace Zeta {
     // Check for intersection and return the collision normal.
     // If there is not an intersection, the normal will be a junk value.
     // The normal will point towards B away from A.
-    static bool PlaneAndSphere(Plane const &plane, Sphere const &sphere, ZMath::Vec3D &normal) {
+    inline static bool PlaneAndSphere(Plane const &plane, Sphere const &sphere, ZMath::Vec3D &normal) {
         ZMath::Vec3D closest(sphere.c - plane.pos);
         ZMath::Vec2D min = plane.getLocalMin(), max = plane.getLocalMax();
 
@@ -418,7 +606,7 @@ namespace Zeta {
     };
 
     // Determine if a plane intersects an unrotated cube.
-    static bool PlaneAndAABB(Plane const &plane, AABB const &aabb) {
+    inline static bool PlaneAndAABB(Plane const &plane, AABB const &aabb) {
         // halfsize of the plane (A) and aabb (B)
         ZMath::Vec2D planeH = plane.getHalfSize();
         ZMath::Vec3D hA(planeH.x, planeH.y, 0.0f), hB = aabb.getHalfSize();
@@ -447,7 +635,7 @@ namespace Zeta {
     // Check for intersection and return the collision normal.
     // If there is not an intersection, the normal will be a junk value.
     // The normal will point towards B away from A.
-    static bool PlaneAndAABB(Plane const &plane, AABB const &aabb, ZMath::Vec3D &normal) {
+    inline static bool PlaneAndAABB(Plane const &plane, AABB const &aabb, ZMath::Vec3D &normal) {
         // halfsize of the plane (A) and aabb (B)
         ZMath::Vec2D planeH = plane.getHalfSize();
         ZMath::Vec3D hA(planeH.x, planeH.y, 0.0f), hB = aabb.getHalfSize();
@@ -517,7 +705,7 @@ namespace Zeta {
     };
 
     // Determine if a plane intersects a cube.
-    static bool PlaneAndCube(Plane const &plane, Cube const &cube) {
+    inline static bool PlaneAndCube(Plane const &plane, Cube const &cube) {
         // halfsize of the plane (A) and cube (B)
         ZMath::Vec2D planeH = plane.getHalfSize();
         ZMath::Vec3D hA(planeH.x, planeH.y, 0.0f), hB = cube.getHalfSize();
@@ -559,7 +747,7 @@ namespace Zeta {
     // Check for intersection and return the collision normal.
     // If there is not an intersection, the normal will be a junk value.
     // The normal will point towards B away from A.
-    static bool PlaneAndCube(Plane const &plane, Cube const &cube, ZMath::Vec3D &normal) {
+    inline static bool PlaneAndCube(Plane const &plane, Cube const &cube, ZMath::Vec3D &normal) {
         // halfsize of the plane (A) and cube (B)
         ZMath::Vec2D planeH = plane.getHalfSize();
         ZMath::Vec3D hA(planeH.x, planeH.y, 0.0f), hB = cube.getHalfSize();
@@ -646,16 +834,16 @@ namespace Zeta {
     // * ===================================
 
     // Determine if a sphere intersects a point.
-    static bool SphereAndPoint(Sphere const &sphere, ZMath::Vec3D const &point) { return PointAndSphere(point, sphere); };
+    inline static bool SphereAndPoint(Sphere const &sphere, ZMath::Vec3D const &point) { return PointAndSphere(point, sphere); };
 
     // Determine if a sphere intersects a line.
-    static bool SphereAndLine(Sphere const &sphere, Line3D const &line) { return LineAndSphere(line, sphere); };
+    inline static bool SphereAndLine(Sphere const &sphere, Line3D const &line) { return LineAndSphere(line, sphere); };
 
     // Determine if a sphere intersects a plane.
-    static bool SphereAndPlane(Sphere const &sphere, Plane const &plane) { return PlaneAndSphere(plane, sphere); };
+    inline static bool SphereAndPlane(Sphere const &sphere, Plane const &plane) { return PlaneAndSphere(plane, sphere); };
 
     // Determine if a sphere intersects another sphere.
-    static bool SphereAndSphere(Sphere const &sphere1, Sphere const &sphere2) {
+    inline static bool SphereAndSphere(Sphere const &sphere1, Sphere const &sphere2) {
         float r = sphere1.r + sphere2.r;
         return sphere1.c.distSq(sphere2.c) <= r*r;
     };
@@ -663,7 +851,7 @@ namespace Zeta {
     // Check for intersection and return the collision normal.
     // If there is not an intersection, the normal will be a junk value.
     // The normal will point towards B away from A.
-    static bool SphereAndSphere(Sphere const &sphere1, Sphere const &sphere2, ZMath::Vec3D &normal) {
+    inline static bool SphereAndSphere(Sphere const &sphere1, Sphere const &sphere2, ZMath::Vec3D &normal) {
         float r = sphere1.r + sphere2.r;
         ZMath::Vec3D sphereDiff = sphere2.c - sphere1.c;
 
@@ -674,23 +862,23 @@ namespace Zeta {
     };
 
     // Determine if a sphere intersects an unrotated cube.
-    static bool SphereAndAABB(Sphere const &sphere, AABB const &aabb) {
+    inline static bool SphereAndAABB(Sphere const &sphere, AABB const &aabb) {
         // ? We know a sphere and AABB would intersect if the distance from the closest point to the center on the AABB
         // ?  from the center is less than or equal to the radius of the sphere.
         // ? We can determine the closet point by clamping the value of the sphere's center between the min and max of the AABB.
         // ? From here, we can check the distance from this point to the sphere's center.
 
         ZMath::Vec3D min = aabb.getMin(), max = aabb.getMax();
-        ZMath::Vec3D closest = ZMath::clamp(closest, min, max);
+        ZMath::Vec3D closest = ZMath::clamp(sphere.c, min, max);
         return closest.distSq(sphere.c) <= sphere.r*sphere.r;
     };
 
     // Check for intersection and return the collision normal.
     // If there is not an intersection, the normal will be a junk value.
     // The normal will point towards B away from A.
-    static bool SphereAndAABB(Sphere const &sphere, AABB const & aabb, ZMath::Vec3D &normal) {
+    inline static bool SphereAndAABB(Sphere const &sphere, AABB const & aabb, ZMath::Vec3D &normal) {
         ZMath::Vec3D min = aabb.getMin(), max = aabb.getMax();
-        ZMath::Vec3D closest = ZMath::clamp(closest, min, max);
+        ZMath::Vec3D closest = ZMath::clamp(sphere.c, min, max);
         ZMath::Vec3D diff = closest - sphere.c;
 
         if (diff.magSq() > sphere.r*sphere.r) { return 0; }
@@ -701,42 +889,35 @@ namespace Zeta {
     };
 
     // Determine if a sphere intersects a cube.
-    static bool SphereAndCube(Sphere const &sphere, Cube const &cube) {
+    inline static bool SphereAndCube(Sphere const &sphere, Cube const &cube) {
         // ? We can use the same approach as for SphereAndAABB, just we have to rotate the sphere into the Cube's UVW coordinates.
+        // ? The cube's rotation matrix rotates from its local space to global space, so its transpose rotates the other way.
 
-        ZMath::Vec3D closest = sphere.c - cube.pos;
-        ZMath::Vec3D min = cube.getLocalMin(), max = cube.getLocalMax();
+        ZMath::Vec3D h = cube.getHalfSize();
 
         // rotate the center of the sphere into the UVW coordinates of our cube
-        closest = cube.rot * closest + cube.pos;
-        
+        ZMath::Vec3D center = cube.rot.transpose() * (sphere.c - cube.pos);
+
         // perform the check as if it was an AABB vs Sphere
-        closest = ZMath::clamp(closest, min, max);
-        return closest.distSq(sphere.c) <= sphere.r*sphere.r;
+        ZMath::Vec3D closest = ZMath::clamp(center, -h, h);
+        return closest.distSq(center) <= sphere.r*sphere.r;
     };
 
     // Check for intersection and return the collision normal.
     // If there is not an intersection, the normal will be a junk value.
     // The normal will point towards B away from A.
-    static bool SphereAndCube(Sphere const &sphere, Cube const &cube, ZMath::Vec3D &normal) {
-        ZMath::Vec3D closest = sphere.c - cube.pos;
-        ZMath::Vec3D min = cube.getLocalMin(), max = cube.getLocalMax();
+    inline static bool SphereAndCube(Sphere const &sphere, Cube const &cube, ZMath::Vec3D &normal) {
+        ZMath::Vec3D h = cube.getHalfSize();
 
         // rotate the center of the sphere into the UVW coordinates of our cube
-        closest = cube.rot * closest + cube.pos;
-        
-        // perform the check as if it was an AABB vs Sphere
-        closest = ZMath::clamp(closest, min, max);
-        ZMath::Vec3D diff = closest - sphere.c;
-
-        if (diff.magSq() > sphere.r*sphere.r) { return 0; }
+        ZMath::Vec3D center = cube.rot.transpose() * (sphere.c - cube.pos);
 
-        // the closest point to the sphere's center will be our contact point rotated back into global coordinates coordinates
-
-        closest -= cube.pos;
-        closest = cube.rot.transpose() * closest + cube.pos;
+        // perform the check as if it was an AABB vs Sphere
+        ZMath::Vec3D closest = ZMath::clamp(center, -h, h);
+        if (closest.distSq(center) > sphere.r*sphere.r) { return 0; }
 
-        normal = diff.normalize();
+        // the closest point to the sphere's center rotated back into global coordinates gives us the normal
+        normal = (cube.rot * closest + cube.pos - sphere.c).normalize();
 
         return 1;
     };
@@ -746,28 +927,28 @@ namespace Zeta {
     // * ===================================
 
     // Determine if an unrotated cube intersects a point.
-    static bool AABBAndPoint(AABB const &aabb, ZMath::Vec3D const &point) { return PointAndAABB(point, aabb); };
+    inline static bool AABBAndPoint(AABB const &aabb, ZMath::Vec3D const &point) { return PointAndAABB(point, aabb); };
 
     // Determine if an unrotated cube intersects a line.
-    static bool AABBAndLine(AABB const &aabb, Line3D const &line) { return LineAndAABB(line, aabb); };
+    inline static bool AABBAndLine(AABB const &aabb, Line3D const &line) { return LineAndAABB(line, aabb); };
 
     // Determine if an unrotated cube intersects a plane.
-    static bool AABBAndPlane(AABB const &aabb, Plane const &plane) { return PlaneAndAABB(plane, aabb); };
+    inline static bool AABBAndPlane(AABB const &aabb, Plane const &plane) { return PlaneAndAABB(plane, aabb); };
 
     // Determine if an unrotated cube intersects a sphere.
-    static bool AABBAndSphere(AABB const &aabb, Sphere const &sphere) { return SphereAndAABB(sphere, aabb); };
+    inline static bool AABBAndSphere(AABB const &aabb, Sphere const &sphere) { return SphereAndAABB(sphere, aabb); };
 
     // Check for intersection and return the collision normal.
     // If there is not an intersection, the normal will be a junk value.
     // The normal will point towards B away from A.
-    static bool AABBAndSphere(AABB const &aabb, Sphere const &sphere, ZMath::Vec3D &normal) {
+    inline static bool AABBAndSphere(AABB const &aabb, Sphere const &sphere, ZMath::Vec3D &normal) {
         bool hit = SphereAndAABB(sphere, aabb, normal);
         normal = -normal;
         return hit;
     };
 
     // Determine if an unrotated cube intersects another unrotated cube.
-    static bool AABBAndAABB(AABB const &aabb1, AABB const &aabb2) {
+    inline static bool AABBAndAABB(AABB const &aabb1, AABB const &aabb2) {
         // ? Check if there's overlap for the AABBs on all three axes.
         // ? If there is, we know the two AABBs intersect.
 
@@ -780,7 +961,7 @@ namespace Zeta {
     // Check for intersection and return the collision normal.
     // If there is not an intersection, the normal will be a junk value.
     // The normal will point towards B away from A.
-    static bool AABBAndAABB(AABB const &aabb1, AABB const &aabb2, ZMath::Vec3D &normal) {
+    inline static bool AABBAndAABB(AABB const &aabb1, AABB const &aabb2, ZMath::Vec3D &normal) {
         // half size of AABB a and b respectively
         ZMath::Vec3D hA = aabb1.getHalfSize(), hB = aabb2.getHalfSize();
 
@@ -826,35 +1007,68 @@ namespace Zeta {
         return 1;
     };
 
-    // Determine if an unrotated cube intersects a cube.
-    static bool AABBAndCube(AABB const &aabb, Cube const &cube) {
-        // ? Use the separating axis theorem to determine if there is an intersection between the AABB and cube.
+    // Determine if two boxes intersect using the separating axis theorem on all 15 axes (each box's face normals and the cross products of their edges).
+    // The rotation matrices rotate from each box's local space to global space.
+    inline static bool BoxAndBox(ZMath::Vec3D const &pos1, ZMath::Mat3D const &rot1, ZMath::Vec3D const &h1,
+                          ZMath::Vec3D const &pos2, ZMath::Mat3D const &rot2, ZMath::Vec3D const &h2) {
 
-        // half size of the aabb and cube respectively (A = AABB, B = Cube)
-        ZMath::Vec3D hA = aabb.getHalfSize(), hB = cube.getHalfSize();
+        ZMath::Vec3D const* axes1[3] = {&rot1.c1, &rot1.c2, &rot1.c3};
+        ZMath::Vec3D const* axes2[3] = {&rot2.c1, &rot2.c2, &rot2.c3};
+        float hA[3] = {h1.x, h1.y, h1.z}, hB[3] = {h2.x, h2.y, h2.z};
 
-        // rotate anything from global space to the cube's local space
-        ZMath::Mat3D rotBT = cube.rot.transpose();
+        // * Express the second box in the first box's local space.
 
-        // determine the distance between the positions
-        ZMath::Vec3D dA = cube.pos - aabb.pos; // global space is the AABB's local space
-        ZMath::Vec3D dB = rotBT * dA;
+        ZMath::Vec3D dP = pos2 - pos1;
+        float d[3], R[3][3], absR[3][3];
 
-        // * Check for intersection using the separating axis theorem
+        for (int i = 0; i < 3; ++i) {
+            d[i] = dP * *axes1[i];
 
-        // amount of penetration along A's axes
-        ZMath::Vec3D faceA = ZMath::abs(dA) - hA - hB;
-        if (faceA.x > 0 || faceA.y > 0 || faceA.z > 0) { return 0; }
+            for (int j = 0; j < 3; ++j) {
+                R[i][j] = *axes1[i] * *axes2[j];
 
-        // amount of penetration along B's axes
-        ZMath::Vec3D faceB = ZMath::abs(dB) - hB - rotBT * hA;
-        return faceB.x <= 0 && faceB.y <= 0 && faceB.z <= 0;
+                // ? The epsilon stops the edge axes from reporting a false separation when two edges are parallel and their cross product is zero.
+                absR[i][j] = fabsf(R[i][j]) + (float) EPSILON;
+            }
+        }
+
+        // A's axes
+        for (int i = 0; i < 3; ++i) {
+            if (fabsf(d[i]) > hA[i] + hB[0]*absR[i][0] + hB[1]*absR[i][1] + hB[2]*absR[i][2]) { return 0; }
+        }
+
+        // B's axes
+        for (int j = 0; j < 3; ++j) {
+            float dist = d[0]*R[0][j] + d[1]*R[1][j] + d[2]*R[2][j];
+            if (fabsf(dist) > hB[j] + hA[0]*absR[0][j] + hA[1]*absR[1][j] + hA[2]*absR[2][j]) { return 0; }
+        }
+
+        // cross products of A's axes with B's axes
+        for (int i = 0; i < 3; ++i) {
+            int i1 = (i + 1) % 3, i2 = (i + 2) % 3;
+
+            for (int j = 0; j < 3; ++j) {
+                int j1 = (j + 1) % 3, j2 = (j + 2) % 3;
+
+                float rA = hA[i1]*absR[i2][j] + hA[i2]*absR[i1][j];
+                float rB = hB[j1]*absR[i][j2] + hB[j2]*absR[i][j1];
+
+                if (fabsf(d[i2]*R[i1][j] - d[i1]*R[i2][j]) > rA + rB) { return 0; }
+            }
+        }
+
+        return 1;
+    };
+
+    // Determine if an unrotated cube intersects a cube.
+    inline static bool AABBAndCube(AABB const &aabb, Cube const &cube) {
+        return BoxAndBox(aabb.pos, ZMath::Mat3D(1, 0, 0, 0, 1, 0, 0, 0, 1), aabb.getHalfSize(), cube.pos, cube.rot, cube.getHalfSize());
     };
 
     // Check for intersection and return the collision normal.
     // If there is not an intersection, the normal will be a junk value.
     // The normal will point towards B away from A.
-    static bool AABBAndCube(AABB const &aabb, Cube const &cube, ZMath::Vec3D &normal) {
+    inline static bool AABBAndCube(AABB const &aabb, Cube const &cube, ZMath::Vec3D &normal) {
         // ? Use the separating axis theorem to determine if there is an intersection between the AABB and cube.
 
         // half size of the aabb and cube respectively (A = AABB, B = Cube)
@@ -869,13 +1083,15 @@ namespace Zeta {
 
         // * Check for intersection using the separating axis theorem
 
+        if (!BoxAndBox(aabb.pos, ZMath::Mat3D(1, 0, 0, 0, 1, 0, 0, 0, 1), hA, cube.pos, cube.rot, hB)) { return 0; }
+
+        // ? The extent of each box along the other's axes is its half size projected with the absolute value of the rotation.
+
         // amount of penetration along A's axes
-        ZMath::Vec3D faceA = ZMath::abs(dA) - hA - hB;
-        if (faceA.x > 0 || faceA.y > 0 || faceA.z > 0) { return 0; }
+        ZMath::Vec3D faceA = ZMath::abs(dA) - hA - ZMath::abs(cube.rot) * hB;
 
         // amount of penetration along B's axes
-        ZMath::Vec3D faceB = ZMath::abs(dB) - hB - rotBT * hA;
-        if (faceB.x > 0 || faceB.y > 0 || faceB.z > 0) { return 0; }
+        ZMath::Vec3D faceB = ZMath::abs(dB) - hB - ZMath::abs(rotBT) * hA;
         
         // * Find the best axis (i.e. the axis with the least amount of penetration).
 
@@ -926,40 +1142,40 @@ namespace Zeta {
     // * ===================================
 
     // Determine if a cube intersects a point.
-    static bool CubeAndPoint(Cube const &cube, ZMath::Vec3D const &point) { return PointAndCube(point, cube); };
+    inline static bool CubeAndPoint(Cube const &cube, ZMath::Vec3D const &point) { return PointAndCube(point, cube); };
 
     // Determine if a cube intersects a line.
-    static bool CubeAndLine(Cube const &cube, Line3D const &line) { return LineAndCube(line, cube); };
+    inline static bool CubeAndLine(Cube const &cube, Line3D const &line) { return LineAndCube(line, cube); };
 
     // Determine if a cube intersects a plane.
-    static bool CubeAndPlane(Cube const &cube, Plane const &plane) { return PlaneAndCube(plane, cube); };
+    inline static bool CubeAndPlane(Cube const &cube, Plane const &plane) { return PlaneAndCube(plane, cube); };
 
     // Determine if a cube intersects a sphere.
-    static bool CubeAndSphere(Cube const &cube, Sphere const &sphere) { return SphereAndCube(sphere, cube); };
+    inline static bool CubeAndSphere(Cube const &cube, Sphere const &sphere) { return SphereAndCube(sphere, cube); };
 
     // Check for intersection and return the collision normal.
     // If there is not an intersection, the normal will be a junk value.
     // The normal will point towards B away from A.
-    static bool CubeAndSphere(Cube const &cube, Sphere const &sphere, ZMath::Vec3D &normal) {
+    inline static bool CubeAndSphere(Cube const &cube, Sphere const &sphere, ZMath::Vec3D &normal) {
         bool hit = SphereAndCube(sphere, cube, normal);
         normal = -normal;
         return hit;
     };
 
     // Determine if a cube intersects an unrotated cube.
-    static bool CubeAndAABB(Cube const &cube, AABB const &aabb) { return AABBAndCube(aabb, cube); };
+    inline static bool CubeAndAABB(Cube const &cube, AABB const &aabb) { return AABBAndCube(aabb, cube); };
 
     // Check for intersection and return the collision normal.
     // If there is not an intersection, the normal will be a junk value.
     // The normal will point towards B away from A.
-    static bool CubeAndAABB(Cube const &cube, AABB const &aabb, ZMath::Vec3D &normal) {
+    inline static bool CubeAndAABB(Cube const &cube, AABB const &aabb, ZMath::Vec3D &normal) {
         bool hit = AABBAndCube(aabb, cube, normal);
         normal = -normal;
         return hit;
     };
 
     // Determine if a cube intersects another cube.
-    static bool CubeAndCube(Cube const &cube1, Cube const &cube2) {
+    inline static bool CubeAndCube(Cube const &cube1, Cube const &cube2) {
         // ? Use the separating axis theorem to determine if there is an intersection between the cubes.
 
         // half size of cube a and b respectively
@@ -997,7 +1213,7 @@ namespace Zeta {
     // Check for intersection and return the collision normal.
     // If there is not an intersection, the normal will be a junk value.
     // The normal will point towards B away from A.
-    static bool CubeAndCube(Cube const &cube1, Cube const &cube2, ZMath::Vec3D &normal) {
+    inline static bool CubeAndCube(Cube const &cube1, Cube const &cube2, ZMath::Vec3D &normal) {
         // ? Use the separating axis theorem to determine if there is an intersection between the cubes.
 
         // half size of cube a and b respectively
@@ -1075,6 +1291,780 @@ namespace Zeta {
         return 1;
     };
 
+    // * ===================================
+    // * Heightfield vs Primitives
+    // * ===================================
+
+    // ? A heightfield is treated as solid below its surface. Anything over a tile which is not loaded will never intersect it.
+
+    // Find the closest point on a triangle to a point.
+    inline static ZMath::Vec3D closestPointOnTriangle(ZMath::Vec3D const &p, ZMath::Vec3D const &a, ZMath::Vec3D const &b, ZMath::Vec3D const &c) {
+        // ? Determine which voronoi region of the triangle the point lies in using barycentric coordinates.
+        // ? From there the closest point is either a vertex, a point on an edge, or the projection of the point onto the face.
+
+        ZMath::Vec3D ab = b - a, ac = c - a, ap = p - a;
+        float d1 = ab * ap, d2 = ac * ap;
+
+        if (d1 <= 0.0f && d2 <= 0.0f) { return a; }
+
+        ZMath::Vec3D bp = p - b;
+        float d3 = ab * bp, d4 = ac * bp;
+
+        if (d3 >= 0.0f && d4 <= d3) { return b; }
+
+        float vc = d1*d4 - d3*d2;
+        if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f) { return a + ab * (d1/(d1 - d3)); }
+
+        ZMath::Vec3D cp = p - c;
+        float d5 = ab * cp, d6 = ac * cp;
+
+        if (d6 >= 0.0f && d5 <= d6) { return c; }
+
+        float vb = d5*d2 - d1*d6;
+        if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f) { return a + ac * (d2/(d2 - d6)); }
+
+        float va = d3*d6 - d5*d4;
+        if (va <= 0.0f && d4 - d3 >= 0.0f && d5 - d6 >= 0.0f) { return b + (c - b) * ((d4 - d3)/((d4 - d3) + (d5 - d6))); }
+
+        // the point projects onto the face of the triangle
+        float denom = 1.0f/(va + vb + vc);
+        return a + ab * (vb * denom) + ac * (vc * denom);
+    };
+
+    // Determine if a ray intersects a triangle.
+    // dist will be modified to equal the distance from the ray it hits the triangle.
+    // dist is set to -1 if there is no intersection.
+    inline static bool raycastTriangle(ZMath::Vec3D const &a, ZMath::Vec3D const &b, ZMath::Vec3D const &c, Ray3D const &ray, float &dist) {
+        // ? Moller-Trumbore. Solve origin + t*dir = a + u*(b - a) + v*(c - a) using Cramer's rule.
+
+        ZMath::Vec3D e1 = b - a, e2 = c - a;
+        ZMath::Vec3D p = ray.dir.cross(e2);
+        float det = e1 * p;
+
+        // the ray is parallel to the triangle
+        if (!det) { dist = -1.0f; return 0; }
+
+        float invDet = 1.0f/det;
+        ZMath::Vec3D s = ray.origin - a;
+        float u = (s * p) * invDet;
+
+        if (u < 0.0f || u > 1.0f) { dist = -1.0f; return 0; }
+
+        ZMath::Vec3D q = s.cross(e1);
+        float v = (ray.dir * q) * invDet;
+
+        if (v < 0.0f || u + v > 1.0f) { dist = -1.0f; return 0; }
+
+        dist = (e2 * q) * invDet;
+        if (dist >= 0.0f) { return 1; }
+
+        dist = -1.0f;
+        return 0;
+    };
+
+    // Determine if a triangle intersects a box centered at the origin using SAT.
+    // The triangle's vertices must be given in the box's local coordinates.
+    inline static bool triangleAndBox(ZMath::Vec3D const &v0, ZMath::Vec3D const &v1, ZMath::Vec3D const &v2, ZMath::Vec3D const &halfSize) {
+        // ? There are 13 possible separating axes: the 3 face normals of the box, the normal of the triangle,
+        // ?  and the 9 cross products between the box's face normals and the triangle's edges.
+
+        // box face normals
+        if (ZMath::min(v0.x, ZMath::min(v1.x, v2.x)) > halfSize.x || ZMath::max(v0.x, ZMath::max(v1.x, v2.x)) < -halfSize.x) { return 0; }
+        if (ZMath::min(v0.y, ZMath::min(v1.y, v2.y)) > halfSize.y || ZMath::max(v0.y, ZMath::max(v1.y, v2.y)) < -halfSize.y) { return 0; }
+        if (ZMath::min(v0.z, ZMath::min(v1.z, v2.z)) > halfSize.z || ZMath::max(v0.z, ZMath::max(v1.z, v2.z)) < -halfSize.z) { return 0; }
+
+        ZMath::Vec3D edges[3] = {v1 - v0, v2 - v1, v0 - v2};
+
+        // triangle normal
+        ZMath::Vec3D n = edges[0].cross(edges[1]);
+        float r = halfSize * ZMath::abs(n);
+        if (fabsf(n * v0) > r) { return 0; }
+
+        // edge cross products
+        ZMath::Vec3D axes[3] = {ZMath::Vec3D(1, 0, 0), ZMath::Vec3D(0, 1, 0), ZMath::Vec3D(0, 0, 1)};
+
+        for (int i = 0; i < 3; ++i) {
+            for (int j = 0; j < 3; ++j) {
+                ZMath::Vec3D a = axes[i].cross(edges[j]);
+
+                float p0 = a * v0, p1 = a * v1, p2 = a * v2;
+                r = halfSize * ZMath::abs(a);
+
+                if (ZMath::min(p0, ZMath::min(p1, p2)) > r || ZMath::max(p0, ZMath::max(p1, p2)) < -r) { return 0; }
+            }
+        }
+
+        return 1;
+    };
+
+    /**
+     * @brief Find the closest point on the surface of a heightfield to a point within a max distance.
+     *
+     * @param hf The heightfield.
+     * @param point The point.
+     * @param maxDist Only surface within this distance of the point is considered.
+     * @param closest Set to the closest point on the surface.
+     * @return (bool) 1 if a point on the surface lies within maxDist and 0 otherwise.
+     */
+    inline static bool closestPointOnHeightfield(Heightfield const &hf, ZMath::Vec3D const &point, float maxDist, ZMath::Vec3D &closest) {
+        uint32_t cx0, cy0, cx1, cy1;
+        float maxZ;
+
+        if (!hf.getCellRange(point - maxDist, point + maxDist, cx0, cy0, cx1, cy1)) { return 0; }
+        if (!hf.getMaxHeight(cx0, cy0, cx1, cy1, maxZ) || point.z - maxDist > maxZ) { return 0; }
+
+        float best = maxDist*maxDist;
+        bool found = 0;
+        ZMath::Vec3D v[4];
+
+        for (uint32_t cy = cy0; cy <= cy1; ++cy) {
+            for (uint32_t cx = cx0; cx <= cx1; ++cx) {
+                if (!hf.getCellVertices(cx, cy, v)) { continue; }
+
+                // skip cells entirely below the point's reach
+                if (point.z - maxDist > ZMath::max(ZMath::max(v[0].z, v[1].z), ZMath::max(v[2].z, v[3].z))) { continue; }
+
+                ZMath::Vec3D c1 = closestPointOnTriangle(point, v[0], v[1], v[3]);
+                ZMath::Vec3D c2 = closestPointOnTriangle(point, v[0], v[3], v[2]);
+                float d1 = c1.distSq(point), d2 = c2.distSq(point);
+
+                if (d1 <= best) { best = d1; closest = c1; found = 1; }
+                if (d2 <= best) { best = d2; closest = c2; found = 1; }
+            }
+        }
+
+        return found;
+    };
+
+    // Determine if a point lies on or below the surface of a heightfield.
+    inline static bool HeightfieldAndPoint(Heightfield const &hf, ZMath::Vec3D const &point) {
+        float h;
+        ZMath::Vec3D n;
+        return hf.getHeight(point.x, point.y, h, n) && point.z <= h;
+    };
+
+    // Determine if a heightfield intersects a sphere.
+    inline static bool HeightfieldAndSphere(Heightfield const &hf, Sphere const &sphere) {
+        float h;
+        ZMath::Vec3D closest;
+
+        // the center of the sphere is below the surface
+        if (hf.getHeight(sphere.c.x, sphere.c.y, h, closest) && sphere.c.z <= h) { return 1; }
+
+        return closestPointOnHeightfield(hf, sphere.c, sphere.r, closest);
+    };
+
+    // Check for intersection and return the collision normal.
+    // If there is not an intersection, the normal will be a junk value.
+    // The normal will point towards B away from A.
+    inline static bool HeightfieldAndSphere(Heightfield const &hf, Sphere const &sphere, ZMath::Vec3D &normal) {
+        float h;
+        ZMath::Vec3D closest;
+
+        // the center of the sphere is below the surface so push it out along the surface normal
+        if (hf.getHeight(sphere.c.x, sphere.c.y, h, normal) && sphere.c.z <= h) {
+            normal = normal.normalize();
+            return 1;
+        }
+
+        if (!closestPointOnHeightfield(hf, sphere.c, sphere.r, closest)) { return 0; }
+
+        normal = (sphere.c - closest).normalize();
+        return 1;
+    };
+
+    /**
+     * @brief Determine if a heightfield intersects a box.
+     *
+     * @param hf The heightfield.
+     * @param pos The center of the box.
+     * @param rot The rotation of the box. The columns should be the box's axes in global coordinates.
+     * @param halfSize The half size of the box.
+     * @return (bool) 1 if they intersect and 0 otherwise.
+     */
+    inline static bool heightfieldAndBox(Heightfield const &hf, ZMath::Vec3D const &pos, ZMath::Mat3D const &rot, ZMath::Vec3D const &halfSize) {
+        // ? Either a vertex of the box is below the surface (this covers boxes entirely underground) or a triangle of the surface intersects the box.
+
+        // half size of the box's bounds in global coordinates
+        ZMath::Vec3D extents = ZMath::abs(rot) * halfSize;
+
+        uint32_t cx0, cy0, cx1, cy1;
+        float maxZ;
+
+        if (!hf.getCellRange(pos - extents, pos + extents, cx0, cy0, cx1, cy1)) { return 0; }
+        if (!hf.getMaxHeight(cx0, cy0, cx1, cy1, maxZ) || pos.z - extents.z > maxZ) { return 0; }
+
+        // check the vertices of the box
+        float h;
+        ZMath::Vec3D n;
+
+        for (int i = 0; i < 8; ++i) {
+            ZMath::Vec3D v = pos + rot * ZMath::Vec3D(i & 1 ? halfSize.x : -halfSize.x, i & 2 ? halfSize.y : -halfSize.y, i & 4 ? halfSize.z : -halfSize.z);
+            if (hf.getHeight(v.x, v.y, h, n) && v.z <= h) { return 1; }
+        }
+
+        // check the triangles of the surface in the box's local coordinates
+        ZMath::Mat3D invRot = rot.transpose();
+        ZMath::Vec3D v[4];
+
+        for (uint32_t cy = cy0; cy <= cy1; ++cy) {
+            for (uint32_t cx = cx0; cx <= cx1; ++cx) {
+                if (!hf.getCellVertices(cx, cy, v)) { continue; }
+
+                for (int i = 0; i < 4; ++i) { v[i] = invRot * (v[i] - pos); }
+
+                if (triangleAndBox(v[0], v[1], v[3], halfSize) || triangleAndBox(v[0], v[3], v[2], halfSize)) { return 1; }
+            }
+        }
+
+        return 0;
+    };
+
+    // Determine if a heightfield intersects an unrotated cube.
+    inline static bool HeightfieldAndAABB(Heightfield const &hf, AABB const &aabb) {
+        return heightfieldAndBox(hf, aabb.pos, ZMath::Mat3D(1, 0, 0, 0, 1, 0, 0, 0, 1), aabb.getHalfSize());
+    };
+
+    // Determine if a heightfield intersects a cube.
+    inline static bool HeightfieldAndCube(Heightfield const &hf, Cube const &cube) {
+        return heightfieldAndBox(hf, cube.pos, cube.rot, cube.getHalfSize());
+    };
+
+    // Determine if a ray intersects a heightfield.
+    // dist will be modified to equal the distance from the ray it hits the heightfield.
+    // dist is set to -1 if there is no intersection.
+    inline static bool raycast(Heightfield const &hf, Ray3D const &ray, float &dist) {
+        // ? Clip the ray to the bounds of the heightfield and then walk the cells under the ray in order (2D DDA).
+        // ? The first cell containing a hit contains the closest hit so we can stop there.
+        // ? Cells entirely below the ray over the cell's span are skipped without testing their triangles.
+
+        dist = -1.0f;
+
+        ZMath::Vec3D min = hf.getMin(), max = hf.getMax();
+        ZMath::Vec3D dirfrac(1.0f/ray.dir.x, 1.0f/ray.dir.y, 1.0f/ray.dir.z);
+
+        float t1 = (min.x - ray.origin.x)*dirfrac.x;
+        float t2 = (max.x - ray.origin.x)*dirfrac.x;
+        float t3 = (min.y - ray.origin.y)*dirfrac.y;
+        float t4 = (max.y - ray.origin.y)*dirfrac.y;
+        float t5 = (min.z - ray.origin.z)*dirfrac.z;
+        float t6 = (max.z - ray.origin.z)*dirfrac.z;
+
+        float tMin = ZMath::max(ZMath::max(ZMath::min(t1, t2), ZMath::min(t3, t4)), ZMath::min(t5, t6));
+        float tMax = ZMath::min(ZMath::min(ZMath::max(t1, t2), ZMath::max(t3, t4)), ZMath::max(t5, t6));
+
+        if (tMax < 0 || tMax < tMin) { return 0; }
+        if (tMin < 0) { tMin = 0; }
+
+        // find the starting cell
+        ZMath::Vec3D start = ray.origin + ray.dir * tMin;
+        float invCell = 1.0f/hf.cellSize;
+
+        int cx = (int) ZMath::clamp((start.x - hf.pos.x) * invCell, 0.0f, hf.cellsX - 1.0f);
+        int cy = (int) ZMath::clamp((start.y - hf.pos.y) * invCell, 0.0f, hf.cellsY - 1.0f);
+
+        // setup the DDA
+        int stepX = ray.dir.x > 0.0f ? 1 : -1, stepY = ray.dir.y > 0.0f ? 1 : -1;
+        float tDeltaX = ray.dir.x ? hf.cellSize * fabsf(dirfrac.x) : INFINITY;
+        float tDeltaY = ray.dir.y ? hf.cellSize * fabsf(dirfrac.y) : INFINITY;
+        float tNextX = ray.dir.x ? (hf.pos.x + (cx + (stepX > 0)) * hf.cellSize - ray.origin.x) * dirfrac.x : INFINITY;
+        float tNextY = ray.dir.y ? (hf.pos.y + (cy + (stepY > 0)) * hf.cellSize - ray.origin.y) * dirfrac.y : INFINITY;
+
+        float t = tMin;
+        ZMath::Vec3D v[4];
+
+        while (t <= tMax) {
+            float tExit = ZMath::min(ZMath::min(tNextX, tNextY), tMax);
+
+            if (hf.getCellVertices(cx, cy, v)) {
+                float rayZ = ZMath::min(ray.origin.z + ray.dir.z * t, ray.origin.z + ray.dir.z * tExit);
+                float cellZ = ZMath::max(ZMath::max(v[0].z, v[1].z), ZMath::max(v[2].z, v[3].z));
+
+                if (rayZ <= cellZ) {
+                    float d1, d2;
+                    bool hit1 = raycastTriangle(v[0], v[1], v[3], ray, d1);
+                    bool hit2 = raycastTriangle(v[0], v[3], v[2], ray, d2);
+
+                    if (hit1 && (!hit2 || d1 < d2)) { dist = d1; return 1; }
+                    if (hit2) { dist = d2; return 1; }
+                }
+            }
+
+            // step into the next cell
+            if (tNextX < tNextY) {
+                cx += stepX;
+                t = tNextX;
+                tNextX += tDeltaX;
+
+            } else {
+                cy += stepY;
+                t = tNextY;
+                tNextY += tDeltaY;
+            }
+
+            if (cx < 0 || cy < 0 || cx >= (int) hf.cellsX || cy >= (int) hf.cellsY) { break; }
+        }
+
+        return 0;
+    };
+
+    // Determine if a ray intersects a heightfield and find the normal of the surface hit.
+    // Rays starting below the surface are ignored. dist is set to -1 if there is no intersection.
+    inline static bool raycast(Heightfield const &hf, Ray3D const &ray, float &dist, ZMath::Vec3D &normal) {
+        float h;
+        if (hf.getHeight(ray.origin.x, ray.origin.y, h, normal) && ray.origin.z < h) {
+            dist = -1.0f;
+            return 0;
+        }
+
+        if (!raycast(hf, ray, dist)) { return 0; }
+
+        ZMath::Vec3D p = ray.origin + ray.dir * dist;
+        hf.getHeight(p.x, p.y, h, normal);
+        normal = normal.normalize();
+
+        return 1;
+    };
+
+    // Determine if a point lies on or below the surface of a heightfield.
+    inline static bool PointAndHeightfield(ZMath::Vec3D const &point, Heightfield const &hf) { return HeightfieldAndPoint(hf, point); };
+
+    // Determine if a sphere intersects a heightfield.
+    inline static bool SphereAndHeightfield(Sphere const &sphere, Heightfield const &hf) { return HeightfieldAndSphere(hf, sphere); };
+
+    // Determine if an unrotated cube intersects a heightfield.
+    inline static bool AABBAndHeightfield(AABB const &aabb, Heightfield const &hf) { return HeightfieldAndAABB(hf, aabb); };
+
+    // Determine if a cube intersects a heightfield.
+    inline static bool CubeAndHeightfield(Cube const &cube, Heightfield const &hf) { return HeightfieldAndCube(hf, cube); };
+
+    // * ===================================
+    // * Capsule vs Primitives
+    // * ===================================
+
+    // Find the closest point on a line segment to a point.
+    inline static ZMath::Vec3D closestPointOnSegment(ZMath::Vec3D const &point, ZMath::Vec3D const &a, ZMath::Vec3D const &b) {
+        ZMath::Vec3D ab = b - a;
+        float lenSq = ab * ab;
+
+        if (lenSq <= EPSILON) { return a; }
+
+        return a + ab * ZMath::clamp(((point - a) * ab)/lenSq, 0.0f, 1.0f);
+    };
+
+    /**
+     * @brief Find the closest points between two line segments.
+     *
+     * @param p1 The start of the first segment.
+     * @param q1 The end of the first segment.
+     * @param p2 The start of the second segment.
+     * @param q2 The end of the second segment.
+     * @param c1 Set to the closest point on the first segment.
+     * @param c2 Set to the closest point on the second segment.
+     * @return (float) The squared distance between the segments.
+     */
+    inline static float closestPointsSegmentSegment(ZMath::Vec3D const &p1, ZMath::Vec3D const &q1, ZMath::Vec3D const &p2, ZMath::Vec3D const &q2,
+                                             ZMath::Vec3D &c1, ZMath::Vec3D &c2) {
+        // ? Minimize |(p1 + s*d1) - (p2 + t*d2)|^2 by solving for where both partial derivatives are 0.
+        // ? If the solution lies outside of the unit square, clamp s and recompute t (and vice versa).
+
+        ZMath::Vec3D d1 = q1 - p1, d2 = q2 - p2, r = p1 - p2;
+        float a = d1 * d1, e = d2 * d2, f = d2 * r;
+        float s, t;
+
+        if (a <= EPSILON && e <= EPSILON) { // both segments are points
+            s = t = 0.0f;
+
+        } else if (a <= EPSILON) { // the first segment is a point
+            s = 0.0f;
+            t = ZMath::clamp(f/e, 0.0f, 1.0f);
+
+        } else {
+            float c = d1 * r;
+
+            if (e <= EPSILON) { // the second segment is a point
+                t = 0.0f;
+                s = ZMath::clamp(-c/a, 0.0f, 1.0f);
+
+            } else {
+                float b = d1 * d2;
+                float denom = a*e - b*b;
+
+                // if the segments are parallel any s works so we pick 0
+                s = denom ? ZMath::clamp((b*f - c*e)/denom, 0.0f, 1.0f) : 0.0f;
+                t = (b*s + f)/e;
+
+                if (t < 0.0f) {
+                    t = 0.0f;
+                    s = ZMath::clamp(-c/a, 0.0f, 1.0f);
+
+                } else if (t > 1.0f) {
+                    t = 1.0f;
+                    s = ZMath::clamp((b - c)/a, 0.0f, 1.0f);
+                }
+            }
+        }
+
+        c1 = p1 + d1 * s;
+        c2 = p2 + d2 * t;
+
+        return c1.distSq(c2);
+    };
+
+    /**
+     * @brief Cheaply check if a capsule could touch a box centered at the origin by testing the capsule's bounds against the box.
+     *  This rules out most separated pairs before finding the closest points between the segment and the box.
+     *
+     * @param a The start of the capsule's segment in the box's local coordinates.
+     * @param b The end of the capsule's segment in the box's local coordinates.
+     * @param halfSize The half size of the box.
+     * @param r The radius of the capsule.
+     * @return (bool) 0 if the capsule cannot touch the box and 1 if it might.
+     */
+    inline static bool capsuleNearBox(ZMath::Vec3D const &a, ZMath::Vec3D const &b, ZMath::Vec3D const &halfSize, float r) {
+        ZMath::Vec3D gap = ZMath::abs(a + b) - ZMath::abs(b - a) - halfSize * 2.0f;
+        r *= 2.0f;
+
+        return gap.x <= r && gap.y <= r && gap.z <= r;
+    };
+
+    /**
+     * @brief Find the closest points between a line segment and a box centered at the origin.
+     *
+     * @param a The start of the segment in the box's local coordinates.
+     * @param b The end of the segment in the box's local coordinates.
+     * @param halfSize The half size of the box.
+     * @param onSeg Set to the closest point on the segment.
+     * @param onBox Set to the closest point on the box.
+     * @return (float) The squared distance between the segment and the box. This is 0 if the segment intersects the box.
+     */
+    inline static float closestPointsSegmentBox(ZMath::Vec3D const &a, ZMath::Vec3D const &b, ZMath::Vec3D const &halfSize,
+                                         ZMath::Vec3D &onSeg, ZMath::Vec3D &onBox) {
+        // ? The squared distance from the box to a point moving along the segment is convex and piecewise quadratic.
+        // ? It only changes form where the segment crosses one of the box's slab planes, so we split the segment there and
+        // ?  solve the quadratic on each piece in closed form rather than testing the segment against every edge of the box.
+
+        // clip the segment against the slabs of the box to check for intersection
+        ZMath::Vec3D d = b - a;
+        float tMin = 0.0f, tMax = 1.0f;
+        bool clipped = 1;
+
+        float ds[3] = {d.x, d.y, d.z}, as[3] = {a.x, a.y, a.z}, hs[3] = {halfSize.x, halfSize.y, halfSize.z};
+
+        for (int i = 0; i < 3 && clipped; ++i) {
+            if (!ds[i]) {
+                clipped = as[i] >= -hs[i] && as[i] <= hs[i];
+                continue;
+            }
+
+            float t1 = (-hs[i] - as[i])/ds[i], t2 = (hs[i] - as[i])/ds[i];
+
+            tMin = ZMath::max(tMin, ZMath::min(t1, t2));
+            tMax = ZMath::min(tMax, ZMath::max(t1, t2));
+            clipped = tMin <= tMax;
+        }
+
+        if (clipped) {
+            onSeg = a + d * tMin;
+            onBox = onSeg;
+            return 0.0f;
+        }
+
+        // * Split the segment where it crosses the slab planes.
+
+        float ts[8] = {0.0f, 1.0f};
+        int n = 2;
+
+        for (int i = 0; i < 3; ++i) {
+            if (!ds[i]) { continue; }
+
+            float t1 = (-hs[i] - as[i])/ds[i], t2 = (hs[i] - as[i])/ds[i];
+
+            if (t1 > 0.0f && t1 < 1.0f) { ts[n++] = t1; }
+            if (t2 > 0.0f && t2 < 1.0f) { ts[n++] = t2; }
+        }
+
+        // insertion sort as there are at most 8 values
+        for (int i = 1; i < n; ++i) {
+            float t = ts[i];
+            int j = i - 1;
+
+            for (; j >= 0 && ts[j] > t; --j) { ts[j + 1] = ts[j]; }
+            ts[j + 1] = t;
+        }
+
+        // * Minimize the squared distance on each piece.
+
+        float best = -1.0f;
+
+        for (int k = 0; k < n - 1; ++k) {
+            float t0 = ts[k], t1 = ts[k + 1], tm = (t0 + t1) * 0.5f;
+
+            // the distance on this piece is the sum of (a + t*d - bound)^2 over the axes the piece is outside of.
+            // expanding gives A*t^2 + 2*B*t + C, which is smallest at t = -B/A.
+            float A = 0.0f, B = 0.0f;
+
+            for (int i = 0; i < 3; ++i) {
+                float p = as[i] + tm * ds[i];
+                if (p >= -hs[i] && p <= hs[i]) { continue; }
+
+                A += ds[i] * ds[i];
+                B += ds[i] * (as[i] - (p < 0.0f ? -hs[i] : hs[i]));
+            }
+
+            float t = A > 0.0f ? ZMath::clamp(-B/A, t0, t1) : t0;
+            ZMath::Vec3D cs = a + d * t, cb = ZMath::clamp(cs, -halfSize, halfSize);
+            float dist = cs.distSq(cb);
+
+            if (best < 0.0f || dist < best) {
+                best = dist;
+                onSeg = cs;
+                onBox = cb;
+            }
+        }
+
+        return best;
+    };
+
+    /**
+     * @brief Find the closest points between a line segment and a triangle.
+     *
+     * @param p The start of the segment.
+     * @param q The end of the segment.
+     * @param a The first vertex of the triangle.
+     * @param b The second vertex of the triangle.
+     * @param c The third vertex of the triangle.
+     * @param onSeg Set to the closest point on the segment.
+     * @param onTri Set to the closest point on the triangle.
+     * @return (float) The squared distance between the segment and the triangle. This is 0 if the segment intersects the triangle.
+     */
+    inline static float closestPointsSegmentTriangle(ZMath::Vec3D const &p, ZMath::Vec3D const &q, ZMath::Vec3D const &a, ZMath::Vec3D const &b,
+                                              ZMath::Vec3D const &c, ZMath::Vec3D &onSeg, ZMath::Vec3D &onTri) {
+        // ? Either the segment passes through the triangle or the closest points involve an endpoint of the segment or an edge of the triangle.
+        // ? Any other closest feature (ex: the triangle's face) would be parallel to the segment and tied with one of those.
+
+        float t;
+        if (raycastTriangle(a, b, c, Ray3D(p, q - p), t) && t <= 1.0f) {
+            onSeg = p + (q - p) * t;
+            onTri = onSeg;
+            return 0.0f;
+        }
+
+        onSeg = p;
+        onTri = closestPointOnTriangle(p, a, b, c);
+        float best = p.distSq(onTri);
+
+        ZMath::Vec3D c1 = closestPointOnTriangle(q, a, b, c), c2;
+        float dist = q.distSq(c1);
+
+        if (dist < best) {
+            best = dist;
+            onSeg = q;
+            onTri = c1;
+        }
+
+        ZMath::Vec3D tri[3] = {a, b, c};
+
+        for (int i = 0; i < 3; ++i) {
+            dist = closestPointsSegmentSegment(p, q, tri[i], tri[(i + 1) % 3], c1, c2);
+
+            if (dist < best) {
+                best = dist;
+                onSeg = c1;
+                onTri = c2;
+            }
+        }
+
+        return best;
+    };
+
+    // Determine if a point lies within a capsule.
+    inline static bool CapsuleAndPoint(Capsule const &capsule, ZMath::Vec3D const &point) {
+        return closestPointOnSegment(point, capsule.getStart(), capsule.getEnd()).distSq(point) <= capsule.r*capsule.r;
+    };
+
+    // Determine if a capsule intersects a line.
+    inline static bool CapsuleAndLine(Capsule const &capsule, Line3D const &line) {
+        ZMath::Vec3D c1, c2;
+        return closestPointsSegmentSegment(capsule.getStart(), capsule.getEnd(), line.start, line.end, c1, c2) <= capsule.r*capsule.r;
+    };
+
+    // Determine if a capsule intersects a plane.
+    inline static bool CapsuleAndPlane(Capsule const &capsule, Plane const &plane) {
+        // ? Treat the plane as a box with no thickness.
+
+        ZMath::Mat3D rotT = plane.rot.transpose();
+        ZMath::Vec2D h = plane.getHalfSize();
+        ZMath::Vec3D a = rotT * (capsule.getStart() - plane.pos), b = rotT * (capsule.getEnd() - plane.pos), halfSize(h.x, h.y, 0.0f);
+        ZMath::Vec3D onSeg, onBox;
+
+        return capsuleNearBox(a, b, halfSize, capsule.r) && closestPointsSegmentBox(a, b, halfSize, onSeg, onBox) <= capsule.r*capsule.r;
+    };
+
+    // Determine if a capsule intersects a sphere.
+    inline static bool CapsuleAndSphere(Capsule const &capsule, Sphere const &sphere) {
+        float r = capsule.r + sphere.r;
+        return closestPointOnSegment(sphere.c, capsule.getStart(), capsule.getEnd()).distSq(sphere.c) <= r*r;
+    };
+
+    // Check for intersection and return the collision normal.
+    // If there is not an intersection, the normal will be a junk value.
+    // The normal will point towards B away from A.
+    inline static bool CapsuleAndSphere(Capsule const &capsule, Sphere const &sphere, ZMath::Vec3D &normal) {
+        float r = capsule.r + sphere.r;
+        ZMath::Vec3D diff = sphere.c - closestPointOnSegment(sphere.c, capsule.getStart(), capsule.getEnd());
+
+        if (diff.magSq() > r*r) { return 0; }
+        normal = diff.normalize();
+
+        return 1;
+    };
+
+    // Determine if a capsule intersects an unrotated cube.
+    inline static bool CapsuleAndAABB(Capsule const &capsule, AABB const &aabb) {
+        ZMath::Vec3D a = capsule.getStart() - aabb.pos, b = capsule.getEnd() - aabb.pos, halfSize = aabb.getHalfSize();
+        ZMath::Vec3D onSeg, onBox;
+
+        return capsuleNearBox(a, b, halfSize, capsule.r) && closestPointsSegmentBox(a, b, halfSize, onSeg, onBox) <= capsule.r*capsule.r;
+    };
+
+    // Determine if a capsule intersects a cube.
+    inline static bool CapsuleAndCube(Capsule const &capsule, Cube const &cube) {
+        ZMath::Mat3D rotT = cube.rot.transpose();
+        ZMath::Vec3D a = rotT * (capsule.getStart() - cube.pos), b = rotT * (capsule.getEnd() - cube.pos), halfSize = cube.getHalfSize();
+        ZMath::Vec3D onSeg, onBox;
+
+        return capsuleNearBox(a, b, halfSize, capsule.r) && closestPointsSegmentBox(a, b, halfSize, onSeg, onBox) <= capsule.r*capsule.r;
+    };
+
+    // Determine if a capsule intersects another capsule.
+    inline static bool CapsuleAndCapsule(Capsule const &capsule1, Capsule const &capsule2) {
+        float r = capsule1.r + capsule2.r;
+        ZMath::Vec3D c1, c2;
+
+        return closestPointsSegmentSegment(capsule1.getStart(), capsule1.getEnd(), capsule2.getStart(), capsule2.getEnd(), c1, c2) <= r*r;
+    };
+
+    // Check for intersection and return the collision normal.
+    // If there is not an intersection, the normal will be a junk value.
+    // The normal will point towards B away from A.
+    inline static bool CapsuleAndCapsule(Capsule const &capsule1, Capsule const &capsule2, ZMath::Vec3D &normal) {
+        float r = capsule1.r + capsule2.r;
+        ZMath::Vec3D c1, c2;
+
+        if (closestPointsSegmentSegment(capsule1.getStart(), capsule1.getEnd(), capsule2.getStart(), capsule2.getEnd(), c1, c2) > r*r) { return 0; }
+        normal = (c2 - c1).normalize();
+
+        return 1;
+    };
+
+    // Determine if a capsule intersects a heightfield.
+    inline static bool CapsuleAndHeightfield(Capsule const &capsule, Heightfield const &hf) {
+        // ? Either the segment is below the surface or a triangle of the surface is within the radius of the segment.
+
+        ZMath::Vec3D start = capsule.getStart(), end = capsule.getEnd();
+        if (HeightfieldAndPoint(hf, start) || HeightfieldAndPoint(hf, end)) { return 1; }
+
+        uint32_t cx0, cy0, cx1, cy1;
+        float maxZ;
+
+        ZMath::Vec3D min = capsule.getMin(), max = capsule.getMax();
+        if (!hf.getCellRange(min, max, cx0, cy0, cx1, cy1)) { return 0; }
+        if (!hf.getMaxHeight(cx0, cy0, cx1, cy1, maxZ) || min.z > maxZ) { return 0; }
+
+        float rSq = capsule.r*capsule.r;
+        ZMath::Vec3D v[4], onSeg, onTri;
+
+        for (uint32_t cy = cy0; cy <= cy1; ++cy) {
+            for (uint32_t cx = cx0; cx <= cx1; ++cx) {
+                if (!hf.getCellVertices(cx, cy, v)) { continue; }
+
+                if (closestPointsSegmentTriangle(start, end, v[0], v[1], v[3], onSeg, onTri) <= rSq) { return 1; }
+                if (closestPointsSegmentTriangle(start, end, v[0], v[3], v[2], onSeg, onTri) <= rSq) { return 1; }
+            }
+        }
+
+        return 0;
+    };
+
+    // Determine if a ray intersects a capsule.
+    // dist will be modified to equal the distance from the ray it hits the capsule.
+    // dist is set to 0 if the ray starts inside of the capsule and -1 if there is no intersection.
+    inline static bool raycast(Capsule const &capsule, Ray3D const &ray, float &dist) {
+        // ? A capsule is the union of a finite cylinder and a sphere at each end.
+        // ? The first hit on the capsule is the closest of the hits on the side of the cylinder and the two spheres.
+        // ? The caps of the cylinder are inside of the spheres so we do not need to check them.
+
+        ZMath::Vec3D start = capsule.getStart(), end = capsule.getEnd();
+
+        if (closestPointOnSegment(ray.origin, start, end).distSq(ray.origin) <= capsule.r*capsule.r) {
+            dist = 0.0f;
+            return 1;
+        }
+
+        float best = -1.0f, t;
+
+        if (raycast(Sphere(start, capsule.r), ray, t)) { best = t; }
+        if (raycast(Sphere(end, capsule.r), ray, t) && (best < 0.0f || t < best)) { best = t; }
+
+        // side of the cylinder
+        ZMath::Vec3D d = end - start, m = ray.origin - start;
+        float dd = d * d, md = m * d, nd = ray.dir * d;
+        float a = dd * (ray.dir * ray.dir) - nd*nd;
+
+        // if a is 0, the ray is parallel to the segment and can only hit the spheres
+        if (a > EPSILON) {
+            float b = dd * (m * ray.dir) - nd*md;
+            float c = dd * (m * m - capsule.r*capsule.r) - md*md;
+            float disc = b*b - a*c;
+
+            if (disc >= 0.0f) {
+                t = (-b - sqrtf(disc))/a;
+                float s = md + t*nd; // projection of the hit onto the segment scaled by dd
+
+                if (t >= 0.0f && s >= 0.0f && s <= dd && (best < 0.0f || t < best)) { best = t; }
+            }
+        }
+
+        dist = best;
+        return best >= 0.0f;
+    };
+
+    // Determine if a ray intersects a capsule and find the normal of the capsule at the hit.
+    // Rays starting inside of the capsule are ignored. dist is set to -1 if there is no intersection.
+    inline static bool raycast(Capsule const &capsule, Ray3D const &ray, float &dist, ZMath::Vec3D &normal) {
+        if (!raycast(capsule, ray, dist) || !dist) {
+            dist = -1.0f;
+            return 0;
+        }
+
+        ZMath::Vec3D p = ray.origin + ray.dir * dist;
+        normal = (p - closestPointOnSegment(p, capsule.getStart(), capsule.getEnd())).normalize();
+
+        return 1;
+    };
+
+    // Determine if a point lies within a capsule.
+    inline static bool PointAndCapsule(ZMath::Vec3D const &point, Capsule const &capsule) { return CapsuleAndPoint(capsule, point); };
+
+    // Determine if a line intersects a capsule.
+    inline static bool LineAndCapsule(Line3D const &line, Capsule const &capsule) { return CapsuleAndLine(capsule, line); };
+
+    // Determine if a plane intersects a capsule.
+    inline static bool PlaneAndCapsule(Plane const &plane, Capsule const &capsule) { return CapsuleAndPlane(capsule, plane); };
+
+    // Determine if a sphere intersects a capsule.
+    inline static bool SphereAndCapsule(Sphere const &sphere, Capsule const &capsule) { return CapsuleAndSphere(capsule, sphere); };
+
+    // Determine if an unrotated cube intersects a capsule.
+    inline static bool AABBAndCapsule(AABB const &aabb, Capsule const &capsule) { return CapsuleAndAABB(capsule, aabb); };
+
+    // Determine if a cube intersects a capsule.
+    inline static bool CubeAndCapsule(Cube const &cube, Capsule const &capsule) { return CapsuleAndCube(capsule, cube); };
+
+    // Determine if a heightfield intersects a capsule.
+    inline static bool HeightfieldAndCapsule(Heightfield const &hf, Capsule const &capsule) { return CapsuleAndHeightfield(capsule, hf); };
+
     // Returns 1 if the given point is within the given triangular pyramid, 0 otherwise
     // @param point: The point that needs to be checked
     // @param tri: The triangular pyramid that is being checked for containing the point
@@ -1101,4 +2091,332 @@ namespace Zeta {
             }
         }
     };
+
+    // * ===================================
+    // * Frustum vs Primitives
+    // * ===================================
+
+    // ? Points are inside of a frustum if they are behind all of its planes.
+    // ? Shapes are tested conservatively against each plane so shapes near the corners of a frustum may be reported as intersecting.
+
+    // Determine if a point lies within a frustum.
+    inline static bool FrustumAndPoint(Frustum const &frustum, ZMath::Vec3D const &point) {
+        for (int i = 0; i < 6; ++i) {
+            if (frustum.normals[i] * point > frustum.offsets[i]) { return 0; }
+        }
+
+        return 1;
+    };
+
+    // Determine if a sphere intersects a frustum.
+    inline static bool FrustumAndSphere(Frustum const &frustum, Sphere const &sphere) {
+        for (int i = 0; i < 6; ++i) {
+            if (frustum.normals[i] * sphere.c - frustum.offsets[i] > sphere.r) { return 0; }
+        }
+
+        return 1;
+    };
+
+    // Determine if an AABB intersects a frustum.
+    inline static bool FrustumAndAABB(Frustum const &frustum, AABB const &aabb) {
+        ZMath::Vec3D h = aabb.getHalfSize();
+
+        for (int i = 0; i < 6; ++i) {
+            // the projection of the halfsize onto the normal is how far the box reaches towards the plane
+            ZMath::Vec3D const &n = frustum.normals[i];
+            if (n * aabb.pos - frustum.offsets[i] > h.x*fabsf(n.x) + h.y*fabsf(n.y) + h.z*fabsf(n.z)) { return 0; }
+        }
+
+        return 1;
+    };
+
+    inline static bool PointAndFrustum(ZMath::Vec3D const &point, Frustum const &frustum) { return FrustumAndPoint(frustum, point); };
+    inline static bool SphereAndFrustum(Sphere const &sphere, Frustum const &frustum) { return FrustumAndSphere(frustum, sphere); };
+    inline static bool AABBAndFrustum(AABB const &aabb, Frustum const &frustum) { return FrustumAndAABB(frustum, aabb); };
+
+    // * ====================================================
+    // * Raycasting Colliders
+    // * ====================================================
+
+    /**
+     * @brief Determine if a ray intersects a collider which can be attached to a rigidbody.
+     * 
+     * @param type The type of the collider.
+     * @param collider The collider.
+     * @param ray The ray.
+     * @param dist Set to the distance along the ray to the hit. Set to -1 if there is no intersection.
+     * @param normal Set to the normal of the surface hit.
+     * @return (bool) 1 if the ray hits the collider and 0 otherwise. Colliders containing the origin of the ray are ignored.
+     */
+    inline static bool raycast(RigidBodyCollider type, void const* collider, Ray3D const &ray, float &dist, ZMath::Vec3D &normal) {
+        dist = -1.0f;
+
+        switch (type) {
+            case RIGID_SPHERE_COLLIDER:  { return raycast(*((Sphere const*) collider), ray, dist, normal);  }
+            case RIGID_AABB_COLLIDER:    { return raycast(*((AABB const*) collider), ray, dist, normal);    }
+            case RIGID_CUBE_COLLIDER:    { return raycast(*((Cube const*) collider), ray, dist, normal);    }
+            case RIGID_CAPSULE_COLLIDER: { return raycast(*((Capsule const*) collider), ray, dist, normal); }
+
+            case RIGID_COMPOUND_COLLIDER: {
+                // ? The closest hit on any of the children is the hit on the compound.
+                Compound const* compound = (Compound const*) collider;
+                float t;
+                ZMath::Vec3D n;
+
+                for (int i = 0; i < compound->numChildren; ++i) {
+                    CompoundChild const &child = compound->children[i];
+
+                    if (raycast(child.type, child.collider, ray, t, n) && (dist < 0.0f || t < dist)) {
+                        dist = t;
+                        normal = n;
+                    }
+                }
+
+                return dist >= 0.0f;
+            }
+
+            // todo add raycasting for triangular pyramids
+            default: { return 0; }
+        }
+    };
+
+    /**
+     * @brief Determine if a ray intersects a collider which can be attached to a staticbody.
+     * 
+     * @param type The type of the collider.
+     * @param collider The collider.
+     * @param ray The ray.
+     * @param dist Set to the distance along the ray to the hit. Set to -1 if there is no intersection.
+     * @param normal Set to the normal of the surface hit.
+     * @return (bool) 1 if the ray hits the collider and 0 otherwise. Colliders containing the origin of the ray are ignored.
+     */
+    inline static bool raycast(StaticBodyCollider type, void const* collider, Ray3D const &ray, float &dist, ZMath::Vec3D &normal) {
+        dist = -1.0f;
+
+        switch (type) {
+            case STATIC_PLANE_COLLIDER:       { return raycast(*((Plane const*) collider), ray, dist, normal);       }
+            case STATIC_SPHERE_COLLIDER:      { return raycast(*((Sphere const*) collider), ray, dist, normal);      }
+            case STATIC_AABB_COLLIDER:        { return raycast(*((AABB const*) collider), ray, dist, normal);        }
+            case STATIC_CUBE_COLLIDER:        { return raycast(*((Cube const*) collider), ray, dist, normal);        }
+            case STATIC_HEIGHTFIELD_COLLIDER: { return raycast(*((Heightfield const*) collider), ray, dist, normal); }
+            case STATIC_CAPSULE_COLLIDER:     { return raycast(*((Capsule const*) collider), ray, dist, normal);     }
+            default:                          { return 0;                                                            }
+        }
+    };
+
+    // Test each lane of a packet against a collider with the single ray functions.
+    // ? Used for colliders which do not have a packet version.
+    template <typename ColliderType>
+    inline static int raycastLanes(ColliderType type, void const* collider, RayPacket const &packet, int mask, float* dist, ZMath::Vec3D* normal) {
+        int hits = 0;
+
+        for (int i = 0; i < packet.count; ++i) {
+            if ((mask & (1 << i)) && raycast(type, collider, packet.getRay(i), dist[i], normal[i])) { hits |= 1 << i; }
+        }
+
+        return hits;
+    };
+
+    /**
+     * @brief Determine which rays in a packet intersect a collider which can be attached to a rigidbody.
+     * 
+     * @param type The type of the collider.
+     * @param collider The collider.
+     * @param packet The rays.
+     * @param mask The lanes to test.
+     * @param dist Set to the distance along each ray to its hit for the lanes hit.
+     * @param normal Set to the normal of the surface hit for the lanes hit.
+     * @return (int) Mask of the lanes which hit the collider.
+     */
+    inline static int raycast(RigidBodyCollider type, void const* collider, RayPacket const &packet, int mask, float* dist, ZMath::Vec3D* normal) {
+        switch (type) {
+            case RIGID_SPHERE_COLLIDER: { return raycast(*((Sphere const*) collider), packet, mask, dist, normal); }
+            case RIGID_AABB_COLLIDER:   { return raycast(*((AABB const*) collider), packet, mask, dist, normal);   }
+            case RIGID_CUBE_COLLIDER:   { return raycast(*((Cube const*) collider), packet, mask, dist, normal);   }
+            default:                    { return raycastLanes(type, collider, packet, mask, dist, normal);         }
+        }
+    };
+
+    /**
+     * @brief Determine which rays in a packet intersect a collider which can be attached to a staticbody.
+     * 
+     * @param type The type of the collider.
+     * @param collider The collider.
+     * @param packet The rays.
+     * @param mask The lanes to test.
+     * @param dist Set to the distance along each ray to its hit for the lanes hit.
+     * @param normal Set to the normal of the surface hit for the lanes hit.
+     * @return (int) Mask of the lanes which hit the collider.
+     */
+    inline static int raycast(StaticBodyCollider type, void const* collider, RayPacket const &packet, int mask, float* dist, ZMath::Vec3D* normal) {
+        switch (type) {
+            case STATIC_PLANE_COLLIDER:  { return raycast(*((Plane const*) collider), packet, mask, dist, normal);  }
+            case STATIC_SPHERE_COLLIDER: { return raycast(*((Sphere const*) collider), packet, mask, dist, normal); }
+            case STATIC_AABB_COLLIDER:   { return raycast(*((AABB const*) collider), packet, mask, dist, normal);   }
+            case STATIC_CUBE_COLLIDER:   { return raycast(*((Cube const*) collider), packet, mask, dist, normal);   }
+            default:                     { return raycastLanes(type, collider, packet, mask, dist, normal);         }
+        }
+    };
+
+    // * ====================================================
+    // * Overlap Testing Colliders
+    // * ====================================================
+
+    /**
+     * @brief Determine if a sphere intersects a collider which can be attached to a rigidbody.
+     * 
+     * @param sphere The sphere.
+     * @param type The type of the collider.
+     * @param collider The collider.
+     * @return (bool) 1 if they intersect and 0 otherwise.
+     */
+    inline static bool overlaps(Sphere const &sphere, RigidBodyCollider type, void const* collider) {
+        switch (type) {
+            case RIGID_SPHERE_COLLIDER:  { return SphereAndSphere(sphere, *((Sphere const*) collider));   }
+            case RIGID_AABB_COLLIDER:    { return SphereAndAABB(sphere, *((AABB const*) collider));       }
+            case RIGID_CUBE_COLLIDER:    { return SphereAndCube(sphere, *((Cube const*) collider));       }
+            case RIGID_CAPSULE_COLLIDER: { return SphereAndCapsule(sphere, *((Capsule const*) collider)); }
+
+            case RIGID_COMPOUND_COLLIDER: {
+                Compound const* compound = (Compound const*) collider;
+
+                for (int i = 0; i < compound->numChildren; ++i) {
+                    if (overlaps(sphere, compound->children[i].type, compound->children[i].collider)) { return 1; }
+                }
+
+                return 0;
+            }
+
+            // todo add triangular pyramids
+            default: { return 0; }
+        }
+    };
+
+    /**
+     * @brief Determine if a sphere intersects a collider which can be attached to a staticbody.
+     * 
+     * @param sphere The sphere.
+     * @param type The type of the collider.
+     * @param collider The collider.
+     * @return (bool) 1 if they intersect and 0 otherwise.
+     */
+    inline static bool overlaps(Sphere const &sphere, StaticBodyCollider type, void const* collider) {
+        switch (type) {
+            case STATIC_PLANE_COLLIDER:       { return SphereAndPlane(sphere, *((Plane const*) collider));             }
+            case STATIC_SPHERE_COLLIDER:      { return SphereAndSphere(sphere, *((Sphere const*) collider));           }
+            case STATIC_AABB_COLLIDER:        { return SphereAndAABB(sphere, *((AABB const*) collider));               }
+            case STATIC_CUBE_COLLIDER:        { return SphereAndCube(sphere, *((Cube const*) collider));               }
+            case STATIC_HEIGHTFIELD_COLLIDER: { return SphereAndHeightfield(sphere, *((Heightfield const*) collider)); }
+            case STATIC_CAPSULE_COLLIDER:     { return SphereAndCapsule(sphere, *((Capsule const*) collider));         }
+            default:                          { return 0;                                                              }
+        }
+    };
+
+    /**
+     * @brief Determine if an AABB intersects a collider which can be attached to a rigidbody.
+     * 
+     * @param aabb The AABB.
+     * @param type The type of the collider.
+     * @param collider The collider.
+     * @return (bool) 1 if they intersect and 0 otherwise.
+     */
+    inline static bool overlaps(AABB const &aabb, RigidBodyCollider type, void const* collider) {
+        switch (type) {
+            case RIGID_SPHERE_COLLIDER:  { return AABBAndSphere(aabb, *((Sphere const*) collider));   }
+            case RIGID_AABB_COLLIDER:    { return AABBAndAABB(aabb, *((AABB const*) collider));       }
+            case RIGID_CUBE_COLLIDER:    { return AABBAndCube(aabb, *((Cube const*) collider));       }
+            case RIGID_CAPSULE_COLLIDER: { return AABBAndCapsule(aabb, *((Capsule const*) collider)); }
+
+            case RIGID_COMPOUND_COLLIDER: {
+                Compound const* compound = (Compound const*) collider;
+
+                for (int i = 0; i < compound->numChildren; ++i) {
+                    if (overlaps(aabb, compound->children[i].type, compound->children[i].collider)) { return 1; }
+                }
+
+                return 0;
+            }
+
+            // todo add triangular pyramids
+            default: { return 0; }
+        }
+    };
+
+    /**
+     * @brief Determine if an AABB intersects a collider which can be attached to a staticbody.
+     * 
+     * @param aabb The AABB.
+     * @param type The type of the collider.
+     * @param collider The collider.
+     * @return (bool) 1 if they intersect and 0 otherwise.
+     */
+    inline static bool overlaps(AABB const &aabb, StaticBodyCollider type, void const* collider) {
+        switch (type) {
+            case STATIC_PLANE_COLLIDER:       { return AABBAndPlane(aabb, *((Plane const*) collider));             }
+            case STATIC_SPHERE_COLLIDER:      { return AABBAndSphere(aabb, *((Sphere const*) collider));           }
+            case STATIC_AABB_COLLIDER:        { return AABBAndAABB(aabb, *((AABB const*) collider));               }
+            case STATIC_CUBE_COLLIDER:        { return AABBAndCube(aabb, *((Cube const*) collider));               }
+            case STATIC_HEIGHTFIELD_COLLIDER: { return AABBAndHeightfield(aabb, *((Heightfield const*) collider)); }
+            case STATIC_CAPSULE_COLLIDER:     { return AABBAndCapsule(aabb, *((Capsule const*) collider));         }
+            default:                          { return 0;                                                          }
+        }
+    };
+
+    // Determine if a cube intersects a collider which can be attached to a staticbody.
+    inline static bool overlaps(Cube const &cube, StaticBodyCollider type, void const* collider) {
+        switch (type) {
+            case STATIC_PLANE_COLLIDER:       { return CubeAndPlane(cube, *((Plane const*) collider));             }
+            case STATIC_SPHERE_COLLIDER:      { return CubeAndSphere(cube, *((Sphere const*) collider));           }
+            case STATIC_AABB_COLLIDER:        { return CubeAndAABB(cube, *((AABB const*) collider));               }
+            case STATIC_CUBE_COLLIDER:        { return CubeAndCube(cube, *((Cube const*) collider));               }
+            case STATIC_HEIGHTFIELD_COLLIDER: { return CubeAndHeightfield(cube, *((Heightfield const*) collider)); }
+            case STATIC_CAPSULE_COLLIDER:     { return CubeAndCapsule(cube, *((Capsule const*) collider));         }
+            default:                          { return 0;                                                          }
+        }
+    };
+
+    // Determine if a capsule intersects a collider which can be attached to a staticbody.
+    inline static bool overlaps(Capsule const &capsule, StaticBodyCollider type, void const* collider) {
+        switch (type) {
+            case STATIC_PLANE_COLLIDER:       { return CapsuleAndPlane(capsule, *((Plane const*) collider));             }
+            case STATIC_SPHERE_COLLIDER:      { return CapsuleAndSphere(capsule, *((Sphere const*) collider));           }
+            case STATIC_AABB_COLLIDER:        { return CapsuleAndAABB(capsule, *((AABB const*) collider));               }
+            case STATIC_CUBE_COLLIDER:        { return CapsuleAndCube(capsule, *((Cube const*) collider));               }
+            case STATIC_HEIGHTFIELD_COLLIDER: { return CapsuleAndHeightfield(capsule, *((Heightfield const*) collider)); }
+            case STATIC_CAPSULE_COLLIDER:     { return CapsuleAndCapsule(capsule, *((Capsule const*) collider));         }
+            default:                          { return 0;                                                                }
+        }
+    };
+
+    /**
+     * @brief Determine if a collider which can be attached to a staticbody intersects one which can be attached to a rigidbody.
+     * ? This only checks for overlap, so it is much cheaper than finding the collision features.
+     * 
+     * @param sType The type of the static collider.
+     * @param sCollider The static collider.
+     * @param rType The type of the rigid collider.
+     * @param rCollider The rigid collider.
+     * @return (bool) 1 if they intersect and 0 otherwise.
+     */
+    inline static bool overlaps(StaticBodyCollider sType, void const* sCollider, RigidBodyCollider rType, void const* rCollider) {
+        switch (rType) {
+            case RIGID_SPHERE_COLLIDER:  { return overlaps(*((Sphere const*) rCollider), sType, sCollider);  }
+            case RIGID_AABB_COLLIDER:    { return overlaps(*((AABB const*) rCollider), sType, sCollider);    }
+            case RIGID_CUBE_COLLIDER:    { return overlaps(*((Cube const*) rCollider), sType, sCollider);    }
+            case RIGID_CAPSULE_COLLIDER: { return overlaps(*((Capsule const*) rCollider), sType, sCollider); }
+
+            case RIGID_COMPOUND_COLLIDER: {
+                Compound const* compound = (Compound const*) rCollider;
+
+                for (int i = 0; i < compound->numChildren; ++i) {
+                    if (overlaps(sType, sCollider, compound->children[i].type, compound->children[i].collider)) { return 1; }
+                }
+
+                return 0;
+            }
+
+            // todo add triangular pyramids
+            default: { return 0; }
+        }
+    };
 }
@@ -2,6 +2,7 @@
 
 #include <cassert>
 #include <stdexcept>
+#include <type_traits>
 #include <utility>
 #include "primitives.h"
 
@@ -22,13 +23,18 @@
 
 namespace Zeta {
     // Array allowing removal of elements from anywhere with O(1) without invalidating indices.
-    // This can only be used for datatypes that are trivially constructible and destructible.
+    // This can only be used for datatypes that are trivially copyable and destructible.
     template <typename T>
     class FreeList {
+        static_assert(std::is_trivially_copyable<T>::value && std::is_trivially_destructible<T>::value, "FreeList elements must be trivially copyable and destructible.");
+
         private:
             union FreeElement {
                 T element;
                 uint32_t next;
+
+                // ? Elements may have default constructors (such as Vec3D), which would delete the union's default constructor.
+                FreeElement() {};
             };
 
             FreeElement* data;
@@ -56,8 +62,8 @@ namespace Zeta {
 
             // By default, allocate 16 data slots.
             // Cap must be strictly greater than 0.
-            inline FreeList(uint32_t cap = 16) : data(new FreeElement[cap]), capacity(cap), count(0), freeFirst(npos) {
-                static_assert(cap, "The capacity must be strictly greater than 0.");
+            inline FreeList(uint32_t cap = 16) : data(new FreeElement[cap]), capacity(cap), freeFirst(npos), count(0) {
+                assert(cap && "The capacity must be strictly greater than 0.");
             };
 
 
@@ -71,7 +77,7 @@ namespace Zeta {
                 freeFirst = list.freeFirst;
 
                 data = new FreeElement[capacity];
-                for (int i = 0; i < count; ++i) { data[i] = list.data[i]; }
+                for (uint32_t i = 0; i < count; ++i) { data[i] = list.data[i]; }
             };
 
             inline FreeList(FreeList &&list) {
@@ -91,7 +97,7 @@ namespace Zeta {
                     freeFirst = list.freeFirst;
 
                     data = new FreeElement[capacity];
-                    for (int i = 0; i < count; ++i) { data[i] = list.data[i]; }
+                    for (uint32_t i = 0; i < count; ++i) { data[i] = list.data[i]; }
                 }
 
                 return *this;
@@ -227,7 +233,7 @@ namespace Zeta {
 
                 // check to assign the head node
                 // we do this outside the for loop to save a clock cycle per iteration
-                if (nodes[dst].firstChild == -1) { // No values yet
+                if (nodes[dst].firstChild == npos) { // No values yet
                     nodes[dst].firstChild = nodes[src].firstChild;
                     
                 } else { // already contains values
@@ -308,7 +314,7 @@ namespace Zeta {
              * @param maxDepth The maximum depth of the octree allowed. Default of 8.
              */
             Octree(ZMath::Vec3D const &min, ZMath::Vec3D const &max, uint32_t maxElementCapacity = OCT_MAX_CAPACITY,
-                    uint16_t maxDepth = OCT_MAX_DEPTH) : maxDepth(maxDepth), maxElementCapacity(maxElementCapacity)
+                    uint16_t maxDepth = OCT_MAX_DEPTH) : maxElementCapacity(maxElementCapacity), maxDepth(maxDepth)
             {
                 assert(maxElementCapacity >= 4 && "The maximum elements allowed in a node must be at least 4.");
                 assert(maxDepth >= 3 && "The maximum depth must be at least 3.");
@@ -395,7 +401,7 @@ namespace Zeta {
                 halfsize = tree.halfsize;
 
                 nodes = new Node[capacity];
-                for (int i = 0; i < count; ++i) { nodes[i] = tree.nodes[i]; }
+                for (uint32_t i = 0; i < count; ++i) { nodes[i] = tree.nodes[i]; }
 
                 elements = tree.elements;
                 elmNodes = tree.elmNodes;
@@ -432,7 +438,7 @@ namespace Zeta {
                     halfsize = tree.halfsize;
 
                     nodes = new Node[capacity];
-                    for (int i = 0; i < count; ++i) { nodes[i] = tree.nodes[i]; }
+                    for (uint32_t i = 0; i < count; ++i) { nodes[i] = tree.nodes[i]; }
 
                     elements = tree.elements;
                     elmNodes = tree.elmNodes;
@@ -1,7 +1,11 @@
 #pragma once
 
-#include "collisions.h"
+#include "broadphase.h"
+#include "history.h"
+#include "scenefile.h"
 #include "octree.h"
+#include "stats.h"
+#include "trace.h"
 #include <stdexcept>
 
 // todo also provide an implementation based on 3 fixed levels of dense grids with row based optimizations as an alternative
@@ -25,29 +29,213 @@
 // * Impulse Resolution
 // * =========================
 
+// Contacts approaching slower than this (in m/s) do not bounce. This keeps resting contacts from jittering.
+#define RESTITUTION_THRESHOLD 1.0f
+
+// Fraction of the penetration to push bodies apart by each step, and the amount of penetration allowed before doing so.
+#define PENETRATION_CORRECTION 0.2f
+#define PENETRATION_SLOP 0.005f
+
+
+// * =========================
+// * Broadphase
+// * =========================
+
+// The bounds of the rigid bodies in the broadphase tree are stretched by how far each body moves in this many steps at its
+//  current velocity and grown by the margin (in m) on every side. The tree is only rebuilt once a body moves outside of them.
+#define RIGID_TREE_PREDICTION 4.0f
+#define RIGID_TREE_MARGIN 0.1f
+
 namespace Zeta {
+    // Solver state of a contact point, kept across the solver's iterations within a step.
+    // ? Keeping the total impulse lets later iterations take back impulse an earlier iteration applied too eagerly
+    // ?  without ever pulling the bodies together.
+    typedef struct SolverPoint {
+        float impulse; // total impulse applied to the point this step. This is never negative as contacts can only push.
+        float target; // approaching speed the point should be left with, including any bounce
+    } SolverPoint;
+
+    // Number of points the solver resolves for a manifold. Manifolds without contact points are resolved at the bodies' centers.
+    inline static int getNumSolverPoints(CollisionManifold const &manifold) { return manifold.numPoints ? manifold.numPoints : 1; };
+
+    // Determine the approaching speed the solver should allow for a contact.
+    // Speculative contacts (negative pDist) may close the gap between the bodies within the step.
+    // Penetrating contacts must separate slightly to correct the penetration over a few steps.
+    inline static float getAllowedSpeed(CollisionManifold const &manifold, float dt) {
+        if (manifold.pDist < 0.0f) { return -manifold.pDist/dt; }
+        return -PENETRATION_CORRECTION * ZMath::max(manifold.pDist - PENETRATION_SLOP, 0.0f)/dt;
+    };
+
+    // Setup the solver state for a collision between two rigidbodies before the impulses are applied.
+    // dt is the length of the step, used to resolve speculative contacts.
+    // points gets filled with the solver state of each of the manifold's points.
+    inline static void prepareImpulse(RigidBody3D* rb1, RigidBody3D* rb2, CollisionManifold const &manifold, float dt, SolverPoint* points) {
+        float allowed = getAllowedSpeed(manifold, dt);
+        int numPoints = getNumSolverPoints(manifold);
+
+        for (int i = 0; i < numPoints; ++i) {
+            ZMath::Vec3D r1, r2;
+            if (manifold.numPoints) {
+                r1 = manifold.contactPoints[i] - rb1->pos;
+                r2 = manifold.contactPoints[i] - rb2->pos;
+            }
+
+            float vn = ((rb1->vel + rb1->angVel.cross(r1)) - (rb2->vel + rb2->angVel.cross(r2))) * manifold.normal;
+
+            // ? Speculative and resting contacts do not bounce.
+            float cor = manifold.pDist < 0.0f || vn < RESTITUTION_THRESHOLD ? 0.0f : rb1->cor * rb2->cor;
+
+            points[i].impulse = 0.0f;
+            points[i].target = allowed - cor * vn;
+        }
+    };
+
+    // Setup the solver state for a collision between a rigidbody and a staticbody before the impulses are applied.
+    inline static void prepareImpulse(RigidBody3D* rb, StaticBody3D*, CollisionManifold const &manifold, float dt, SolverPoint* points) {
+        float allowed = getAllowedSpeed(manifold, dt);
+        int numPoints = getNumSolverPoints(manifold);
+
+        for (int i = 0; i < numPoints; ++i) {
+            ZMath::Vec3D r;
+            if (manifold.numPoints) { r = manifold.contactPoints[i] - rb->pos; }
+
+            // ? The normal points towards the rigidbody so it is approaching when its velocity is against the normal.
+            float vn = -((rb->vel + rb->angVel.cross(r)) * manifold.normal);
+            float cor = manifold.pDist < 0.0f || vn < RESTITUTION_THRESHOLD ? 0.0f : rb->cor;
+
+            points[i].impulse = 0.0f;
+            points[i].target = allowed - cor * vn;
+        }
+    };
+
+    // Apply the impulse a pair of rigidbodies needed in the last step to start the solver close to its final answer.
+    // The impulse is split evenly between the contact points.
+    // Returns the magnitude of the impulse applied.
+    inline static float warmStartImpulse(RigidBody3D* rb1, RigidBody3D* rb2, CollisionManifold const &manifold, SolverPoint* points, float impulse) {
+        int numPoints = getNumSolverPoints(manifold);
+        float J = impulse/numPoints;
+
+        for (int i = 0; i < numPoints; ++i) {
+            ZMath::Vec3D r1, r2;
+            if (manifold.numPoints) {
+                r1 = manifold.contactPoints[i] - rb1->pos;
+                r2 = manifold.contactPoints[i] - rb2->pos;
+            }
+
+            points[i].impulse = J;
+
+            rb1->vel -= manifold.normal * (rb1->invMass * J);
+            rb2->vel += manifold.normal * (rb2->invMass * J);
+            rb1->angVel -= rb1->invInertia * r1.cross(manifold.normal) * J;
+            rb2->angVel += rb2->invInertia * r2.cross(manifold.normal) * J;
+        }
+
+        return impulse;
+    };
+
+    // Apply the impulse a rigidbody needed against a staticbody in the last step to start the solver close to its final answer.
+    inline static float warmStartImpulse(RigidBody3D* rb, StaticBody3D*, CollisionManifold const &manifold, SolverPoint* points, float impulse) {
+        int numPoints = getNumSolverPoints(manifold);
+        float J = impulse/numPoints;
+
+        for (int i = 0; i < numPoints; ++i) {
+            ZMath::Vec3D r;
+            if (manifold.numPoints) { r = manifold.contactPoints[i] - rb->pos; }
+
+            points[i].impulse = J;
+
+            rb->vel += manifold.normal * (rb->invMass * J);
+            rb->angVel += rb->invInertia * r.cross(manifold.normal) * J;
+        }
+
+        return impulse;
+    };
+
     // Resolve a collision between two rigidbodies.
-    static void applyImpulse(RigidBody3D* rb1, RigidBody3D* rb2, CollisionManifold const &manifold) {
+    // points holds the solver state of each of the manifold's points set by prepareImpulse.
+    // Returns the magnitude of the impulse applied.
+    inline static float applyImpulse(RigidBody3D* rb1, RigidBody3D* rb2, CollisionManifold const &manifold, SolverPoint* points) {
         // delta v = J/m
         // For this calculation we need to acocunt for the relative velocity between the two objects
         // v_r = v_1 - v_2
-        // To determine the total velocity of the collision: v_j = -(1 + cor)v_r dot collisionNormal
+        // The speed the objects are approaching each other at is: v_n = v_r dot collisionNormal (the normal points towards rb2)
+        // To determine the total velocity of the collision: v_j = (1 + cor)v_n
         // Impulse then equals: J = v_j/(invMass_1 + invMass_2)
-        // v_1' = v_1 + invMass_1 * J * collisionNormal
-        // v_2' = v_2 - invMass_2 * J * collisionNormal. Note the - is to account for the direction which the normal is pointing.
+        // v_1' = v_1 - invMass_1 * J * collisionNormal
+        // v_2' = v_2 + invMass_2 * J * collisionNormal. Note the + is to account for the direction which the normal is pointing.
         // It's opposite for one of the two objects.
 
-        float J = ((ZMath::abs(rb1->vel - rb2->vel) * -(1 + rb1->cor * rb2->cor)) * manifold.normal)/(rb1->invMass + rb2->invMass);
+        // ? When the bodies can rotate, the impulse is applied at each contact point instead.
+        // ? The velocity of a point is then v + w x r, where r is the offset of the point from the body's center,
+        // ?  and the denominator gains the rotational inertia about the point: (I^-1 (r x n) x r) dot n.
 
-        rb1->vel -= manifold.normal * (rb1->invMass * J);
-        rb2->vel += manifold.normal * (rb2->invMass * J);
+        // ? The points are solved together from the same velocities and each gets 1/n of the impulse it asks for.
+        // ? Solving them one after another would let the first point take all of the impulse,
+        // ?  spinning bodies which land flat and slowly tipping over stacks.
+
+        float total = 0.0f;
+        int numPoints = getNumSolverPoints(manifold);
+        ZMath::Vec3D dw1, dw2;
+
+        for (int i = 0; i < numPoints; ++i) {
+            ZMath::Vec3D r1, r2;
+            if (manifold.numPoints) {
+                r1 = manifold.contactPoints[i] - rb1->pos;
+                r2 = manifold.contactPoints[i] - rb2->pos;
+            }
+
+            float vn = ((rb1->vel + rb1->angVel.cross(r1)) - (rb2->vel + rb2->angVel.cross(r2))) * manifold.normal;
+
+            ZMath::Vec3D rn1 = r1.cross(manifold.normal), rn2 = r2.cross(manifold.normal);
+            ZMath::Vec3D ang1 = rb1->invInertia * rn1, ang2 = rb2->invInertia * rn2;
+
+            // only remove approaching velocity, keeping the total impulse pushing the bodies apart
+            float J = (vn - points[i].target)/((rb1->invMass + rb2->invMass + ang1 * rn1 + ang2 * rn2) * numPoints);
+            J = ZMath::max(points[i].impulse + J, 0.0f) - points[i].impulse;
+
+            points[i].impulse += J;
+            dw1 -= ang1 * J;
+            dw2 += ang2 * J;
+            total += J;
+        }
+
+        rb1->vel -= manifold.normal * (rb1->invMass * total);
+        rb2->vel += manifold.normal * (rb2->invMass * total);
+        rb1->angVel += dw1;
+        rb2->angVel += dw2;
+
+        return total;
     };
 
-    // todo test if this is reasonable for the impulse resolution
     // Resolve a collision between a rigidbody and a staticbody.
-    static void applyImpulse(RigidBody3D* rb, StaticBody3D* sb, CollisionManifold const &manifold) {
-        float J = ((ZMath::abs(rb->vel) * -(1 + rb->cor)) * manifold.normal)/rb->invMass;
-        rb->vel -= manifold.normal * (rb->invMass * J);
+    // points holds the solver state of each of the manifold's points set by prepareImpulse.
+    // Returns the magnitude of the impulse applied.
+    inline static float applyImpulse(RigidBody3D* rb, StaticBody3D*, CollisionManifold const &manifold, SolverPoint* points) {
+        float total = 0.0f;
+        int numPoints = getNumSolverPoints(manifold);
+        ZMath::Vec3D dw;
+
+        for (int i = 0; i < numPoints; ++i) {
+            ZMath::Vec3D r;
+            if (manifold.numPoints) { r = manifold.contactPoints[i] - rb->pos; }
+
+            float vn = -((rb->vel + rb->angVel.cross(r)) * manifold.normal);
+
+            ZMath::Vec3D rn = r.cross(manifold.normal);
+            ZMath::Vec3D ang = rb->invInertia * rn;
+
+            float J = (vn - points[i].target)/((rb->invMass + ang * rn) * numPoints);
+            J = ZMath::max(points[i].impulse + J, 0.0f) - points[i].impulse;
+
+            points[i].impulse += J;
+            dw += ang * J;
+            total += J;
+        }
+
+        rb->vel += manifold.normal * (rb->invMass * total);
+        rb->angVel += dw;
+
+        return total;
     };
 }
 
@@ -81,6 +269,7 @@ namespace Zeta {
         RigidBody3D** bodies1 = nullptr; // list of colliding bodies (Object A)
         RigidBody3D** bodies2 = nullptr; // list of colliding bodies (Object B)
         Manifold* manifolds = nullptr; // list of the collision manifolds between the objects
+        float* impulses = nullptr; // total impulse applied to each collision this step
 
         int capacity; // current max capacity
         int count; // number of collisions
@@ -90,11 +279,128 @@ namespace Zeta {
         RigidBody3D** rbs = nullptr;
         StaticBody3D** sbs = nullptr;
         Manifold* manifolds = nullptr;
+        float* impulses = nullptr;
 
         int capacity;
         int count;
     } RSCol;
 
+    // Start or end of an overlap between a sensor and a rigid body.
+    enum SensorEventType {
+        SENSOR_ENTER,
+        SENSOR_EXIT
+    };
+
+    typedef struct SensorEvent {
+        StaticBody3D* sensor;
+        RigidBody3D* rb;
+        SensorEventType type;
+    } SensorEvent;
+
+    // Rigid body overlapping a sensor.
+    typedef struct SensorOverlap {
+        StaticBody3D* sensor;
+        RigidBody3D* rb;
+    } SensorOverlap;
+
+    // Pair of bodies in contact.
+    typedef struct Contact {
+        RigidBody3D* rb1;
+        RigidBody3D* rb2; // nullptr if the contact is with a static body
+        StaticBody3D* sb; // nullptr if the contact is between two rigid bodies
+        ZMath::Vec3D normal; // contact normal pointing towards rb2 or, for static bodies, towards rb1
+        float impulse; // total impulse the solver applied to the contact during the step
+    } Contact;
+
+    // Stage of a contact.
+    // ? Persist is sent every step the contact lasts after it begins. End events hold the last step's contact data.
+    enum ContactEventType {
+        CONTACT_BEGIN,
+        CONTACT_PERSIST,
+        CONTACT_END
+    };
+
+    typedef struct ContactEvent {
+        Contact contact;
+        ContactEventType type;
+    } ContactEvent;
+
+    typedef struct SensorWrapper {
+        StaticBody3D** sensors = nullptr; // list of sensors
+        int capacity;
+        int count;
+
+        // ? The overlaps are sorted so the overlaps from consecutive steps can be compared in a single pass.
+        SensorOverlap* overlaps = nullptr; // overlaps found in the last step
+        SensorOverlap* nextOverlaps = nullptr; // scratch space for the overlaps found in the current step
+        int overlapCapacity; // capacity of both overlap lists
+        int overlapCount;
+
+        SensorEvent* events = nullptr; // events from the last call to update
+        int eventCapacity;
+        int eventCount;
+    } Sensors;
+
+    typedef struct ContactWrapper {
+        // ? The contacts are sorted by body so the contacts from consecutive steps can be compared in a single pass.
+        Contact* contacts = nullptr; // contacts found in the last step
+        Contact* nextContacts = nullptr; // scratch space for the contacts found in the current step
+        int capacity; // capacity of both contact lists
+        int count;
+
+        ContactEvent* events = nullptr; // events from the last call to update
+        int eventCapacity;
+        int eventCount;
+    } Contacts;
+
+    // Result of a raycast query on a handler.
+    typedef struct RaycastHit {
+        RigidBody3D* rb = nullptr; // rigid body hit. nullptr if a static body was hit.
+        StaticBody3D* sb = nullptr; // static body hit. nullptr if a rigid body was hit.
+        ZMath::Vec3D point; // point hit
+        ZMath::Vec3D normal; // normal of the surface at the point hit
+        float dist = -1.0f; // distance along the ray to the point hit. -1 if nothing was hit.
+    } RaycastHit;
+
+    // Result of a sweep query on a handler.
+    typedef struct SweepHit {
+        RigidBody3D* rb = nullptr; // rigid body hit. nullptr if a static body was hit.
+        StaticBody3D* sb = nullptr; // static body hit. nullptr if a rigid body was hit.
+        ZMath::Vec3D normal; // collision normal at the time of impact. This points towards the swept shape.
+        float toi = -1.0f; // fraction of the sweep travelled before the hit. -1 if nothing was hit.
+        float dist = -1.0f; // distance travelled along the sweep before the hit. -1 if nothing was hit.
+    } SweepHit;
+
+    // Body found by an overlap or proximity query on a handler.
+    typedef struct QueryHit {
+        RigidBody3D* rb = nullptr; // rigid body found. nullptr if a static body was found.
+        StaticBody3D* sb = nullptr; // static body found. nullptr if a rigid body was found.
+        float dist = 0.0f; // distance from the query point to the bounds of the body. Only set by queryKNearest.
+    } QueryHit;
+
+    // Dynamic state of a rigid body saved by Handler::saveState.
+    typedef struct RigidBodyState {
+        ZMath::Vec3D pos;
+        ZMath::Vec3D vel;
+        ZMath::Vec3D netForce;
+        ZMath::Quaternion orientation;
+        ZMath::Vec3D angVel;
+        ZMath::Vec3D netTorque;
+    } RigidBodyState;
+
+    // Start of a buffer written by Handler::saveState.
+    // ? The header is followed by the rigid body states, contacts, and sensor overlaps, in that order.
+    // ?  The rigid body states come first so they line up between states for StateHistory's delta encoding.
+    // ?  The header and every list are a multiple of 8 bytes so each list stays aligned without any padding.
+    typedef struct HandlerStateHeader {
+        uint32_t size; // total size of the state in bytes
+        int numRigidBodies;
+        int numStaticBodies;
+        int numSensors;
+        int contactCount;
+        int overlapCount;
+    } HandlerStateHeader;
+
 
     // * ========================
     // * Main Physics Handler
@@ -110,10 +416,43 @@ namespace Zeta {
             SBS sbs; // static bodies to check for collisions with
             RCol rCol; // collisions between rigid bodies
             RSCol rsCol; // collisions between rigid and static bodies
+            Sensors sensors; // sensors and the rigid bodies overlapping them
+            Contacts contacts; // bodies in contact and the events between them
+
+            SolverPoint* solverPoints = nullptr; // solver state of every contact point in the current step
+            int solverCapacity = 0;
 
             float updateStep; // amount of dt to update after
             static const int IMPULSE_ITERATIONS = 6; // number of times to apply the impulse update.
 
+            // ? Used for CCD. Each rigid body is assumed to move linearly from startPos at startTime to its pos at the end of the update.
+            // ? startTime is the fraction of the update which had passed at startPos.
+            ZMath::Vec3D* startPos = nullptr;
+            float* startTime = nullptr;
+            int startCapacity = 0;
+
+            // ? The CCD sweeps only test the bodies whose path over the update overlaps theirs, found through ccdTree.
+            // ?  A body bounced by a sweep leaves the path its bounds in ccdTree were built from, so it is kept in rerouted and always tested.
+            BVH ccdTree; // bounds of the path of each rigid body's CCD sphere over the update. Only built when CCD is needed.
+            int* rerouted = nullptr; // rigid bodies whose path changed during the CCD pass
+            int reroutedCount = 0;
+
+            // ? Broadphase trees used by the collision detection and the queries. These are only rebuilt when needed after the bodies changed.
+            // ? The bounds in rigidTree are fattened so moving the rigid bodies only dirties it once one leaves its bounds.
+            BVH staticTree;
+            BVH rigidTree;
+            bool staticTreeDirty = 1;
+            bool rigidTreeDirty = 1;
+
+            int* candidates = nullptr; // scratch space for the bodies found by the broadphase for each rigid body in the current step
+            int candidateCapacity = 0;
+
+            StateHistory history; // states of the last few steps. Empty unless turned on with setHistorySize.
+
+#ifdef ENABLE_PHYSICS_STATS
+            Stats stepStats; // stats of the last STATS_HISTORY steps
+#endif
+
 
             // * ==============================
             // * Functions for Ease of Use
@@ -126,24 +465,29 @@ namespace Zeta {
                     RigidBody3D** temp1 = new RigidBody3D*[rCol.capacity];
                     RigidBody3D** temp2 = new RigidBody3D*[rCol.capacity];
                     Manifold* temp3 = new Manifold[rCol.capacity];
+                    float* temp4 = new float[rCol.capacity];
 
                     for (int i = 0; i < rCol.count; i++) {
                         temp1[i] = rCol.bodies1[i];
                         temp2[i] = rCol.bodies2[i];
                         temp3[i] = std::move(rCol.manifolds[i]);
+                        temp4[i] = rCol.impulses[i];
                     }
 
                     delete[] rCol.bodies1;
                     delete[] rCol.bodies2;
                     delete[] rCol.manifolds;
+                    delete[] rCol.impulses;
 
                     rCol.bodies1 = temp1;
                     rCol.bodies2 = temp2;
                     rCol.manifolds = temp3;
+                    rCol.impulses = temp4;
                 }
 
                 rCol.bodies1[rCol.count] = rb1;
                 rCol.bodies2[rCol.count] = rb2;
+                rCol.impulses[rCol.count] = 0.0f;
                 rCol.manifolds[rCol.count++] = manifold;
             };
 
@@ -154,24 +498,29 @@ namespace Zeta {
                     RigidBody3D** temp1 = new RigidBody3D*[rsCol.capacity];
                     StaticBody3D** temp2 = new StaticBody3D*[rsCol.capacity];
                     Manifold* temp3 = new Manifold[rsCol.capacity];
+                    float* temp4 = new float[rsCol.capacity];
 
                     for (int i = 0; i < rsCol.count; ++i) {
                         temp1[i] = rsCol.rbs[i];
                         temp2[i] = rsCol.sbs[i];
                         temp3[i] = std::move(rsCol.manifolds[i]);
+                        temp4[i] = rsCol.impulses[i];
                     }
 
                     delete[] rsCol.rbs;
                     delete[] rsCol.sbs;
                     delete[] rsCol.manifolds;
+                    delete[] rsCol.impulses;
 
                     rsCol.rbs = temp1;
                     rsCol.sbs = temp2;
                     rsCol.manifolds = temp3;
+                    rsCol.impulses = temp4;
                 }
 
                 rsCol.rbs[rsCol.count] = rb;
                 rsCol.sbs[rsCol.count] = sb;
+                rsCol.impulses[rsCol.count] = 0.0f;
                 rsCol.manifolds[rsCol.count++] = manifold;
             };
 
@@ -187,10 +536,12 @@ namespace Zeta {
 
                 for (int i = 0; i < rCol.count; ++i) { delete[] rCol.manifolds[i].contactPoints; }
                 delete[] rCol.manifolds;
+                delete[] rCol.impulses;
 
                 rCol.bodies1 = new RigidBody3D*[halfRbs];
                 rCol.bodies2 = new RigidBody3D*[halfRbs];
                 rCol.manifolds = new Manifold[halfRbs];
+                rCol.impulses = new float[halfRbs];
 
                 rCol.capacity = halfRbs;
                 rCol.count = 0;
@@ -203,220 +554,928 @@ namespace Zeta {
 
                 for (int i = 0; i < rsCol.count; ++i) { delete[] rsCol.manifolds[i].contactPoints; }
                 delete[] rsCol.manifolds;
+                delete[] rsCol.impulses;
 
                 rsCol.rbs = new RigidBody3D*[halfRbs];
                 rsCol.sbs = new StaticBody3D*[halfRbs];
                 rsCol.manifolds = new Manifold[halfRbs];
+                rsCol.impulses = new float[halfRbs];
 
                 rsCol.capacity = halfRbs;
                 rsCol.count = 0;
             };
 
-        public:
-            // * =====================
-            // * Public Attributes
-            // * =====================
-
-            ZMath::Vec3D g; // gravity
+            // * ==================================
+            // * Continuous Collision Detection
+            // * ==================================
+
+            // Check if any rigid body needs continuous collision detection and, if so, record where each rigid body starts the update.
+            // Returns 1 if CCD is needed and 0 otherwise.
+            inline bool recordStartPos() {
+                int i = 0;
+                for (; i < rbs.count && !rbs.rigidBodies[i]->ccd; ++i) {}
+                if (i == rbs.count) { return 0; }
+
+                if (startCapacity < rbs.count) {
+                    delete[] startPos;
+                    delete[] startTime;
+                    delete[] rerouted;
+
+                    startCapacity = rbs.capacity;
+                    startPos = new ZMath::Vec3D[startCapacity];
+                    startTime = new float[startCapacity];
+                    rerouted = new int[startCapacity];
+                }
 
-            // * ===================================
-            // * Constructors, Destructors, Etc.
-            // * ===================================
+                for (i = 0; i < rbs.count; ++i) {
+                    startPos[i] = rbs.rigidBodies[i]->pos;
+                    startTime[i] = 0.0f;
+                }
 
-            // Make a physics handler with a default gravity of -9.8 and an update speed of 60FPS.
+                return 1;
+            };
 
-            /**
-             * @brief Create a physics handler.
-             * 
-             * @param g (Vec3D) The force applied by gravity. Default of <0, 0, -9.8f>.
-             * @param timeStep (float) The amount of time in seconds that must pass before the handler updates physics.
-             *    Default speed of 60FPS. Anything above 60FPS is not recommended as it can cause lag in lower end hardware.
-             */
-            Handler(ZMath::Vec3D const &g = ZMath::Vec3D(0, 0, -9.8f), float timeStep = FPS_60) : g(g), updateStep(timeStep) {
-                if (updateStep < FPS_60) { updateStep = FPS_60; } // hard cap at 60 FPS
+            // Get the pos of a rigid body at a given fraction of the update, t, assuming linear motion.
+            inline ZMath::Vec3D getPosAt(int index, float t) {
+                if (t <= startTime[index]) { return startPos[index]; }
+                return startPos[index] + (rbs.rigidBodies[index]->pos - startPos[index]) * ((t - startTime[index])/(1.0f - startTime[index]));
+            };
 
-                // * Bodies
+            // Get the bounds of a sphere of radius r swept from start by disp.
+            static inline void getSweptBounds(ZMath::Vec3D const &start, ZMath::Vec3D const &disp, float r, ZMath::Vec3D &min, ZMath::Vec3D &max) {
+                ZMath::Vec3D end = start + disp;
 
-                rbs.rigidBodies = new RigidBody3D*[startingSlots];
-                rbs.capacity = startingSlots;
-                rbs.count = 0;
+                min.set(ZMath::min(start.x, end.x) - r, ZMath::min(start.y, end.y) - r, ZMath::min(start.z, end.z) - r);
+                max.set(ZMath::max(start.x, end.x) + r, ZMath::max(start.y, end.y) + r, ZMath::max(start.z, end.z) + r);
+            };
 
-                sbs.staticBodies = new StaticBody3D*[startingSlots];
-                sbs.capacity = startingSlots;
-                sbs.count = 0;
+            // Build the tree of the paths the rigid bodies take over the update. Call this after the bodies move and before any sweeps.
+            void buildCCDTree() {
+                ccdTree.build(rbs.count, [this](int i, ZMath::Vec3D &min, ZMath::Vec3D &max) {
+                    RigidBody3D const* rb = rbs.rigidBodies[i];
+                    float r = getCCDRadius(rb->colliderType, rb->collider);
 
+                    // ? Bodies without a CCD radius cannot be hit by a sweep so they get inverted bounds and are never visited.
+                    if (!r) { min.set(FLT_MAX); max.set(-FLT_MAX); }
+                    else { getSweptBounds(startPos[i], rb->pos - startPos[i], r, min, max); }
+                });
 
-                // * Collisions
+                reroutedCount = 0;
+            };
 
-                rCol.bodies1 = new RigidBody3D*[halfStartingSlots];
-                rCol.bodies2 = new RigidBody3D*[halfStartingSlots];
-                rCol.manifolds = new Manifold[halfStartingSlots];
-                rCol.capacity = halfStartingSlots;
-                rCol.count = 0;
+            // Remember that a rigid body's path changed during the CCD pass.
+            inline void markRerouted(int index) {
+                for (int i = 0; i < reroutedCount; ++i) {
+                    if (rerouted[i] == index) { return; }
+                }
 
-                rsCol.rbs = new RigidBody3D*[halfStartingSlots];
-                rsCol.sbs = new StaticBody3D*[halfStartingSlots];
-                rsCol.manifolds = new Manifold[halfStartingSlots];
-                rsCol.capacity = halfStartingSlots;
-                rsCol.count = 0;
+                rerouted[reroutedCount++] = index;
             };
 
-            // Do not allow for construction from an existing physics handler.
-            Handler(Handler const &handler) { throw std::runtime_error("PhysicsHandler object CANNOT be constructed from another PhysicsHandler."); };
-            Handler(Handler&& handler) { throw std::runtime_error("PhysicsHandler object CANNOT be constructed from another PhysicsHandler."); };
+            inline bool isRerouted(int index) const {
+                for (int i = 0; i < reroutedCount; ++i) {
+                    if (rerouted[i] == index) { return 1; }
+                }
 
-            // The physics handler cannot be reassigned.
-            Handler& operator = (Handler const &handler) { throw std::runtime_error("PhysicsHandler object CANNOT be reassigned to another PhysicsHandler."); };
-            Handler& operator = (Handler&& handler) { throw std::runtime_error("PhysicsHandler object CANNOT be reassigned to another PhysicsHandler."); };
+                return 0;
+            };
 
-            ~Handler() { // todo could probs combine some of the loops together
-                // If one of the pointers is not NULL, none of them are.
-                if (rbs.rigidBodies) {
-                    for (int i = 0; i < rbs.count; ++i) { delete rbs.rigidBodies[i]; }
-                    delete[] rbs.rigidBodies;
+            // Sweep a CCD enabled rigid body from where it started the update to where it ended up.
+            // If it hits anything on the way, it is stopped at the time of impact, bounced, and moved for the remainder of the update.
+            // This is done at most CCD_MAX_SUBSTEPS times. Slow bodies are left to the regular collision detection.
+            void advanceCCD(int index) {
+                RigidBody3D* rb = rbs.rigidBodies[index];
 
-                    // ? Note: we do not need to delete each RigidBody pointer in bodies1 and bodies2 as the main rigidBodies list
-                    // ?       is guarenteed to contain those same pointers.
-                    delete[] rCol.bodies1;
-                    delete[] rCol.bodies2;
-                    
-                    delete[] rsCol.rbs;
-                    delete[] rsCol.sbs;
+                float r = getCCDRadius(rb->colliderType, rb->collider);
+                ZMath::Vec3D start = startPos[index], disp = rb->pos - start;
 
-                    // ? We do not need to check for nullptr for contactPoints as if rCol.count > 0, it is guarenteed manifolds[i].contactPoints != nullptr.
-                    for (int i = 0; i < rCol.count; ++i) { delete[] rCol.manifolds[i].contactPoints; }
-                    delete[] rCol.manifolds;
+                if (!r || disp.magSq() <= r*r) { return; }
 
-                    for (int i = 0; i < rsCol.count; ++i) { delete[] rsCol.manifolds[i].contactPoints; }
-                    delete[] rsCol.manifolds;
-                }
-            };
+                float elapsed = startTime[index]; // fraction of the update which has been accounted for
+                int sub = 0;
 
+                for (; sub < CCD_MAX_SUBSTEPS; ++sub) {
+                    Sphere sphere(start, r);
+                    float toi = 1.0f, t;
+                    ZMath::Vec3D normal, n;
+                    RigidBody3D* hitRb = nullptr;
+                    StaticBody3D* hitSb = nullptr;
 
-            // * ============================
-            // * RigidBody List Functions
-            // * ============================
+                    // only the bodies overlapping the bounds of this sweep can be hit
+                    ZMath::Vec3D sweepMin, sweepMax;
+                    getSweptBounds(start, disp, r, sweepMin, sweepMax);
 
-            // Add a rigid body to the list of rigid bodies to be updated.
-            void addRigidBody(RigidBody3D* rb) {
-                if (rbs.count == rbs.capacity) {
-                    rbs.capacity *= 2;
-                    RigidBody3D** temp = new RigidBody3D*[rbs.capacity];
+                    // ? Static geometry does not move so we can solve for the time of impact of the swept sphere directly.
+                    staticTree.query(sweepMin, sweepMax, [&](int j) {
+                        StaticBody3D* sb = sbs.staticBodies[j];
 
-                    for (int i = 0; i < rbs.count; ++i) { temp[i] = rbs.rigidBodies[i]; }
+                        if (shouldCollide(rb->filter, sb->filter) && sweepSphere(sphere, disp, sb->colliderType, sb->collider, t, n) && t < toi) {
+                            toi = t;
+                            normal = n;
+                            hitSb = sb;
+                        }
 
-                    delete[] rbs.rigidBodies;
-                    rbs.rigidBodies = temp;
-                }
+                        return 1;
+                    });
 
-                rbs.rigidBodies[rbs.count++] = rb;
-            };
+                    // ? The other rigid bodies are assumed to move linearly over the remainder of the update.
+                    int hitIndex = -1;
+                    ZMath::Vec3D hitPos;
 
-            // Add a list of rigid bodies to be updated
-            void addRigidBodies(RigidBody3D** rbs, int size) {
-                if (this->rbs.count + size - 1 >= this->rbs.capacity) {
-                    this->rbs.capacity += size;
-                    RigidBody3D** temp = new RigidBody3D*[this->rbs.capacity];
+                    auto sweepRigid = [&](int j) {
+                        if (j == index) { return; }
 
-                    for (int i = 0; i < this->rbs.count; ++i) { temp[i] = this->rbs.rigidBodies[i]; }
+                        RigidBody3D* other = rbs.rigidBodies[j];
+                        if (!shouldCollide(rb->filter, other->filter)) { return; }
 
-                    delete[] this->rbs.rigidBodies;
-                    this->rbs.rigidBodies = temp;
-                }
+                        float otherR = getCCDRadius(other->colliderType, other->collider);
+                        if (!otherR) { return; }
 
-                for (int i = 0; i < size; ++i) { this->rbs.rigidBodies[this->rbs.count++] = rbs[i]; }
-            };
+                        Sphere otherSphere(getPosAt(j, elapsed), otherR);
+                        ZMath::Vec3D otherDisp = other->pos - otherSphere.c;
 
-            // Remove a rigid body.
-            // This returns 1 if the rigid body is found and removed and 0 if it was not found.
-            // If the rigid body is found, the data pointed to by rb gets deleted by this function.
-            bool removeRigidBody(RigidBody3D* rb) {
-                for (int i = rbs.count; i >= 0; --i) {
-                    if (rbs.rigidBodies[i] == rb) {
-                        delete rb;
-                        for (int j = i; j < rbs.count - 1; ++j) { rbs.rigidBodies[j] = rbs.rigidBodies[j + 1]; }
-                        rbs.count--;
+                        if (conservativeAdvancement(sphere, disp, otherSphere, otherDisp, t) && t < toi) {
+                            toi = t;
+                            hitPos = otherSphere.c + otherDisp * t;
+                            normal = (hitPos - (start + disp * t)).normalize();
+                            hitRb = other;
+                            hitSb = nullptr;
+                            hitIndex = j;
+                        }
+                    };
+
+                    ccdTree.query(sweepMin, sweepMax, [&](int j) {
+                        if (!isRerouted(j)) { sweepRigid(j); }
                         return 1;
+                    });
+
+                    for (int k = 0; k < reroutedCount; ++k) { sweepRigid(rerouted[k]); }
+
+                    if (!hitRb && !hitSb) { break; }
+
+                    start += disp * toi;
+                    elapsed += (1.0f - elapsed) * toi;
+
+                    if (hitSb) {
+                        // normal points towards rb
+                        float vn = rb->vel * normal;
+                        if (vn < 0.0f) { rb->vel -= normal * ((1.0f + rb->cor) * vn); }
+
+                    } else {
+                        // normal points towards hitRb
+                        float vn = (rb->vel - hitRb->vel) * normal;
+
+                        if (vn > 0.0f) {
+                            float J = ((1.0f + rb->cor * hitRb->cor) * vn)/(rb->invMass + hitRb->invMass);
+                            rb->vel -= normal * (rb->invMass * J);
+                            hitRb->vel += normal * (hitRb->invMass * J);
+                        }
+
+                        // the other body also changes course at the time of impact
+                        startPos[hitIndex] = hitPos;
+                        startTime[hitIndex] = elapsed;
+                        hitRb->pos = hitPos + hitRb->vel * (updateStep * (1.0f - elapsed));
+                        hitRb->syncCollider();
+                        markRerouted(hitIndex);
                     }
+
+                    // move with the new velocity for the remainder of the update
+                    disp = rb->vel * (updateStep * (1.0f - elapsed));
                 }
 
-                return 0;
+                // ? If we ran out of substeps, stay at the last time of impact to avoid tunneling.
+                rb->pos = sub < CCD_MAX_SUBSTEPS ? start + disp : start;
+                rb->syncCollider();
+
+                startPos[index] = start;
+                startTime[index] = elapsed;
+
+                if (sub) { markRerouted(index); }
             };
 
-            // Will go through an array of rigid bodies, look for them in the handler and remove if founc
-            // Returns -1 if all rigid bodies found and removed
-            // If not all rigid bodies in the array are in the handler, it will return the index of the first rigid body not found in the handler 
-            int removeRigidBodies(RigidBody3D** rbs, int size) {
-                for(int i = 0; i < size; ++i) {
-                    for(int j = 0; j < this->rbs.count; ++j) {
-                        if(this->rbs.rigidBodies[j] == rbs[i]) {
-                            delete rbs[i];
-                            for(int k = j; k < this->rbs.count - 1; ++k) {
-                                this->rbs.rigidBodies[k] = this->rbs.rigidBodies[k + 1];
-                            }
-                            this->rbs.count--;
-                            break;
-                        } else if(j == this->rbs.count - 1 && this->rbs.rigidBodies[j] != rbs[i]) {
-                            return i;
-                        }
+            // Sweep any supported shape through the world.
+            template <typename Shape>
+            bool sweepShape(Shape const &shape, RigidBodyCollider type, ZMath::Vec3D const &dir, float maxDist, SweepHit &hit, RigidBody3D const* ignore) {
+                refreshTrees();
+                hit = SweepHit();
+
+                ZMath::Vec3D disp = dir * maxDist, min, max;
+                getBounds(type, &shape, min, max);
+
+                // ? Only bodies overlapping the bounds of the whole sweep can be hit.
+                ZMath::Vec3D sweepMin(ZMath::min(min.x, min.x + disp.x), ZMath::min(min.y, min.y + disp.y), ZMath::min(min.z, min.z + disp.z));
+                ZMath::Vec3D sweepMax(ZMath::max(max.x, max.x + disp.x), ZMath::max(max.y, max.y + disp.y), ZMath::max(max.z, max.z + disp.z));
+
+                staticTree.query(sweepMin, sweepMax, [&](int i) {
+                    StaticBody3D* sb = sbs.staticBodies[i];
+                    float toi;
+                    ZMath::Vec3D normal;
+
+                    if (Zeta::sweepShape(shape, type, disp, sb->colliderType, sb->collider, toi, normal) && (hit.toi < 0.0f || toi < hit.toi)) {
+                        hit.sb = sb;
+                        hit.normal = normal;
+                        hit.toi = toi;
                     }
-                }
-                return -1;
-            }
-            // * ============================
-            // * StaticBody List Functions
-            // * ============================
 
-            // Add a static body to the list of rigid bodies to be updated.
-            void addStaticBody(StaticBody3D* sb) {
-                if (sbs.count == sbs.capacity) {
-                    sbs.capacity *= 2;
-                    StaticBody3D** temp = new StaticBody3D*[sbs.capacity];
+                    return 1;
+                });
 
-                    for (int i = 0; i < sbs.count; ++i) { temp[i] = sbs.staticBodies[i]; }
+                rigidTree.query(sweepMin, sweepMax, [&](int i) {
+                    RigidBody3D* rb = rbs.rigidBodies[i];
+                    float toi;
+                    ZMath::Vec3D normal;
 
-                    delete[] sbs.staticBodies;
-                    sbs.staticBodies = temp;
-                }
+                    if (rb != ignore && Zeta::sweepShape(shape, type, disp, rb->colliderType, rb->collider, toi, normal) && (hit.toi < 0.0f || toi < hit.toi)) {
+                        hit.rb = rb;
+                        hit.sb = nullptr;
+                        hit.normal = normal;
+                        hit.toi = toi;
+                    }
 
-                sbs.staticBodies[sbs.count++] = sb;
+                    return 1;
+                });
+
+                if (hit.toi < 0.0f) { return 0; }
+
+                hit.dist = hit.toi * maxDist;
+                return 1;
             };
 
-            // Add a list of static bodies to be updated
-            void addStaticBodies(StaticBody3D** sbs, int size) {
-                if (this->sbs.count + size - 1 >= this->sbs.capacity) {
-                    this->sbs.capacity += size;
-                    StaticBody3D** temp = new StaticBody3D*[this->sbs.capacity];
+            // Visit the bodies whose bounds pass a test and whose colliders pass an exact test.
+            // ? The visitor takes (RigidBody3D*, StaticBody3D*), one of which is nullptr, and returns 0 to stop the query.
+            template <typename BoundsTest, typename ColliderTest, typename Visitor>
+            bool queryBodies(BoundsTest &&testBounds, ColliderTest &&testCollider, Visitor &&visit) {
+                refreshTrees();
 
-                    for (int i = 0; i < this->sbs.count; ++i) { temp[i] = this->sbs.staticBodies[i]; }
+                bool complete = staticTree.query(testBounds, [&](int i) {
+                    StaticBody3D* sb = sbs.staticBodies[i];
+                    return !testCollider(sb->colliderType, sb->collider) || visit((RigidBody3D*) nullptr, sb);
+                });
 
-                    delete[] this->sbs.staticBodies;
-                    this->sbs.staticBodies = temp;
-                }
+                if (!complete) { return 0; }
 
-                for (int i = 0; i < size; ++i) { this->sbs.staticBodies[this->sbs.count++] = sbs[i]; }
+                return rigidTree.query(testBounds, [&](int i) {
+                    RigidBody3D* rb = rbs.rigidBodies[i];
+                    ZMath::Vec3D min, max;
+
+                    // ? The bounds in rigidTree are fattened so the body's own bounds are tested as well.
+                    return !getBounds(rb->colliderType, rb->collider, min, max) || !testBounds(min, max)
+                            || !testCollider(rb->colliderType, rb->collider) || visit(rb, (StaticBody3D*) nullptr);
+                });
             };
 
-            // Remove a static body.
-            // This returns 1 if the static body is found and removed and 0 if it was not found.
-            // If the static body is found, the data pointed to by sb gets deleted by this function.
-            bool removeStaticBody(StaticBody3D* sb) {
-                for (int i = sbs.count; i >= 0; --i) {
-                    if (sbs.staticBodies[i] == sb) {
-                        delete sb;
-                        for (int j = i; j < sbs.count - 1; ++j) { sbs.staticBodies[j] = sbs.staticBodies[j + 1]; }
-                        sbs.count--;
-                        return 1;
-                    }
-                }
+            // Store the bodies found by a query taking a visitor in a buffer, stopping once it is full.
+            template <typename Query>
+            static int collectHits(Query &&query, QueryHit* hits, int capacity) {
+                int count = 0;
+                if (capacity <= 0) { return 0; }
 
-                return 0;
+                query([&](RigidBody3D* rb, StaticBody3D* sb) {
+                    hits[count].rb = rb;
+                    hits[count].sb = sb;
+                    hits[count].dist = 0.0f;
+                    return ++count < capacity;
+                });
+
+                return count;
             };
 
-            //Tries to remove all static bodies in an array of static bodies
-            //Returns 1 if all found in the handler and deleted
-            //Returns 0 if any of the bodies in sbs are not found in the handler (none of them are deleted in this case)
-            bool removeStaticBodies(StaticBody3D** sbs, int size) {
+            // Add an overlap found in the current step to the scratch list.
+            inline void addSensorOverlap(int index, StaticBody3D* sensor, RigidBody3D* rb) {
+                if (index == sensors.overlapCapacity) {
+                    sensors.overlapCapacity *= 2;
+
+                    SensorOverlap* temp1 = new SensorOverlap[sensors.overlapCapacity];
+                    SensorOverlap* temp2 = new SensorOverlap[sensors.overlapCapacity];
+
+                    for (int i = 0; i < sensors.overlapCount; ++i) { temp1[i] = sensors.overlaps[i]; }
+                    for (int i = 0; i < index; ++i) { temp2[i] = sensors.nextOverlaps[i]; }
+
+                    delete[] sensors.overlaps;
+                    delete[] sensors.nextOverlaps;
+
+                    sensors.overlaps = temp1;
+                    sensors.nextOverlaps = temp2;
+                }
+
+                sensors.nextOverlaps[index].sensor = sensor;
+                sensors.nextOverlaps[index].rb = rb;
+            };
+
+            inline void addSensorEvent(SensorOverlap const &overlap, SensorEventType type) {
+                if (sensors.eventCount == sensors.eventCapacity) {
+                    sensors.eventCapacity *= 2;
+                    SensorEvent* temp = new SensorEvent[sensors.eventCapacity];
+
+                    for (int i = 0; i < sensors.eventCount; ++i) { temp[i] = sensors.events[i]; }
+
+                    delete[] sensors.events;
+                    sensors.events = temp;
+                }
+
+                sensors.events[sensors.eventCount++] = {overlap.sensor, overlap.rb, type};
+            };
+
+            // Order overlaps by their sensor and then their rigid body.
+            static inline bool sensorOverlapLess(SensorOverlap const &a, SensorOverlap const &b) {
+                std::less<void const*> less;
+                return a.sensor != b.sensor ? less(a.sensor, b.sensor) : less(a.rb, b.rb);
+            };
+
+            // Find the rigid bodies overlapping each sensor and compare against the last step to find the enter and exit events.
+            void updateSensors() {
+                refreshTrees();
+                int count = 0;
+
+                // * Find the overlaps with the broadphase, then check them with the boolean intersection tests.
+
+                for (int i = 0; i < sensors.count; ++i) {
+                    StaticBody3D* sensor = sensors.sensors[i];
+                    ZMath::Vec3D min, max;
+
+                    if (!getBounds(sensor->colliderType, sensor->collider, min, max)) { continue; }
+
+                    rigidTree.query(min, max, [&](int j) {
+                        RigidBody3D* rb = rbs.rigidBodies[j];
+                        if (!shouldCollide(sensor->filter, rb->filter)) { return 1; }
+
+                        if (overlaps(sensor->colliderType, sensor->collider, rb->colliderType, rb->collider)) { addSensorOverlap(count++, sensor, rb); }
+                        return 1;
+                    });
+                }
+
+                std::sort(sensors.nextOverlaps, sensors.nextOverlaps + count, sensorOverlapLess);
+
+                // * Merge the sorted lists. Overlaps only in the new list entered and overlaps only in the old list exited.
+
+                int i = 0, j = 0;
+
+                while (i < sensors.overlapCount || j < count) {
+                    if (j == count || (i < sensors.overlapCount && sensorOverlapLess(sensors.overlaps[i], sensors.nextOverlaps[j]))) {
+                        addSensorEvent(sensors.overlaps[i++], SENSOR_EXIT);
+                    } else if (i == sensors.overlapCount || sensorOverlapLess(sensors.nextOverlaps[j], sensors.overlaps[i])) {
+                        addSensorEvent(sensors.nextOverlaps[j++], SENSOR_ENTER);
+                    } else {
+                        ++i;
+                        ++j;
+                    }
+                }
+
+                SensorOverlap* temp = sensors.overlaps;
+                sensors.overlaps = sensors.nextOverlaps;
+                sensors.nextOverlaps = temp;
+                sensors.overlapCount = count;
+            };
+
+            // Make sure there is solver state for every contact point found this step.
+            inline void reserveSolverPoints() {
+                int count = 0;
+                for (int i = 0; i < rCol.count; ++i) { count += getNumSolverPoints(rCol.manifolds[i]); }
+                for (int i = 0; i < rsCol.count; ++i) { count += getNumSolverPoints(rsCol.manifolds[i]); }
+
+                if (count <= solverCapacity) { return; }
+
+                while (solverCapacity < count) { solverCapacity = solverCapacity ? solverCapacity * 2 : startingSlots; }
+
+                delete[] solverPoints;
+                solverPoints = new SolverPoint[solverCapacity];
+            };
+
+            // Find the total impulse applied to a contact in the last step. Returns 0 if the bodies were not in contact.
+            // rb2 should be nullptr for contacts with static bodies and sb should be nullptr otherwise.
+            inline float getLastImpulse(RigidBody3D* rb1, RigidBody3D* rb2, StaticBody3D* sb) const {
+                if (rb2 && std::less<RigidBody3D*>()(rb2, rb1)) { std::swap(rb1, rb2); }
+
+                Contact key = {rb1, rb2, sb, ZMath::Vec3D(), 0.0f};
+                Contact* contact = std::lower_bound(contacts.contacts, contacts.contacts + contacts.count, key, contactLess);
+
+                if (contact == contacts.contacts + contacts.count || contactLess(key, *contact)) { return 0.0f; }
+                return contact->impulse;
+            };
+
+            // Add a contact found in the current step to the scratch list.
+            inline void addContact(int index, Contact const &contact) {
+                if (index == contacts.capacity) {
+                    contacts.capacity *= 2;
+
+                    Contact* temp1 = new Contact[contacts.capacity];
+                    Contact* temp2 = new Contact[contacts.capacity];
+
+                    for (int i = 0; i < contacts.count; ++i) { temp1[i] = contacts.contacts[i]; }
+                    for (int i = 0; i < index; ++i) { temp2[i] = contacts.nextContacts[i]; }
+
+                    delete[] contacts.contacts;
+                    delete[] contacts.nextContacts;
+
+                    contacts.contacts = temp1;
+                    contacts.nextContacts = temp2;
+                }
+
+                contacts.nextContacts[index] = contact;
+            };
+
+            inline void addContactEvent(Contact const &contact, ContactEventType type) {
+                if (contacts.eventCount == contacts.eventCapacity) {
+                    contacts.eventCapacity *= 2;
+                    ContactEvent* temp = new ContactEvent[contacts.eventCapacity];
+
+                    for (int i = 0; i < contacts.eventCount; ++i) { temp[i] = contacts.events[i]; }
+
+                    delete[] contacts.events;
+                    contacts.events = temp;
+                }
+
+                contacts.events[contacts.eventCount++] = {contact, type};
+            };
+
+            // Order contacts by their first rigid body and then by the other body.
+            static inline bool contactLess(Contact const &a, Contact const &b) {
+                std::less<void const*> less;
+                if (a.rb1 != b.rb1) { return less(a.rb1, b.rb1); }
+                return less(a.rb2 ? (void const*) a.rb2 : a.sb, b.rb2 ? (void const*) b.rb2 : b.sb);
+            };
+
+            // Collect the contacts the solver found this step and compare against the last step to find the contact events.
+            // ? Speculative contacts only count once the solver applies an impulse to them, meaning the bodies touch by the end of the step.
+            void updateContacts() {
+                int count = 0;
+
+                for (int i = 0; i < rCol.count; ++i) {
+                    Manifold const &manifold = rCol.manifolds[i];
+                    if (manifold.pDist < 0.0f && rCol.impulses[i] <= 0.0f) { continue; }
+
+                    // ? The pair is stored with the lower address first so it does not depend on the order of the bodies in the handler.
+                    if (std::less<RigidBody3D*>()(rCol.bodies1[i], rCol.bodies2[i])) {
+                        addContact(count++, {rCol.bodies1[i], rCol.bodies2[i], nullptr, manifold.normal, rCol.impulses[i]});
+                    } else {
+                        addContact(count++, {rCol.bodies2[i], rCol.bodies1[i], nullptr, -manifold.normal, rCol.impulses[i]});
+                    }
+                }
+
+                for (int i = 0; i < rsCol.count; ++i) {
+                    if (rsCol.manifolds[i].pDist < 0.0f && rsCol.impulses[i] <= 0.0f) { continue; }
+                    addContact(count++, {rsCol.rbs[i], nullptr, rsCol.sbs[i], rsCol.manifolds[i].normal, rsCol.impulses[i]});
+                }
+
+                std::sort(contacts.nextContacts, contacts.nextContacts + count, contactLess);
+
+                // * Merge the sorted lists to find which contacts began, persisted, and ended.
+
+                int i = 0, j = 0;
+
+                while (i < contacts.count || j < count) {
+                    if (j == count || (i < contacts.count && contactLess(contacts.contacts[i], contacts.nextContacts[j]))) {
+                        addContactEvent(contacts.contacts[i++], CONTACT_END);
+                    } else if (i == contacts.count || contactLess(contacts.nextContacts[j], contacts.contacts[i])) {
+                        addContactEvent(contacts.nextContacts[j++], CONTACT_BEGIN);
+                    } else {
+                        addContactEvent(contacts.nextContacts[j++], CONTACT_PERSIST);
+                        ++i;
+                    }
+                }
+
+                Contact* temp = contacts.contacts;
+                contacts.contacts = contacts.nextContacts;
+                contacts.nextContacts = temp;
+                contacts.count = count;
+            };
+
+            // Forget the contacts, overlaps and events involving a body which is being removed so they never point to freed memory.
+            void forgetBody(void const* body) {
+                int count = 0;
+
+                for (int i = 0; i < contacts.count; ++i) {
+                    Contact const &contact = contacts.contacts[i];
+                    if (contact.rb1 != body && contact.rb2 != body && contact.sb != body) { contacts.contacts[count++] = contact; }
+                }
+
+                contacts.count = count;
+                count = 0;
+
+                for (int i = 0; i < contacts.eventCount; ++i) {
+                    Contact const &contact = contacts.events[i].contact;
+                    if (contact.rb1 != body && contact.rb2 != body && contact.sb != body) { contacts.events[count++] = contacts.events[i]; }
+                }
+
+                contacts.eventCount = count;
+                count = 0;
+
+                for (int i = 0; i < sensors.overlapCount; ++i) {
+                    if (sensors.overlaps[i].sensor != body && sensors.overlaps[i].rb != body) { sensors.overlaps[count++] = sensors.overlaps[i]; }
+                }
+
+                sensors.overlapCount = count;
+                count = 0;
+
+                for (int i = 0; i < sensors.eventCount; ++i) {
+                    if (sensors.events[i].sensor != body && sensors.events[i].rb != body) { sensors.events[count++] = sensors.events[i]; }
+                }
+
+                sensors.eventCount = count;
+            };
+
+#ifdef ENABLE_PHYSICS_STATS
+            // Bytes held by the handler's lists and trees. This does not include the bodies or their colliders.
+            size_t getMemoryUsage() const {
+                size_t bytes = rbs.capacity * sizeof(RigidBody3D*) + sbs.capacity * sizeof(StaticBody3D*);
+
+                bytes += rCol.capacity * (2*sizeof(RigidBody3D*) + sizeof(Manifold) + sizeof(float));
+                bytes += rsCol.capacity * (sizeof(RigidBody3D*) + sizeof(StaticBody3D*) + sizeof(Manifold) + sizeof(float));
+                bytes += sensors.capacity * sizeof(StaticBody3D*) + sensors.overlapCapacity * 2*sizeof(SensorOverlap) + sensors.eventCapacity * sizeof(SensorEvent);
+                bytes += contacts.capacity * 2*sizeof(Contact) + contacts.eventCapacity * sizeof(ContactEvent);
+                bytes += solverCapacity * sizeof(SolverPoint) + startCapacity * (sizeof(ZMath::Vec3D) + sizeof(float) + sizeof(int));
+                bytes += candidateCapacity * sizeof(int);
+
+                return bytes + staticTree.getMemoryUsage() + rigidTree.getMemoryUsage() + ccdTree.getMemoryUsage() + history.getMemoryUsage();
+            };
+#endif
+
+            // Bounds of a static body in staticTree.
+            inline void getStaticBounds(int i, ZMath::Vec3D &min, ZMath::Vec3D &max) const {
+                StaticBody3D const* sb = sbs.staticBodies[i];
+
+                // ? Bodies without bounds get inverted bounds so they are never visited.
+                if (!getBounds(sb->colliderType, sb->collider, min, max)) { min.set(FLT_MAX); max.set(-FLT_MAX); }
+            };
+
+            // Rebuild the static body tree if the static bodies changed since it was last built.
+            void refreshStaticTree() {
+                if (staticTreeDirty) {
+                    staticTree.build(sbs.count, [this](int i, ZMath::Vec3D &min, ZMath::Vec3D &max) { getStaticBounds(i, min, max); });
+                    staticTreeDirty = 0;
+                }
+            };
+
+            // Get the bounds of a rigid body stretched by how far it moves within dt at its current velocity.
+            // Returns 0 if the rigid body's collider has no bounds.
+            static inline bool getReachBounds(RigidBody3D const* rb, float dt, ZMath::Vec3D &min, ZMath::Vec3D &max) {
+                if (!getBounds(rb->colliderType, rb->collider, min, max)) { return 0; }
+
+                ZMath::Vec3D disp = rb->vel * dt;
+
+                min += ZMath::Vec3D(ZMath::min(disp.x, 0.0f), ZMath::min(disp.y, 0.0f), ZMath::min(disp.z, 0.0f));
+                max += ZMath::Vec3D(ZMath::max(disp.x, 0.0f), ZMath::max(disp.y, 0.0f), ZMath::max(disp.z, 0.0f));
+                return 1;
+            };
+
+            // Rebuild the broadphase trees if the bodies changed since they were last built.
+            void refreshTrees() {
+                refreshStaticTree();
+
+                if (rigidTreeDirty) {
+                    rigidTree.build(rbs.count, [this](int i, ZMath::Vec3D &min, ZMath::Vec3D &max) {
+                        if (!getReachBounds(rbs.rigidBodies[i], RIGID_TREE_PREDICTION * updateStep, min, max)) {
+                            min.set(FLT_MAX);
+                            max.set(-FLT_MAX);
+                            return;
+                        }
+
+                        min -= ZMath::Vec3D(RIGID_TREE_MARGIN);
+                        max += ZMath::Vec3D(RIGID_TREE_MARGIN);
+                    });
+
+                    rigidTreeDirty = 0;
+                }
+            };
+
+            // Flag the rigid body tree for a rebuild if any rigid body can move outside of its bounds in the tree within dt.
+            void checkRigidTree(float dt) {
+                if (rigidTreeDirty) { return; }
+
+                for (int i = 0; i < rbs.count; ++i) {
+                    ZMath::Vec3D min, max, fatMin, fatMax;
+                    if (!getReachBounds(rbs.rigidBodies[i], dt, min, max)) { continue; }
+
+                    rigidTree.getItemBounds(i, fatMin, fatMax);
+
+                    if (min.x < fatMin.x || min.y < fatMin.y || min.z < fatMin.z || max.x > fatMax.x || max.y > fatMax.y || max.z > fatMax.z) {
+                        rigidTreeDirty = 1;
+                        return;
+                    }
+                }
+            };
+
+            // Add a body found by the broadphase in the current step to the scratch list.
+            inline void addCandidate(int index, int body) {
+                if (index == candidateCapacity) {
+                    candidateCapacity = candidateCapacity ? candidateCapacity * 2 : startingSlots;
+
+                    int* temp = new int[candidateCapacity];
+                    for (int i = 0; i < index; ++i) { temp[i] = candidates[i]; }
+
+                    delete[] candidates;
+                    candidates = temp;
+                }
+
+                candidates[index] = body;
+            };
+
+            // Move the rigid bodies and their colliders to the states saved by saveState.
+            void loadRigidBodies(RigidBodyState const* states) {
+                for (int i = 0; i < rbs.count; ++i) {
+                    RigidBody3D* rb = rbs.rigidBodies[i];
+                    bool rotated = rb->orientation.w != states[i].orientation.w || rb->orientation.x != states[i].orientation.x
+                            || rb->orientation.y != states[i].orientation.y || rb->orientation.z != states[i].orientation.z;
+
+                    rb->pos = states[i].pos;
+                    rb->vel = states[i].vel;
+                    rb->netForce = states[i].netForce;
+                    rb->orientation = states[i].orientation;
+                    rb->angVel = states[i].angVel;
+                    rb->netTorque = states[i].netTorque;
+
+                    // ? Rebuilding the collider's rotation is the slowest part of a load so it is skipped for bodies which did not rotate.
+                    if (rotated) { rb->syncRotation(); }
+
+                    rb->syncCollider();
+                }
+
+                rigidTreeDirty = 1;
+            };
+
+            // Add the current state to the history.
+            inline void recordHistory() {
+                size_t size = getStateSize();
+                uint8_t* state = history.getScratch(size);
+
+                saveState(state, size);
+                history.push(state, size);
+            };
+
+        public:
+            // * =====================
+            // * Public Attributes
+            // * =====================
+
+            ZMath::Vec3D g; // gravity
+
+            // * ===================================
+            // * Constructors, Destructors, Etc.
+            // * ===================================
+
+            // Make a physics handler with a default gravity of -9.8 and an update speed of 60FPS.
+
+            /**
+             * @brief Create a physics handler.
+             * 
+             * @param g (Vec3D) The force applied by gravity. Default of <0, 0, -9.8f>.
+             * @param timeStep (float) The amount of time in seconds that must pass before the handler updates physics.
+             *    Default speed of 60FPS. Anything above 60FPS is not recommended as it can cause lag in lower end hardware.
+             *    Speculative contacts keep stacks stable at larger steps such as FPS_30 or FPS_24.
+             */
+            Handler(ZMath::Vec3D const &g = ZMath::Vec3D(0, 0, -9.8f), float timeStep = FPS_60) : updateStep(timeStep), g(g) {
+                if (updateStep < FPS_60) { updateStep = FPS_60; } // hard cap at 60 FPS
+
+                // * Bodies
+
+                rbs.rigidBodies = new RigidBody3D*[startingSlots];
+                rbs.capacity = startingSlots;
+                rbs.count = 0;
+
+                sbs.staticBodies = new StaticBody3D*[startingSlots];
+                sbs.capacity = startingSlots;
+                sbs.count = 0;
+
+
+                // * Collisions
+
+                rCol.bodies1 = new RigidBody3D*[halfStartingSlots];
+                rCol.bodies2 = new RigidBody3D*[halfStartingSlots];
+                rCol.manifolds = new Manifold[halfStartingSlots];
+                rCol.impulses = new float[halfStartingSlots];
+                rCol.capacity = halfStartingSlots;
+                rCol.count = 0;
+
+                rsCol.rbs = new RigidBody3D*[halfStartingSlots];
+                rsCol.sbs = new StaticBody3D*[halfStartingSlots];
+                rsCol.manifolds = new Manifold[halfStartingSlots];
+                rsCol.impulses = new float[halfStartingSlots];
+                rsCol.capacity = halfStartingSlots;
+                rsCol.count = 0;
+
+
+                // * Sensors
+
+                sensors.sensors = new StaticBody3D*[halfStartingSlots];
+                sensors.capacity = halfStartingSlots;
+                sensors.count = 0;
+
+                sensors.overlaps = new SensorOverlap[halfStartingSlots];
+                sensors.nextOverlaps = new SensorOverlap[halfStartingSlots];
+                sensors.overlapCapacity = halfStartingSlots;
+                sensors.overlapCount = 0;
+
+                sensors.events = new SensorEvent[halfStartingSlots];
+                sensors.eventCapacity = halfStartingSlots;
+                sensors.eventCount = 0;
+
+
+                // * Contacts
+
+                contacts.contacts = new Contact[halfStartingSlots];
+                contacts.nextContacts = new Contact[halfStartingSlots];
+                contacts.capacity = halfStartingSlots;
+                contacts.count = 0;
+
+                contacts.events = new ContactEvent[halfStartingSlots];
+                contacts.eventCapacity = halfStartingSlots;
+                contacts.eventCount = 0;
+            };
+
+            // Do not allow for construction from an existing physics handler.
+            Handler(Handler const &) { throw std::runtime_error("PhysicsHandler object CANNOT be constructed from another PhysicsHandler."); };
+            Handler(Handler&&) { throw std::runtime_error("PhysicsHandler object CANNOT be constructed from another PhysicsHandler."); };
+
+            // The physics handler cannot be reassigned.
+            Handler& operator = (Handler const &) { throw std::runtime_error("PhysicsHandler object CANNOT be reassigned to another PhysicsHandler."); };
+            Handler& operator = (Handler&&) { throw std::runtime_error("PhysicsHandler object CANNOT be reassigned to another PhysicsHandler."); };
+
+            ~Handler() { // todo could probs combine some of the loops together
+                // If one of the pointers is not NULL, none of them are.
+                if (rbs.rigidBodies) {
+                    for (int i = 0; i < rbs.count; ++i) { delete rbs.rigidBodies[i]; }
+                    delete[] rbs.rigidBodies;
+
+                    // ? Static bodies are not deleted along with the handler so only the list is freed.
+                    delete[] sbs.staticBodies;
+
+                    // ? Note: we do not need to delete each RigidBody pointer in bodies1 and bodies2 as the main rigidBodies list
+                    // ?       is guarenteed to contain those same pointers.
+                    delete[] rCol.bodies1;
+                    delete[] rCol.bodies2;
+                    
+                    delete[] rsCol.rbs;
+                    delete[] rsCol.sbs;
+
+                    // ? We do not need to check for nullptr for contactPoints as if rCol.count > 0, it is guarenteed manifolds[i].contactPoints != nullptr.
+                    for (int i = 0; i < rCol.count; ++i) { delete[] rCol.manifolds[i].contactPoints; }
+                    delete[] rCol.manifolds;
+                    delete[] rCol.impulses;
+
+                    for (int i = 0; i < rsCol.count; ++i) { delete[] rsCol.manifolds[i].contactPoints; }
+                    delete[] rsCol.manifolds;
+                    delete[] rsCol.impulses;
+
+                    delete[] contacts.contacts;
+                    delete[] contacts.nextContacts;
+                    delete[] contacts.events;
+                    delete[] solverPoints;
+
+                    for (int i = 0; i < sensors.count; ++i) { delete sensors.sensors[i]; }
+                    delete[] sensors.sensors;
+                    delete[] sensors.overlaps;
+                    delete[] sensors.nextOverlaps;
+                    delete[] sensors.events;
+                }
+
+                delete[] startPos;
+                delete[] startTime;
+                delete[] rerouted;
+                delete[] candidates;
+            };
+
+
+            // * ============================
+            // * RigidBody List Functions
+            // * ============================
+
+            // Add a rigid body to the list of rigid bodies to be updated.
+            void addRigidBody(RigidBody3D* rb) {
+                if (rbs.count == rbs.capacity) {
+                    rbs.capacity *= 2;
+                    RigidBody3D** temp = new RigidBody3D*[rbs.capacity];
+
+                    for (int i = 0; i < rbs.count; ++i) { temp[i] = rbs.rigidBodies[i]; }
+
+                    delete[] rbs.rigidBodies;
+                    rbs.rigidBodies = temp;
+                }
+
+                rbs.rigidBodies[rbs.count++] = rb;
+                rigidTreeDirty = 1;
+                history.clear();
+            };
+
+            // Add a list of rigid bodies to be updated
+            void addRigidBodies(RigidBody3D** rbs, int size) {
+                if (this->rbs.count + size - 1 >= this->rbs.capacity) {
+                    this->rbs.capacity += size;
+                    RigidBody3D** temp = new RigidBody3D*[this->rbs.capacity];
+
+                    for (int i = 0; i < this->rbs.count; ++i) { temp[i] = this->rbs.rigidBodies[i]; }
+
+                    delete[] this->rbs.rigidBodies;
+                    this->rbs.rigidBodies = temp;
+                }
+
+                for (int i = 0; i < size; ++i) { this->rbs.rigidBodies[this->rbs.count++] = rbs[i]; }
+                rigidTreeDirty = 1;
+                history.clear();
+            };
+
+            // Remove a rigid body.
+            // This returns 1 if the rigid body is found and removed and 0 if it was not found.
+            // If the rigid body is found, the data pointed to by rb gets deleted by this function.
+            bool removeRigidBody(RigidBody3D* rb) {
+                for (int i = rbs.count; i >= 0; --i) {
+                    if (rbs.rigidBodies[i] == rb) {
+                        forgetBody(rb);
+                        delete rb;
+                        for (int j = i; j < rbs.count - 1; ++j) { rbs.rigidBodies[j] = rbs.rigidBodies[j + 1]; }
+                        rbs.count--;
+                        rigidTreeDirty = 1;
+                        history.clear();
+                        return 1;
+                    }
+                }
+
+                return 0;
+            };
+
+            // Will go through an array of rigid bodies, look for them in the handler and remove if founc
+            // Returns -1 if all rigid bodies found and removed
+            // If not all rigid bodies in the array are in the handler, it will return the index of the first rigid body not found in the handler 
+            int removeRigidBodies(RigidBody3D** rbs, int size) {
+                for(int i = 0; i < size; ++i) {
+                    for(int j = 0; j < this->rbs.count; ++j) {
+                        if(this->rbs.rigidBodies[j] == rbs[i]) {
+                            forgetBody(rbs[i]);
+                            delete rbs[i];
+                            for(int k = j; k < this->rbs.count - 1; ++k) {
+                                this->rbs.rigidBodies[k] = this->rbs.rigidBodies[k + 1];
+                            }
+                            this->rbs.count--;
+                            rigidTreeDirty = 1;
+                            history.clear();
+                            break;
+                        } else if(j == this->rbs.count - 1 && this->rbs.rigidBodies[j] != rbs[i]) {
+                            return i;
+                        }
+                    }
+                }
+                return -1;
+            }
+            // * ============================
+            // * StaticBody List Functions
+            // * ============================
+
+            // Add a static body to the list of rigid bodies to be updated.
+            void addStaticBody(StaticBody3D* sb) {
+                if (sbs.count == sbs.capacity) {
+                    sbs.capacity *= 2;
+                    StaticBody3D** temp = new StaticBody3D*[sbs.capacity];
+
+                    for (int i = 0; i < sbs.count; ++i) { temp[i] = sbs.staticBodies[i]; }
+
+                    delete[] sbs.staticBodies;
+                    sbs.staticBodies = temp;
+                }
+
+                sbs.staticBodies[sbs.count++] = sb;
+                staticTreeDirty = 1;
+                history.clear();
+            };
+
+            // Add a list of static bodies to be updated
+            void addStaticBodies(StaticBody3D** sbs, int size) {
+                if (this->sbs.count + size - 1 >= this->sbs.capacity) {
+                    this->sbs.capacity += size;
+                    StaticBody3D** temp = new StaticBody3D*[this->sbs.capacity];
+
+                    for (int i = 0; i < this->sbs.count; ++i) { temp[i] = this->sbs.staticBodies[i]; }
+
+                    delete[] this->sbs.staticBodies;
+                    this->sbs.staticBodies = temp;
+                }
+
+                for (int i = 0; i < size; ++i) { this->sbs.staticBodies[this->sbs.count++] = sbs[i]; }
+                staticTreeDirty = 1;
+                history.clear();
+            };
+
+            // Remove a static body.
+            // This returns 1 if the static body is found and removed and 0 if it was not found.
+            // If the static body is found, the data pointed to by sb gets deleted by this function.
+            bool removeStaticBody(StaticBody3D* sb) {
+                for (int i = sbs.count; i >= 0; --i) {
+                    if (sbs.staticBodies[i] == sb) {
+                        forgetBody(sb);
+                        delete sb;
+                        for (int j = i; j < sbs.count - 1; ++j) { sbs.staticBodies[j] = sbs.staticBodies[j + 1]; }
+                        sbs.count--;
+                        staticTreeDirty = 1;
+                        history.clear();
+                        return 1;
+                    }
+                }
+
+                return 0;
+            };
+
+            //Tries to remove all static bodies in an array of static bodies
+            //Returns 1 if all found in the handler and deleted
+            //Returns 0 if any of the bodies in sbs are not found in the handler (none of them are deleted in this case)
+            bool removeStaticBodies(StaticBody3D** sbs, int size) {
                 int* indices = new int[size];
                 for(int i = 0; i < size; ++i) {
                     for(int j = 0; j < this->sbs.count; ++j) {
@@ -430,15 +1489,141 @@ namespace Zeta {
                     }
                 }
                 for(int i = 0; i < size; ++i) {
+                    forgetBody(sbs[i]);
                     delete sbs[i];
                     for(int j = indices[i]; j < this->sbs.count - 1; ++j) { 
                         this->sbs.staticBodies[j] = this->sbs.staticBodies[j + 1]; 
                     }
-                    this->sbs.count--;
+                    this->sbs.count--;
+                }
+                delete[] indices;
+                staticTreeDirty = 1;
+                history.clear();
+                return 1;
+            }
+
+            /**
+             * @brief Add the bodies from a scene file.
+             * ? If the handler has no static bodies yet, the broadphase tree stored in the scene is used as is instead of being built.
+             * ?  It is used until the static bodies change.
+             * The scene's static bodies belong to the scene. They must not be removed one at a time, and the scene must stay loaded
+             *  while they are in the handler. The rigid bodies are new and belong to the handler like any other.
+             *
+             * @param scene The scene.
+             */
+            void addScene(SceneFile const &scene) {
+                if (!scene.isLoaded()) { return; }
+
+                bool hadStaticBodies = sbs.count > 0;
+                int numStatic = scene.getNumStaticBodies();
+
+                if (numStatic) { addStaticBodies(scene.getStaticBodies(), numStatic); }
+
+                if (!hadStaticBodies && numStatic) {
+                    staticTree.borrow(scene.getNodes(), scene.getNumNodes(), scene.getItems(), numStatic,
+                            [this](int i, ZMath::Vec3D &min, ZMath::Vec3D &max) { getStaticBounds(i, min, max); });
+                    staticTreeDirty = 0;
+                }
+
+                for (int i = 0; i < scene.getNumRigidBodies(); ++i) { addRigidBody(scene.createRigidBody(i)); }
+            };
+
+            // * ============================
+            // * Sensor Functions
+            // * ============================
+
+            // Add a sensor. Sensors are static bodies which detect the rigid bodies overlapping them without colliding with them.
+            // They are ignored by the solver and the queries, and only use boolean intersection tests.
+            void addSensor(StaticBody3D* sensor) {
+                if (sensors.count == sensors.capacity) {
+                    sensors.capacity *= 2;
+                    StaticBody3D** temp = new StaticBody3D*[sensors.capacity];
+
+                    for (int i = 0; i < sensors.count; ++i) { temp[i] = sensors.sensors[i]; }
+
+                    delete[] sensors.sensors;
+                    sensors.sensors = temp;
+                }
+
+                sensors.sensors[sensors.count++] = sensor;
+                history.clear();
+            };
+
+            // Remove a sensor.
+            // This returns 1 if the sensor is found and removed and 0 if it was not found.
+            // If the sensor is found, the data pointed to by sensor gets deleted by this function.
+            // ? No exit events are sent for the bodies overlapping a removed sensor.
+            bool removeSensor(StaticBody3D* sensor) {
+                for (int i = 0; i < sensors.count; ++i) {
+                    if (sensors.sensors[i] == sensor) {
+                        forgetBody(sensor);
+                        delete sensor;
+
+                        for (int j = i; j < sensors.count - 1; ++j) { sensors.sensors[j] = sensors.sensors[j + 1]; }
+                        sensors.count--;
+                        history.clear();
+                        return 1;
+                    }
                 }
-                delete[] indices;
-                return 1;
-            }
+
+                return 0;
+            };
+
+            // Get the sensor events from the last call to update, in the order they happened.
+            // count is set to the number of events. The events are only valid until the next call to update.
+            inline SensorEvent const* getSensorEvents(int &count) const {
+                count = sensors.eventCount;
+                return sensors.events;
+            };
+
+            // Get every rigid body currently overlapping a sensor, sorted by sensor.
+            // count is set to the number of overlaps. The overlaps are only valid until the next call to update.
+            inline SensorOverlap const* getSensorOverlaps(int &count) const {
+                count = sensors.overlapCount;
+                return sensors.overlaps;
+            };
+
+
+            // * ============================
+            // * Contact Functions
+            // * ============================
+
+            // Get the contact events from the last call to update, in the order they happened.
+            // count is set to the number of events. The events are only valid until the next call to update.
+            inline ContactEvent const* getContactEvents(int &count) const {
+                count = contacts.eventCount;
+                return contacts.events;
+            };
+
+            /**
+             * @brief Visit the contact events from the last call to update involving a body.
+             *
+             * @param body The rigid or static body to get the events of.
+             * @param visit Called with each ContactEvent involving the body. Return 0 to stop visiting events.
+             * @return (int) The number of events visited.
+             */
+            template <typename Visitor>
+            int getContactEvents(void const* body, Visitor &&visit) const {
+                int count = 0;
+
+                for (int i = 0; i < contacts.eventCount; ++i) {
+                    Contact const &contact = contacts.events[i].contact;
+                    if (contact.rb1 != body && contact.rb2 != body && contact.sb != body) { continue; }
+
+                    ++count;
+                    if (!visit(contacts.events[i])) { break; }
+                }
+
+                return count;
+            };
+
+            // Get the contacts from the last step.
+            // count is set to the number of contacts. The contacts are only valid until the next call to update.
+            inline Contact const* getContacts(int &count) const {
+                count = contacts.count;
+                return contacts.contacts;
+            };
+
 
             // * ============================
             // * Main Physics Functions
@@ -447,51 +1632,742 @@ namespace Zeta {
             // Update the physics.
             // dt will be updated to the appropriate value after the updates run for you so DO NOT modify it yourself.
             int update(float &dt) {
+                ZETA_TRACE(TraceScope updateTrace("Handler::update"));
                 int count = 0;
 
+                sensors.eventCount = 0;
+                contacts.eventCount = 0;
+
                 // todo combine the loops together later with an equation
                 while (dt >= updateStep) {
+                    ZETA_TRACE(TraceScope stepTrace("step"));
+                    ZETA_TRACE(TraceScope phaseTrace("integrate velocities"));
+
+                    ZETA_STATS(stepStats.beginStep());
+                    ZETA_STATS(size_t startMemory = getMemoryUsage());
+                    ZETA_STATS(int pairs = 0);
+
+                    // Apply forces first so the contacts can cancel out any velocity gained this step
+                    for (int i = 0; i < rbs.count; ++i) { rbs.rigidBodies[i]->integrateVel(g, updateStep); }
+
+                    ZETA_STATS(stepStats.endPhase(STAT_INTEGRATION_TIME));
+                    ZETA_STATS(stepStats.beginPhase());
+                    ZETA_TRACE(phaseTrace.next("find collisions"));
+
                     // Broad phase: collision detection
-                    for (int i = 0; i < rbs.count - 1; ++i) {
-                        for (int j = i + 1; j < rbs.count; ++j) {
-                            Manifold result = findCollisionFeatures(rbs.rigidBodies[i], rbs.rigidBodies[j]);
-                            if (result.hit) { addCollision(rbs.rigidBodies[i], rbs.rigidBodies[j], result); }
+                    // ? Bodies which are not touching yet but could touch this step get speculative contacts, so each rigid body is
+                    // ?  paired with the bodies overlapping its bounds stretched by how far it moves this step. Two bodies which could touch
+                    // ?  always overlap each other's stretched bounds, and the fattened bounds in rigidTree contain the stretched bounds.
+                    // ? The bodies found for each rigid body are sorted so the contacts are found in the same order as the trees change.
+                    // ? Pairs rejected by their collision filters are skipped before any narrowphase work.
+                    checkRigidTree(updateStep);
+                    refreshTrees();
+
+                    for (int i = 0; i < rbs.count; ++i) {
+                        RigidBody3D* rb = rbs.rigidBodies[i];
+                        ZMath::Vec3D min, max;
+
+                        if (!getReachBounds(rb, updateStep, min, max)) { continue; }
+
+                        int n = 0;
+                        rigidTree.query(min, max, [&](int j) {
+                            if (j > i) { addCandidate(n++, j); }
+                            return 1;
+                        });
+
+                        std::sort(candidates, candidates + n);
+
+                        for (int k = 0; k < n; ++k) {
+                            RigidBody3D* other = rbs.rigidBodies[candidates[k]];
+                            if (!shouldCollide(rb->filter, other->filter)) { continue; }
+                            ZETA_STATS(++pairs);
+
+                            Manifold result = findCollisionFeatures(rb, other);
+                            if (!result.hit) { result = findSpeculativeFeatures(rb, other, updateStep); }
+                            if (result.hit) { addCollision(rb, other, result); }
                         }
 
-                        for (int j = 0; j < sbs.count; ++j) {
-                            Manifold result = findCollisionFeatures(sbs.staticBodies[j], rbs.rigidBodies[i]);
-                            if (result.hit) { addCollision(rbs.rigidBodies[i], sbs.staticBodies[j], result); }
+                        n = 0;
+                        staticTree.query(min, max, [&](int j) {
+                            addCandidate(n++, j);
+                            return 1;
+                        });
+
+                        std::sort(candidates, candidates + n);
+
+                        for (int k = 0; k < n; ++k) {
+                            StaticBody3D* sb = sbs.staticBodies[candidates[k]];
+                            if (!shouldCollide(rb->filter, sb->filter)) { continue; }
+                            ZETA_STATS(++pairs);
+
+                            Manifold result = findCollisionFeatures(sb, rb);
+                            if (!result.hit) { result = findSpeculativeFeatures(sb, rb, updateStep); }
+                            if (result.hit) { addCollision(rb, sb, result); }
                         }
                     }
 
+                    ZETA_STATS(stepStats.endPhase(STAT_COLLISION_TIME));
+                    ZETA_STATS(stepStats.beginPhase());
+                    ZETA_TRACE(phaseTrace.next("solve impulses"));
+
                     // todo update to not be through iterative deepening -- look into this in the future
                     // todo use spacial partitioning
                     // Narrow phase: Impulse resolution
+                    // ? Each contact point is resolved separately so off-center contacts make the bodies rotate.
+                    // ? The solver starts from the impulse each contact needed last step as resting contacts need about the same every step.
+                    // ?  Otherwise stacks would need far more iterations to stop sinking into each other.
+                    reserveSolverPoints();
+
+                    SolverPoint* points = solverPoints;
+
+#ifdef ENABLE_PHYSICS_STATS
+                    stepStats.set(STAT_PAIRS, pairs);
+                    stepStats.set(STAT_MANIFOLDS, rCol.count + rsCol.count);
+                    stepStats.set(STAT_SOLVER_ITERATIONS, IMPULSE_ITERATIONS);
+
+                    for (int i = 0; i < rCol.count; ++i) {
+                        stepStats.add(STAT_CONTACT_POINTS, getNumSolverPoints(rCol.manifolds[i]));
+                        stepStats.add(STAT_BYTES_ALLOCATED, rCol.manifolds[i].numPoints * sizeof(ZMath::Vec3D));
+                    }
+
+                    for (int i = 0; i < rsCol.count; ++i) {
+                        stepStats.add(STAT_CONTACT_POINTS, getNumSolverPoints(rsCol.manifolds[i]));
+                        stepStats.add(STAT_BYTES_ALLOCATED, rsCol.manifolds[i].numPoints * sizeof(ZMath::Vec3D));
+                    }
+#endif
+
+                    for (int i = 0; i < rCol.count; ++i) {
+                        prepareImpulse(rCol.bodies1[i], rCol.bodies2[i], rCol.manifolds[i], updateStep, points);
+                        points += getNumSolverPoints(rCol.manifolds[i]);
+                    }
+
+                    for (int i = 0; i < rsCol.count; ++i) {
+                        prepareImpulse(rsCol.rbs[i], rsCol.sbs[i], rsCol.manifolds[i], updateStep, points);
+                        points += getNumSolverPoints(rsCol.manifolds[i]);
+                    }
+
+                    points = solverPoints;
+
+                    for (int i = 0; i < rCol.count; ++i) {
+                        float impulse = getLastImpulse(rCol.bodies1[i], rCol.bodies2[i], nullptr);
+                        if (impulse > 0.0f) { rCol.impulses[i] += warmStartImpulse(rCol.bodies1[i], rCol.bodies2[i], rCol.manifolds[i], points, impulse); }
+                        points += getNumSolverPoints(rCol.manifolds[i]);
+                    }
+
+                    for (int i = 0; i < rsCol.count; ++i) {
+                        float impulse = getLastImpulse(rsCol.rbs[i], nullptr, rsCol.sbs[i]);
+                        if (impulse > 0.0f) { rsCol.impulses[i] += warmStartImpulse(rsCol.rbs[i], rsCol.sbs[i], rsCol.manifolds[i], points, impulse); }
+                        points += getNumSolverPoints(rsCol.manifolds[i]);
+                    }
+
                     for (int k = 0; k < IMPULSE_ITERATIONS; ++k) {
+                        points = solverPoints;
+
                         for (int i = 0; i < rCol.count; ++i) {
-                            applyImpulse(rCol.bodies1[i], rCol.bodies2[i], rCol.manifolds[i]);
+                            rCol.impulses[i] += applyImpulse(rCol.bodies1[i], rCol.bodies2[i], rCol.manifolds[i], points);
+                            points += getNumSolverPoints(rCol.manifolds[i]);
                         }
 
                         for (int i = 0; i < rsCol.count; ++i) {
-                            applyImpulse(rsCol.rbs[i], rsCol.sbs[i], rsCol.manifolds[i]);
+                            rsCol.impulses[i] += applyImpulse(rsCol.rbs[i], rsCol.sbs[i], rsCol.manifolds[i], points);
+                            points += getNumSolverPoints(rsCol.manifolds[i]);
                         }
                     }
 
+                    ZETA_STATS(stepStats.endPhase(STAT_SOLVER_TIME));
+                    ZETA_STATS(stepStats.beginPhase());
+                    ZETA_TRACE(phaseTrace.next("contact events"));
+
+                    updateContacts();
                     clearCollisions();
 
+                    ZETA_STATS(stepStats.endPhase(STAT_EVENT_TIME));
+                    ZETA_STATS(stepStats.beginPhase());
+                    ZETA_TRACE(phaseTrace.next("integrate positions"));
+
                     // Update our rigidbodies
-                    for (int i = 0; i < rbs.count; ++i) { rbs.rigidBodies[i]->update(g, updateStep); }
+                    bool ccd = recordStartPos();
+                    for (int i = 0; i < rbs.count; ++i) { rbs.rigidBodies[i]->integratePos(updateStep); }
+
+                    // Continuous collision detection for fast bodies
+                    if (ccd) {
+                        ZETA_TRACE(TraceScope ccdTrace("continuous collision detection"));
+
+                        refreshStaticTree();
+                        buildCCDTree();
+
+                        for (int i = 0; i < rbs.count; ++i) {
+                            if (rbs.rigidBodies[i]->ccd) { advanceCCD(i); }
+                        }
+                    }
+
+                    // ? The queries between steps use rigidTree so it must still hold the bodies where they ended up.
+                    checkRigidTree(0.0f);
+
+                    ZETA_STATS(stepStats.endPhase(STAT_INTEGRATION_TIME));
+                    ZETA_STATS(stepStats.beginPhase());
+                    ZETA_TRACE(phaseTrace.next("sensor events"));
+
+                    // Sensors only need to know which bodies overlap them after the bodies move
+                    if (sensors.count) { updateSensors(); }
+
+                    if (history.getCapacity()) {
+                        ZETA_TRACE(TraceScope historyTrace("record history"));
+                        recordHistory();
+                    }
+
+#ifdef ENABLE_PHYSICS_STATS
+                    stepStats.endPhase(STAT_EVENT_TIME);
+
+                    size_t memory = getMemoryUsage();
+                    if (memory > startMemory) { stepStats.add(STAT_BYTES_ALLOCATED, memory - startMemory); }
+
+                    stepStats.set(STAT_MEMORY, memory);
+                    stepStats.set(STAT_TREE_NODES, staticTree.getNumNodes() + rigidTree.getNumNodes());
+                    stepStats.set(STAT_TREE_ITEMS, staticTree.numItems + rigidTree.numItems);
+                    stepStats.endStep();
+#endif
 
                     dt -= updateStep;
                     ++count;
                 }
 
+                return count;
+            };
+
+#ifdef ENABLE_PHYSICS_STATS
+            // Get the timings and counters of the most recent steps. Only available with ENABLE_PHYSICS_STATS defined.
+            // ? The tree stats reflect the trees as they were at the end of each step.
+            inline Stats const& stats() const { return stepStats; };
+
+            // Forget the recorded stats, such as after loading a new scene.
+            inline void resetStats() { stepStats.reset(); };
+
+            // Call a probe around each phase of every step, such as to read hardware counters. nullptr to remove it.
+            // The probe is not owned by the handler and must stay alive while it is set.
+            inline void setStatsProbe(StatsProbe* probe) { stepStats.setProbe(probe); };
+#endif
+
+            // Call this after moving or resizing bodies outside of update so the queries see the changes.
+            void refreshBroadphase() { staticTreeDirty = rigidTreeDirty = 1; };
+
+
+            // * ============================
+            // * Snapshots
+            // * ============================
+
+            // ? A snapshot holds the dynamic state of every rigid body along with the contacts and sensor overlaps found in the last step,
+            // ?  so updating after a load gives the same result as updating from when the state was saved.
+            // ? Static bodies and sensors are not saved as they do not move. The colliders are moved to match the rigid bodies on load.
+            // ? The events are not saved as update clears them before stepping. They are cleared by a load as well.
+            // ? The contacts store pointers to the bodies so a snapshot can only be loaded by the handler which saved it,
+            // ?  and only while it holds the same bodies in the same order.
+
+            // Get the number of bytes needed to save the current state.
+            size_t getStateSize() const {
+                return sizeof(HandlerStateHeader) + contacts.count * sizeof(Contact) + sensors.overlapCount * sizeof(SensorOverlap)
+                        + rbs.count * sizeof(RigidBodyState);
+            };
+
+            /**
+             * @brief Save the state of the bodies and collisions into a flat buffer, such as to roll back to it later.
+             *
+             * @param buffer Memory to save the state to. This should be aligned for pointers, which memory from new or malloc always is.
+             * @param size Size of the buffer in bytes. Use getStateSize to find how big it must be.
+             * @return (size_t) Number of bytes written. 0 if the buffer was too small.
+             */
+            size_t saveState(void* buffer, size_t size) const {
+                size_t stateSize = getStateSize();
+                if (size < stateSize) { return 0; }
+
+                HandlerStateHeader* header = (HandlerStateHeader*) buffer;
+                header->size = (uint32_t) stateSize;
+                header->numRigidBodies = rbs.count;
+                header->numStaticBodies = sbs.count;
+                header->numSensors = sensors.count;
+                header->contactCount = contacts.count;
+                header->overlapCount = sensors.overlapCount;
+
+                RigidBodyState* states = (RigidBodyState*) (header + 1);
+
+                for (int i = 0; i < rbs.count; ++i) {
+                    RigidBody3D const* rb = rbs.rigidBodies[i];
+
+                    states[i].pos = rb->pos;
+                    states[i].vel = rb->vel;
+                    states[i].netForce = rb->netForce;
+                    states[i].orientation = rb->orientation;
+                    states[i].angVel = rb->angVel;
+                    states[i].netTorque = rb->netTorque;
+                }
+
+                char* p = (char*) (states + rbs.count);
+
+                memcpy(p, contacts.contacts, contacts.count * sizeof(Contact));
+                p += contacts.count * sizeof(Contact);
+
+                memcpy(p, sensors.overlaps, sensors.overlapCount * sizeof(SensorOverlap));
+
+                return stateSize;
+            };
+
+            /**
+             * @brief Load a state written by saveState. The lists already allocated by the handler are reused whenever they are big enough.
+             *
+             * @param buffer State written by saveState on this handler.
+             * @param size Size of the buffer in bytes.
+             * @return (bool) 1 if the state was loaded. 0, leaving the handler unchanged, if the buffer is too small
+             *                 or the handler no longer holds the same number of bodies.
+             */
+            bool loadState(void const* buffer, size_t size) {
+                if (size < sizeof(HandlerStateHeader)) { return 0; }
+
+                HandlerStateHeader const* header = (HandlerStateHeader const*) buffer;
+
+                if (size < header->size || header->numRigidBodies != rbs.count || header->numStaticBodies != sbs.count
+                        || header->numSensors != sensors.count) { return 0; }
+
+                // * Make room for the saved lists. This only allocates if the state holds more than the handler has ever held.
+
+                if (contacts.capacity < header->contactCount) {
+                    while (contacts.capacity < header->contactCount) { contacts.capacity *= 2; }
+
+                    delete[] contacts.contacts;
+                    delete[] contacts.nextContacts;
+
+                    contacts.contacts = new Contact[contacts.capacity];
+                    contacts.nextContacts = new Contact[contacts.capacity];
+                }
+
+                if (sensors.overlapCapacity < header->overlapCount) {
+                    while (sensors.overlapCapacity < header->overlapCount) { sensors.overlapCapacity *= 2; }
+
+                    delete[] sensors.overlaps;
+                    delete[] sensors.nextOverlaps;
+
+                    sensors.overlaps = new SensorOverlap[sensors.overlapCapacity];
+                    sensors.nextOverlaps = new SensorOverlap[sensors.overlapCapacity];
+                }
+
+                // * Copy the lists back.
+
+                RigidBodyState const* states = (RigidBodyState const*) (header + 1);
+                char const* p = (char const*) (states + rbs.count);
+
+                contacts.count = header->contactCount;
+                memcpy(contacts.contacts, p, contacts.count * sizeof(Contact));
+                p += contacts.count * sizeof(Contact);
+
+                sensors.overlapCount = header->overlapCount;
+                memcpy(sensors.overlaps, p, sensors.overlapCount * sizeof(SensorOverlap));
+
+                contacts.eventCount = 0;
+                sensors.eventCount = 0;
+
+                loadRigidBodies(states);
+                return 1;
+            };
+
+
+            // * ============================
+            // * History
+            // * ============================
+
+            // ? With the history turned on, the state is recorded at the end of every step so the handler can be rewound to any of them.
+            // ?  Each state is stored as its difference from a keyframe so bodies which have not changed take up almost no memory.
+            // ? Adding or removing bodies or sensors clears the history as the old states would point to the old bodies.
+
+            // Keep the states of the last steps steps. 0, the default, turns the history off and frees it.
+            // This clears the history.
+            void setHistorySize(int steps) { history.resize(steps); };
+
+            // Get the number of steps the handler can currently be rewound by.
+            // ? The newest state is the state at the end of the last step, so the handler can be rewound by one less than this.
+            inline int getHistoryCount() const { return history.getCount(); };
+
+            // Bytes taken by the encoded states in the history.
+            inline size_t getHistoryBytes() const { return history.getEncodedSize(); };
+
+            /**
+             * @brief Rewind the handler to the end of an earlier step and forget the steps after it, such as to resimulate them for rollback.
+             *
+             * @param steps Number of steps to go back. 0 reloads the state at the end of the last step.
+             * @return (bool) 1 if the handler was rewound and 0, leaving it unchanged, if the history does not go back that far.
+             */
+            bool rewind(int steps) {
+                size_t size;
+                uint8_t const* state = history.get(steps, size);
+
+                if (!state || !loadState(state, size)) { return 0; }
+
+                history.drop(steps);
+                return 1;
+            };
+
+            /**
+             * @brief Run queries with the bodies moved back to where they were at the end of an earlier step, such as for lag compensation.
+             *        The bodies are moved back once the queries finish. Only the bodies are moved, so the contacts and events are untouched.
+             * ? Moving the bodies marks the broadphase as changed, so batch the queries for a step together when possible.
+             *
+             * @param steps Number of steps to go back. 0 for the end of the last step.
+             * @param query Callable with the signature void() making the queries on this handler.
+             * @return (bool) 1 if the queries were run and 0 if the history does not go back that far.
+             */
+            template <typename Query>
+            bool queryAt(int steps, Query &&query) {
+                size_t pastSize;
+                uint8_t const* past = history.get(steps, pastSize);
+
+                if (!past || ((HandlerStateHeader const*) past)->numRigidBodies != rbs.count) { return 0; }
+
+                size_t size = getStateSize();
+                uint8_t* present = history.getScratch(size);
+                saveState(present, size);
+
+                loadRigidBodies((RigidBodyState const*) (((HandlerStateHeader const*) past) + 1));
+                query();
+                loadRigidBodies((RigidBodyState const*) (((HandlerStateHeader const*) present) + 1));
+
+                return 1;
+            };
+
+            // Find the closest body hit by a ray as the bodies were at the end of an earlier step. See raycast and queryAt.
+            // Returns 1 if a body was hit and 0 if nothing was hit or the history does not go back that far.
+            bool raycastAt(int steps, Ray3D const &ray, RaycastHit &hit, float maxDist = FLT_MAX) {
+                bool result = 0;
+                hit = RaycastHit();
+
+                queryAt(steps, [&]() { result = raycast(ray, hit, maxDist); });
+                return result;
+            };
+
+
+            // * ============================
+            // * Queries
+            // * ============================
+
+            /**
+             * @brief Find the closest body hit by a ray.
+             * ? Bodies containing the ray's origin are ignored.
+             *
+             * @param ray The ray. Its direction must be normalized.
+             * @param hit Set to the closest hit. hit.dist is -1 if nothing was hit.
+             * @param maxDist Hits further than this along the ray are ignored.
+             * @return (bool) 1 if a body was hit and 0 otherwise.
+             */
+            bool raycast(Ray3D const &ray, RaycastHit &hit, float maxDist = FLT_MAX) {
+                refreshTrees();
+                hit = RaycastHit();
+
+                // ? Each tree is traversed front-to-back and only visits bodies which could be closer than the current hit.
+                staticTree.raycast(ray, maxDist, [&](int i, float closest) {
+                    StaticBody3D* sb = sbs.staticBodies[i];
+                    float dist;
+                    ZMath::Vec3D normal;
+
+                    if (Zeta::raycast(sb->colliderType, sb->collider, ray, dist, normal) && dist <= closest) {
+                        hit.sb = sb;
+                        hit.normal = normal;
+                        hit.dist = dist;
+                        return dist;
+                    }
+
+                    return closest;
+                });
+
+                rigidTree.raycast(ray, hit.dist < 0.0f ? maxDist : hit.dist, [&](int i, float closest) {
+                    RigidBody3D* rb = rbs.rigidBodies[i];
+                    float dist;
+                    ZMath::Vec3D normal;
+
+                    if (Zeta::raycast(rb->colliderType, rb->collider, ray, dist, normal) && dist <= closest) {
+                        hit.rb = rb;
+                        hit.sb = nullptr;
+                        hit.normal = normal;
+                        hit.dist = dist;
+                        return dist;
+                    }
+
+                    return closest;
+                });
+
+                if (hit.dist < 0.0f) { return 0; }
+
+                hit.point = ray.origin + ray.dir*hit.dist;
+                return 1;
+            };
+
+            /**
+             * @brief Find the bodies hit by a ray, sorted from closest to furthest.
+             * ? If there are more hits than fit in the buffer, only the closest ones are kept.
+             *
+             * @param ray The ray. Its direction must be normalized.
+             * @param hits Buffer to store the hits in.
+             * @param capacity The number of hits the buffer can hold.
+             * @param maxDist Hits further than this along the ray are ignored.
+             * @return (int) The number of hits stored.
+             */
+            int raycastAll(Ray3D const &ray, RaycastHit* hits, int capacity, float maxDist = FLT_MAX) {
+                if (capacity <= 0) { return 0; }
+
+                refreshTrees();
+                int count = 0;
+
+                // Insert a hit in sorted order. Once the buffer is full, anything past the furthest stored hit can be skipped.
+                auto addHit = [&](RigidBody3D* rb, StaticBody3D* sb, float dist, ZMath::Vec3D const &normal) {
+                    if (count == capacity && dist >= hits[count - 1].dist) { return; }
+
+                    int i = count < capacity ? count++ : count - 1;
+                    for (; i > 0 && hits[i - 1].dist > dist; --i) { hits[i] = hits[i - 1]; }
+
+                    hits[i].rb = rb;
+                    hits[i].sb = sb;
+                    hits[i].point = ray.origin + ray.dir*dist;
+                    hits[i].normal = normal;
+                    hits[i].dist = dist;
+                };
+
+                staticTree.raycast(ray, maxDist, [&](int i, float furthest) {
+                    StaticBody3D* sb = sbs.staticBodies[i];
+                    float dist;
+                    ZMath::Vec3D normal;
+
+                    if (Zeta::raycast(sb->colliderType, sb->collider, ray, dist, normal) && dist <= furthest) {
+                        addHit(nullptr, sb, dist, normal);
+                    }
+
+                    return count == capacity ? hits[count - 1].dist : furthest;
+                });
+
+                rigidTree.raycast(ray, count == capacity ? hits[count - 1].dist : maxDist, [&](int i, float furthest) {
+                    RigidBody3D* rb = rbs.rigidBodies[i];
+                    float dist;
+                    ZMath::Vec3D normal;
+
+                    if (Zeta::raycast(rb->colliderType, rb->collider, ray, dist, normal) && dist <= furthest) {
+                        addHit(rb, nullptr, dist, normal);
+                    }
+
+                    return count == capacity ? hits[count - 1].dist : furthest;
+                });
+
+                return count;
+            };
+
+            /**
+             * @brief Sweep a sphere through the world and find the first body it hits.
+             * ? Bodies the sphere starts out touching are only hit (at a distance of 0) if it is moving into them.
+             *
+             * @param sphere The sphere at the start of the sweep.
+             * @param dir The direction of the sweep. This must be normalized.
+             * @param maxDist The distance to sweep the sphere.
+             * @param hit Set to the first hit. hit.dist is -1 if nothing was hit.
+             * @param ignore Rigid body to ignore, such as the body the sphere belongs to.
+             * @return (bool) 1 if a body was hit and 0 otherwise.
+             */
+            bool sweep(Sphere const &sphere, ZMath::Vec3D const &dir, float maxDist, SweepHit &hit, RigidBody3D const* ignore = nullptr) {
+                return sweepShape(sphere, RIGID_SPHERE_COLLIDER, dir, maxDist, hit, ignore);
+            };
+
+            // Sweep an AABB through the world and find the first body it hits. See sweep(Sphere) for details.
+            bool sweep(AABB const &aabb, ZMath::Vec3D const &dir, float maxDist, SweepHit &hit, RigidBody3D const* ignore = nullptr) {
+                return sweepShape(aabb, RIGID_AABB_COLLIDER, dir, maxDist, hit, ignore);
+            };
+
+            // Sweep a cube through the world and find the first body it hits. See sweep(Sphere) for details.
+            bool sweep(Cube const &cube, ZMath::Vec3D const &dir, float maxDist, SweepHit &hit, RigidBody3D const* ignore = nullptr) {
+                return sweepShape(cube, RIGID_CUBE_COLLIDER, dir, maxDist, hit, ignore);
+            };
+
+            // Sweep a capsule through the world and find the first body it hits. See sweep(Sphere) for details.
+            bool sweep(Capsule const &capsule, ZMath::Vec3D const &dir, float maxDist, SweepHit &hit, RigidBody3D const* ignore = nullptr) {
+                return sweepShape(capsule, RIGID_CAPSULE_COLLIDER, dir, maxDist, hit, ignore);
+            };
+
+            /**
+             * @brief Visit the bodies intersecting an AABB.
+             *
+             * @param aabb The AABB.
+             * @param visit Callable with the signature bool(RigidBody3D* rb, StaticBody3D* sb) called for each body found.
+             *               One of rb and sb is nullptr. Return 0 to stop the query.
+             * @return (bool) 0 if the query was stopped by the visitor and 1 otherwise.
+             */
+            template <typename Visitor>
+            bool queryAABB(AABB const &aabb, Visitor &&visit) {
+                ZMath::Vec3D min = aabb.getMin(), max = aabb.getMax();
+
+                return queryBodies([&](ZMath::Vec3D const &lo, ZMath::Vec3D const &hi) {
+                    return lo.x <= max.x && hi.x >= min.x && lo.y <= max.y && hi.y >= min.y && lo.z <= max.z && hi.z >= min.z;
+                }, [&](auto type, void const* collider) { return overlaps(aabb, type, collider); }, visit);
+            };
+
+            // Find the bodies intersecting an AABB. Returns the number stored in hits, stopping once capacity are found.
+            int queryAABB(AABB const &aabb, QueryHit* hits, int capacity) {
+                return collectHits([&](auto &&visit) { return queryAABB(aabb, visit); }, hits, capacity);
+            };
+
+            /**
+             * @brief Visit the bodies intersecting a sphere, such as the bodies within a radius of a point.
+             *
+             * @param sphere The sphere.
+             * @param visit Callable with the signature bool(RigidBody3D* rb, StaticBody3D* sb) called for each body found.
+             *               One of rb and sb is nullptr. Return 0 to stop the query.
+             * @return (bool) 0 if the query was stopped by the visitor and 1 otherwise.
+             */
+            template <typename Visitor>
+            bool querySphere(Sphere const &sphere, Visitor &&visit) {
+                return queryBodies([&](ZMath::Vec3D const &lo, ZMath::Vec3D const &hi) {
+                    return sphere.c.distSq(ZMath::clamp(sphere.c, lo, hi)) <= sphere.r*sphere.r;
+                }, [&](auto type, void const* collider) { return overlaps(sphere, type, collider); }, visit);
+            };
+
+            // Find the bodies intersecting a sphere. Returns the number stored in hits, stopping once capacity are found.
+            int querySphere(Sphere const &sphere, QueryHit* hits, int capacity) {
+                return collectHits([&](auto &&visit) { return querySphere(sphere, visit); }, hits, capacity);
+            };
+
+            /**
+             * @brief Visit the bodies whose bounds intersect a frustum.
+             * ? Only the bounds of the bodies are tested, so this may include bodies just outside of the frustum.
+             *
+             * @param frustum The frustum.
+             * @param visit Callable with the signature bool(RigidBody3D* rb, StaticBody3D* sb) called for each body found.
+             *               One of rb and sb is nullptr. Return 0 to stop the query.
+             * @return (bool) 0 if the query was stopped by the visitor and 1 otherwise.
+             */
+            template <typename Visitor>
+            bool queryFrustum(Frustum const &frustum, Visitor &&visit) {
+                return queryBodies([&](ZMath::Vec3D const &lo, ZMath::Vec3D const &hi) {
+                    return FrustumAndAABB(frustum, AABB(lo, hi));
+                }, [](auto, void const*) { return 1; }, visit);
+            };
+
+            // Find the bodies whose bounds intersect a frustum. Returns the number stored in hits, stopping once capacity are found.
+            int queryFrustum(Frustum const &frustum, QueryHit* hits, int capacity) {
+                return collectHits([&](auto &&visit) { return queryFrustum(frustum, visit); }, hits, capacity);
+            };
+
+            /**
+             * @brief Find the bodies nearest to a point, sorted from nearest to furthest.
+             * ? Bodies are measured by the distance from the point to the bounds of their colliders, so bodies containing the point are at 0.
+             *
+             * @param point The point.
+             * @param k The max number of bodies to find.
+             * @param hits Buffer of at least k hits to store the bodies in. hits[i].dist is set to the distance to each body.
+             * @param maxDist Bodies further than this from the point are ignored.
+             * @return (int) The number of bodies stored.
+             */
+            int queryKNearest(ZMath::Vec3D const &point, int k, QueryHit* hits, float maxDist = FLT_MAX) {
+                if (k <= 0) { return 0; }
+
+                refreshTrees();
+                int count = 0;
+
+                // Insert a body in sorted order. Once the buffer is full, anything past the furthest stored body can be skipped.
+                auto visit = [&](RigidBody3D* rb, StaticBody3D* sb, float distSq, float furthest) {
+                    float dist = sqrtf(distSq);
+
+                    if (count < k || dist < hits[count - 1].dist) {
+                        int i = count < k ? count++ : count - 1;
+                        for (; i > 0 && hits[i - 1].dist > dist; --i) { hits[i] = hits[i - 1]; }
+
+                        hits[i].rb = rb;
+                        hits[i].sb = sb;
+                        hits[i].dist = dist;
+                    }
+
+                    return count == k ? hits[count - 1].dist : furthest;
+                };
+
+                staticTree.nearest(point, maxDist, [&](int i, float distSq, float furthest) {
+                    return visit(nullptr, sbs.staticBodies[i], distSq, furthest);
+                });
+
+                rigidTree.nearest(point, count == k ? hits[count - 1].dist : maxDist, [&](int i, float, float furthest) {
+                    RigidBody3D* rb = rbs.rigidBodies[i];
+                    ZMath::Vec3D min, max;
+
+                    // ? The bounds in rigidTree are fattened so the distance is measured to the body's own bounds instead.
+                    if (!getBounds(rb->colliderType, rb->collider, min, max)) { return furthest; }
+
+                    float distSq = point.distSq(ZMath::clamp(point, min, max));
+                    return distSq > furthest*furthest ? furthest : visit(rb, nullptr, distSq, furthest);
+                });
+
+                return count;
+            };
+
+            /**
+             * @brief Find the closest body hit by each ray in a batch.
+             * ? Consecutive rays are traced together in packets of RAY_PACKET_SIZE, so ordering coherent rays next to each other
+             * ?  (ex: neighboring rays of a fan) is much faster. The broadphase trees are only refreshed once for the whole batch.
+             *
+             * @param rays The rays. Their directions must be normalized.
+             * @param numRays The number of rays.
+             * @param hits Buffer of at least numRays hits. hits[i] is set to the closest hit of rays[i] (dist is -1 for a miss).
+             * @param maxDist Hits further than this along the rays are ignored.
+             * @return (int) The number of rays which hit something.
+             */
+            int raycastBatch(Ray3D const* rays, int numRays, RaycastHit* hits, float maxDist = FLT_MAX) {
+                refreshTrees();
+                int count = 0;
+
+                alignas(4*RAY_PACKET_SIZE) float closest[RAY_PACKET_SIZE], dist[RAY_PACKET_SIZE];
+                ZMath::Vec3D normal[RAY_PACKET_SIZE];
+
+                for (int p = 0; p < numRays; p += RAY_PACKET_SIZE) {
+                    RayPacket packet(rays + p, numRays - p);
+                    RaycastHit* packetHits = hits + p;
+
+                    for (int i = 0; i < packet.count; ++i) {
+                        packetHits[i] = RaycastHit();
+                        closest[i] = maxDist;
+                    }
+
+                    for (int i = packet.count; i < RAY_PACKET_SIZE; ++i) { closest[i] = -1.0f; }
+
+                    staticTree.raycast(packet, closest, [&](int item, int mask) {
+                        StaticBody3D* sb = sbs.staticBodies[item];
+                        int hit = Zeta::raycast(sb->colliderType, sb->collider, packet, mask, dist, normal);
+
+                        for (int i = 0; hit; ++i, hit >>= 1) {
+                            if (!(hit & 1) || dist[i] > closest[i]) { continue; }
+
+                            packetHits[i].sb = sb;
+                            packetHits[i].normal = normal[i];
+                            packetHits[i].dist = closest[i] = dist[i];
+                        }
+                    });
+
+                    rigidTree.raycast(packet, closest, [&](int item, int mask) {
+                        RigidBody3D* rb = rbs.rigidBodies[item];
+                        int hit = Zeta::raycast(rb->colliderType, rb->collider, packet, mask, dist, normal);
+
+                        for (int i = 0; hit; ++i, hit >>= 1) {
+                            if (!(hit & 1) || dist[i] > closest[i]) { continue; }
+
+                            packetHits[i].rb = rb;
+                            packetHits[i].sb = nullptr;
+                            packetHits[i].normal = normal[i];
+                            packetHits[i].dist = closest[i] = dist[i];
+                        }
+                    });
+
+                    for (int i = 0; i < packet.count; ++i) {
+                        if (packetHits[i].dist < 0.0f) { continue; }
+
+                        packetHits[i].point = rays[p + i].origin + rays[p + i].dir*packetHits[i].dist;
+                        ++count;
+                    }
+                }
+
                 return count;
             };
     };
 }
 
 #else
+
 // physics handler using spatial partitioning
 
 namespace Zeta {
@@ -544,7 +2420,7 @@ namespace Zeta {
             // * ==============================
 
             inline void grow() {
-                capacity << 1;
+                capacity <<= 1;
                 Body* temp = new Body[capacity];
 
                 for (uint32_t i = 0; i < count; ++i) { temp[i] = std::move(bodies[i]); }
@@ -610,12 +2486,12 @@ namespace Zeta {
             };
 
             // Do not allow for construction from an existing physics handler.
-            Handler(Handler const &handler) { throw std::runtime_error("PhysicsHandler object CANNOT be constructed from another PhysicsHandler."); };
-            Handler(Handler&& handler) { throw std::runtime_error("PhysicsHandler object CANNOT be constructed from another PhysicsHandler."); };
+            Handler(Handler const &) { throw std::runtime_error("PhysicsHandler object CANNOT be constructed from another PhysicsHandler."); };
+            Handler(Handler&&) { throw std::runtime_error("PhysicsHandler object CANNOT be constructed from another PhysicsHandler."); };
 
             // The physics handler cannot be reassigned.
-            Handler& operator = (Handler const &handler) { throw std::runtime_error("PhysicsHandler object CANNOT be reassigned to another PhysicsHandler."); };
-            Handler& operator = (Handler&& handler) { throw std::runtime_error("PhysicsHandler object CANNOT be reassigned to another PhysicsHandler."); };
+            Handler& operator = (Handler const &) { throw std::runtime_error("PhysicsHandler object CANNOT be reassigned to another PhysicsHandler."); };
+            Handler& operator = (Handler&&) { throw std::runtime_error("PhysicsHandler object CANNOT be reassigned to another PhysicsHandler."); };
 
             // Note: The destructor does NOT delete the actual bodies inside of the array.
             // This is in case you need to use the bodies after the handler is out of scope.
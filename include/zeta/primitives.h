@@ -1,9 +1,16 @@
 #pragma once
 
+#include <cstdint>
+#include <cstring>
 #include "zmath.h"
 
 // todo ask josh about some move semantics stuff
 
+// Number of rays in a RayPacket. Define this as 8 before including the engine when targeting AVX.
+#ifndef RAY_PACKET_SIZE
+#define RAY_PACKET_SIZE 4
+#endif
+
 namespace Zeta {
     class Ray3D {
         public:
@@ -17,6 +24,41 @@ namespace Zeta {
             Ray3D(ZMath::Vec3D const &origin, ZMath::Vec3D const &direction) : origin(origin), dir(direction) {};
     };
 
+    // A group of rays stored as a structure of arrays so they can be tested together with SIMD instructions.
+    // ? Packets are only faster when the rays are coherent (similar origins and directions), such as a fan of sensor rays.
+    class RayPacket {
+        public:
+            alignas(4*RAY_PACKET_SIZE) float ox[RAY_PACKET_SIZE], oy[RAY_PACKET_SIZE], oz[RAY_PACKET_SIZE]; // origins
+            alignas(4*RAY_PACKET_SIZE) float dx[RAY_PACKET_SIZE], dy[RAY_PACKET_SIZE], dz[RAY_PACKET_SIZE]; // normalized directions
+            alignas(4*RAY_PACKET_SIZE) float ix[RAY_PACKET_SIZE], iy[RAY_PACKET_SIZE], iz[RAY_PACKET_SIZE]; // inverse directions
+            int count = 0; // number of lanes in use
+
+            RayPacket() {};
+
+            // @brief Pack up to RAY_PACKET_SIZE rays.
+            //
+            // @param rays The rays.
+            // @param n The number of rays. Only the first RAY_PACKET_SIZE are used.
+            RayPacket(Ray3D const* rays, int n) {
+                count = n < RAY_PACKET_SIZE ? n : RAY_PACKET_SIZE;
+
+                // ? Unused lanes repeat the first ray so they never produce NaNs. They are excluded by getMask().
+                for (int i = 0; i < RAY_PACKET_SIZE; ++i) {
+                    Ray3D const &ray = rays[i < count ? i : 0];
+
+                    ox[i] = ray.origin.x; oy[i] = ray.origin.y; oz[i] = ray.origin.z;
+                    dx[i] = ray.dir.x; dy[i] = ray.dir.y; dz[i] = ray.dir.z;
+                    ix[i] = 1.0f/dx[i]; iy[i] = 1.0f/dy[i]; iz[i] = 1.0f/dz[i];
+                }
+            };
+
+            // Bitmask of the lanes in use.
+            inline int getMask() const { return (1 << count) - 1; };
+
+            // Get the ray in a lane.
+            inline Ray3D getRay(int i) const { return Ray3D(ZMath::Vec3D(ox[i], oy[i], oz[i]), ZMath::Vec3D(dx[i], dy[i], dz[i])); };
+    };
+
     class Line3D {
         public:
             ZMath::Vec3D start, end;
@@ -190,11 +232,14 @@ namespace Zeta {
             // Get half the distance between the cube's min and max vertices.
             inline ZMath::Vec3D getHalfSize() const { return halfSize; };
 
+            // Regenerate the cached rotation matrix. Call this after changing theta or phi.
+            inline void updateRotation() { rot = ZMath::Mat3D::generateRotationMatrix(theta, phi); };
+
             // Get the vertices of the cube in terms of global coordinates.
+            // This uses the cached rotation matrix, so call updateRotation first if theta or phi changed.
             // Remeber to use delete[] on the variable you assign this after use to free the memory.
-            ZMath::Vec3D* getVertices() {
+            ZMath::Vec3D* getVertices() const {
                 ZMath::Vec3D* v = new ZMath::Vec3D[8];
-                this->rot = ZMath::Mat3D::generateRotationMatrix(this->theta, this->phi);
 
                 // todo reorder to match OpenGL bindings
                 v[0] = -halfSize;
@@ -207,12 +252,43 @@ namespace Zeta {
                 v[7] = halfSize;
 
                 // Rotate the vertices.
-                for (int i = 0; i < 8; i++) { v[i] = rot*v[i] + pos; }
+                ZMath::transform(rot, v, v, 8, pos);
 
                 return v;
             }; 
     };
-    
+
+    // Models a line segment swept by a sphere.
+    // Capsules are cheaper to collide than cubes and roll smoothly, making them ideal for characters and limbs.
+    class Capsule {
+        private:
+            ZMath::Vec3D halfSegment; // Vector from the center of the capsule to the end of its segment.
+
+        public:
+            ZMath::Vec3D pos; // Centerpoint of the capsule's segment.
+            float r; // radius
+
+            // @brief Create a capsule from the segment at its core and a radius.
+            //
+            // @param start (Vec3D) Starting point of the segment.
+            // @param end (Vec3D) Ending point of the segment.
+            // @param rho (float) Radius of the capsule.
+            Capsule(ZMath::Vec3D const &start, ZMath::Vec3D const &end, float rho) : halfSegment((end - start) * 0.5f), pos((start + end) * 0.5f), r(rho) {};
+
+            inline ZMath::Vec3D getStart() const { return pos - halfSegment; };
+            inline ZMath::Vec3D getEnd() const { return pos + halfSegment; };
+            inline ZMath::Vec3D getHalfSegment() const { return halfSegment; };
+
+            // Set the vector from the center of the capsule to the end of its segment. Used to rotate the capsule.
+            inline void setHalfSegment(ZMath::Vec3D const &h) { halfSegment = h; };
+
+            // A vector with the lowest value of x, y, and z the capsule reaches.
+            inline ZMath::Vec3D getMin() const { return pos - ZMath::abs(halfSegment) - r; };
+
+            // A vector with the greatest value of x, y, and z the capsule reaches.
+            inline ZMath::Vec3D getMax() const { return pos + ZMath::abs(halfSegment) + r; };
+    };
+
     class TriangularPyramid {
         private: 
             // Constants that help with calculating vertices
@@ -233,7 +309,7 @@ namespace Zeta {
             // @param sideLen side length; all side lengths are equal
             // @param angleXY angle with respect to the XY plane
             // @param angleXZ angle with respect to the XZ plane
-            TriangularPyramid(ZMath::Vec3D const &center, float sideLen, float angleXY = 0.0f, float angleXZ = 0.0f): theta(angleXY), phi(angleXZ), sideLength(sideLen) {
+            TriangularPyramid(ZMath::Vec3D const &center, float sideLen, float angleXY = 0.0f, float angleXZ = 0.0f): sideLength(sideLen), theta(angleXY), phi(angleXZ) {
                 this->pos = center;
                 this->distance = c1 * sideLen;
                 this->rot = ZMath::Mat3D::generateRotationMatrix(angleXY, angleXZ);
@@ -253,4 +329,424 @@ namespace Zeta {
                 return v;
             };
     };
+
+    // Formats a Heightfield can store its samples in.
+    enum HeightfieldFormat {
+        HEIGHTFIELD_UINT16, // 2 bytes per sample. A sample's height is sample * heightScale.
+        HEIGHTFIELD_FLOAT   // 4 bytes per sample. A sample's height is the sample itself.
+    };
+
+    // Models static terrain as a regular grid of heights over the XY plane.
+    // Only the heights are stored (2-4 bytes per sample) so any point can be mapped to its cell in O(1) without a mesh hierarchy.
+    // Each cell is split into two triangles along the diagonal from its min corner to its max corner.
+    // The samples are split into square tiles which can be streamed in and out independently.
+    // Cells inside of tiles that are not loaded are treated as empty space.
+    // Heightfields should only be used as colliders for static bodies.
+    class Heightfield {
+        private:
+            // Sample data for each tile or nullptr if the tile is not loaded.
+            // Each tile stores (tileCells + 1)^2 samples in row major order so cells on the border of a tile never need their neighbor.
+            uint8_t** tiles;
+
+            // Min and max heights (in global coordinates) of each loaded tile. Used to cull queries before touching the samples.
+            float* tileMinZ;
+            float* tileMaxZ;
+
+            inline uint32_t sampleSize() const { return format == HEIGHTFIELD_UINT16 ? sizeof(uint16_t) : sizeof(float); };
+
+            // Read the height of a sample relative to pos.z from a tile.
+            inline float readSample(uint8_t const* tile, uint32_t index) const {
+                if (format == HEIGHTFIELD_UINT16) { return ((uint16_t const*) tile)[index] * heightScale; }
+                return ((float const*) tile)[index];
+            };
+
+            // Allocate the tile lists and copy the sample data from another heightfield.
+            inline void copyTiles(Heightfield const &hf) {
+                uint32_t numTiles = tilesX * tilesY, bytes = getTileSamples() * sampleSize();
+
+                tiles = new uint8_t*[numTiles];
+                tileMinZ = new float[numTiles];
+                tileMaxZ = new float[numTiles];
+
+                for (uint32_t i = 0; i < numTiles; ++i) {
+                    tileMinZ[i] = hf.tileMinZ[i];
+                    tileMaxZ[i] = hf.tileMaxZ[i];
+
+                    if (hf.tiles[i]) {
+                        tiles[i] = new uint8_t[bytes];
+                        memcpy(tiles[i], hf.tiles[i], bytes);
+
+                    } else { tiles[i] = nullptr; }
+                }
+            };
+
+            inline void freeTiles() {
+                if (!tiles) { return; }
+
+                for (uint32_t i = 0; i < tilesX * tilesY; ++i) { delete[] tiles[i]; }
+
+                delete[] tiles;
+                delete[] tileMinZ;
+                delete[] tileMaxZ;
+            };
+
+        public:
+            ZMath::Vec3D pos; // Min corner of the heightfield. Heights are measured upwards from pos.z.
+            float cellSize; // Side length of a cell.
+            float heightScale; // Height of a single unit for HEIGHTFIELD_UINT16 samples. Unused by HEIGHTFIELD_FLOAT.
+
+            uint32_t cellsX, cellsY; // Number of cells along the x and y axes.
+            uint32_t tileCells; // Number of cells along the side of a tile.
+            uint32_t tilesX, tilesY; // Number of tiles along the x and y axes.
+
+            HeightfieldFormat format;
+
+            /**
+             * @brief Create a heightfield with no tiles loaded.
+             *
+             * @param min The min corner of the heightfield. The grid extends along +x and +y and heights are measured from min.z.
+             * @param cellsX The number of cells along the x axis.
+             * @param cellsY The number of cells along the y axis.
+             * @param cellSize The side length of a cell.
+             * @param tileCells The number of cells along the side of a streaming tile. Default of 64.
+             * @param format The format the samples are stored in. Default of HEIGHTFIELD_UINT16.
+             * @param heightScale The height of one unit for HEIGHTFIELD_UINT16 samples. Default of 0.01.
+             */
+            Heightfield(ZMath::Vec3D const &min, uint32_t cellsX, uint32_t cellsY, float cellSize, uint32_t tileCells = 64,
+                        HeightfieldFormat format = HEIGHTFIELD_UINT16, float heightScale = 0.01f)
+                    : pos(min), cellSize(cellSize), heightScale(heightScale), cellsX(cellsX), cellsY(cellsY),
+                      tileCells(tileCells), format(format)
+            {
+                tilesX = (cellsX + tileCells - 1)/tileCells;
+                tilesY = (cellsY + tileCells - 1)/tileCells;
+
+                uint32_t numTiles = tilesX * tilesY;
+                tiles = new uint8_t*[numTiles];
+                tileMinZ = new float[numTiles];
+                tileMaxZ = new float[numTiles];
+
+                for (uint32_t i = 0; i < numTiles; ++i) {
+                    tiles[i] = nullptr;
+                    tileMinZ[i] = min.z;
+                    tileMaxZ[i] = min.z;
+                }
+            };
+
+
+            // * ===================
+            // * Rule of 5 Stuff
+            // * ===================
+
+            Heightfield(Heightfield const &hf) : pos(hf.pos), cellSize(hf.cellSize), heightScale(hf.heightScale), cellsX(hf.cellsX),
+                    cellsY(hf.cellsY), tileCells(hf.tileCells), tilesX(hf.tilesX), tilesY(hf.tilesY), format(hf.format) { copyTiles(hf); };
+
+            Heightfield(Heightfield &&hf) : pos(hf.pos), cellSize(hf.cellSize), heightScale(hf.heightScale), cellsX(hf.cellsX),
+                    cellsY(hf.cellsY), tileCells(hf.tileCells), tilesX(hf.tilesX), tilesY(hf.tilesY), format(hf.format)
+            {
+                tiles = hf.tiles;
+                tileMinZ = hf.tileMinZ;
+                tileMaxZ = hf.tileMaxZ;
+                hf.tiles = nullptr;
+            };
+
+            Heightfield& operator = (Heightfield const &hf) {
+                if (this != &hf) {
+                    freeTiles();
+
+                    pos = hf.pos;
+                    cellSize = hf.cellSize;
+                    heightScale = hf.heightScale;
+                    cellsX = hf.cellsX;
+                    cellsY = hf.cellsY;
+                    tileCells = hf.tileCells;
+                    tilesX = hf.tilesX;
+                    tilesY = hf.tilesY;
+                    format = hf.format;
+
+                    copyTiles(hf);
+                }
+
+                return *this;
+            };
+
+            Heightfield& operator = (Heightfield &&hf) {
+                if (this != &hf) {
+                    freeTiles();
+
+                    pos = hf.pos;
+                    cellSize = hf.cellSize;
+                    heightScale = hf.heightScale;
+                    cellsX = hf.cellsX;
+                    cellsY = hf.cellsY;
+                    tileCells = hf.tileCells;
+                    tilesX = hf.tilesX;
+                    tilesY = hf.tilesY;
+                    format = hf.format;
+
+                    tiles = hf.tiles;
+                    tileMinZ = hf.tileMinZ;
+                    tileMaxZ = hf.tileMaxZ;
+                    hf.tiles = nullptr;
+                }
+
+                return *this;
+            };
+
+            ~Heightfield() { freeTiles(); };
+
+
+            // * ======================
+            // * Tile Streaming
+            // * ======================
+
+            // Number of samples stored by each tile.
+            inline uint32_t getTileSamples() const { return (tileCells + 1) * (tileCells + 1); };
+
+            /**
+             * @brief Load (or reload) the samples of a tile.
+             *
+             * @param tx The x index of the tile.
+             * @param ty The y index of the tile.
+             * @param samples (tileCells + 1)^2 samples in row major order (x varies fastest) matching the heightfield's format.
+             *                  The samples are copied so the memory can be reused by the caller afterwards.
+             */
+            void loadTile(uint32_t tx, uint32_t ty, void const* samples) {
+                uint32_t t = ty * tilesX + tx, n = getTileSamples();
+
+                if (!tiles[t]) { tiles[t] = new uint8_t[n * sampleSize()]; }
+                memcpy(tiles[t], samples, n * sampleSize());
+
+                // cache the bounds of the tile for culling
+                float minZ = readSample(tiles[t], 0), maxZ = minZ;
+
+                for (uint32_t i = 1; i < n; ++i) {
+                    float z = readSample(tiles[t], i);
+                    if (z < minZ) { minZ = z; }
+                    if (z > maxZ) { maxZ = z; }
+                }
+
+                tileMinZ[t] = pos.z + minZ;
+                tileMaxZ[t] = pos.z + maxZ;
+            };
+
+            // Free the samples of a tile. Anything over the tile will no longer collide with the heightfield.
+            void unloadTile(uint32_t tx, uint32_t ty) {
+                uint32_t t = ty * tilesX + tx;
+
+                delete[] tiles[t];
+                tiles[t] = nullptr;
+            };
+
+            inline bool isTileLoaded(uint32_t tx, uint32_t ty) const { return tiles[ty * tilesX + tx] != nullptr; };
+
+
+            // * ======================
+            // * Cell Lookup
+            // * ======================
+
+            // Get the min vertex of the heightfield's bounds. The z component is the lowest height of any loaded tile.
+            ZMath::Vec3D getMin() const {
+                float minZ = pos.z;
+                bool found = 0;
+
+                for (uint32_t i = 0; i < tilesX * tilesY; ++i) {
+                    if (tiles[i] && (!found || tileMinZ[i] < minZ)) { minZ = tileMinZ[i]; found = 1; }
+                }
+
+                return ZMath::Vec3D(pos.x, pos.y, minZ);
+            };
+
+            // Get the max vertex of the heightfield's bounds. The z component is the greatest height of any loaded tile.
+            ZMath::Vec3D getMax() const {
+                float maxZ = pos.z;
+                bool found = 0;
+
+                for (uint32_t i = 0; i < tilesX * tilesY; ++i) {
+                    if (tiles[i] && (!found || tileMaxZ[i] > maxZ)) { maxZ = tileMaxZ[i]; found = 1; }
+                }
+
+                return ZMath::Vec3D(pos.x + cellsX * cellSize, pos.y + cellsY * cellSize, maxZ);
+            };
+
+            /**
+             * @brief Determine the range of cells overlapped by a region on the XY plane.
+             *
+             * @param min The min vertex of the region. The z component is ignored.
+             * @param max The max vertex of the region. The z component is ignored.
+             * @param cx0 Set to the lowest overlapped cell on the x axis.
+             * @param cy0 Set to the lowest overlapped cell on the y axis.
+             * @param cx1 Set to the greatest overlapped cell on the x axis.
+             * @param cy1 Set to the greatest overlapped cell on the y axis.
+             * @return (bool) 1 if the region overlaps the heightfield and 0 otherwise.
+             */
+            bool getCellRange(ZMath::Vec3D const &min, ZMath::Vec3D const &max, uint32_t &cx0, uint32_t &cy0, uint32_t &cx1, uint32_t &cy1) const {
+                float invCell = 1.0f/cellSize;
+
+                float x0 = (min.x - pos.x) * invCell, y0 = (min.y - pos.y) * invCell;
+                float x1 = (max.x - pos.x) * invCell, y1 = (max.y - pos.y) * invCell;
+
+                if (x1 < 0.0f || y1 < 0.0f || x0 > (float) cellsX || y0 > (float) cellsY) { return 0; }
+
+                cx0 = x0 > 0.0f ? (uint32_t) x0 : 0;
+                cy0 = y0 > 0.0f ? (uint32_t) y0 : 0;
+                cx1 = x1 < (float) cellsX ? (uint32_t) x1 : cellsX - 1;
+                cy1 = y1 < (float) cellsY ? (uint32_t) y1 : cellsY - 1;
+
+                if (cx0 >= cellsX) { cx0 = cellsX - 1; }
+                if (cy0 >= cellsY) { cy0 = cellsY - 1; }
+
+                return 1;
+            };
+
+            // Get the greatest height of any loaded tile overlapping a range of cells.
+            // Returns 0 if none of the tiles are loaded.
+            bool getMaxHeight(uint32_t cx0, uint32_t cy0, uint32_t cx1, uint32_t cy1, float &maxZ) const {
+                bool found = 0;
+
+                for (uint32_t ty = cy0/tileCells; ty <= cy1/tileCells; ++ty) {
+                    for (uint32_t tx = cx0/tileCells; tx <= cx1/tileCells; ++tx) {
+                        uint32_t t = ty * tilesX + tx;
+                        if (tiles[t] && (!found || tileMaxZ[t] > maxZ)) { maxZ = tileMaxZ[t]; found = 1; }
+                    }
+                }
+
+                return found;
+            };
+
+            /**
+             * @brief Get a sample in global coordinates.
+             *
+             * @param sx The x index of the sample. This ranges from 0 to cellsX.
+             * @param sy The y index of the sample. This ranges from 0 to cellsY.
+             * @param p Set to the position of the sample.
+             * @return (bool) 1 if the sample's tile is loaded and 0 otherwise.
+             */
+            bool getSample(uint32_t sx, uint32_t sy, ZMath::Vec3D &p) const {
+                // samples on the far border of the last tile are only stored by that tile
+                uint32_t tx = sx/tileCells, ty = sy/tileCells;
+                if (tx == tilesX) { --tx; }
+                if (ty == tilesY) { --ty; }
+
+                uint8_t const* tile = tiles[ty * tilesX + tx];
+                if (!tile) { return 0; }
+
+                p.set(pos.x + sx * cellSize, pos.y + sy * cellSize, pos.z + readSample(tile, (sy - ty * tileCells) * (tileCells + 1) + sx - tx * tileCells));
+                return 1;
+            };
+
+            /**
+             * @brief Get the 4 corners of a cell in global coordinates.
+             * v[0] = (x, y), v[1] = (x + 1, y), v[2] = (x, y + 1), v[3] = (x + 1, y + 1).
+             * The cell's triangles are (v[0], v[1], v[3]) and (v[0], v[3], v[2]).
+             *
+             * @param cx The x index of the cell.
+             * @param cy The y index of the cell.
+             * @param v Array which gets filled with the corners of the cell.
+             * @return (bool) 1 if the cell's tile is loaded and 0 otherwise.
+             */
+            bool getCellVertices(uint32_t cx, uint32_t cy, ZMath::Vec3D v[4]) const {
+                uint32_t tx = cx/tileCells, ty = cy/tileCells;
+                uint8_t const* tile = tiles[ty * tilesX + tx];
+
+                if (!tile) { return 0; }
+
+                uint32_t row = tileCells + 1;
+                uint32_t i = (cy - ty * tileCells) * row + (cx - tx * tileCells);
+
+                float x = pos.x + cx * cellSize, y = pos.y + cy * cellSize;
+
+                v[0].set(x, y, pos.z + readSample(tile, i));
+                v[1].set(x + cellSize, y, pos.z + readSample(tile, i + 1));
+                v[2].set(x, y + cellSize, pos.z + readSample(tile, i + row));
+                v[3].set(x + cellSize, y + cellSize, pos.z + readSample(tile, i + row + 1));
+
+                return 1;
+            };
+
+            /**
+             * @brief Determine the height of the surface above or below a point.
+             *
+             * @param x The x coordinate of the point.
+             * @param y The y coordinate of the point.
+             * @param h Set to the height of the surface at (x, y).
+             * @param normal Set to the normal of the triangle containing (x, y). This is not normalized.
+             * @return (bool) 1 if (x, y) lies over a loaded tile and 0 otherwise.
+             */
+            bool getHeight(float x, float y, float &h, ZMath::Vec3D &normal) const {
+                float fx = (x - pos.x)/cellSize, fy = (y - pos.y)/cellSize;
+                if (fx < 0.0f || fy < 0.0f || fx > (float) cellsX || fy > (float) cellsY) { return 0; }
+
+                uint32_t cx = (uint32_t) fx, cy = (uint32_t) fy;
+                if (cx == cellsX) { --cx; }
+                if (cy == cellsY) { --cy; }
+
+                ZMath::Vec3D v[4];
+                if (!getCellVertices(cx, cy, v)) { return 0; }
+
+                // local coordinates within the cell
+                fx -= cx;
+                fy -= cy;
+
+                if (fx >= fy) { // triangle (v0, v1, v3)
+                    h = v[0].z + fx * (v[1].z - v[0].z) + fy * (v[3].z - v[1].z);
+                    normal.set((v[0].z - v[1].z) * cellSize, (v[1].z - v[3].z) * cellSize, cellSize * cellSize);
+
+                } else { // triangle (v0, v3, v2)
+                    h = v[0].z + fx * (v[3].z - v[2].z) + fy * (v[2].z - v[0].z);
+                    normal.set((v[2].z - v[3].z) * cellSize, (v[0].z - v[2].z) * cellSize, cellSize * cellSize);
+                }
+
+                return 1;
+            };
+    };
+
+    // Convex volume bounded by 6 planes, such as the view volume of a camera.
+    class Frustum {
+        public:
+            // Planes bounding the frustum. The normals face outwards so a point p is inside if normals[i] * p <= offsets[i] for every plane.
+            ZMath::Vec3D normals[6];
+            float offsets[6];
+
+            /**
+             * @brief Create a frustum from the planes bounding it.
+             * 
+             * @param normals The normals of the planes. These must be normalized and face outwards.
+             * @param offsets The distance of each plane from the origin along its normal.
+             */
+            Frustum(ZMath::Vec3D const normals[6], float const offsets[6]) {
+                for (int i = 0; i < 6; ++i) {
+                    this->normals[i] = normals[i];
+                    this->offsets[i] = offsets[i];
+                }
+            };
+
+            /**
+             * @brief Create the view frustum of a perspective camera.
+             * 
+             * @param pos The position of the camera.
+             * @param forward The direction the camera faces. This must be normalized.
+             * @param up The up direction of the camera. This must be normalized and perpendicular to forward.
+             * @param fov The vertical field of view in degrees.
+             * @param aspect The width of the view divided by its height.
+             * @param near The distance to the near plane.
+             * @param far The distance to the far plane.
+             */
+            Frustum(ZMath::Vec3D const &pos, ZMath::Vec3D const &forward, ZMath::Vec3D const &up, float fov, float aspect, float near, float far) {
+                ZMath::Vec3D right = forward.cross(up);
+
+                float v = tanf(ZMath::toRadians(fov) * 0.5f), h = v * aspect;
+
+                normals[0] = -forward;
+                normals[1] = forward;
+                normals[2] = up.cross(forward - right*h).normalize(); // left
+                normals[3] = (forward + right*h).cross(up).normalize(); // right
+                normals[4] = right.cross(forward + up*v).normalize(); // top
+                normals[5] = (forward - up*v).cross(right).normalize(); // bottom
+
+                for (int i = 2; i < 6; ++i) { offsets[i] = normals[i] * pos; }
+
+                offsets[0] = normals[0] * (pos + forward*near);
+                offsets[1] = normals[1] * (pos + forward*far);
+            };
+    };
 } // namespace Primitives
\ No newline at end of file
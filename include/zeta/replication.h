@@ -0,0 +1,478 @@
+// ? Compact stream of rigid body states for sending the simulation from a server to its clients.
+// ? Each value is quantized to a configurable number of bits:
+// ?  Positions are quantized within the world's bounds, given as a center and half size like the Octree's.
+// ?  Velocities and angular velocities are quantized within a max speed. Faster bodies are sent at the max speed.
+// ?  Orientations are sent as their three smallest components along with which component was dropped,
+// ?   as the dropped component can be found from the others since the quaternion is normalized.
+// ? Each frame is encoded against the last frame the client acknowledged. Bodies whose quantized state did not change since
+// ?  then cost a single bit, and the bodies which did only send the parts of their state which changed.
+// ? The encoder and decoder must use the same settings and bodies must be passed in the same order on both ends.
+
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include "bodies.h"
+
+namespace Zeta {
+    // * ===================================
+    // * Bit Packing
+    // * ===================================
+
+    // Writes values of any number of bits up to 32 into a byte buffer, starting from the lowest bit.
+    class BitWriter {
+        private:
+            uint8_t* data;
+            size_t capacity;
+            size_t bytes = 0; // bytes written, including any which did not fit
+            uint64_t buffer = 0; // bits not written yet
+            int bits = 0; // number of bits in buffer
+
+        public:
+            BitWriter(uint8_t* data, size_t capacity) : data(data), capacity(capacity) {};
+
+            // Write the lowest n bits of a value.
+            inline void write(uint32_t value, int n) {
+                buffer |= (uint64_t) (value & (uint32_t) ((1ull << n) - 1)) << bits;
+                bits += n;
+
+                while (bits >= 8) {
+                    if (bytes < capacity) { data[bytes] = (uint8_t) buffer; }
+
+                    ++bytes;
+                    buffer >>= 8;
+                    bits -= 8;
+                }
+            };
+
+            // Write any bits left over and get the number of bytes written. 0 if the buffer was too small.
+            size_t finish() {
+                if (bits) { write(0, 8 - bits); }
+                return bytes <= capacity ? bytes : 0;
+            };
+    };
+
+    // Reads values written by a BitWriter.
+    class BitReader {
+        private:
+            uint8_t const* data;
+            size_t size;
+            size_t bytes = 0; // bytes read
+            uint64_t buffer = 0; // bits not read yet
+            int bits = 0; // number of bits in buffer
+
+        public:
+            bool overrun = 0; // set if a read went past the end of the data. Those bits are read as 0.
+
+            BitReader(uint8_t const* data, size_t size) : data(data), size(size) {};
+
+            // Read a value of n bits.
+            inline uint32_t read(int n) {
+                while (bits < n) {
+                    if (bytes < size) { buffer |= (uint64_t) data[bytes++] << bits; }
+                    else { overrun = 1; }
+
+                    bits += 8;
+                }
+
+                uint32_t value = (uint32_t) (buffer & ((1ull << n) - 1));
+                buffer >>= n;
+                bits -= n;
+
+                return value;
+            };
+    };
+
+
+    // * ===================================
+    // * Quantization
+    // * ===================================
+
+    // Bit widths and ranges used to quantize the bodies. Each width must be between 1 and 24 bits.
+    // ? The largest error of a value within its range is half of a step, where a step is its range divided by 2^bits - 1.
+    typedef struct QuantizationSettings {
+        ZMath::Vec3D center; // center of the world's bounds
+        ZMath::Vec3D halfsize; // half of the size of the world's bounds along each axis
+        int posBits = 16; // bits per axis of the position
+
+        float maxSpeed = 32.0f; // largest speed along each axis, in m/s
+        int velBits = 10; // bits per axis of the velocity
+
+        int rotBits = 9; // bits per component of the orientation. The orientation takes 3 times this plus 2 bits.
+
+        float maxAngSpeed = 16.0f; // largest angular speed about each axis, in radians per second
+        int angVelBits = 8; // bits per axis of the angular velocity
+    } QuantizationSettings;
+
+    // Quantized state of a body.
+    typedef struct QuantizedBody {
+        uint32_t pos[3];
+        uint32_t vel[3];
+        uint32_t rot[3]; // the three smallest components of the orientation
+        uint32_t largest; // index of the component of the orientation left out
+        uint32_t angVel[3];
+    } QuantizedBody;
+
+    // State of a body read from a replication stream.
+    typedef struct ReplicatedBody {
+        ZMath::Vec3D pos;
+        ZMath::Vec3D vel;
+        ZMath::Quaternion orientation;
+        ZMath::Vec3D angVel;
+    } ReplicatedBody;
+
+    // ? Each quaternion component other than the largest is at most 1/sqrt(2) in magnitude.
+    static const float QUAT_COMPONENT_RANGE = 0.70710678f;
+
+    // Quantize a value within [min, max] to an integer of the given number of bits. Values outside of the range are clamped.
+    inline static uint32_t quantize(float value, float min, float max, int bits) {
+        uint32_t steps = (uint32_t) ((1ull << bits) - 1);
+        float t = (value - min)/(max - min);
+
+        // ? This is written so NaNs are clamped as well.
+        if (!(t > 0.0f)) { return 0; }
+        if (t >= 1.0f) { return steps; }
+
+        return (uint32_t) (t * steps + 0.5f);
+    };
+
+    inline static float dequantize(uint32_t value, float min, float max, int bits) {
+        return min + (max - min) * ((float) value/(float) ((1ull << bits) - 1));
+    };
+
+    // Get the largest error of a quantized value within its range.
+    inline static float getQuantizationError(float min, float max, int bits) { return 0.5f * (max - min)/(float) ((1ull << bits) - 1); };
+
+    // Get the largest error along each axis of a quantized position within the world's bounds.
+    inline static ZMath::Vec3D getPositionError(QuantizationSettings const &settings) {
+        return ZMath::Vec3D(getQuantizationError(-settings.halfsize.x, settings.halfsize.x, settings.posBits),
+                            getQuantizationError(-settings.halfsize.y, settings.halfsize.y, settings.posBits),
+                            getQuantizationError(-settings.halfsize.z, settings.halfsize.z, settings.posBits));
+    };
+
+    // Get the largest error along each axis of a quantized velocity up to the max speed.
+    inline static float getVelocityError(QuantizationSettings const &settings) {
+        return getQuantizationError(-settings.maxSpeed, settings.maxSpeed, settings.velBits);
+    };
+
+    // Get the largest error of each component of a quantized orientation.
+    // ? The component left out is found from the others, so its error can be a few times larger.
+    inline static float getOrientationError(QuantizationSettings const &settings) {
+        return getQuantizationError(-QUAT_COMPONENT_RANGE, QUAT_COMPONENT_RANGE, settings.rotBits);
+    };
+
+    // Get the largest error about each axis of a quantized angular velocity up to the max angular speed.
+    inline static float getAngularVelocityError(QuantizationSettings const &settings) {
+        return getQuantizationError(-settings.maxAngSpeed, settings.maxAngSpeed, settings.angVelBits);
+    };
+
+    inline static void quantizeBody(QuantizationSettings const &settings, RigidBody3D const* rb, QuantizedBody &q) {
+        ZMath::Vec3D p = rb->pos - settings.center;
+
+        for (int i = 0; i < 3; ++i) {
+            float h = (&settings.halfsize.x)[i];
+
+            q.pos[i] = quantize((&p.x)[i], -h, h, settings.posBits);
+            q.vel[i] = quantize((&rb->vel.x)[i], -settings.maxSpeed, settings.maxSpeed, settings.velBits);
+            q.angVel[i] = quantize((&rb->angVel.x)[i], -settings.maxAngSpeed, settings.maxAngSpeed, settings.angVelBits);
+        }
+
+        // * Leave out the largest component of the orientation, flipping it so the component left out is positive.
+
+        float c[4] = {rb->orientation.w, rb->orientation.x, rb->orientation.y, rb->orientation.z};
+        q.largest = 0;
+
+        for (uint32_t i = 1; i < 4; ++i) {
+            if (std::fabs(c[i]) > std::fabs(c[q.largest])) { q.largest = i; }
+        }
+
+        float sign = c[q.largest] < 0.0f ? -1.0f : 1.0f;
+
+        for (uint32_t i = 0, j = 0; i < 4; ++i) {
+            if (i != q.largest) { q.rot[j++] = quantize(sign * c[i], -QUAT_COMPONENT_RANGE, QUAT_COMPONENT_RANGE, settings.rotBits); }
+        }
+    };
+
+    inline static void dequantizeBody(QuantizationSettings const &settings, QuantizedBody const &q, ReplicatedBody &body) {
+        for (int i = 0; i < 3; ++i) {
+            float h = (&settings.halfsize.x)[i];
+
+            (&body.pos.x)[i] = (&settings.center.x)[i] + dequantize(q.pos[i], -h, h, settings.posBits);
+            (&body.vel.x)[i] = dequantize(q.vel[i], -settings.maxSpeed, settings.maxSpeed, settings.velBits);
+            (&body.angVel.x)[i] = dequantize(q.angVel[i], -settings.maxAngSpeed, settings.maxAngSpeed, settings.angVelBits);
+        }
+
+        float c[4];
+        float sumSq = 0.0f;
+
+        for (uint32_t i = 0, j = 0; i < 4; ++i) {
+            if (i == q.largest) { continue; }
+
+            c[i] = dequantize(q.rot[j++], -QUAT_COMPONENT_RANGE, QUAT_COMPONENT_RANGE, settings.rotBits);
+            sumSq += c[i]*c[i];
+        }
+
+        c[q.largest] = sumSq < 1.0f ? std::sqrt(1.0f - sumSq) : 0.0f;
+        body.orientation = ZMath::Quaternion(c[0], c[1], c[2], c[3]).normalize();
+    };
+
+    // Move a rigid body to a replicated state, along with its collider.
+    inline static void applyReplicatedBody(ReplicatedBody const &body, RigidBody3D* rb) {
+        rb->pos = body.pos;
+        rb->vel = body.vel;
+        rb->orientation = body.orientation;
+        rb->angVel = body.angVel;
+
+        rb->syncRotation();
+        rb->syncCollider();
+    };
+
+
+    // * ===================================
+    // * Replication Streams
+    // * ===================================
+
+    // ? Parts of a body's state which can be sent on their own. A body which changed sends a mask of which parts changed.
+    enum ReplicationPart {
+        REPLICATE_POS = 1,
+        REPLICATE_VEL = 2,
+        REPLICATE_ROT = 4,
+        REPLICATE_ANG_VEL = 8
+    };
+
+    static const uint32_t NO_FRAME = 0xFFFFFFFF; // frame number used when there is no acknowledged frame
+
+    // Ring of the quantized states of the last few frames, used as the baselines to encode and decode frames against.
+    class ReplicationFrames {
+        private:
+            typedef struct Frame {
+                uint32_t number = NO_FRAME;
+                QuantizedBody* bodies = nullptr;
+                int count = 0;
+                int capacity = 0;
+            } Frame;
+
+            Frame* frames;
+            int numFrames;
+
+        public:
+            ReplicationFrames(int numFrames) : numFrames(numFrames > 0 ? numFrames : 1) { frames = new Frame[this->numFrames]; };
+
+            ReplicationFrames(ReplicationFrames const &frames) = delete;
+            ReplicationFrames& operator = (ReplicationFrames const &frames) = delete;
+
+            ~ReplicationFrames() {
+                for (int i = 0; i < numFrames; ++i) { delete[] frames[i].bodies; }
+                delete[] frames;
+            };
+
+            // Get the stored bodies of a frame. nullptr if the frame is no longer stored.
+            inline QuantizedBody const* get(uint32_t number, int &count) const {
+                if (number == NO_FRAME) { return nullptr; }
+
+                Frame const &frame = frames[number % numFrames];
+                count = frame.count;
+
+                return frame.number == number ? frame.bodies : nullptr;
+            };
+
+            // Make room to store a frame, overwriting the oldest frame in its slot. The memory is reused between frames.
+            QuantizedBody* add(uint32_t number, int count) {
+                Frame &frame = frames[number % numFrames];
+
+                if (frame.capacity < count) {
+                    delete[] frame.bodies;
+
+                    frame.capacity = count;
+                    frame.bodies = new QuantizedBody[count];
+                }
+
+                frame.number = number;
+                frame.count = count;
+
+                return frame.bodies;
+            };
+
+            // Forget a frame so it is no longer used as a baseline.
+            inline void remove(uint32_t number) {
+                Frame &frame = frames[number % numFrames];
+                if (frame.number == number) { frame.number = NO_FRAME; }
+            };
+    };
+
+    // Encodes the state of the bodies on the server.
+    class ReplicationEncoder {
+        private:
+            QuantizationSettings settings;
+            ReplicationFrames frames; // frames sent recently, kept as the baselines for the next frames
+
+        public:
+            /**
+             * @brief Create an encoder.
+             *
+             * @param settings The quantization settings. These must match the client's decoder.
+             * @param numFrames Number of frames kept as baselines. Acknowledgements older than this are ignored
+             *                   and the frame is sent in full instead.
+             */
+            ReplicationEncoder(QuantizationSettings const &settings, int numFrames = 32) : settings(settings), frames(numFrames) {};
+
+            inline QuantizationSettings const& getSettings() const { return settings; };
+
+            /**
+             * @brief Encode the state of a list of bodies for a frame.
+             *
+             * @param bodies The bodies to send. These must be in the same order every frame and the client must decode them in this order.
+             * @param count Number of bodies.
+             * @param frame Number of the frame. This should go up by at least one every call.
+             * @param ackedFrame Last frame the client acknowledged receiving, or NO_FRAME to send every body in full.
+             * @param out Buffer to write the stream to.
+             * @param capacity Size of the buffer in bytes.
+             * @return (size_t) Number of bytes written. 0 if the buffer was too small.
+             */
+            size_t encode(RigidBody3D* const* bodies, int count, uint32_t frame, uint32_t ackedFrame, uint8_t* out, size_t capacity) {
+                int baseCount = 0;
+                QuantizedBody const* base = frames.get(ackedFrame, baseCount);
+
+                // ? A baseline with a different number of bodies cannot be compared against, so the frame is sent in full.
+                if (base && baseCount != count) { base = nullptr; }
+
+                QuantizedBody* current = frames.add(frame, count);
+                BitWriter writer(out, capacity);
+
+                writer.write(frame, 32);
+                writer.write(base != nullptr, 1);
+                if (base) { writer.write(ackedFrame, 32); }
+                writer.write((uint32_t) count, 32);
+
+                // ? The baseline may be stored in the same slot as the new frame, so each body is compared before it is stored.
+                for (int i = 0; i < count; ++i) {
+                    QuantizedBody q;
+                    quantizeBody(settings, bodies[i], q);
+
+                    uint32_t parts = REPLICATE_POS | REPLICATE_VEL | REPLICATE_ROT | REPLICATE_ANG_VEL;
+
+                    if (base) {
+                        QuantizedBody const &b = base[i];
+                        parts = 0;
+
+                        if (memcmp(q.pos, b.pos, sizeof(q.pos))) { parts |= REPLICATE_POS; }
+                        if (memcmp(q.vel, b.vel, sizeof(q.vel))) { parts |= REPLICATE_VEL; }
+                        if (q.largest != b.largest || memcmp(q.rot, b.rot, sizeof(q.rot))) { parts |= REPLICATE_ROT; }
+                        if (memcmp(q.angVel, b.angVel, sizeof(q.angVel))) { parts |= REPLICATE_ANG_VEL; }
+                    }
+
+                    current[i] = q;
+
+                    if (base) {
+                        writer.write(parts != 0, 1);
+                        if (!parts) { continue; }
+
+                        writer.write(parts, 4);
+                    }
+
+                    if (parts & REPLICATE_POS) {
+                        for (int j = 0; j < 3; ++j) { writer.write(q.pos[j], settings.posBits); }
+                    }
+
+                    if (parts & REPLICATE_VEL) {
+                        for (int j = 0; j < 3; ++j) { writer.write(q.vel[j], settings.velBits); }
+                    }
+
+                    if (parts & REPLICATE_ROT) {
+                        writer.write(q.largest, 2);
+                        for (int j = 0; j < 3; ++j) { writer.write(q.rot[j], settings.rotBits); }
+                    }
+
+                    if (parts & REPLICATE_ANG_VEL) {
+                        for (int j = 0; j < 3; ++j) { writer.write(q.angVel[j], settings.angVelBits); }
+                    }
+                }
+
+                return writer.finish();
+            };
+    };
+
+    // Decodes the state of the bodies on a client.
+    class ReplicationDecoder {
+        private:
+            QuantizationSettings settings;
+            ReplicationFrames frames; // frames received recently, kept as the baselines for the next frames
+
+        public:
+            /**
+             * @brief Create a decoder.
+             *
+             * @param settings The quantization settings. These must match the server's encoder.
+             * @param numFrames Number of frames kept as baselines. This should be at least the number of frames the server keeps.
+             */
+            ReplicationDecoder(QuantizationSettings const &settings, int numFrames = 32) : settings(settings), frames(numFrames) {};
+
+            inline QuantizationSettings const& getSettings() const { return settings; };
+
+            /**
+             * @brief Decode a frame. Once decoded, the frame can be acknowledged to the server so it is used as a baseline.
+             *
+             * @param data The stream written by the encoder.
+             * @param size Size of the stream in bytes.
+             * @param bodies Set to the state of each body, in the order they were encoded.
+             * @param capacity Max number of bodies to store.
+             * @param frame Set to the number of the frame decoded.
+             * @return (int) Number of bodies in the frame. -1 if the stream is cut off, the frame has more bodies than the capacity,
+             *                or it was encoded against a frame this decoder no longer has.
+             */
+            int decode(uint8_t const* data, size_t size, ReplicatedBody* bodies, int capacity, uint32_t &frame) {
+                BitReader reader(data, size);
+
+                frame = reader.read(32);
+                bool hasBase = reader.read(1);
+                uint32_t baseFrame = hasBase ? reader.read(32) : NO_FRAME;
+                int count = (int) reader.read(32);
+
+                if (reader.overrun || count < 0 || count > capacity) { return -1; }
+
+                int baseCount = 0;
+                QuantizedBody const* base = frames.get(baseFrame, baseCount);
+
+                if (hasBase && (!base || baseCount != count)) { return -1; }
+
+                // ? The baseline may be stored in the same slot as the new frame, so the bodies are decoded in place.
+                QuantizedBody* current = frames.add(frame, count);
+                if (base && base != current) { memcpy(current, base, count * sizeof(QuantizedBody)); }
+
+                for (int i = 0; i < count; ++i) {
+                    QuantizedBody &q = current[i];
+                    uint32_t parts = REPLICATE_POS | REPLICATE_VEL | REPLICATE_ROT | REPLICATE_ANG_VEL;
+
+                    if (hasBase) { parts = reader.read(1) ? reader.read(4) : 0; }
+
+                    if (parts & REPLICATE_POS) {
+                        for (int j = 0; j < 3; ++j) { q.pos[j] = reader.read(settings.posBits); }
+                    }
+
+                    if (parts & REPLICATE_VEL) {
+                        for (int j = 0; j < 3; ++j) { q.vel[j] = reader.read(settings.velBits); }
+                    }
+
+                    if (parts & REPLICATE_ROT) {
+                        q.largest = reader.read(2);
+                        for (int j = 0; j < 3; ++j) { q.rot[j] = reader.read(settings.rotBits); }
+                    }
+
+                    if (parts & REPLICATE_ANG_VEL) {
+                        for (int j = 0; j < 3; ++j) { q.angVel[j] = reader.read(settings.angVelBits); }
+                    }
+
+                    dequantizeBody(settings, q, bodies[i]);
+                }
+
+                // ? A cut off frame must not be used as a baseline as its bodies are only partly decoded.
+                if (reader.overrun) {
+                    frames.remove(frame);
+                    return -1;
+                }
+
+                return count;
+            };
+    };
+}
@@ -0,0 +1,547 @@
+// ? Binary scene files which load without any parsing, for large static worlds which would take seconds to build in code.
+// ? A scene file holds static bodies, rigid bodies, their colliders, the rigid bodies' materials, and a prebuilt broadphase
+// ?  tree over the static bodies. Scenes are saved with SceneFile::save and added to a handler with Handler::addScene.
+// ? The file is memory mapped and the static colliders and broadphase tree are used directly from the mapping.
+// ?  Only the static bodies themselves are built on load, as each one points to its collider.
+// ?  Rigid bodies and their colliders are copied out of the file as they move.
+// ? Every section is found through its offset from the start of the file, so the file works wherever it is mapped.
+// ? Colliders are stored in the same layout they have in memory. The header records the size of each collider type,
+// ?  the format version, and the byte order, and a file which does not match the program loading it is rejected.
+// ? Only planes, spheres, AABBs, cubes, capsules, and (for rigid bodies) triangular pyramids are supported, as the other
+// ?  colliders hold pointers to their data.
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include "broadphase.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define ZETA_SCENE_MMAP
+#endif
+
+namespace Zeta {
+    // * ===================================
+    // * File Layout
+    // * ===================================
+
+    static const uint32_t SCENE_FILE_MAGIC = 0x4E43535A; // "ZSCN" when read as bytes
+    static const uint32_t SCENE_FILE_VERSION = 1;
+    static const uint32_t SCENE_FILE_BYTE_ORDER = 0x01020304; // reads differently on a machine with another byte order
+
+    // Alignment of every section and collider in the file.
+    static const uint64_t SCENE_FILE_ALIGNMENT = 8;
+
+    static_assert(std::is_trivially_copyable<Plane>::value && std::is_trivially_copyable<Sphere>::value
+                  && std::is_trivially_copyable<AABB>::value && std::is_trivially_copyable<Cube>::value
+                  && std::is_trivially_copyable<Capsule>::value && std::is_trivially_copyable<TriangularPyramid>::value,
+                  "Colliders stored in scene files must be trivially copyable.");
+
+    // Types of colliders stored in a scene file. Their sizes are recorded in the header.
+    enum SceneColliderType {
+        SCENE_PLANE,
+        SCENE_SPHERE,
+        SCENE_AABB,
+        SCENE_CUBE,
+        SCENE_CAPSULE,
+        SCENE_TRI_PY,
+        SCENE_BVH_NODE, // not a collider, but the nodes are stored in their in-memory layout too
+        NUM_SCENE_COLLIDER_TYPES
+    };
+
+    typedef struct SceneFileHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t byteOrder;
+        uint32_t sizes[NUM_SCENE_COLLIDER_TYPES]; // size of each collider type
+
+        uint32_t numMaterials;
+        uint32_t numStaticBodies;
+        uint32_t numRigidBodies;
+        uint32_t numNodes; // nodes in the static broadphase tree
+
+        uint64_t fileSize;
+        uint64_t materialsOffset;
+        uint64_t staticBodiesOffset;
+        uint64_t rigidBodiesOffset;
+        uint64_t nodesOffset;
+        uint64_t itemsOffset; // item indices of the broadphase tree's leaves
+        uint64_t collidersOffset;
+    } SceneFileHeader;
+
+    // Surface and damping properties shared by rigid bodies.
+    typedef struct SceneMaterial {
+        float cor;
+        float linearDamping;
+        float angularDamping;
+    } SceneMaterial;
+
+    typedef struct SceneStaticBody {
+        float pos[3];
+        uint32_t colliderType; // StaticBodyCollider
+        uint64_t colliderOffset; // offset of the collider from the start of the file
+        CollisionFilter filter;
+        uint32_t padding;
+    } SceneStaticBody;
+
+    typedef struct SceneRigidBody {
+        float pos[3];
+        float mass;
+        uint32_t material; // index into the materials
+        uint32_t colliderType; // RigidBodyCollider
+        uint64_t colliderOffset; // offset of the collider from the start of the file
+        CollisionFilter filter;
+        uint32_t ccd;
+    } SceneRigidBody;
+
+
+    // * ===================================
+    // * Scene Files
+    // * ===================================
+
+    class SceneFile {
+        private:
+            uint8_t const* data = nullptr; // start of the file
+            size_t size = 0;
+
+            // ? Only one of these is set, depending on how the file was loaded.
+            void* mapping = nullptr; // memory mapped file
+            uint64_t* copy = nullptr; // file read into memory where memory mapping is not available
+
+            SceneFileHeader const* header = nullptr;
+
+            // ? The static bodies are built in a single block. Their destructors are never run as their colliders belong to the file.
+            StaticBody3D* staticBodies = nullptr;
+            StaticBody3D** staticBodyList = nullptr; // pointers to each static body, as taken by the handler
+
+            // Get the size of a static collider. 0 if it cannot be stored in a scene file.
+            static inline size_t getColliderSize(StaticBodyCollider type) {
+                switch(type) {
+                    case STATIC_PLANE_COLLIDER:   { return sizeof(Plane);   }
+                    case STATIC_SPHERE_COLLIDER:  { return sizeof(Sphere);  }
+                    case STATIC_AABB_COLLIDER:    { return sizeof(AABB);    }
+                    case STATIC_CUBE_COLLIDER:    { return sizeof(Cube);    }
+                    case STATIC_CAPSULE_COLLIDER: { return sizeof(Capsule); }
+                    default:                      { return 0;               }
+                }
+            };
+
+            // Get the size of a rigid collider. 0 if it cannot be stored in a scene file.
+            static inline size_t getColliderSize(RigidBodyCollider type) {
+                switch(type) {
+                    case RIGID_SPHERE_COLLIDER:  { return sizeof(Sphere);            }
+                    case RIGID_AABB_COLLIDER:    { return sizeof(AABB);              }
+                    case RIGID_CUBE_COLLIDER:    { return sizeof(Cube);              }
+                    case RIGID_CAPSULE_COLLIDER: { return sizeof(Capsule);           }
+                    case RIGID_TRI_PY_COLLIDER:  { return sizeof(TriangularPyramid); }
+                    default:                     { return 0;                         }
+                }
+            };
+
+            static inline uint64_t align(uint64_t offset) { return (offset + SCENE_FILE_ALIGNMENT - 1) & ~(SCENE_FILE_ALIGNMENT - 1); };
+
+            static void fillHeaderSizes(SceneFileHeader &h) {
+                h.sizes[SCENE_PLANE] = sizeof(Plane);
+                h.sizes[SCENE_SPHERE] = sizeof(Sphere);
+                h.sizes[SCENE_AABB] = sizeof(AABB);
+                h.sizes[SCENE_CUBE] = sizeof(Cube);
+                h.sizes[SCENE_CAPSULE] = sizeof(Capsule);
+                h.sizes[SCENE_TRI_PY] = sizeof(TriangularPyramid);
+                h.sizes[SCENE_BVH_NODE] = sizeof(BVH::Node);
+            };
+
+            // Check that a section of count items of a given size fits in the file and is aligned.
+            inline bool validSection(uint64_t offset, uint64_t count, uint64_t itemSize) const {
+                return offset % SCENE_FILE_ALIGNMENT == 0 && offset <= size && count <= (size - offset)/itemSize;
+            };
+
+            // Check that a collider fits in the file and is aligned.
+            inline bool validCollider(uint64_t offset, size_t colliderSize) const {
+                return colliderSize && offset >= header->collidersOffset && validSection(offset, 1, colliderSize);
+            };
+
+            // Check the header and every offset and index in the file, then build the static bodies.
+            bool init() {
+                if (size < sizeof(SceneFileHeader) || (uintptr_t) data % SCENE_FILE_ALIGNMENT) { return 0; }
+
+                header = (SceneFileHeader const*) data;
+
+                SceneFileHeader expected;
+                fillHeaderSizes(expected);
+
+                if (header->magic != SCENE_FILE_MAGIC || header->version != SCENE_FILE_VERSION || header->byteOrder != SCENE_FILE_BYTE_ORDER
+                        || memcmp(header->sizes, expected.sizes, sizeof(expected.sizes)) || header->fileSize != size) { return 0; }
+
+                if (!validSection(header->materialsOffset, header->numMaterials, sizeof(SceneMaterial))
+                        || !validSection(header->staticBodiesOffset, header->numStaticBodies, sizeof(SceneStaticBody))
+                        || !validSection(header->rigidBodiesOffset, header->numRigidBodies, sizeof(SceneRigidBody))
+                        || !validSection(header->nodesOffset, header->numNodes, sizeof(BVH::Node))
+                        || !validSection(header->itemsOffset, header->numStaticBodies, sizeof(int))
+                        || !validSection(header->collidersOffset, 0, 1)
+                        || header->numStaticBodies > INT32_MAX/2 || header->numRigidBodies > INT32_MAX) { return 0; }
+
+                // * Check the broadphase tree so a bad file cannot send a query out of bounds.
+
+                int numStatic = (int) header->numStaticBodies;
+                int numNodes = (int) header->numNodes;
+
+                if ((numStatic && !numNodes) || numNodes > 2*numStatic) { return 0; }
+
+                BVH::Node const* nodes = getNodes();
+                int const* items = getItems();
+
+                // ? Children always come after their parent, so each node's depth is known by the time it is reached.
+                // ?  The tree must be shallow enough for the fixed size stacks used to traverse it.
+                uint8_t* depths = new uint8_t[numNodes > 0 ? numNodes : 1]();
+                bool validTree = 1;
+
+                for (int i = 0; i < numNodes && validTree; ++i) {
+                    BVH::Node const &node = nodes[i];
+
+                    if (node.count) {
+                        validTree = node.first >= 0 && node.count > 0 && node.count <= numStatic && node.first <= numStatic - node.count;
+                        continue;
+                    }
+
+                    validTree = node.first > i && node.first < numNodes - 1 && depths[i] < BVH_STACK_SIZE - 2;
+                    if (!validTree) { break; }
+
+                    for (int child = node.first; child <= node.first + 1; ++child) {
+                        if (depths[child] <= depths[i]) { depths[child] = depths[i] + 1; }
+                    }
+                }
+
+                delete[] depths;
+                if (!validTree) { return 0; }
+
+                for (int i = 0; i < numStatic; ++i) {
+                    if (items[i] < 0 || items[i] >= numStatic) { return 0; }
+                }
+
+                SceneRigidBody const* rigid = (SceneRigidBody const*) (data + header->rigidBodiesOffset);
+
+                for (uint32_t i = 0; i < header->numRigidBodies; ++i) {
+                    if (rigid[i].material >= header->numMaterials
+                            || !validCollider(rigid[i].colliderOffset, getColliderSize((RigidBodyCollider) rigid[i].colliderType))) { return 0; }
+                }
+
+                // * Build the static bodies, pointing each to its collider in the file.
+
+                SceneStaticBody const* stat = (SceneStaticBody const*) (data + header->staticBodiesOffset);
+
+                for (int i = 0; i < numStatic; ++i) {
+                    if (!validCollider(stat[i].colliderOffset, getColliderSize((StaticBodyCollider) stat[i].colliderType))) { return 0; }
+                }
+
+                staticBodies = (StaticBody3D*) ::operator new(numStatic * sizeof(StaticBody3D));
+                staticBodyList = new StaticBody3D*[numStatic];
+
+                for (int i = 0; i < numStatic; ++i) {
+                    // ? The collider is never written to, so casting away const is safe.
+                    StaticBody3D* sb = new (staticBodies + i) StaticBody3D(ZMath::Vec3D(stat[i].pos[0], stat[i].pos[1], stat[i].pos[2]),
+                            (StaticBodyCollider) stat[i].colliderType, (void*) (data + stat[i].colliderOffset));
+
+                    sb->filter = stat[i].filter;
+                    staticBodyList[i] = sb;
+                }
+
+                return 1;
+            };
+
+        public:
+            // * ===================================
+            // * Constructors, Destructors, Etc.
+            // * ===================================
+
+            SceneFile() {};
+
+            SceneFile(SceneFile const &scene) = delete;
+            SceneFile& operator = (SceneFile const &scene) = delete;
+
+            ~SceneFile() { close(); };
+
+
+            // * ============================
+            // * Loading
+            // * ============================
+
+            /**
+             * @brief Open a scene file, memory mapping it where possible and reading it into memory otherwise.
+             * ? The mapping is private, so the file is never changed even if a collider is.
+             *
+             * @param path Path to the file.
+             * @return (bool) 1 if the scene was loaded and 0 if the file could not be read or is not a valid scene file for this program.
+             */
+            bool open(char const* path) {
+                close();
+
+#ifdef ZETA_SCENE_MMAP
+                int fd = ::open(path, O_RDONLY);
+                if (fd < 0) { return 0; }
+
+                struct stat st;
+                if (fstat(fd, &st) || st.st_size <= 0) { ::close(fd); return 0; }
+
+                void* p = mmap(nullptr, (size_t) st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+                ::close(fd);
+
+                if (p == MAP_FAILED) { return 0; }
+
+                mapping = p;
+                data = (uint8_t const*) p;
+                size = (size_t) st.st_size;
+#else
+                FILE* file = fopen(path, "rb");
+                if (!file) { return 0; }
+
+                fseek(file, 0, SEEK_END);
+                long length = ftell(file);
+                fseek(file, 0, SEEK_SET);
+
+                if (length <= 0) { fclose(file); return 0; }
+
+                // ? uint64_t keeps the copy aligned like a mapping would be.
+                copy = new uint64_t[((size_t) length + 7)/8];
+                bool read = fread(copy, 1, (size_t) length, file) == (size_t) length;
+                fclose(file);
+
+                data = (uint8_t const*) copy;
+                size = (size_t) length;
+
+                if (!read) { close(); return 0; }
+#endif
+
+                if (!init()) { close(); return 0; }
+                return 1;
+            };
+
+            /**
+             * @brief Load a scene file which is already in memory, such as one embedded in the program. Nothing is copied.
+             *
+             * @param data The file. This must be aligned to 8 bytes and stay alive and unchanged while the scene is loaded.
+             * @param size Size of the file in bytes.
+             * @return (bool) 1 if the scene was loaded and 0 if it is not a valid scene file for this program.
+             */
+            bool load(void const* data, size_t size) {
+                close();
+
+                this->data = (uint8_t const*) data;
+                this->size = size;
+
+                if (!init()) { close(); return 0; }
+                return 1;
+            };
+
+            // Unload the scene. Remove its static bodies from any handler first.
+            void close() {
+                ::operator delete(staticBodies);
+                delete[] staticBodyList;
+
+#ifdef ZETA_SCENE_MMAP
+                if (mapping) { munmap(mapping, size); }
+#endif
+
+                delete[] copy;
+
+                data = nullptr;
+                size = 0;
+                mapping = nullptr;
+                copy = nullptr;
+                header = nullptr;
+                staticBodies = nullptr;
+                staticBodyList = nullptr;
+            };
+
+            inline bool isLoaded() const { return header != nullptr; };
+
+
+            // * ============================
+            // * Contents
+            // * ============================
+
+            inline int getNumStaticBodies() const { return header ? (int) header->numStaticBodies : 0; };
+            inline int getNumRigidBodies() const { return header ? (int) header->numRigidBodies : 0; };
+
+            // Get the static bodies. These belong to the scene and must not be deleted or removed from a handler one at a time.
+            inline StaticBody3D** getStaticBodies() const { return staticBodyList; };
+
+            // Broadphase tree over the static bodies, in the order returned by getStaticBodies.
+            inline int getNumNodes() const { return header ? (int) header->numNodes : 0; };
+            inline BVH::Node const* getNodes() const { return (BVH::Node const*) (data + header->nodesOffset); };
+            inline int const* getItems() const { return (int const*) (data + header->itemsOffset); };
+
+            // Make a new rigid body from the scene. The caller owns the rigid body, such as by adding it to a handler.
+            RigidBody3D* createRigidBody(int i) const {
+                SceneRigidBody const &body = ((SceneRigidBody const*) (data + header->rigidBodiesOffset))[i];
+                SceneMaterial const &material = ((SceneMaterial const*) (data + header->materialsOffset))[body.material];
+                void const* collider = data + body.colliderOffset;
+                ZMath::Vec3D pos(body.pos[0], body.pos[1], body.pos[2]);
+                RigidBody3D* rb = nullptr;
+
+                // ? The collider is copied into the rigidbody so nothing else needs to be allocated.
+                switch((RigidBodyCollider) body.colliderType) {
+                    case RIGID_SPHERE_COLLIDER:  { rb = new RigidBody3D(pos, body.mass, material.cor, material.linearDamping, *((Sphere const*) collider));            break; }
+                    case RIGID_AABB_COLLIDER:    { rb = new RigidBody3D(pos, body.mass, material.cor, material.linearDamping, *((AABB const*) collider));              break; }
+                    case RIGID_CUBE_COLLIDER:    { rb = new RigidBody3D(pos, body.mass, material.cor, material.linearDamping, *((Cube const*) collider));              break; }
+                    case RIGID_CAPSULE_COLLIDER: { rb = new RigidBody3D(pos, body.mass, material.cor, material.linearDamping, *((Capsule const*) collider));           break; }
+                    case RIGID_TRI_PY_COLLIDER:  { rb = new RigidBody3D(pos, body.mass, material.cor, material.linearDamping, *((TriangularPyramid const*) collider)); break; }
+                    default:                     { return nullptr; } // checked when the scene was loaded
+                }
+
+                rb->angularDamping = material.angularDamping;
+                rb->filter = body.filter;
+                rb->ccd = body.ccd != 0;
+
+                return rb;
+            };
+
+
+            // * ============================
+            // * Saving
+            // * ============================
+
+            /**
+             * @brief Save bodies as a scene file. The broadphase tree over the static bodies is built and stored along with them.
+             * ? Rigid bodies sharing the same coefficient of restitution and damping share a material.
+             *
+             * @param path Path to the file to write.
+             * @param sbs The static bodies. Only planes, spheres, AABBs, cubes, and capsules are supported.
+             * @param numSbs Number of static bodies.
+             * @param rbs The rigid bodies. Only spheres, AABBs, cubes, capsules, and triangular pyramids are supported.
+             * @param numRbs Number of rigid bodies.
+             * @return (bool) 1 if the file was written and 0 if a collider is not supported or the file could not be written.
+             */
+            static bool save(char const* path, StaticBody3D* const* sbs, int numSbs, RigidBody3D* const* rbs, int numRbs) {
+                // * Find the materials and the size of the colliders.
+
+                SceneMaterial* materials = new SceneMaterial[numRbs > 0 ? numRbs : 1];
+                uint32_t* bodyMaterials = new uint32_t[numRbs > 0 ? numRbs : 1];
+                uint32_t numMaterials = 0;
+                uint64_t collidersSize = 0;
+                bool supported = 1;
+
+                for (int i = 0; i < numSbs; ++i) {
+                    size_t colliderSize = getColliderSize(sbs[i]->colliderType);
+                    supported = supported && colliderSize;
+                    collidersSize += align(colliderSize);
+                }
+
+                for (int i = 0; i < numRbs; ++i) {
+                    size_t colliderSize = getColliderSize(rbs[i]->colliderType);
+                    supported = supported && colliderSize;
+                    collidersSize += align(colliderSize);
+
+                    // ? Scenes usually only use a handful of materials so a linear search is fine.
+                    SceneMaterial material = {rbs[i]->cor, rbs[i]->linearDamping, rbs[i]->angularDamping};
+                    uint32_t j = 0;
+
+                    for (; j < numMaterials; ++j) {
+                        if (!memcmp(&materials[j], &material, sizeof(SceneMaterial))) { break; }
+                    }
+
+                    if (j == numMaterials) { materials[numMaterials++] = material; }
+                    bodyMaterials[i] = j;
+                }
+
+                if (!supported) {
+                    delete[] materials;
+                    delete[] bodyMaterials;
+                    return 0;
+                }
+
+                // * Build the broadphase tree.
+
+                BVH tree;
+                tree.build(numSbs, [sbs](int i, ZMath::Vec3D &min, ZMath::Vec3D &max) {
+                    if (!getBounds(sbs[i]->colliderType, sbs[i]->collider, min, max)) { min.set(FLT_MAX); max.set(-FLT_MAX); }
+                });
+
+                // * Lay out the file.
+
+                SceneFileHeader h;
+                memset(&h, 0, sizeof(h));
+
+                h.magic = SCENE_FILE_MAGIC;
+                h.version = SCENE_FILE_VERSION;
+                h.byteOrder = SCENE_FILE_BYTE_ORDER;
+                fillHeaderSizes(h);
+
+                h.numMaterials = numMaterials;
+                h.numStaticBodies = numSbs;
+                h.numRigidBodies = numRbs;
+                h.numNodes = tree.getNumNodes();
+
+                h.materialsOffset = align(sizeof(SceneFileHeader));
+                h.staticBodiesOffset = align(h.materialsOffset + numMaterials * sizeof(SceneMaterial));
+                h.rigidBodiesOffset = align(h.staticBodiesOffset + numSbs * sizeof(SceneStaticBody));
+                h.nodesOffset = align(h.rigidBodiesOffset + numRbs * sizeof(SceneRigidBody));
+                h.itemsOffset = align(h.nodesOffset + h.numNodes * sizeof(BVH::Node));
+                h.collidersOffset = align(h.itemsOffset + numSbs * sizeof(int));
+                h.fileSize = h.collidersOffset + collidersSize;
+
+                // * Write the file into memory first so it can be written in a single call.
+
+                uint8_t* out = new uint8_t[h.fileSize];
+                memset(out, 0, h.fileSize);
+                memcpy(out, &h, sizeof(h));
+
+                memcpy(out + h.materialsOffset, materials, numMaterials * sizeof(SceneMaterial));
+                if (h.numNodes) { memcpy(out + h.nodesOffset, tree.getNodes(), h.numNodes * sizeof(BVH::Node)); }
+                if (numSbs) { memcpy(out + h.itemsOffset, tree.getItems(), numSbs * sizeof(int)); }
+
+                uint64_t colliderOffset = h.collidersOffset;
+                SceneStaticBody* stat = (SceneStaticBody*) (out + h.staticBodiesOffset);
+
+                for (int i = 0; i < numSbs; ++i) {
+                    size_t colliderSize = getColliderSize(sbs[i]->colliderType);
+
+                    stat[i].pos[0] = sbs[i]->pos.x;
+                    stat[i].pos[1] = sbs[i]->pos.y;
+                    stat[i].pos[2] = sbs[i]->pos.z;
+                    stat[i].colliderType = sbs[i]->colliderType;
+                    stat[i].colliderOffset = colliderOffset;
+                    stat[i].filter = sbs[i]->filter;
+
+                    memcpy(out + colliderOffset, sbs[i]->collider, colliderSize);
+                    colliderOffset += align(colliderSize);
+                }
+
+                SceneRigidBody* rigid = (SceneRigidBody*) (out + h.rigidBodiesOffset);
+
+                for (int i = 0; i < numRbs; ++i) {
+                    size_t colliderSize = getColliderSize(rbs[i]->colliderType);
+
+                    rigid[i].pos[0] = rbs[i]->pos.x;
+                    rigid[i].pos[1] = rbs[i]->pos.y;
+                    rigid[i].pos[2] = rbs[i]->pos.z;
+                    rigid[i].mass = rbs[i]->mass;
+                    rigid[i].material = bodyMaterials[i];
+                    rigid[i].colliderType = rbs[i]->colliderType;
+                    rigid[i].colliderOffset = colliderOffset;
+                    rigid[i].filter = rbs[i]->filter;
+                    rigid[i].ccd = rbs[i]->ccd;
+
+                    memcpy(out + colliderOffset, rbs[i]->collider, colliderSize);
+                    colliderOffset += align(colliderSize);
+                }
+
+                delete[] materials;
+                delete[] bodyMaterials;
+
+                FILE* file = fopen(path, "wb");
+                bool written = file && fwrite(out, 1, h.fileSize, file) == h.fileSize;
+
+                if (file && fclose(file)) { written = 0; }
+
+                delete[] out;
+                return written;
+            };
+    };
+}
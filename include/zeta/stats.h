@@ -0,0 +1,172 @@
+// ? Per step timings and counters of the physics handler.
+// ? Stats are opt-in. Add `#define ENABLE_PHYSICS_STATS` above `#include <zeta/physicshandler.h>` to record them.
+// ? Without it, the recording compiles away entirely and Handler::stats() does not exist.
+
+#pragma once
+
+// Wrap a statement which is only needed to record stats.
+#ifdef ENABLE_PHYSICS_STATS
+    #define ZETA_STATS(statement) statement
+#else
+    #define ZETA_STATS(statement)
+#endif
+
+#ifdef ENABLE_PHYSICS_STATS
+
+#include <algorithm>
+#include <chrono>
+
+// Number of steps the rolling averages and percentiles are taken over.
+#ifndef STATS_HISTORY
+#define STATS_HISTORY 128
+#endif
+
+namespace Zeta {
+    // Values recorded for each step.
+    // Times are in milliseconds.
+    enum StatType {
+        STAT_STEP_TIME, // total time taken by the step
+        STAT_COLLISION_TIME, // finding the colliding pairs and their manifolds. The handler does both in the same pass.
+        STAT_SOLVER_TIME, // resolving the collisions
+        STAT_INTEGRATION_TIME, // integrating the bodies' velocities and positions, including CCD
+        STAT_EVENT_TIME, // finding the contact and sensor events
+        STAT_PAIRS, // pairs which passed the collision filters and were tested for a collision
+        STAT_MANIFOLDS, // collisions found, including speculative contacts
+        STAT_CONTACT_POINTS, // contact points the solver resolved
+        STAT_SOLVER_ITERATIONS, // iterations the solver ran
+        STAT_TREE_NODES, // nodes in the broadphase trees used by the queries
+        STAT_TREE_ITEMS, // bodies in the broadphase trees used by the queries
+        STAT_BYTES_ALLOCATED, // bytes allocated on the heap during the step
+        STAT_MEMORY, // bytes held by the handler's lists and trees at the end of the step
+        NUM_STAT_TYPES
+    };
+
+    // Hook for taking extra measurements around each of the handler's phases, such as hardware performance counters.
+    class StatsProbe {
+        public:
+            virtual void beginPhase() = 0;
+
+            // @param type The timing stat the phase is added to.
+            virtual void endPhase(StatType type) = 0;
+
+            virtual ~StatsProbe() {};
+    };
+
+    // Rolling record of the stats of the last STATS_HISTORY steps.
+    class Stats {
+        private:
+            typedef std::chrono::steady_clock Clock;
+
+            StatsProbe* probe = nullptr;
+
+            float history[STATS_HISTORY][NUM_STAT_TYPES];
+            float current[NUM_STAT_TYPES];
+            int next = 0; // slot the next step is recorded to
+            int count = 0; // number of steps recorded, up to STATS_HISTORY
+
+            Clock::time_point stepStart;
+            Clock::time_point phaseStart;
+
+            static inline float msSince(Clock::time_point const &start) {
+                return std::chrono::duration<float, std::milli>(Clock::now() - start).count();
+            };
+
+        public:
+            // * ==============================
+            // * Recording (used by the handler)
+            // * ==============================
+
+            // ? The probe is called outside of the timed section so its own cost is not counted in the phase times.
+
+            inline void beginStep() {
+                for (int i = 0; i < NUM_STAT_TYPES; ++i) { current[i] = 0.0f; }
+
+                if (probe) { probe->beginPhase(); }
+                stepStart = phaseStart = Clock::now();
+            };
+
+            inline void beginPhase() {
+                if (probe) { probe->beginPhase(); }
+                phaseStart = Clock::now();
+            };
+
+            // Add the time since the last call to beginPhase to a timing stat.
+            inline void endPhase(StatType type) {
+                current[type] += msSince(phaseStart);
+                if (probe) { probe->endPhase(type); }
+            };
+
+            inline void set(StatType type, float value) { current[type] = value; };
+            inline void add(StatType type, float value) { current[type] += value; };
+
+            inline void endStep() {
+                current[STAT_STEP_TIME] = msSince(stepStart);
+
+                for (int i = 0; i < NUM_STAT_TYPES; ++i) { history[next][i] = current[i]; }
+
+                next = (next + 1) % STATS_HISTORY;
+                if (count < STATS_HISTORY) { ++count; }
+            };
+
+            // Forget the recorded steps.
+            inline void reset() { next = count = 0; };
+
+            // Set the probe called around each phase. nullptr to remove it. The probe is not owned by the stats.
+            inline void setProbe(StatsProbe* statsProbe) { probe = statsProbe; };
+
+            // * ============
+            // * Reading
+            // * ============
+
+            // Number of steps the stats are taken over.
+            inline int getNumSteps() const { return count; };
+
+            // Value from the most recent step. 0 if no steps have been recorded.
+            inline float last(StatType type) const {
+                if (!count) { return 0.0f; }
+                return history[(next + STATS_HISTORY - 1) % STATS_HISTORY][type];
+            };
+
+            // Average over the recorded steps. 0 if no steps have been recorded.
+            float average(StatType type) const {
+                if (!count) { return 0.0f; }
+
+                float sum = 0.0f;
+                for (int i = 0; i < count; ++i) { sum += history[i][type]; }
+
+                return sum/count;
+            };
+
+            /**
+             * @brief Find a percentile over the recorded steps using the nearest rank.
+             *
+             * @param type The stat.
+             * @param p The percentile as a fraction between 0 and 1. For example, 0.99 for the 99th percentile.
+             * @return (float) The percentile. 0 if no steps have been recorded.
+             */
+            float percentile(StatType type, float p) const {
+                if (!count) { return 0.0f; }
+
+                float values[STATS_HISTORY];
+                for (int i = 0; i < count; ++i) { values[i] = history[i][type]; }
+
+                int rank = (int) (p * count + 0.5f) - 1;
+                rank = rank < 0 ? 0 : (rank >= count ? count - 1 : rank);
+
+                std::nth_element(values, values + rank, values + count);
+                return values[rank];
+            };
+
+            // Largest value over the recorded steps. 0 if no steps have been recorded.
+            float max(StatType type) const {
+                if (!count) { return 0.0f; }
+
+                float result = history[0][type];
+                for (int i = 1; i < count; ++i) { result = history[i][type] > result ? history[i][type] : result; }
+
+                return result;
+            };
+    };
+}
+
+#endif
@@ -0,0 +1,191 @@
+// ? Timeline of the physics handler's work which can be saved as a Chrome trace.
+// ? Tracing is opt-in. Add `#define ENABLE_PHYSICS_TRACE` above `#include <zeta/physicshandler.h>` to record it.
+// ? Without it, the recording compiles away entirely.
+// ? Saved traces can be opened in chrome://tracing or ui.perfetto.dev.
+
+#pragma once
+
+// Wrap a statement which is only needed to record the trace.
+#ifdef ENABLE_PHYSICS_TRACE
+    #define ZETA_TRACE(statement) statement
+#else
+    #define ZETA_TRACE(statement)
+#endif
+
+#ifdef ENABLE_PHYSICS_TRACE
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+
+// Number of events kept for each thread. Older events are overwritten. This must be a power of 2.
+#ifndef TRACE_BUFFER_SIZE
+#define TRACE_BUFFER_SIZE 16384
+#endif
+
+static_assert((TRACE_BUFFER_SIZE & (TRACE_BUFFER_SIZE - 1)) == 0, "TRACE_BUFFER_SIZE must be a power of 2.");
+
+namespace Zeta {
+    typedef struct TraceEvent {
+        char const* name; // this must outlive the trace, such as a string literal
+        int64_t start; // nanoseconds on the steady clock
+        int64_t duration; // nanoseconds
+    } TraceEvent;
+
+    // Ring buffer of the events recorded by a single thread.
+    // ? Only the owning thread writes to its buffer so recording never waits on a lock.
+    // ? The head is published with release ordering so a dump sees every event finished before it.
+    typedef struct TraceBuffer {
+        TraceEvent events[TRACE_BUFFER_SIZE];
+        std::atomic<uint64_t> head; // number of events ever written
+        std::atomic<uint64_t> start; // events before this were cleared
+        char const* threadName; // name shown for the thread. nullptr to show its id.
+        int tid;
+        TraceBuffer* next; // buffer of the next thread
+    } TraceBuffer;
+
+    // ? The functions holding the shared state are inline rather than static so every translation unit shares them.
+
+    // Head of the list of every thread's buffer.
+    // Buffers are pushed but never removed so the trace of a thread can still be saved after the thread exits.
+    inline std::atomic<TraceBuffer*>& getTraceBuffers() {
+        static std::atomic<TraceBuffer*> buffers(nullptr);
+        return buffers;
+    };
+
+    inline int64_t getTraceTime() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    };
+
+    // Get the calling thread's buffer, making it on the thread's first event.
+    inline TraceBuffer* getTraceBuffer() {
+        static std::atomic<int> nextTid(1);
+        thread_local TraceBuffer* buffer = nullptr;
+
+        if (!buffer) {
+            buffer = new TraceBuffer;
+            buffer->head.store(0, std::memory_order_relaxed);
+            buffer->start.store(0, std::memory_order_relaxed);
+            buffer->threadName = nullptr;
+            buffer->tid = nextTid.fetch_add(1, std::memory_order_relaxed);
+
+            std::atomic<TraceBuffer*> &buffers = getTraceBuffers();
+            buffer->next = buffers.load(std::memory_order_relaxed);
+            while (!buffers.compare_exchange_weak(buffer->next, buffer, std::memory_order_release, std::memory_order_relaxed)) {}
+        }
+
+        return buffer;
+    };
+
+    // Record an event on the calling thread.
+    inline void addTraceEvent(char const* name, int64_t start, int64_t duration) {
+        TraceBuffer* buffer = getTraceBuffer();
+        uint64_t head = buffer->head.load(std::memory_order_relaxed);
+
+        buffer->events[head & (TRACE_BUFFER_SIZE - 1)] = {name, start, duration};
+        buffer->head.store(head + 1, std::memory_order_release);
+    };
+
+    // Name the calling thread in the trace. name must outlive the trace, such as a string literal.
+    inline void setTraceThreadName(char const* name) { getTraceBuffer()->threadName = name; };
+
+    // Traces the time from its creation to its destruction.
+    // next can be used to end the current event and start another for consecutive stages of the same scope.
+    class TraceScope {
+        private:
+            char const* name;
+            int64_t start;
+
+        public:
+            TraceScope(char const* name) : name(name), start(getTraceTime()) {};
+
+            // The event is recorded when the scope ends so it cannot be copied.
+            TraceScope(TraceScope const &scope) = delete;
+            TraceScope& operator = (TraceScope const &scope) = delete;
+
+            ~TraceScope() { addTraceEvent(name, start, getTraceTime() - start); };
+
+            // End the current event and start a new one.
+            inline void next(char const* nextName) {
+                int64_t now = getTraceTime();
+                addTraceEvent(name, start, now - start);
+
+                name = nextName;
+                start = now;
+            };
+    };
+
+    // Forget every event recorded so far.
+    // ? Writers never touch the start marker so this is safe to call while other threads record.
+    inline void clearTrace() {
+        for (TraceBuffer* buffer = getTraceBuffers().load(std::memory_order_acquire); buffer; buffer = buffer->next) {
+            buffer->start.store(buffer->head.load(std::memory_order_acquire), std::memory_order_relaxed);
+        }
+    };
+
+    // Write a string as a JSON string.
+    inline void writeTraceString(FILE* file, char const* str) {
+        fputc('"', file);
+
+        for (; *str; ++str) {
+            if (*str == '"' || *str == '\\') { fputc('\\', file); }
+            if ((unsigned char) *str >= 0x20) { fputc(*str, file); }
+        }
+
+        fputc('"', file);
+    };
+
+    /**
+     * @brief Save the events recorded by every thread in the Chrome trace event format.
+     *        This can be called while other threads are recording. Events they overwrite while it is saving are left out.
+     *
+     * @param path Path of the file to write.
+     * @return (bool) 1 if the file was written, 0 otherwise.
+     */
+    inline bool saveTrace(char const* path) {
+        FILE* file = fopen(path, "w");
+        if (!file) { return 0; }
+
+        TraceEvent* events = new TraceEvent[TRACE_BUFFER_SIZE];
+        bool first = 1;
+
+        fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+
+        for (TraceBuffer* buffer = getTraceBuffers().load(std::memory_order_acquire); buffer; buffer = buffer->next) {
+            // * Copy the events out and throw away any the owner overwrote while they were copied.
+
+            uint64_t head = buffer->head.load(std::memory_order_acquire);
+            uint64_t begin = buffer->start.load(std::memory_order_relaxed);
+            if (head - begin > TRACE_BUFFER_SIZE) { begin = head - TRACE_BUFFER_SIZE; }
+
+            for (uint64_t i = begin; i < head; ++i) { events[i - begin] = buffer->events[i & (TRACE_BUFFER_SIZE - 1)]; }
+
+            uint64_t written = buffer->head.load(std::memory_order_acquire);
+            uint64_t valid = written - begin > TRACE_BUFFER_SIZE ? written - TRACE_BUFFER_SIZE : begin;
+
+            // * Write the events. Complete events ("X") hold their start and duration in microseconds.
+
+            fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":", first ? "" : ",", buffer->tid);
+            if (buffer->threadName) { writeTraceString(file, buffer->threadName); }
+            else { fprintf(file, "\"thread %d\"", buffer->tid); }
+            fprintf(file, "}}");
+            first = 0;
+
+            for (uint64_t i = valid; i < head; ++i) {
+                TraceEvent const &event = events[i - begin];
+
+                fprintf(file, ",{\"name\":");
+                writeTraceString(file, event.name);
+                fprintf(file, ",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}", buffer->tid, event.start/1000.0, event.duration/1000.0);
+            }
+        }
+
+        fprintf(file, "]}\n");
+
+        delete[] events;
+        return !fclose(file);
+    };
+}
+
+#endif
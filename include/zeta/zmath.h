@@ -1,6 +1,17 @@
 #pragma once
 
 #include <cmath>
+#include <type_traits>
+
+// * Pick the SIMD instruction set backing the aligned vectors.
+// ? Define ZMATH_NO_SIMD to force the scalar fallback.
+#if !defined(ZMATH_NO_SIMD) && (defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1))
+    #include <xmmintrin.h>
+    #define ZMATH_SSE
+#elif !defined(ZMATH_NO_SIMD) && (defined(__ARM_NEON) || defined(_M_ARM64))
+    #include <arm_neon.h>
+    #define ZMATH_NEON
+#endif
 
 namespace ZMath {
     // * ============================================
@@ -17,6 +28,153 @@ namespace ZMath {
     #define SIGNOF(num)( num < 0 ? -1 : 1 )
 
 
+    // * ============================================
+    // * SIMD Registers
+    // * ============================================
+
+    // * Thin wrappers over the 4-wide float registers for the current instruction set.
+    // * Loads and stores require 16-byte aligned addresses.
+    namespace SIMD {
+        #if defined(ZMATH_SSE)
+
+        typedef __m128 Reg;
+
+        inline Reg load(float const* p) { return _mm_load_ps(p); };
+        inline void store(float* p, Reg a) { _mm_store_ps(p, a); };
+        inline Reg loadu(float const* p) { return _mm_loadu_ps(p); };
+        inline void storeu(float* p, Reg a) { _mm_storeu_ps(p, a); };
+
+        // Load or store only 3 floats. The 4th lane is loaded as 0.
+        inline Reg load3(float const* p) { return _mm_movelh_ps(_mm_loadl_pi(_mm_setzero_ps(), (__m64 const*) p), _mm_load_ss(p + 2)); };
+        inline void store3(float* p, Reg a) {
+            _mm_storel_pi((__m64*) p, a);
+            _mm_store_ss(p + 2, _mm_movehl_ps(a, a));
+        };
+        inline Reg set(float x, float y, float z, float w) { return _mm_setr_ps(x, y, z, w); };
+        inline Reg splat(float c) { return _mm_set1_ps(c); };
+
+        inline Reg add(Reg a, Reg b) { return _mm_add_ps(a, b); };
+        inline Reg sub(Reg a, Reg b) { return _mm_sub_ps(a, b); };
+        inline Reg mul(Reg a, Reg b) { return _mm_mul_ps(a, b); };
+        inline Reg div(Reg a, Reg b) { return _mm_div_ps(a, b); };
+        inline Reg min(Reg a, Reg b) { return _mm_min_ps(a, b); };
+        inline Reg max(Reg a, Reg b) { return _mm_max_ps(a, b); };
+        inline Reg neg(Reg a) { return _mm_xor_ps(a, _mm_set1_ps(-0.0f)); };
+        inline Reg abs(Reg a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); };
+
+        // Sum of all 4 lanes.
+        inline float sum(Reg a) {
+            Reg t = _mm_add_ps(a, _mm_movehl_ps(a, a)); // (x + z, y + w, ...)
+            return _mm_cvtss_f32(_mm_add_ss(t, _mm_shuffle_ps(t, t, _MM_SHUFFLE(1, 1, 1, 1))));
+        };
+
+        // Cross product of the first 3 lanes. The 4th lane of the result is 0 if the 4th lanes of a and b are 0.
+        inline Reg cross(Reg a, Reg b) {
+            Reg aYZX = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 2, 1));
+            Reg bYZX = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 2, 1));
+            Reg c = _mm_sub_ps(_mm_mul_ps(a, bYZX), _mm_mul_ps(aYZX, b)); // (z, x, y)
+            return _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 0, 2, 1));
+        };
+
+        // 1 if every lane of a equals the same lane of b.
+        inline bool equal(Reg a, Reg b) { return _mm_movemask_ps(_mm_cmpeq_ps(a, b)) == 0xF; };
+
+        #elif defined(ZMATH_NEON)
+
+        typedef float32x4_t Reg;
+
+        inline Reg load(float const* p) { return vld1q_f32(p); };
+        inline void store(float* p, Reg a) { vst1q_f32(p, a); };
+        inline Reg loadu(float const* p) { return vld1q_f32(p); };
+        inline void storeu(float* p, Reg a) { vst1q_f32(p, a); };
+
+        inline Reg load3(float const* p) { return vcombine_f32(vld1_f32(p), vset_lane_f32(p[2], vdup_n_f32(0.0f), 0)); };
+        inline void store3(float* p, Reg a) {
+            vst1_f32(p, vget_low_f32(a));
+            vst1q_lane_f32(p + 2, a, 2);
+        };
+        inline Reg set(float x, float y, float z, float w) { float v[4] = {x, y, z, w}; return vld1q_f32(v); };
+        inline Reg splat(float c) { return vdupq_n_f32(c); };
+
+        inline Reg add(Reg a, Reg b) { return vaddq_f32(a, b); };
+        inline Reg sub(Reg a, Reg b) { return vsubq_f32(a, b); };
+        inline Reg mul(Reg a, Reg b) { return vmulq_f32(a, b); };
+        inline Reg min(Reg a, Reg b) { return vminq_f32(a, b); };
+        inline Reg max(Reg a, Reg b) { return vmaxq_f32(a, b); };
+        inline Reg neg(Reg a) { return vnegq_f32(a); };
+        inline Reg abs(Reg a) { return vabsq_f32(a); };
+
+        #if defined(__aarch64__) || defined(_M_ARM64)
+        inline Reg div(Reg a, Reg b) { return vdivq_f32(a, b); };
+        inline float sum(Reg a) { return vaddvq_f32(a); };
+        #else
+        // ? 32-bit NEON has no division so refine the reciprocal estimate with two Newton-Raphson steps.
+        inline Reg div(Reg a, Reg b) {
+            Reg r = vrecpeq_f32(b);
+            r = vmulq_f32(vrecpsq_f32(b, r), r);
+            r = vmulq_f32(vrecpsq_f32(b, r), r);
+            return vmulq_f32(a, r);
+        };
+
+        inline float sum(Reg a) {
+            float32x2_t t = vadd_f32(vget_low_f32(a), vget_high_f32(a));
+            return vget_lane_f32(vpadd_f32(t, t), 0);
+        };
+        #endif
+
+        // Rotate (x, y, z, w) to (y, z, x, w).
+        inline Reg yzxw(Reg a) { return vsetq_lane_f32(vgetq_lane_f32(a, 3), vextq_f32(vextq_f32(a, a, 3), a, 2), 3); };
+
+        inline Reg cross(Reg a, Reg b) {
+            Reg c = vsubq_f32(vmulq_f32(a, yzxw(b)), vmulq_f32(yzxw(a), b)); // (z, x, y)
+            return yzxw(c);
+        };
+
+        inline bool equal(Reg a, Reg b) {
+            uint32x4_t eq = vceqq_f32(a, b);
+            uint32x2_t t = vand_u32(vget_low_u32(eq), vget_high_u32(eq));
+            return (vget_lane_u32(t, 0) & vget_lane_u32(t, 1)) == 0xFFFFFFFF;
+        };
+
+        #else
+
+        // ? Scalar fallback so the aligned vectors work on any target.
+        typedef struct Reg { float v[4]; } Reg;
+
+        inline Reg load(float const* p) { return {{p[0], p[1], p[2], p[3]}}; };
+        inline void store(float* p, Reg a) { for (int i = 0; i < 4; ++i) { p[i] = a.v[i]; } };
+        inline Reg loadu(float const* p) { return load(p); };
+        inline void storeu(float* p, Reg a) { store(p, a); };
+
+        inline Reg load3(float const* p) { return {{p[0], p[1], p[2], 0.0f}}; };
+        inline void store3(float* p, Reg a) { for (int i = 0; i < 3; ++i) { p[i] = a.v[i]; } };
+        inline Reg set(float x, float y, float z, float w) { return {{x, y, z, w}}; };
+        inline Reg splat(float c) { return {{c, c, c, c}}; };
+
+        inline Reg add(Reg a, Reg b) { return {{a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3]}}; };
+        inline Reg sub(Reg a, Reg b) { return {{a.v[0] - b.v[0], a.v[1] - b.v[1], a.v[2] - b.v[2], a.v[3] - b.v[3]}}; };
+        inline Reg mul(Reg a, Reg b) { return {{a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2], a.v[3] * b.v[3]}}; };
+        inline Reg div(Reg a, Reg b) { return {{a.v[0] / b.v[0], a.v[1] / b.v[1], a.v[2] / b.v[2], a.v[3] / b.v[3]}}; };
+        inline Reg min(Reg a, Reg b) { return {{a.v[0] < b.v[0] ? a.v[0] : b.v[0], a.v[1] < b.v[1] ? a.v[1] : b.v[1], a.v[2] < b.v[2] ? a.v[2] : b.v[2], a.v[3] < b.v[3] ? a.v[3] : b.v[3]}}; };
+        inline Reg max(Reg a, Reg b) { return {{a.v[0] > b.v[0] ? a.v[0] : b.v[0], a.v[1] > b.v[1] ? a.v[1] : b.v[1], a.v[2] > b.v[2] ? a.v[2] : b.v[2], a.v[3] > b.v[3] ? a.v[3] : b.v[3]}}; };
+        inline Reg neg(Reg a) { return {{-a.v[0], -a.v[1], -a.v[2], -a.v[3]}}; };
+        inline Reg abs(Reg a) { return {{std::fabs(a.v[0]), std::fabs(a.v[1]), std::fabs(a.v[2]), std::fabs(a.v[3])}}; };
+
+        inline float sum(Reg a) { return (a.v[0] + a.v[2]) + (a.v[1] + a.v[3]); };
+
+        inline Reg cross(Reg a, Reg b) {
+            return {{a.v[1]*b.v[2] - a.v[2]*b.v[1], a.v[2]*b.v[0] - a.v[0]*b.v[2], a.v[0]*b.v[1] - a.v[1]*b.v[0], 0.0f}};
+        };
+
+        inline bool equal(Reg a, Reg b) { return a.v[0] == b.v[0] && a.v[1] == b.v[1] && a.v[2] == b.v[2] && a.v[3] == b.v[3]; };
+
+        #endif
+
+        // a*b + c
+        inline Reg mulAdd(Reg a, Reg b, Reg c) { return add(mul(a, b), c); };
+    }
+
+
     // * Class modeling a 2D Vector.
     class Vec2D {
         public:
@@ -37,8 +195,9 @@ namespace ZMath {
             // * Instantiate a Vec3D object with each component assigned.
             Vec2D(float i, float j) : x(i), y(j) {};
 
-            // * Instantiate a copy of the Vec3D object passed in.
-            Vec2D(const Vec2D &vec) : x(vec.x), y(vec.y) {};
+            // * Instantiate a copy of the Vec2D object passed in.
+            // ? Defaulted so the vector stays trivially copyable.
+            Vec2D(const Vec2D &vec) = default;
 
             // * ============================
             // * Functions
@@ -171,7 +330,8 @@ namespace ZMath {
             Vec3D(float i, float j, float k) : x(i), y(j), z(k) {};
 
             // * Instantiate a copy of the Vec3D object passed in.
-            Vec3D(const Vec3D &vec) : x(vec.x), y(vec.y), z(vec.z) {};
+            // ? Defaulted so the vector stays trivially copyable. This allows memcpy and lets the compiler vectorize copies.
+            Vec3D(const Vec3D &vec) = default;
 
             // * ============================
             // * Functions
@@ -376,12 +536,7 @@ namespace ZMath {
             Mat2D() = default;
 
             // Create a 2D matrix from another 2D matrix.
-            Mat2D (const Mat2D &mat) {
-                c1.x = mat.c1.x;
-                c1.y = mat.c1.y;
-                c2.x = mat.c2.x;
-                c2.y = mat.c2.y;
-            };
+            Mat2D (const Mat2D &mat) = default;
 
             // Create a 2D matrix from 2 column vectors.
             Mat2D (const Vec2D &col1, const Vec2D &col2) {
@@ -552,11 +707,7 @@ namespace ZMath {
             Mat3D() = default;
 
             // Create a 3D matrix from another 3D matrix.
-            Mat3D (const Mat3D &mat) {
-                c1.set(mat.c1);
-                c2.set(mat.c2);
-                c3.set(mat.c3);
-            };
+            Mat3D (const Mat3D &mat) = default;
 
             // Create a 3D matrix from 2 column vectors.
             Mat3D (const Vec3D &col1, const Vec3D &col2, const Vec3D &col3) {
@@ -603,23 +754,18 @@ namespace ZMath {
             inline Mat3D operator + (const Mat3D &mat) const { return Mat3D(c1 + mat.c1, c2 + mat.c2, c3 + mat.c3); };
             inline Mat3D operator - (const Mat3D &mat) const { return Mat3D(c1 - mat.c1, c2 - mat.c2, c3 - mat.c3); };
 
+            // ? Each column of the product is a combination of our columns, so the columns are kept in registers.
+            // ? The first two columns are loaded and stored 4 floats at a time. Their 4th lane overlaps the next column,
+            // ?  which is harmless since it is never used and the next column is written afterwards.
             inline Mat3D operator * (const Mat3D &mat) const {
-                return Mat3D(
-                    // row 1
-                    c1.x*mat.c1.x + c2.x*mat.c1.y + c3.x*mat.c1.z,
-                    c1.x*mat.c2.x + c2.x*mat.c2.y + c3.x*mat.c2.z,
-                    c1.x*mat.c3.x + c2.x*mat.c3.y + c3.x*mat.c3.z,
-
-                    // row 2
-                    c1.y*mat.c1.x + c2.y*mat.c1.y + c3.y*mat.c1.z,
-                    c1.y*mat.c2.x + c2.y*mat.c2.y + c3.y*mat.c2.z,
-                    c1.y*mat.c3.x + c2.y*mat.c3.y + c3.y*mat.c3.z,
-
-                    // row 3
-                    c1.z*mat.c1.x + c2.z*mat.c1.y + c3.z*mat.c1.z,
-                    c1.z*mat.c2.x + c2.z*mat.c2.y + c3.z*mat.c2.z,
-                    c1.z*mat.c3.x + c2.z*mat.c3.y + c3.z*mat.c3.z
-                );
+                SIMD::Reg a = SIMD::loadu(&c1.x), b = SIMD::loadu(&c2.x), c = SIMD::load3(&c3.x);
+                Mat3D result;
+
+                SIMD::storeu(&result.c1.x, SIMD::mulAdd(a, SIMD::splat(mat.c1.x), SIMD::mulAdd(b, SIMD::splat(mat.c1.y), SIMD::mul(c, SIMD::splat(mat.c1.z)))));
+                SIMD::storeu(&result.c2.x, SIMD::mulAdd(a, SIMD::splat(mat.c2.x), SIMD::mulAdd(b, SIMD::splat(mat.c2.y), SIMD::mul(c, SIMD::splat(mat.c2.z)))));
+                SIMD::store3(&result.c3.x, SIMD::mulAdd(a, SIMD::splat(mat.c3.x), SIMD::mulAdd(b, SIMD::splat(mat.c3.y), SIMD::mul(c, SIMD::splat(mat.c3.z)))));
+
+                return result;
             };
 
             inline Mat3D operator * (float c) const { return Mat3D(c1*c, c2*c, c3*c); };
@@ -852,4 +998,418 @@ namespace ZMath {
             std::fabs(mat.c1.z), std::fabs(mat.c2.z), std::fabs(mat.c3.z)
         );
     };
+
+    /**
+     * @brief Transform a list of vectors by a matrix and then translate them: out[i] = mat * in[i] + offset.
+     *        Much faster than transforming each vector separately for more than a few vectors.
+     *
+     * @param mat The matrix to transform the vectors by.
+     * @param in The vectors to transform.
+     * @param out Filled with the transformed vectors. This can be the same list as in.
+     * @param n The number of vectors.
+     * @param offset Added to each vector after it is transformed.
+     */
+    inline void transform(Mat3D const &mat, Vec3D const* in, Vec3D* out, int n, Vec3D const &offset = Vec3D()) {
+        int i = 0;
+
+        #if defined(ZMATH_SSE) || defined(ZMATH_NEON)
+        // ? 4 vectors at a time are transposed into registers holding their x, y, and z components so each
+        // ?  row of the matrix is applied to all 4 vectors at once.
+        SIMD::Reg m11 = SIMD::splat(mat.c1.x), m21 = SIMD::splat(mat.c1.y), m31 = SIMD::splat(mat.c1.z);
+        SIMD::Reg m12 = SIMD::splat(mat.c2.x), m22 = SIMD::splat(mat.c2.y), m32 = SIMD::splat(mat.c2.z);
+        SIMD::Reg m13 = SIMD::splat(mat.c3.x), m23 = SIMD::splat(mat.c3.y), m33 = SIMD::splat(mat.c3.z);
+        SIMD::Reg ox = SIMD::splat(offset.x), oy = SIMD::splat(offset.y), oz = SIMD::splat(offset.z);
+
+        for (; i + 4 <= n; i += 4) {
+            float const* src = &in[i].x;
+            float* dst = &out[i].x;
+
+            #if defined(ZMATH_SSE)
+            // (x0, y0, z0, x1), (y1, z1, x2, y2), (z2, x3, y3, z3)
+            __m128 a = _mm_loadu_ps(src), b = _mm_loadu_ps(src + 4), c = _mm_loadu_ps(src + 8);
+
+            __m128 xs = _mm_shuffle_ps(a, _mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 1, 2, 2)), _MM_SHUFFLE(2, 0, 3, 0));
+            __m128 ys = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1)), _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+            __m128 zs = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2)), _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 3, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0));
+            #else
+            float32x4x3_t v = vld3q_f32(src);
+            float32x4_t xs = v.val[0], ys = v.val[1], zs = v.val[2];
+            #endif
+
+            SIMD::Reg x = SIMD::mulAdd(m11, xs, SIMD::mulAdd(m12, ys, SIMD::mulAdd(m13, zs, ox)));
+            SIMD::Reg y = SIMD::mulAdd(m21, xs, SIMD::mulAdd(m22, ys, SIMD::mulAdd(m23, zs, oy)));
+            SIMD::Reg z = SIMD::mulAdd(m31, xs, SIMD::mulAdd(m32, ys, SIMD::mulAdd(m33, zs, oz)));
+
+            #if defined(ZMATH_SSE)
+            _mm_storeu_ps(dst, _mm_shuffle_ps(_mm_shuffle_ps(x, y, _MM_SHUFFLE(0, 0, 0, 0)), _mm_shuffle_ps(z, x, _MM_SHUFFLE(1, 1, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0)));
+            _mm_storeu_ps(dst + 4, _mm_shuffle_ps(_mm_shuffle_ps(y, z, _MM_SHUFFLE(1, 1, 1, 1)), _mm_shuffle_ps(x, y, _MM_SHUFFLE(2, 2, 2, 2)), _MM_SHUFFLE(2, 0, 2, 0)));
+            _mm_storeu_ps(dst + 8, _mm_shuffle_ps(_mm_shuffle_ps(z, x, _MM_SHUFFLE(3, 3, 2, 2)), _mm_shuffle_ps(y, z, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0)));
+            #else
+            v.val[0] = x;
+            v.val[1] = y;
+            v.val[2] = z;
+            vst3q_f32(dst, v);
+            #endif
+        }
+        #endif
+
+        for (; i < n; ++i) { out[i] = mat * in[i] + offset; }
+    };
+
+    static_assert(std::is_trivially_copyable<Vec2D>::value, "Vec2D must be trivially copyable.");
+    static_assert(std::is_trivially_copyable<Vec3D>::value, "Vec3D must be trivially copyable.");
+    static_assert(std::is_trivially_copyable<Mat2D>::value, "Mat2D must be trivially copyable.");
+    static_assert(std::is_trivially_copyable<Mat3D>::value, "Mat3D must be trivially copyable.");
+
+
+    // * ============================================
+    // * Quaternions
+    // * ============================================
+
+    // * Class modeling a unit quaternion used to represent an orientation.
+    class Quaternion {
+        public:
+            // * Scalar part, w, and vector part, (x, y, z).
+            float w, x, y, z;
+
+            // * ============================
+            // * Constructors
+            // * ============================
+
+            // * Instantiate the identity rotation.
+            Quaternion() : w(1), x(0), y(0), z(0) {};
+
+            // * Instantiate a Quaternion with each component assigned.
+            Quaternion(float w, float i, float j, float k) : w(w), x(i), y(j), z(k) {};
+
+            // * Instantiate the rotation about a normalized axis by an angle in radians.
+            static inline Quaternion fromAxisAngle(Vec3D const &axis, float angle) {
+                float s = sinf(angle * 0.5f);
+                return Quaternion(cosf(angle * 0.5f), axis.x * s, axis.y * s, axis.z * s);
+            };
+
+            // * Instantiate the rotation represented by a rotation matrix.
+            static inline Quaternion fromMat3D(Mat3D const &mat) {
+                // ? Divide by the largest of the 4 components to avoid losing precision.
+                float trace = mat.c1.x + mat.c2.y + mat.c3.z;
+
+                if (trace > 0.0f) {
+                    float s = sqrtf(trace + 1.0f) * 2.0f;
+                    return Quaternion(0.25f * s, (mat.c2.z - mat.c3.y)/s, (mat.c3.x - mat.c1.z)/s, (mat.c1.y - mat.c2.x)/s);
+                }
+
+                if (mat.c1.x > mat.c2.y && mat.c1.x > mat.c3.z) {
+                    float s = sqrtf(1.0f + mat.c1.x - mat.c2.y - mat.c3.z) * 2.0f;
+                    return Quaternion((mat.c2.z - mat.c3.y)/s, 0.25f * s, (mat.c2.x + mat.c1.y)/s, (mat.c3.x + mat.c1.z)/s);
+                }
+
+                if (mat.c2.y > mat.c3.z) {
+                    float s = sqrtf(1.0f + mat.c2.y - mat.c1.x - mat.c3.z) * 2.0f;
+                    return Quaternion((mat.c3.x - mat.c1.z)/s, (mat.c2.x + mat.c1.y)/s, 0.25f * s, (mat.c3.y + mat.c2.z)/s);
+                }
+
+                float s = sqrtf(1.0f + mat.c3.z - mat.c1.x - mat.c2.y) * 2.0f;
+                return Quaternion((mat.c1.y - mat.c2.x)/s, (mat.c3.x + mat.c1.z)/s, (mat.c3.y + mat.c2.z)/s, 0.25f * s);
+            };
+
+            // * ============================
+            // * Functions
+            // * ============================
+
+            // * Combine two rotations. The result applies quat first and then this rotation.
+            inline Quaternion operator * (Quaternion const &quat) const {
+                return Quaternion(
+                    w*quat.w - x*quat.x - y*quat.y - z*quat.z,
+                    w*quat.x + x*quat.w + y*quat.z - z*quat.y,
+                    w*quat.y - x*quat.z + y*quat.w + z*quat.x,
+                    w*quat.z + x*quat.y - y*quat.x + z*quat.w
+                );
+            };
+
+            inline bool operator == (Quaternion const &quat) const { return w == quat.w && x == quat.x && y == quat.y && z == quat.z; };
+            inline bool operator != (Quaternion const &quat) const { return w != quat.w || x != quat.x || y != quat.y || z != quat.z; };
+
+            // * Get the inverse rotation.
+            inline Quaternion conjugate() const { return Quaternion(w, -x, -y, -z); };
+
+            // * Get the magnitude squared of this quaternion.
+            inline float magSq() const { return w*w + x*x + y*y + z*z; };
+
+            // * Scale this quaternion to unit length.
+            inline Quaternion normalize() const {
+                float inv = 1.0f/sqrtf(w*w + x*x + y*y + z*z);
+                return Quaternion(w*inv, x*inv, y*inv, z*inv);
+            };
+
+            // * Rotate a vector by this rotation.
+            inline Vec3D rotate(Vec3D const &vec) const {
+                // v' = v + 2w(q x v) + 2q x (q x v), where q is the vector part
+                Vec3D q(x, y, z);
+                Vec3D t = q.cross(vec) * 2.0f;
+                return vec + t * w + q.cross(t);
+            };
+
+            // * Advance this rotation by an angular velocity in radians per second over dt seconds.
+            // * The result is normalized to keep numerical drift from scaling the rotation.
+            inline Quaternion integrate(Vec3D const &angVel, float dt) const {
+                // dq/dt = 0.5 * (0, angVel) * q
+                Quaternion dq = Quaternion(0.0f, angVel.x, angVel.y, angVel.z) * (*this);
+                float h = 0.5f * dt;
+
+                return Quaternion(w + dq.w*h, x + dq.x*h, y + dq.y*h, z + dq.z*h).normalize();
+            };
+
+            // * Get the rotation matrix for this rotation. Its columns are the rotated x, y, and z axes.
+            inline Mat3D toMat3D() const {
+                float xx = x*x, yy = y*y, zz = z*z, xy = x*y, xz = x*z, yz = y*z, wx = w*x, wy = w*y, wz = w*z;
+
+                return Mat3D(
+                    Vec3D(1.0f - 2.0f*(yy + zz), 2.0f*(xy + wz), 2.0f*(xz - wy)),
+                    Vec3D(2.0f*(xy - wz), 1.0f - 2.0f*(xx + zz), 2.0f*(yz + wx)),
+                    Vec3D(2.0f*(xz + wy), 2.0f*(yz - wx), 1.0f - 2.0f*(xx + yy))
+                );
+            };
+    };
+
+    static_assert(std::is_trivially_copyable<Quaternion>::value, "Quaternion must be trivially copyable.");
+
+
+    // * ============================================
+    // * Aligned Vectors
+    // * ============================================
+
+    // * Class modeling a 3D Vector stored in a 16-byte aligned SIMD register.
+    // * Has the same API as Vec3D. Hot paths can opt into it by converting from Vec3D once and doing their math in registers.
+    class alignas(16) Vec3A {
+        public:
+            // * ============================
+            // * Vector Components
+            // * ============================
+
+            // * x, y, and z components. These are public for ease of access and assignment.
+            float x, y, z;
+
+            // * Padding to fill the register. This is kept at 0 so it does not affect dot products.
+            float w;
+
+            // * ============================
+            // * Constructors
+            // * ============================
+
+            // * Instantiate a Vec3A object with all components set to the same value.
+            Vec3A(float d = 0) : x(d), y(d), z(d), w(0) {};
+
+            // * Instantiate a Vec3A object with each component assigned.
+            Vec3A(float i, float j, float k) : x(i), y(j), z(k), w(0) {};
+
+            // * Instantiate a Vec3A object from a Vec3D.
+            explicit Vec3A(Vec3D const &vec) : x(vec.x), y(vec.y), z(vec.z), w(0) {};
+
+            // * Instantiate a Vec3A object from a register. The 4th lane must be 0.
+            explicit Vec3A(SIMD::Reg r) { SIMD::store(&x, r); };
+
+            // * ============================
+            // * Functions
+            // * ============================
+
+            // * Get the register holding this vector.
+            inline SIMD::Reg reg() const { return SIMD::load(&x); };
+
+            // * Convert this vector back to a Vec3D.
+            inline Vec3D toVec3D() const { return Vec3D(x, y, z); };
+
+            // * Zero this vector.
+            void zero() { SIMD::store(&x, SIMD::splat(0.0f)); };
+
+            // * Set this vector's components equal to another.
+            void set (Vec3A const &vec) { SIMD::store(&x, vec.reg()); };
+
+            // * Set all components of this vector to the same value.
+            void set (float d) { SIMD::store(&x, SIMD::set(d, d, d, 0.0f)); };
+
+            // * Set each component of this vector.
+            void set (float i, float j, float k) { SIMD::store(&x, SIMD::set(i, j, k, 0.0f)); };
+
+            inline Vec3A operator + (Vec3A const &vec) const { return Vec3A(SIMD::add(reg(), vec.reg())); };
+            inline Vec3A operator - (Vec3A const &vec) const { return Vec3A(SIMD::sub(reg(), vec.reg())); };
+            inline Vec3A operator * (float c) const { return Vec3A(SIMD::mul(reg(), SIMD::splat(c))); };
+            inline float operator * (Vec3A const &vec) const { return SIMD::sum(SIMD::mul(reg(), vec.reg())); };
+
+            // ? The scalar is only added to the first 3 lanes to keep w at 0.
+            inline Vec3A operator + (float c) const { return Vec3A(SIMD::add(reg(), SIMD::set(c, c, c, 0.0f))); };
+            inline Vec3A operator - (float c) const { return Vec3A(SIMD::sub(reg(), SIMD::set(c, c, c, 0.0f))); };
+
+            inline bool operator != (Vec3A const &vec) const { return !SIMD::equal(reg(), vec.reg()); };
+            inline bool operator == (Vec3A const &vec) const { return SIMD::equal(reg(), vec.reg()); };
+
+            Vec3A& operator += (Vec3A const &vec) {
+                SIMD::store(&x, SIMD::add(reg(), vec.reg()));
+                return *this;
+            };
+
+            Vec3A& operator += (float c) {
+                SIMD::store(&x, SIMD::add(reg(), SIMD::set(c, c, c, 0.0f)));
+                return *this;
+            };
+
+            Vec3A& operator -= (Vec3A const &vec) {
+                SIMD::store(&x, SIMD::sub(reg(), vec.reg()));
+                return *this;
+            };
+
+            Vec3A& operator -= (float c) {
+                SIMD::store(&x, SIMD::sub(reg(), SIMD::set(c, c, c, 0.0f)));
+                return *this;
+            };
+
+            Vec3A& operator *= (float c) {
+                SIMD::store(&x, SIMD::mul(reg(), SIMD::splat(c)));
+                return *this;
+            };
+
+            // * Negate this vector.
+            inline Vec3A operator - () const { return Vec3A(SIMD::neg(reg())); };
+
+            // * Get the cross product of this vector and another.
+            inline Vec3A cross (Vec3A const &vec) const { return Vec3A(SIMD::cross(reg(), vec.reg())); };
+
+            // * Get the magnitude of this vector.
+            inline float mag() const { return sqrtf((*this) * (*this)); };
+
+            // * Get the magnitude squared of this vector.
+            inline float magSq() const { return (*this) * (*this); };
+
+            // * Get the projection of this vector onto another.
+            inline Vec3A proj (Vec3A const &vec) const { return (*this) * (((*this) * vec)/magSq()); };
+
+            // * Get the distance between this vector and another.
+            inline float dist (Vec3A const &vec) const { return ((*this) - vec).mag(); };
+
+            // * Get the distance squared between this vector and another.
+            inline float distSq (Vec3A const &vec) const { return ((*this) - vec).magSq(); };
+
+            // * Get the normal vector of this vector.
+            inline Vec3A normalize() const { return (*this) * (1.0f/mag()); };
+
+            // * Get the angle in radians between this vector and another.
+            inline float angle (Vec3A const &vec) const { return acos(((*this) * vec)/sqrtf(magSq() * vec.magSq())); };
+
+            // * Get the signs of each component of this vector.
+            inline Vec3A getSigns() const { return Vec3A(SIGNOF(x), SIGNOF(y), SIGNOF(z)); };
+    };
+
+    // * Class modeling a 4D Vector stored in a 16-byte aligned SIMD register.
+    class alignas(16) Vec4 {
+        public:
+            // * ============================
+            // * Vector Components
+            // * ============================
+
+            // * x, y, z, and w components. These are public for ease of access and assignment.
+            float x, y, z, w;
+
+            // * ============================
+            // * Constructors
+            // * ============================
+
+            // * Instantiate a Vec4 object with all components set to the same value.
+            Vec4(float d = 0) : x(d), y(d), z(d), w(d) {};
+
+            // * Instantiate a Vec4 object with each component assigned.
+            Vec4(float i, float j, float k, float l) : x(i), y(j), z(k), w(l) {};
+
+            // * Instantiate a Vec4 object from a Vec3D and a w component.
+            explicit Vec4(Vec3D const &vec, float l = 0) : x(vec.x), y(vec.y), z(vec.z), w(l) {};
+
+            // * Instantiate a Vec4 object from a register.
+            explicit Vec4(SIMD::Reg r) { SIMD::store(&x, r); };
+
+            // * ============================
+            // * Functions
+            // * ============================
+
+            // * Get the register holding this vector.
+            inline SIMD::Reg reg() const { return SIMD::load(&x); };
+
+            // * Zero this vector.
+            void zero() { SIMD::store(&x, SIMD::splat(0.0f)); };
+
+            // * Set this vector's components equal to another.
+            void set (Vec4 const &vec) { SIMD::store(&x, vec.reg()); };
+
+            // * Set all components of this vector to the same value.
+            void set (float d) { SIMD::store(&x, SIMD::splat(d)); };
+
+            // * Set each component of this vector.
+            void set (float i, float j, float k, float l) { SIMD::store(&x, SIMD::set(i, j, k, l)); };
+
+            inline Vec4 operator + (Vec4 const &vec) const { return Vec4(SIMD::add(reg(), vec.reg())); };
+            inline Vec4 operator - (Vec4 const &vec) const { return Vec4(SIMD::sub(reg(), vec.reg())); };
+            inline Vec4 operator * (float c) const { return Vec4(SIMD::mul(reg(), SIMD::splat(c))); };
+            inline float operator * (Vec4 const &vec) const { return SIMD::sum(SIMD::mul(reg(), vec.reg())); };
+            inline Vec4 operator + (float c) const { return Vec4(SIMD::add(reg(), SIMD::splat(c))); };
+            inline Vec4 operator - (float c) const { return Vec4(SIMD::sub(reg(), SIMD::splat(c))); };
+
+            inline bool operator != (Vec4 const &vec) const { return !SIMD::equal(reg(), vec.reg()); };
+            inline bool operator == (Vec4 const &vec) const { return SIMD::equal(reg(), vec.reg()); };
+
+            Vec4& operator += (Vec4 const &vec) {
+                SIMD::store(&x, SIMD::add(reg(), vec.reg()));
+                return *this;
+            };
+
+            Vec4& operator += (float c) {
+                SIMD::store(&x, SIMD::add(reg(), SIMD::splat(c)));
+                return *this;
+            };
+
+            Vec4& operator -= (Vec4 const &vec) {
+                SIMD::store(&x, SIMD::sub(reg(), vec.reg()));
+                return *this;
+            };
+
+            Vec4& operator -= (float c) {
+                SIMD::store(&x, SIMD::sub(reg(), SIMD::splat(c)));
+                return *this;
+            };
+
+            Vec4& operator *= (float c) {
+                SIMD::store(&x, SIMD::mul(reg(), SIMD::splat(c)));
+                return *this;
+            };
+
+            // * Negate this vector.
+            inline Vec4 operator - () const { return Vec4(SIMD::neg(reg())); };
+
+            // * Get the magnitude of this vector.
+            inline float mag() const { return sqrtf((*this) * (*this)); };
+
+            // * Get the magnitude squared of this vector.
+            inline float magSq() const { return (*this) * (*this); };
+
+            // * Get the distance between this vector and another.
+            inline float dist (Vec4 const &vec) const { return ((*this) - vec).mag(); };
+
+            // * Get the distance squared between this vector and another.
+            inline float distSq (Vec4 const &vec) const { return ((*this) - vec).magSq(); };
+
+            // * Get the normal vector of this vector.
+            inline Vec4 normalize() const { return (*this) * (1.0f/mag()); };
+    };
+
+    static_assert(std::is_trivially_copyable<Vec3A>::value && alignof(Vec3A) == 16, "Vec3A must be trivially copyable and 16-byte aligned.");
+    static_assert(std::is_trivially_copyable<Vec4>::value && alignof(Vec4) == 16, "Vec4 must be trivially copyable and 16-byte aligned.");
+
+    // * Get the absolute value of all components in an aligned vector.
+    inline Vec3A abs(Vec3A const &vec) { return Vec3A(SIMD::abs(vec.reg())); };
+    inline Vec4 abs(Vec4 const &vec) { return Vec4(SIMD::abs(vec.reg())); };
+
+    // * Get the minimum and maximum of each component of two aligned vectors.
+    inline Vec3A min(Vec3A const &a, Vec3A const &b) { return Vec3A(SIMD::min(a.reg(), b.reg())); };
+    inline Vec3A max(Vec3A const &a, Vec3A const &b) { return Vec3A(SIMD::max(a.reg(), b.reg())); };
+    inline Vec4 min(Vec4 const &a, Vec4 const &b) { return Vec4(SIMD::min(a.reg(), b.reg())); };
+    inline Vec4 max(Vec4 const &a, Vec4 const &b) { return Vec4(SIMD::max(a.reg(), b.reg())); };
+
+    // * Clamp each component of an aligned vector.
+    inline Vec3A clamp(Vec3A const &n, Vec3A const &min, Vec3A const &max) { return Vec3A(SIMD::max(SIMD::min(n.reg(), max.reg()), min.reg())); };
 }